@@ -14,6 +14,10 @@
 #include "chemfiles/Property.hpp"
 #include "chemfiles/Atom.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
+#include "chemfiles/FrameStore.hpp"
+#include "chemfiles/Transformations.hpp"
+#include "chemfiles/Superposition.hpp"
 #include "chemfiles/Topology.hpp"
 #include "chemfiles/Residue.hpp"
 #include "chemfiles/Trajectory.hpp"
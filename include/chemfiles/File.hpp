@@ -13,6 +13,7 @@
 #include <fmt/format.h>
 
 #include "chemfiles/exports.h"
+#include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
 
@@ -101,6 +102,23 @@ public:
     /// @throws FileError if it could not write all of the data to the file
     virtual void write(const char* data, size_t count) = 0;
 
+    /// Get the total number of characters in the file, or `nullopt` if this
+    /// can not be known without reading the whole file. The default
+    /// implementation returns `nullopt`.
+    ///
+    /// @throws FileError in case of I/O error
+    virtual optional<uint64_t> size() {
+        return nullopt;
+    }
+
+    /// Make all the data written so far readable from the file on disk. For
+    /// compressed files, this completes the current compressed stream, and
+    /// any data written after this goes in a new compressed stream. The
+    /// default implementation does nothing.
+    ///
+    /// @throws FileError in case of I/O error
+    virtual void flush() {}
+
 protected:
     /// Get the string path used to open this file
     std::string_view path() const {
@@ -155,6 +173,13 @@ public:
     /// Set the position indicator to `position`.
     void seekpos(uint64_t position);
 
+    /// Get the total number of characters in the file, if it can be known
+    /// without reading the whole file (i.e. for uncompressed and in-memory
+    /// files), or `nullopt` otherwise.
+    optional<uint64_t> size() {
+        return file_->size();
+    }
+
     /// Reset the position indicator to the beginning of the file, and clear
     /// end-of-file flag.
     void rewind();
@@ -167,12 +192,25 @@ public:
     /// Clear end-of-file flags on the file.
     void clear();
 
+    /// Discard any buffered data and clear end-of-file flags, so that data
+    /// appended to the file (by another process) after it was read becomes
+    /// visible to the next read operations. The current position is not
+    /// changed.
+    void refresh();
+
     /// Read a single line from the file. The returned `string_view` points into
     /// an internal buffer, and can be invalidated after another call to
     /// `readline`. If storing the line is necessary, transform it to an owned
     /// string using `string_view::to_string()`.
     std::string_view readline();
 
+    /// Get a view of the next `count` characters in the file, without moving
+    /// the position indicator. The returned `string_view` points into an
+    /// internal buffer, and can be invalidated after another call to `peek` or
+    /// `readline`. It contains less than `count` characters if the end of the
+    /// file is reached before.
+    std::string_view peek(size_t count);
+
     /// Read the full file into an owned string. This is a convenience method
     /// for format that need the full file read before parsing can start.
     std::string readall();
@@ -186,6 +224,16 @@ public:
         this->vprint(format, fmt::make_format_args(args...));
     }
 
+    /// Write the `data` to the file, without any formatting.
+    void write(std::string_view data);
+
+    /// Make all the data written so far readable from the file on disk. For
+    /// compressed files, data written after this goes in a new compressed
+    /// stream.
+    void flush() {
+        file_->flush();
+    }
+
 private:
     /// Fill the buffer, calling `refill` and setting all needed internal values
     void fill_buffer(size_t start);
@@ -8,15 +8,19 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 
 #include "chemfiles/exports.h"
 
 #include "chemfiles/File.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/offset_index.hpp"
 #include "chemfiles/Error.hpp"
 #include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
 class Frame;
+class FrameView;
 class MemoryBuffer;
 class FormatMetadata;
 
@@ -74,6 +78,20 @@ public:
     /// @param frame The frame to fill
     virtual void read_step(size_t step, Frame& frame);
 
+    /// Read multiple `steps` from the trajectory file, storing the step
+    /// `steps[i]` in `frames[i]`. Both vectors have the same size.
+    ///
+    /// The default implementation calls `Format::read_step` for each step.
+    /// Formats with random access to the steps should override this function
+    /// to fetch the data for all the steps together.
+    ///
+    /// @throw FormatError if the file does not follow the format
+    /// @throw FileError if their is an OS error while reading the file
+    ///
+    /// @param steps The steps to read
+    /// @param frames The frames to fill
+    virtual void read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames);
+
     /// Read the next step from the trajectory file.
     ///
     /// @throw FormatError if the file does not follow the format
@@ -90,11 +108,87 @@ public:
     /// @param frame The frame to be written
     virtual void write(const Frame& frame);
 
+    /// Write the frame referenced by a `FrameView` to the trajectory file.
+    ///
+    /// The default implementation calls `Format::write` with the frame the
+    /// view was created from if the view still refers to all of its data, and
+    /// copies the view to a new `Frame` otherwise. Formats which only need
+    /// positions, velocities and the unit cell should override this function
+    /// to avoid the copy.
+    ///
+    /// @throw FormatError if the file does not follow the format
+    /// @throw FileError if their is an OS error while reading the file
+    ///
+    /// @param frame The frame to be written
+    virtual void write_view(const FrameView& frame);
+
+    /// Write multiple frames to the trajectory file, in order.
+    ///
+    /// The default implementation calls `Format::write_view` for each frame.
+    /// Formats where the frames can be encoded independently should override
+    /// this function to encode them in parallel.
+    ///
+    /// @throw FormatError if the file does not follow the format
+    /// @throw FileError if their is an OS error while reading the file
+    ///
+    /// @param frames The frames to be written
+    virtual void write_views(const std::vector<FrameView>& frames);
+
     /// Get the number of frames in the associated file. This function can be
     /// expensive to call since it may needs to scan the whole file.
     ///
     /// @return The number of frames
     virtual size_t nsteps() = 0;
+
+    /// Look for steps appended to the file since it was opened or since the
+    /// last call to this function, and get the updated number of steps. This
+    /// should only look at the new data in the file, and steps which are
+    /// still being written should not be counted until they are complete.
+    ///
+    /// @throw FormatError if the format does not support this operation
+    /// @throw FileError if their is an OS error while reading the file
+    ///
+    /// @return The number of frames
+    virtual size_t refresh();
+
+    /// Use the given access `pattern` to read the file, requesting the data
+    /// of the next `readahead` steps in advance when reading sequentially.
+    ///
+    /// This only gives hints to the operating system, and the default
+    /// implementation does nothing.
+    ///
+    /// @param pattern how the steps will be read
+    /// @param readahead number of steps to request in advance
+    virtual void set_access_pattern(AccessPattern pattern, size_t readahead);
+
+    /// Only the first `count` atoms of the frames read from this format will
+    /// be used, or all the atoms if `count` is `nullopt`. Formats can use this
+    /// to skip reading the other atoms, and only put the first `count` atoms
+    /// in the frames.
+    ///
+    /// This is only a hint, and the default implementation does nothing.
+    ///
+    /// @param count number of atoms at the beginning of each frame to read
+    virtual void set_needed_atoms(optional<size_t> count);
+
+    /// Check if this format waits until the steps are needed to find them in
+    /// the file, instead of finding all of them when opening the file. In
+    /// this case, `Format::nsteps` is only called when the number of steps is
+    /// needed. In append mode, `Format::nsteps` should then also count the
+    /// steps written since the file was opened.
+    ///
+    /// The default implementation returns `false`.
+    virtual bool lazy_steps() const;
+
+    /// Locate the steps in the file by bisection over the file content when
+    /// reading them, instead of finding all the steps in the file. Formats
+    /// implementing this should also return `true` from
+    /// `Format::lazy_steps`.
+    ///
+    /// @throw FormatError if the format does not support bisection
+    ///
+    /// @return An estimate of the number of steps in the file
+    virtual size_t bisect_steps();
 };
 
 /// The `TextFormat` class defines a common, simpler interface for text based
@@ -107,21 +201,54 @@ class CHFL_EXPORT TextFormat: public Format {
 public:
     TextFormat(std::string path, File::Mode mode, File::Compression compression);
     TextFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression);
+    explicit TextFormat(TextFile file);
     virtual ~TextFormat() override = default;
 
     void read_step(size_t step, Frame& frame) override;
     void read(Frame& frame) override;
     void write(const Frame& frame) override;
+    void write_views(const std::vector<FrameView>& frames) override;
     size_t nsteps() override;
+    size_t refresh() override;
+    bool lazy_steps() const override;
 
     /// Fast-forward the file for one step, returning a valid position if the
     /// file does contain one more step or `nullopt` if it does not.
     virtual optional<uint64_t> forward() = 0;
 
     virtual void read_next(Frame& frame);
+
+    /// Write the `frame` to the file. The default implementation calls
+    /// `TextFormat::format_next` and writes the result to the file.
     virtual void write_next(const Frame& frame);
 
+    /// Format the `frame` as text, appending the result to `buffer` instead of
+    /// writing it to the file. `step` is the index of this frame among the
+    /// frames written with this format.
+    ///
+    /// Formats where the text for a step does not depend on the previous
+    /// steps should implement this function instead of
+    /// `TextFormat::write_next`, allowing to format multiple frames in
+    /// parallel in `TextFormat::write_views`. This function can be called
+    /// from multiple threads at the same time.
+    ///
+    /// @return `false` if this format does not implement this function, which
+    ///         is the default
+    virtual bool format_next(const Frame& frame, size_t step, std::string& buffer) const;
+
 protected:
+    /// Format the `count` items (usually atoms) in `[0, count)` as text,
+    /// appending the result to `buffer` in order. `format(start, stop, chunk)`
+    /// should append the text for the items in `[start, stop)` to `chunk`.
+    ///
+    /// Large number of items are split in chunks formatted in parallel, using
+    /// the chemfiles thread pool.
+    static void format_parallel(
+        size_t count,
+        std::string& buffer,
+        const std::function<void(size_t start, size_t stop, std::string& chunk)>& format
+    );
+
     /// Text file used to read/write data
     TextFile file_;
 
@@ -129,15 +256,34 @@ private:
     /// Scan the whole file to get all the steps positions
     void scan_all();
 
+    /// Check if all the steps in the file have the same size as the steps
+    /// already in `steps_positions_`, and if so add the positions of all the
+    /// remaining steps without reading them. This only reads the file size and
+    /// a few steps at the computed positions. Returns `false` if the steps do
+    /// not have a fixed size, leaving `steps_positions_` unchanged.
+    bool scan_fixed_stride();
+
     /// The next step to read
     size_t step_ = 0;
 
     /// Storing the positions of all the steps in the file, so that we can
     /// just `seekpos` them instead of reading the whole step.
-    std::vector<uint64_t> steps_positions_;
+    OffsetIndex steps_positions_;
+
+    /// Buffers used to format frames in `write_next` and `write_views`, kept
+    /// between calls to re-use the allocated memory
+    std::vector<std::string> write_buffers_;
 
     /// Did we found the end of file while scanning or reading?
     bool eof_found_ = false;
+
+    /// Position after the last step which was followed by more data in the
+    /// file when scanning it
+    uint64_t scan_end_ = 0;
+    /// Did the last step in `steps_positions_` end at the end of the file?
+    /// Such step might still be written to, and is scanned again by
+    /// `refresh`.
+    bool last_step_at_eof_ = false;
 };
 
 } // namespace chemfiles
@@ -21,16 +21,23 @@ class FormatMetadata;
 
 using format_creator_t = std::function<std::unique_ptr<Format>(std::string path, File::Mode mode, File::Compression compression)>;
 using memory_stream_t = std::function<std::unique_ptr<Format>(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression)>;
+using text_file_creator_t = std::function<std::unique_ptr<Format>(TextFile file)>;
 
 struct RegisteredFormat {
     const FormatMetadata& metadata;
     format_creator_t creator;
     memory_stream_t memory_stream_creator;
+    /// Create the format from an already opened `TextFile`. This is empty for
+    /// formats which can not be created this way.
+    text_file_creator_t text_file_creator;
 };
 
 template <typename T>
 using SupportsMemoryIO = std::is_constructible<T, std::shared_ptr<MemoryBuffer>, File::Mode, File::Compression>;
 
+template <typename T>
+using SupportsTextFile = std::is_constructible<T, TextFile>;
+
 /// This class allow to register Format with names and file extensions
 class CHFL_EXPORT FormatFactory final {
 private:
@@ -68,7 +75,8 @@ public:
             },
             [](std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) {
                 return std::make_unique<Format>(std::move(memory), mode, compression);
-            }
+            },
+            text_file_creator<Format>()
         );
     }
 
@@ -85,7 +93,8 @@ public:
         register_format(metadata,
             [](const std::string& path, File::Mode mode, File::Compression compression) {
                 return std::make_unique<Format>(path, mode, compression);
-            }
+            },
+            text_file_creator<Format>()
         );
     }
 
@@ -93,8 +102,23 @@ public:
     std::vector<std::reference_wrapper<const FormatMetadata>> formats();
 
 private:
-    void register_format(const FormatMetadata& metadata, format_creator_t creator, memory_stream_t memory_reader);
-    void register_format(const FormatMetadata& metadata, format_creator_t creator);
+    /// Get a function creating a `Format` from an already opened `TextFile`
+    template<class Format, std::enable_if_t<SupportsTextFile<Format>::value, int> = 0>
+    static text_file_creator_t text_file_creator() {
+        return [](TextFile file) {
+            return std::make_unique<Format>(std::move(file));
+        };
+    }
+
+    /// Get an empty `text_file_creator_t` for formats which can not be created
+    /// from a `TextFile`
+    template<class Format, std::enable_if_t<!SupportsTextFile<Format>::value, int> = 0>
+    static text_file_creator_t text_file_creator() {
+        return nullptr;
+    }
+
+    void register_format(const FormatMetadata& metadata, format_creator_t creator, memory_stream_t memory_reader, text_file_creator_t text_file_creator);
+    void register_format(const FormatMetadata& metadata, format_creator_t creator, text_file_creator_t text_file_creator);
 
     /// Trajectory map associating format descriptions and creators
     mutex<std::vector<RegisteredFormat>> formats_;
@@ -59,6 +59,29 @@ public:
         return *this;
     }
 
+    /// Serialize this frame to a compact binary snapshot.
+    ///
+    /// The snapshot contains all the data in the frame: topology (atoms,
+    /// bonds, residues), unit cell, positions, velocities, step and
+    /// properties. It can be loaded back with `Frame::deserialize` without
+    /// parsing any text, making it a good cache for files which are expensive
+    /// to read. Multiple snapshots written one after the other in a file can
+    /// also be read with the `Chemfiles Snapshot` format.
+    ///
+    /// @example{frame/serialize.cpp}
+    std::vector<char> serialize() const;
+
+    /// Load a frame from the binary snapshot created by `Frame::serialize`
+    /// and stored in the `size` bytes starting at `data`. The data can come
+    /// from a memory-mapped file, and is not used after this function
+    /// returns.
+    ///
+    /// @example{frame/serialize.cpp}
+    ///
+    /// @throws FormatError if the data does not contain a valid frame
+    ///                     snapshot
+    static Frame deserialize(const char* data, size_t size);
+
     /// Get a const reference to the topology of this frame
     ///
     /// It is not possible to get a modifiable reference to the topology,
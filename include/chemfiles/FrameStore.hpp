@@ -0,0 +1,137 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FRAME_STORE_HPP
+#define CHEMFILES_FRAME_STORE_HPP
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "chemfiles/exports.h"
+#include "chemfiles/types.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Property.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/external/span.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// A `FrameStore` keeps many frames in memory using a compressed
+/// representation, as a replacement for `std::vector<Frame>` when the whole
+/// trajectory needs to stay in memory.
+///
+/// Positions and velocities are converted to integers with a fixed
+/// `precision`, the difference between consecutive atoms is computed, and
+/// the result is packed using the smallest number of bits for each block of
+/// 64 values. This is similar to the compression used by XTC files, and
+/// typically needs 4 to 6 bytes per atom instead of 24. A precision of 0
+/// stores the values without any loss, with a smaller compression ratio.
+///
+/// Frames with the same topology as the previous frame share it inside the
+/// store. Unit cells, steps and frame properties are stored as-is.
+///
+/// Frames are compressed independently, so any frame can be retrieved in
+/// constant time with `FrameStore::get`, or only its positions with
+/// `FrameStore::positions`.
+///
+/// @example{frame_store/frame_store.cpp}
+class CHFL_EXPORT FrameStore final {
+public:
+    /// Create an empty store, keeping positions and velocities with the given
+    /// `precision`. The values retrieved from the store are within
+    /// `precision / 2` of the original values. If `precision` is 0, the
+    /// values are stored without any loss.
+    ///
+    /// @throws Error if `precision` is negative or not finite
+    explicit FrameStore(double precision = 1e-3);
+
+    ~FrameStore() = default;
+    FrameStore(FrameStore&&) = default;
+    FrameStore& operator=(FrameStore&&) = default;
+    FrameStore(const FrameStore&) = default;
+    FrameStore& operator=(const FrameStore&) = default;
+
+    /// Compress `frame` and add it at the end of this store
+    ///
+    /// @throws Error if the positions or velocities are too large to be
+    ///               stored with the precision of this store
+    void add(const Frame& frame);
+
+    /// Get the number of frames in this store
+    size_t size() const {
+        return frames_.size();
+    }
+
+    /// Check if this store is empty
+    bool empty() const {
+        return frames_.empty();
+    }
+
+    /// Decompress the frame at `index` in this store
+    ///
+    /// @throws OutOfBounds if `index` is out of bounds
+    Frame get(size_t index) const;
+
+    /// Decompress the positions of the frame at `index` in this store into
+    /// `positions`, without creating a `Frame`
+    ///
+    /// @throws OutOfBounds if `index` is out of bounds
+    /// @throws Error if `positions` does not have the same size as the frame
+    void positions(size_t index, span<Vector3D> positions) const;
+
+    /// Get the topology of the frame at `index` in this store
+    ///
+    /// @throws OutOfBounds if `index` is out of bounds
+    const Topology& topology(size_t index) const;
+
+    /// Get the precision used to store positions and velocities
+    double precision() const {
+        return precision_;
+    }
+
+    /// Get the approximate memory used by this store, in bytes
+    size_t memory() const {
+        return memory_;
+    }
+
+    /// Remove all frames from this store
+    void clear();
+
+private:
+    /// Vectors compressed by blocks of 64 values
+    struct CompressedVectors {
+        /// Number of bits used for each value in a block, each block uses
+        /// exactly `width` words in `data`
+        std::vector<uint8_t> widths;
+        /// Packed values for all blocks
+        std::vector<uint64_t> data;
+    };
+
+    struct Entry {
+        size_t step;
+        size_t natoms;
+        UnitCell cell;
+        property_map properties;
+        std::shared_ptr<const Topology> topology;
+        CompressedVectors positions;
+        optional<CompressedVectors> velocities;
+    };
+
+    /// Compress `vectors` with the precision of this store
+    CompressedVectors compress(span<const Vector3D> vectors) const;
+    /// Decompress `compressed` into `vectors`
+    void decompress(const CompressedVectors& compressed, span<Vector3D> vectors) const;
+    /// Check that `index` is in bounds
+    void check_index(size_t index) const;
+
+    std::vector<Entry> frames_;
+    double precision_;
+    size_t memory_ = 0;
+};
+
+} // namespace chemfiles
+
+#endif
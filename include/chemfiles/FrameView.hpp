@@ -0,0 +1,244 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FRAME_VIEW_HPP
+#define CHEMFILES_FRAME_VIEW_HPP
+
+#include <string>
+#include <vector>
+
+#include "chemfiles/exports.h"
+#include "chemfiles/types.hpp"
+#include "chemfiles/external/span.hpp"
+#include "chemfiles/external/optional.hpp"
+
+#include "chemfiles/Property.hpp"
+
+namespace chemfiles {
+class Atom;
+class Frame;
+class Topology;
+class UnitCell;
+
+/// A `VectorsView` is a non-owning view over an array of 3D vectors, such as
+/// positions or velocities. The vectors can be stored as `double` or `float`
+/// values, with an arbitrary stride between consecutive vectors. This allows
+/// to use arrays coming from simulation codes directly, without copying them
+/// in a `Frame`.
+///
+/// The data must stay alive and unchanged while the view is used.
+///
+/// @example{frame_view/vectors_view.cpp}
+class CHFL_EXPORT VectorsView final {
+public:
+    /// Create an empty view
+    VectorsView() = default;
+
+    /// Create a view over the given `vectors`
+    VectorsView(span<const Vector3D> vectors);
+
+    /// Create a view over the given `vectors`
+    VectorsView(const std::vector<Vector3D>& vectors): VectorsView(span<const Vector3D>(vectors)) {}
+
+    /// Create a view over `size` vectors stored as `double` starting at
+    /// `data`. The vector `i` is made of the values at `data[i * stride]`,
+    /// `data[i * stride + 1]` and `data[i * stride + 2]`.
+    ///
+    /// @throws Error if `stride` is smaller than 3
+    VectorsView(const double* data, size_t size, size_t stride = 3);
+
+    /// Create a view over `size` vectors stored as `float` starting at
+    /// `data`. The vector `i` is made of the values at `data[i * stride]`,
+    /// `data[i * stride + 1]` and `data[i * stride + 2]`.
+    ///
+    /// @throws Error if `stride` is smaller than 3
+    VectorsView(const float* data, size_t size, size_t stride = 3);
+
+    ~VectorsView() = default;
+    VectorsView(const VectorsView&) = default;
+    VectorsView& operator=(const VectorsView&) = default;
+    VectorsView(VectorsView&&) = default;
+    VectorsView& operator=(VectorsView&&) = default;
+
+    /// Get the number of vectors in this view
+    size_t size() const {
+        return size_;
+    }
+
+    /// Get the vector at index `i`, converted to `double` if needed. This
+    /// function does not check that `i` is in bounds.
+    Vector3D operator[](size_t i) const {
+        if (floats_ != nullptr) {
+            auto vector = floats_ + i * stride_;
+            return Vector3D(
+                static_cast<double>(vector[0]),
+                static_cast<double>(vector[1]),
+                static_cast<double>(vector[2])
+            );
+        } else {
+            auto vector = doubles_ + i * stride_;
+            return Vector3D(vector[0], vector[1], vector[2]);
+        }
+    }
+
+    /// If the vectors are stored as contiguous `double` (i.e. as an array of
+    /// `size() x 3` values), get a pointer to the first value. Else, get
+    /// `nullptr`.
+    const double* contiguous() const {
+        if (floats_ == nullptr && stride_ == 3) {
+            return doubles_;
+        }
+        return nullptr;
+    }
+
+private:
+    /// Pointer to the data if stored as `double`
+    const double* doubles_ = nullptr;
+    /// Pointer to the data if stored as `float`
+    const float* floats_ = nullptr;
+    /// Number of vectors
+    size_t size_ = 0;
+    /// Number of values between the start of two consecutive vectors
+    size_t stride_ = 3;
+};
+
+/// A `FrameView` is a non-owning view over the data required to write a
+/// frame to a `Trajectory`: positions and optionally velocities as
+/// `VectorsView`, a reference to the topology and unit cell, the step and the
+/// frame properties.
+///
+/// Writing a `FrameView` does not copy the positions into a `Frame`, which
+/// makes it a good fit for simulation codes writing trajectories from their
+/// own arrays. All the data referenced by the view must stay alive while the
+/// view is used.
+///
+/// @example{frame_view/frame_view.cpp}
+class CHFL_EXPORT FrameView final {
+public:
+    /// Create a view over all the data in an existing `frame`
+    ///
+    /// @example{frame_view/frame_view.cpp}
+    explicit FrameView(const Frame& frame);
+
+    /// Create a view using the given `topology`, `positions` and `cell`.
+    ///
+    /// @example{frame_view/frame_view.cpp}
+    /// @throws Error if the topology and positions sizes do not match
+    FrameView(const Topology& topology, VectorsView positions, const UnitCell& cell);
+
+    ~FrameView() = default;
+    FrameView(const FrameView&) = default;
+    FrameView& operator=(const FrameView&) = default;
+    FrameView(FrameView&&) = default;
+    FrameView& operator=(FrameView&&) = default;
+
+    /// Get the number of atoms in this view
+    size_t size() const {
+        return positions_.size();
+    }
+
+    /// Get the positions (in Angstroms) of the atoms in this view
+    VectorsView positions() const {
+        return positions_;
+    }
+
+    /// Get the velocities (in Angstroms/ps) of the atoms in this view, if
+    /// any
+    optional<VectorsView> velocities() const {
+        return velocities_;
+    }
+
+    /// Use `velocities` as the velocities of the atoms in this view.
+    ///
+    /// @throws Error if the size of `velocities` does not match the number of
+    ///               atoms in this view
+    void set_velocities(VectorsView velocities);
+
+    /// Get the topology referenced by this view
+    const Topology& topology() const {
+        return *topology_;
+    }
+
+    /// Use a reference to `topology` in this view.
+    ///
+    /// @throws Error if the size of `topology` does not match the number of
+    ///               atoms in this view
+    void set_topology(const Topology& topology);
+
+    /// Get the atom at index `i` in the topology referenced by this view.
+    /// This function does not check that `i` is in bounds.
+    const Atom& operator[](size_t i) const;
+
+    /// Get the unit cell referenced by this view
+    const UnitCell& cell() const {
+        return *cell_;
+    }
+
+    /// Use a reference to `cell` in this view
+    void set_cell(const UnitCell& cell) {
+        cell_ = &cell;
+        frame_ = nullptr;
+    }
+
+    /// Get the simulation step of this view
+    size_t step() const {
+        return step_;
+    }
+
+    /// Set the simulation step of this view
+    void set_step(size_t step) {
+        step_ = step;
+        frame_ = nullptr;
+    }
+
+    /// Get the properties associated with this view
+    const property_map& properties() const;
+
+    /// Use a reference to `properties` as the properties of this view
+    void set_properties(const property_map& properties) {
+        properties_ = &properties;
+        frame_ = nullptr;
+    }
+
+    /// Get the property with the given `name` if it exists.
+    optional<const Property&> get(const std::string& name) const {
+        return properties().get(name);
+    }
+
+    /// Get the property with the given `name` if it exists, and if it has
+    /// the requested `kind`.
+    template<Property::Kind kind>
+    optional<typename property_metadata<kind>::type> get(const std::string& name) const {
+        return properties().get<kind>(name);
+    }
+
+    /// Get the `Frame` this view was created from, if the view was created
+    /// from a frame and still refers to all the data of this frame. Else, get
+    /// `nullptr`.
+    const Frame* frame() const {
+        return frame_;
+    }
+
+    /// Copy all the data referenced by this view in a new `Frame`
+    Frame to_frame() const;
+
+private:
+    /// Frame this view was created from, if the view still matches it
+    const Frame* frame_ = nullptr;
+    /// Topology of the atoms
+    const Topology* topology_;
+    /// Unit cell
+    const UnitCell* cell_;
+    /// Positions of the atoms
+    VectorsView positions_;
+    /// Velocities of the atoms, if any
+    optional<VectorsView> velocities_ = nullopt;
+    /// Simulation step
+    size_t step_ = 0;
+    /// Properties, `nullptr` if there are no properties
+    const property_map* properties_ = nullptr;
+};
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,123 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_SUPERPOSITION_HPP
+#define CHEMFILES_SUPERPOSITION_HPP
+
+#include <vector>
+
+#include "chemfiles/exports.h"
+#include "chemfiles/types.hpp"
+#include "chemfiles/external/span.hpp"
+
+namespace chemfiles {
+class Frame;
+
+/// Optimal superposition of a set of positions (the *mobile* positions) onto
+/// a set of *reference* positions, minimizing the root mean square deviation
+/// (RMSD) between them.
+///
+/// The superposition is computed with the quaternion characteristic
+/// polynomial (QCP) method, which only needs a single pass over the atoms and
+/// a few iterations of Newton's method on a fourth order polynomial.
+///
+/// @example{superposition/superposition.cpp}
+class CHFL_EXPORT Superposition final {
+public:
+    /// Create an identity superposition, with an RMSD of 0
+    Superposition() = default;
+
+    /// Compute the optimal superposition of `mobile` onto `reference`. If
+    /// `indexes` is not empty, only the atoms at these indexes are used to
+    /// compute the superposition.
+    ///
+    /// @throws Error if `reference` and `mobile` do not have the same size,
+    ///               or if there are no atoms to superpose
+    /// @throws OutOfBounds if any value in `indexes` is out of bounds
+    Superposition(span<const Vector3D> reference, span<const Vector3D> mobile, const std::vector<size_t>& indexes = {});
+
+    /// Compute the optimal superposition of the positions of `frame` onto the
+    /// positions of `reference`. If `indexes` is not empty, only the atoms at
+    /// these indexes are used to compute the superposition.
+    ///
+    /// @throws Error if `reference` and `frame` do not have the same number of
+    ///               atoms, or if there are no atoms to superpose
+    /// @throws OutOfBounds if any value in `indexes` is out of bounds
+    Superposition(const Frame& reference, const Frame& frame, const std::vector<size_t>& indexes = {});
+
+    /// Get the minimal RMSD between the reference and mobile positions
+    double rmsd() const {
+        return rmsd_;
+    }
+
+    /// Get the rotation matrix of this superposition
+    const Matrix3D& rotation() const {
+        return rotation_;
+    }
+
+    /// Get the geometric center of the superposed atoms in the reference
+    const Vector3D& reference_center() const {
+        return reference_center_;
+    }
+
+    /// Get the geometric center of the superposed atoms in the mobile
+    /// positions
+    const Vector3D& mobile_center() const {
+        return mobile_center_;
+    }
+
+    /// Apply this superposition to the `position` of an atom from the mobile
+    /// set of positions
+    Vector3D apply(const Vector3D& position) const {
+        return rotation_ * (position - mobile_center_) + reference_center_;
+    }
+
+    /// Apply this superposition to all the atoms in `frame`, rotating and
+    /// translating the positions and rotating the velocities.
+    void apply(Frame& frame) const;
+
+private:
+    /// Compute the rotation and RMSD from the centered positions
+    void compute(span<const Vector3D> reference, span<const Vector3D> mobile, const std::vector<size_t>& indexes);
+
+    double rmsd_ = 0;
+    Matrix3D rotation_ = Matrix3D::unit();
+    Vector3D reference_center_;
+    Vector3D mobile_center_;
+};
+
+/// Compute the optimal superposition of each frame in `frames` onto
+/// `reference`, in parallel using the chemfiles thread pool (see
+/// `chemfiles::set_num_threads`). If `indexes` is not empty, only the atoms at
+/// these indexes are used to compute the superposition.
+///
+/// @example{superposition/superpose.cpp}
+///
+/// @throws Error if any frame does not have the same number of atoms as
+///               `reference`
+/// @throws OutOfBounds if any value in `indexes` is out of bounds
+std::vector<Superposition> CHFL_EXPORT superpose(
+    const Frame& reference,
+    const std::vector<Frame>& frames,
+    const std::vector<size_t>& indexes = {}
+);
+
+/// Superpose each frame in `frames` onto `reference` in place, in parallel
+/// using the chemfiles thread pool, and get the RMSD of each frame to the
+/// reference after the superposition. If `indexes` is not empty, only the
+/// atoms at these indexes are used to compute the superposition.
+///
+/// @example{superposition/align.cpp}
+///
+/// @throws Error if any frame does not have the same number of atoms as
+///               `reference`
+/// @throws OutOfBounds if any value in `indexes` is out of bounds
+std::vector<double> CHFL_EXPORT align(
+    const Frame& reference,
+    std::vector<Frame>& frames,
+    const std::vector<size_t>& indexes = {}
+);
+
+} // namespace chemfiles
+
+#endif
@@ -275,6 +275,23 @@ public:
         return residues_;
     }
 
+    /// Serialize this topology to a compact binary snapshot, containing the
+    /// atoms, bonds and residues with their properties. The snapshot can be
+    /// loaded back with `Topology::deserialize`.
+    ///
+    /// @example{topology/serialize.cpp}
+    std::vector<char> serialize() const;
+
+    /// Load a topology from the binary snapshot stored in the `size` bytes
+    /// starting at `data`. The snapshot must have been created by
+    /// `Topology::serialize`, snapshots of frames should be loaded with
+    /// `Frame::deserialize`.
+    ///
+    /// @example{topology/serialize.cpp}
+    ///
+    /// @throws FormatError if the data does not contain a valid snapshot
+    static Topology deserialize(const char* data, size_t size);
+
 private:
     /// Atoms in the system.
     std::vector<Atom> atoms_;
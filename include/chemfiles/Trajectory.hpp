@@ -5,17 +5,23 @@
 #define CHEMFILES_TRAJECTORY_HPP
 
 #include <memory>
+#include <exception>
 #include <string>
+#include <vector>
 
 #include "chemfiles/exports.h"
+#include "chemfiles/misc.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Transformations.hpp"
 #include "chemfiles/external/span.hpp"  // IWYU pragma: keep
 #include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
 class Format;
 class Topology;
+class FrameCache;
 class MemoryBuffer;
 
 /// A `Trajectory` is a chemistry file on the hard drive. It is the entry point
@@ -41,7 +47,18 @@ public:
     /// the file will be treated as a compressed file and the next extension is
     /// used to guess the format. For example `Trajectory("file.xyz.gz")` will
     /// open the file for reading using the XYZ format and the gzip compression
-    /// method.
+    /// method. When reading a file without extension or with an unknown
+    /// extension, the format and compression method are guessed from the
+    /// beginning of the file content instead (see `chemfiles::guess_format`).
+    ///
+    /// Files stored inside a tar or zip archive can be read directly with a
+    /// path of the form `<archive>::<member>`, for example
+    /// `Trajectory("structures.tar.gz::1abc.pdb")`. Tar archives can be
+    /// uncompressed or compressed with gzip, xz or bzip2; and zip archive
+    /// members can be stored or compressed with deflate. The archive is
+    /// indexed once and the index re-used when opening other members of the
+    /// same archive. Archive members are always opened for reading, and the
+    /// format must support in-memory IO.
     ///
     /// @example{trajectory/trajectory.cpp}
     ///
@@ -140,6 +157,25 @@ public:
     ///                     the format does not support reading.
     Frame read_step(size_t step);
 
+    /// Read all the frames at the given `steps` from the trajectory, in the
+    /// same order as `steps`.
+    ///
+    /// This gives the same result as calling `Trajectory::read_step` for each
+    /// step, but allows binary formats with random access (XTC, TRR and DCD)
+    /// to request the data for all the frames from the operating system in
+    /// advance, which is much faster when reading scattered frames from large
+    /// files.
+    ///
+    /// @example{trajectory/read_steps.cpp}
+    ///
+    /// @param steps steps to read from the trajectory
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the file is not valid for the used format, or if
+    ///                     the format does not support reading.
+    std::vector<Frame> read_steps(const std::vector<size_t>& steps);
+
     /// Write a single frame to the trajectory.
     ///
     /// The trajectory must have been opened in write or append mode, and the
@@ -154,6 +190,44 @@ public:
     /// @throws FormatError if the format does not support writing.
     void write(const Frame& frame);
 
+    /// Write the frame referenced by a `FrameView` to the trajectory.
+    ///
+    /// This allows to write positions and velocities stored in external
+    /// arrays, without copying them into a `Frame`. Binary trajectory formats
+    /// (XTC, TRR, DCD and Amber NetCDF) write the view directly, other
+    /// formats create a temporary `Frame` from the view.
+    ///
+    /// The trajectory must have been opened in write or append mode, and the
+    /// underlying format must support writing.
+    ///
+    /// @example{trajectory/write_view.cpp}
+    ///
+    /// @param frame view of the frame to write to this trajectory
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the format does not support writing.
+    void write(const FrameView& frame);
+
+    /// Write multiple frames to the trajectory, in order.
+    ///
+    /// Text formats where each step is independent of the previous ones (XYZ,
+    /// PDB and GRO) format the frames in parallel using the chemfiles thread
+    /// pool, before writing them to the file. Other formats write the frames
+    /// one by one.
+    ///
+    /// The trajectory must have been opened in write or append mode, and the
+    /// underlying format must support writing.
+    ///
+    /// @example{trajectory/write_frames.cpp}
+    ///
+    /// @param frames frames to write to this trajectory
+    ///
+    /// @throws FileError for all errors concerning the physical file: can not
+    ///                   open it, can not read/write it, *etc.*
+    /// @throws FormatError if the format does not support writing.
+    void write(const std::vector<Frame>& frames);
+
     /// Use the given `topology` instead of any pre-existing `Topology` when
     /// reading or writing.
     ///
@@ -180,6 +254,11 @@ public:
     /// This is mainly usefull when a format does not define topological
     /// information, as it can be the case with some molecular dynamic formats.
     ///
+    /// The topology is stored in a process-wide cache, and using the same file
+    /// again (with the same format) will not read it again unless it was
+    /// modified. See `chemfiles::set_topology_cache_limit` to control the
+    /// memory used by this cache.
+    ///
     /// @example{trajectory/set_topology.cpp}
     ///
     /// @param filename trajectory file path.
@@ -208,11 +287,116 @@ public:
     /// @example{trajectory/set_cell.cpp}
     void set_cell(const UnitCell& cell);
 
+    /// Apply the given list of `transformations` to all the frames read from
+    /// this trajectory, after setting the custom topology and unit cell if
+    /// any.
+    ///
+    /// The transformations run in a single pass over the atoms of each frame
+    /// while it is still in the CPU cache, and are also applied to the frames
+    /// read in advance by the frame cache (see `Trajectory::set_frame_cache`).
+    /// Calling this function again replaces the previous transformations.
+    ///
+    /// When the transformations only keep a subset of the atoms and no custom
+    /// topology is set, formats can skip the atoms after the last one used
+    /// by the transformations. For example, XTC files stop decoding each
+    /// frame after the last atom needed.
+    ///
+    /// @throws FileError if the trajectory was not opened in read mode
+    ///
+    /// @example{trajectory/set_transformations.cpp}
+    void set_transformations(Transformations transformations);
+
     /// Get the number of steps (the number of frames) in this trajectory.
     ///
     /// @example{trajectory/nsteps.cpp}
     size_t nsteps() const;
 
+    /// Look for new steps appended to the file since the trajectory was
+    /// opened, or since the last call to this function, and get the updated
+    /// number of steps.
+    ///
+    /// This allows to follow a trajectory which is still being written by
+    /// another process, such as a running simulation. Only the data added at
+    /// the end of the file is scanned, and a step which is not completely
+    /// written yet is not counted until a later call to `refresh`.
+    ///
+    /// @throws FileError if the trajectory was not opened in read mode
+    /// @throws FormatError if the format does not support following files
+    ///
+    /// @example{trajectory/refresh.cpp}
+    size_t refresh();
+
+    /// Tell chemfiles how the steps of this trajectory will be read, allowing
+    /// it to give hints to the operating system about which data to read in
+    /// advance and to keep in cache.
+    ///
+    /// With `AccessPattern::SEQUENTIAL` and `AccessPattern::STREAMING`, the
+    /// data of the next `readahead` steps is requested in advance each time a
+    /// step is read. With `AccessPattern::STREAMING`, the data of each step is
+    /// also dropped from the cache after being read, which prevents one-pass
+    /// scans of very large files from evicting other data from the cache.
+    /// `AccessPattern::RANDOM` disables the readahead done by the operating
+    /// system.
+    ///
+    /// These hints are currently used by the XTC, TRR and DCD formats, and
+    /// ignored by the other formats.
+    ///
+    /// @throws FileError if the trajectory was not opened in read mode
+    ///
+    /// @example{trajectory/set_access_pattern.cpp}
+    void set_access_pattern(AccessPattern pattern, size_t readahead = 1);
+
+    /// Keep the frames read from this trajectory in memory, so that reading
+    /// them again does not need to decode the file.
+    ///
+    /// The cache uses at most `limit` bytes, and the least recently used
+    /// frames are removed when the cache is full. Frames with the same
+    /// topology share it inside the cache. A `limit` of 0 disables the cache.
+    ///
+    /// When `prefetch` is not zero, the `prefetch` steps before and after each
+    /// step read from the trajectory are also read and added to the cache if
+    /// they are not already there. This makes reading steps close to the last
+    /// one (for example when scrubbing through a trajectory in a visualization
+    /// software) almost free after the first read.
+    ///
+    /// While the cache is enabled, frames are always read with the same code
+    /// as `Trajectory::read_step`, and the cache is cleared when calling
+    /// `Trajectory::set_topology` or `Trajectory::set_cell`.
+    ///
+    /// @throws FileError if the trajectory was not opened in read mode
+    ///
+    /// @example{trajectory/set_frame_cache.cpp}
+    void set_frame_cache(size_t limit, size_t prefetch = 0);
+
+    /// Locate the steps of this trajectory by bisection over the file content
+    /// when reading them, instead of finding all the steps in the file
+    /// beforehand.
+    ///
+    /// For very large files, finding all the steps requires reading the
+    /// header of each step, which can take a long time. With this function,
+    /// only a few headers close to the beginning and the end of the file are
+    /// read, and `Trajectory::nsteps` returns an estimate of the number of
+    /// steps. Reading a specific step then reads a few headers in the file to
+    /// find it by bisection, and sequential reading does not need to find the
+    /// steps at all.
+    ///
+    /// This assumes that the simulation steps stored in the file are
+    /// increasing and evenly spaced, which is the case for files written by
+    /// a single simulation. A few steps across the file are checked against
+    /// this assumption, and all the steps in the file are found instead if
+    /// they do not match it. Calling `Trajectory::refresh` also finds all
+    /// the steps in the file, making `Trajectory::nsteps` exact.
+    ///
+    /// This is currently supported by the XTC and TRR formats. If all the
+    /// steps were already found, for example by calling `Trajectory::nsteps`
+    /// or reading a step, this function does nothing.
+    ///
+    /// @throws FileError if the trajectory was not opened in read mode
+    /// @throws FormatError if the format does not support this
+    ///
+    /// @example{trajectory/locate_steps_by_bisection.cpp}
+    void locate_steps_by_bisection();
+
     /// Check if all the frames in this trajectory have been read, *i.e.* if
     /// the last read frame is the last frame of the trajectory.
     ///
@@ -245,10 +429,24 @@ public:
 private:
     Trajectory(char mode, std::unique_ptr<Format> format, std::shared_ptr<MemoryBuffer> buffer);
 
+    /// Get the number of steps from the format when opening the trajectory,
+    /// unless the format finds the steps only when they are needed
+    void init_nsteps();
+    /// Get the number of steps, getting it from the format if needed
+    size_t current_nsteps() const;
     /// Perform a few checks before reading a frame
     void pre_read(size_t step);
     /// Set the frame topology and/or cell after reading it
     void post_read(Frame& frame);
+    /// Tell the format which atoms are needed by the transformations. This
+    /// is disabled when using a custom topology, which must match all the
+    /// atoms in the frames.
+    void update_needed_atoms();
+    /// Read the frame at `step` with the format, without using the cache
+    Frame read_from_format(size_t step);
+    /// Read the frame at `step` from the cache, or from the format and add
+    /// it to the cache, and then prefetch the steps around it.
+    Frame read_cached(size_t step);
     /// Check that the trajectory is still open, and throw a `FileError` is it
     /// has been closed.
     void check_opened() const;
@@ -259,21 +457,71 @@ private:
     char mode_ = '\0';
     /// Current step
     size_t step_ = 0;
-    /// Number of steps in the file, if available
-    size_t nsteps_ = 0;
+    /// Number of steps in the file, `nullopt` if the format did not look for
+    /// the steps yet
+    mutable optional<size_t> nsteps_;
+    /// Is `nsteps_` an estimate from `locate_steps_by_bisection`? The format
+    /// can find all the steps afterward if they are not evenly spaced, and
+    /// `nsteps_` must then be updated.
+    bool nsteps_estimated_ = false;
     /// Format used to read the associated file. It will be `nullptr` is the
     /// trajectory is closed
     std::unique_ptr<Format> format_;
     /// Topology to use for reading/writing files when no topological data is
-    /// present
-    optional<Topology> custom_topology_;
+    /// present. This can be shared with the topology cache.
+    std::shared_ptr<const Topology> custom_topology_;
     /// UnitCell to use for reading/writing files when no unit cell information
     /// is present
     optional<UnitCell> custom_cell_;
+    /// Transformations to apply to all frames after reading them
+    Transformations transformations_;
     /// The internal memory buffer, shared with the MemoryFile implementation
     std::shared_ptr<MemoryBuffer> buffer_;
+    /// Cache of decoded frames, `nullptr` if disabled
+    std::unique_ptr<FrameCache> frame_cache_;
+    /// Number of steps to prefetch around each read step with the cache
+    size_t prefetch_ = 0;
 };
 
+/// Frames read from a single file by `read_files`
+struct FileFrames {
+    /// Path of the file
+    std::string path;
+    /// Frames read from the file, empty if reading the file failed
+    std::vector<Frame> frames;
+    /// Error message if reading the file failed, empty otherwise
+    std::string error;
+    /// The exception thrown when reading the file failed, `nullptr` otherwise
+    std::exception_ptr exception;
+};
+
+/// Read the first frame, or all the frames if `all_steps` is `true`, of each
+/// file in `paths`.
+///
+/// This function is intended for datasets made of many small files. The files
+/// are read in parallel by the chemfiles thread pool (see
+/// `chemfiles::set_num_threads`), each worker taking the next file to read
+/// from a shared queue. The results are returned in the same order as
+/// `paths`. Errors do not stop the reading of the other files, and are
+/// reported in `FileFrames::error` instead.
+///
+/// `format` is used to open all the files and follows the same rules as the
+/// `Trajectory` constructor. If it is empty, the format of each file is guessed
+/// from its extension and content.
+///
+/// @example{trajectory/read_files.cpp}
+///
+/// @param paths paths of all the files to read
+/// @param format format to use for all the files, or an empty string
+/// @param all_steps should we read all the frames in the files, or only the
+///                  first one?
+/// @return the frames (or error) for each file
+std::vector<FileFrames> CHFL_EXPORT read_files(
+    const std::vector<std::string>& paths,
+    const std::string& format = "",
+    bool all_steps = false
+);
+
 } // namespace chemfiles
 
 #endif
@@ -0,0 +1,145 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_TRANSFORMATIONS_HPP
+#define CHEMFILES_TRANSFORMATIONS_HPP
+
+#include <memory>
+#include <vector>
+
+#include "chemfiles/exports.h"
+#include "chemfiles/types.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class Frame;
+class Topology;
+
+/// A list of transformations applied to frames right after they are read by
+/// a `Trajectory` (see `Trajectory::set_transformations`), or to any frame
+/// with `Transformations::apply`.
+///
+/// Instead of running each transformation as a separate pass over the
+/// frame, all the transformations working on positions (`scale`, `center`,
+/// `wrap` and `align`) are executed in a single pass over the atoms, in the order
+/// they were added. Only the atoms kept by `subset` are transformed.
+///
+/// All atomic indexes refer to the atoms in the frame before any
+/// transformation is applied, *i.e.* the frame as read from the file.
+///
+/// @example{transformations/transformations.cpp}
+class CHFL_EXPORT Transformations final {
+public:
+    /// Create an empty list of transformations
+    Transformations() = default;
+
+    ~Transformations() = default;
+    Transformations(Transformations&&) = default;
+    Transformations& operator=(Transformations&&) = default;
+    Transformations(const Transformations&) = default;
+    Transformations& operator=(const Transformations&) = default;
+
+    /// Only keep the atoms at the given `indexes` in the frame, in this
+    /// order. Bonds and residues between the kept atoms are kept as well.
+    ///
+    /// This is always executed first, regardless of the order in which the
+    /// transformations are added. Calling this function again replaces the
+    /// previous subset.
+    ///
+    /// @throws Error if `indexes` contains the same index multiple times
+    Transformations& subset(std::vector<size_t> indexes);
+
+    /// Multiply positions, velocities and the unit cell by `factor`, for
+    /// example to convert positions from nanometers to Angstroms with a factor
+    /// of 10.
+    Transformations& scale(double factor);
+
+    /// Translate all the atoms so that the geometric center of the atoms at
+    /// `indexes` is at the origin. Combined with `Transformations::wrap`,
+    /// this centers the system of interest in the periodic box.
+    ///
+    /// @throws Error if `indexes` is empty
+    Transformations& center(std::vector<size_t> indexes);
+
+    /// Wrap all the positions inside the unit cell, using the same convention
+    /// as `UnitCell::wrap`. This does nothing for infinite unit cells.
+    Transformations& wrap();
+
+    /// Rotate and translate all the atoms to get the optimal superposition
+    /// (see `Superposition`) of the atoms at `indexes` onto the same atoms in
+    /// `reference`. If `indexes` is empty, all the atoms in `reference` are
+    /// used, and the frames should contain the same number of atoms. The
+    /// velocities are rotated as well, but not the unit cell: any `wrap`
+    /// should come before this transformation.
+    ///
+    /// @throws Error if there are no atoms to superpose
+    /// @throws OutOfBounds if any value in `indexes` is out of bounds for
+    ///                     `reference`
+    Transformations& align(const Frame& reference, std::vector<size_t> indexes = {});
+
+    /// Get the number of atoms at the beginning of the frames used by these
+    /// transformations, i.e. one more than the largest atomic index used by
+    /// `subset`, `center` and `align`. This returns `nullopt` if there is no
+    /// subset, since all the atoms are then kept in the frame.
+    optional<size_t> needed_atoms() const;
+
+    /// Check if this list of transformations is empty
+    bool empty() const {
+        return subset_.empty() && stages_.empty();
+    }
+
+    /// Apply all the transformations to the `frame`
+    ///
+    /// @throws OutOfBounds if any atomic index is out of bounds for this frame
+    void apply(Frame& frame);
+
+private:
+    /// A single transformation working on positions
+    struct Stage {
+        enum Kind {
+            SCALE,
+            CENTER,
+            WRAP,
+            ALIGN,
+        } kind;
+        /// Scaling factor for `SCALE`
+        double factor = 1;
+        /// Atoms to center on for `CENTER`, or to superpose for `ALIGN`
+        std::vector<size_t> indexes = {};
+        /// Reference positions of the atoms at `indexes` for `ALIGN`
+        std::vector<Vector3D> reference = {};
+
+        /// Translation for `CENTER` and `ALIGN`, computed for each frame
+        Vector3D translation = Vector3D();
+        /// Rotation for `ALIGN`, computed for each frame
+        Matrix3D rotation = Matrix3D::unit();
+        /// Cell matrix and its inverse for `WRAP`, computed for each frame
+        Matrix3D matrix = Matrix3D::zero();
+        Matrix3D inverse = Matrix3D::zero();
+        /// Is the unit cell infinite for `WRAP`?
+        bool infinite = true;
+    };
+
+    /// Compute the data depending on the frame for all stages, and get the
+    /// cell matrix after all the transformations
+    Matrix3D prepare(const Frame& frame);
+    /// Apply the transformations from the `count` first stages to `position`
+    Vector3D transform(Vector3D position, size_t count) const;
+    /// Get the topology of the subset of `topology`
+    std::shared_ptr<const Topology> subset_topology(const Topology& topology);
+
+    /// Indexes of the atoms to keep, empty to keep all atoms
+    std::vector<size_t> subset_;
+    /// Transformations working on positions, in order
+    std::vector<Stage> stages_;
+
+    /// Topology of the last frame used with a subset, and the corresponding
+    /// subset topology. These are re-used as long as the topology does not
+    /// change.
+    std::shared_ptr<const Topology> last_topology_;
+    std::shared_ptr<const Topology> last_subset_topology_;
+};
+
+} // namespace chemfiles
+
+#endif
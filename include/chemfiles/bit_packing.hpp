@@ -0,0 +1,71 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_BIT_PACKING_HPP
+#define CHEMFILES_BIT_PACKING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chemfiles {
+namespace bit_packing {
+
+/// Number of values in a packed block. With 64 values per block, a block of
+/// values using `width` bits each takes exactly `width` words.
+constexpr size_t BLOCK_SIZE = 64;
+
+/// Get the number of bits needed to represent all the `values`, i.e. the
+/// position of the highest set bit in any of them.
+inline unsigned width(const uint64_t* values) {
+    uint64_t all_bits = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        all_bits |= values[i];
+    }
+    unsigned width = 0;
+    while (width < 64 && (all_bits >> width) != 0) {
+        width++;
+    }
+    return width;
+}
+
+/// Pack the `BLOCK_SIZE` `values` using `width` bits for each of them, and
+/// add the resulting `width` words at the end of `data`. All `values` must
+/// fit in `width` bits.
+inline void pack(std::vector<uint64_t>& data, const uint64_t* values, unsigned width) {
+    auto start = data.size();
+    data.resize(start + width, 0);
+    for (size_t i = 0; i < BLOCK_SIZE && width != 0; i++) {
+        auto bit = i * width;
+        auto word = start + bit / 64;
+        auto shift = bit % 64;
+        data[word] |= values[i] << shift;
+        if (shift + width > 64) {
+            data[word + 1] |= values[i] >> (64 - shift);
+        }
+    }
+}
+
+/// Get the value at index `i` in a block packed with `width` bits per value,
+/// starting at `block`.
+inline uint64_t unpack(const uint64_t* block, unsigned width, size_t i) {
+    if (width == 0) {
+        return 0;
+    }
+    auto bit = i * width;
+    auto word = bit / 64;
+    auto shift = bit % 64;
+    auto value = block[word] >> shift;
+    if (shift + width > 64) {
+        value |= block[word + 1] << (64 - shift);
+    }
+    if (width < 64) {
+        value &= (uint64_t(1) << width) - 1;
+    }
+    return value;
+}
+
+} // namespace bit_packing
+} // namespace chemfiles
+
+#endif
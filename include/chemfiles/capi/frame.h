@@ -86,6 +86,45 @@ CHFL_EXPORT chfl_status chfl_frame_velocities(
     CHFL_FRAME* frame, chfl_vector3d** velocities, uint64_t* size
 );
 
+/// Arrays of a frame which can be exported with `chfl_frame_dlpack`
+typedef enum {  // NOLINT: this is both a C and C++ file
+    /// Positions of the atoms, as a `natoms x 3` array
+    CHFL_ARRAY_POSITIONS = 0,
+    /// Velocities of the atoms, as a `natoms x 3` array
+    CHFL_ARRAY_VELOCITIES = 1,
+    /// Unit cell matrix, as a `3 x 3` array
+    CHFL_ARRAY_CELL = 2,
+    /// Masses of the atoms, as a `natoms` array
+    CHFL_ARRAY_MASSES = 3,
+    /// Charges of the atoms, as a `natoms` array
+    CHFL_ARRAY_CHARGES = 4,
+} chfl_frame_array;
+
+/// Export one of the arrays in a `frame` as a DLPack tensor, in the pointer
+/// pointed to by `tensor`.
+///
+/// The tensor gives direct access to the positions and velocities inside the
+/// frame without any copy. For `CHFL_ARRAY_CELL`, `CHFL_ARRAY_MASSES` and
+/// `CHFL_ARRAY_CHARGES`, the tensor contains a copy of the data, and
+/// modifying it does not change the frame. All arrays contain 64-bit floating
+/// point values on the CPU.
+///
+/// The frame is kept alive until the tensor `deleter` is called, even if the
+/// frame is released with `chfl_free` before. The tensor must be released by
+/// calling `(*tensor)->deleter(*tensor)`, or by giving it to a library
+/// consuming DLPack tensors, which will then call the deleter. As with
+/// `chfl_frame_positions`, the data is invalidated if the frame is resized.
+///
+/// If the frame does not have velocity, exporting `CHFL_ARRAY_VELOCITIES` will
+/// return an error.
+///
+/// @example{capi/chfl_frame/dlpack.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_frame_dlpack(
+    CHFL_FRAME* frame, chfl_frame_array array, chfl_dlpack_managed_tensor** tensor
+);
+
 /// Add an `atom` and the corresponding `position` and `velocity` data to a
 /// `frame`.
 ///
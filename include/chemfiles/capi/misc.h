@@ -62,8 +62,10 @@ CHFL_EXPORT chfl_status chfl_formats_list(chfl_format_metadata** metadata, uint6
 ///
 /// Most of the time, the format is only guessed from the filename extension,
 /// without reading the file to guess the format. When two or more format can
-/// share the same extension (for example CIF and mmCIF), chemfiles tries to
-/// read the file to distinguish between them. If reading fails, the default
+/// share the same extension (for example CIF and mmCIF), or when the file does
+/// not have an extension or has an unknown extension, chemfiles reads the first
+/// bytes of the file (at most 64 KiB after decompression) to guess the format
+/// and compression method from the content. If reading fails, the default
 /// format for this extension is returned.
 ///
 /// Opening the file using the returned format string might still fail. For
@@ -81,6 +83,130 @@ CHFL_EXPORT chfl_status chfl_formats_list(chfl_format_metadata** metadata, uint6
 ///         about the error if the status code is not `CHFL_SUCCESS`.
 CHFL_EXPORT chfl_status chfl_guess_format(const char* path, char* format, uint64_t buffsize);
 
+/// Set the number of threads chemfiles can use to run parallel code to
+/// `count`.
+///
+/// All the parallel code in chemfiles uses a single internal thread pool,
+/// created the first time it is needed. By default, this pool contains as many
+/// threads as the value of the `CHEMFILES_NUM_THREADS` environment variable,
+/// or as many threads as the hardware supports if this variable is not set.
+/// Using `count = 0` resets the number of threads to this default value, and
+/// `count = 1` disables all parallelism. This function also removes any
+/// executor previously set with `chfl_set_executor`.
+///
+/// This function should not be called while chemfiles is running code in
+/// another thread.
+///
+/// @example{capi/chfl_set_num_threads.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_set_num_threads(uint64_t count);
+
+/// Get the number of threads chemfiles uses to run parallel code in `count`.
+///
+/// @example{capi/chfl_num_threads.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_num_threads(uint64_t* count);
+
+/// Function type for a single chemfiles task. Calling `function(task)` executes
+/// the task and releases the associated memory.
+typedef void (*chfl_task_function)(void* task);  // NOLINT: this is both a C and C++ file
+
+/// Callback type used to run chemfiles tasks on an external executor. The
+/// executor should call `function(task)` exactly once, in any thread.
+/// `user_data` is the pointer given to `chfl_set_executor`.
+typedef void (*chfl_executor)(chfl_task_function function, void* task, void* user_data);  // NOLINT: this is both a C and C++ file
+
+/// Use an external `executor` to run chemfiles parallel code instead of the
+/// internal thread pool.
+///
+/// This allows to share threads between chemfiles and the rest of the
+/// application (for example an OpenMP or TBB thread pool), preventing
+/// oversubscription. `user_data` is passed to each call of the `executor`, and
+/// `concurrency` is the number of tasks the executor can run at the same time.
+///
+/// This function should not be called while chemfiles is running code in
+/// another thread.
+///
+/// @example{capi/chfl_set_executor.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_set_executor(chfl_executor executor, void* user_data, uint64_t concurrency);
+
+/// Set the maximal memory (in bytes) used by the topology cache to `limit`.
+///
+/// `chfl_trajectory_topology_file` stores the topologies it reads in a
+/// process-wide cache, and re-uses them when the same file is used again with
+/// the same format. Files are identified by their canonical path, size, and
+/// last modification time, so modified files are always read again. When the
+/// memory used by the cached topologies goes over the limit, the least recently
+/// used topologies are removed from the cache.
+///
+/// The default limit is 1 GiB, and a limit of 0 disables the cache.
+///
+/// @example{capi/chfl_set_topology_cache_limit.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_set_topology_cache_limit(uint64_t limit);
+
+/// Remove the topologies read from the file at `path` from the topology cache,
+/// or all the topologies if `path` is `NULL`.
+///
+/// @example{capi/chfl_clear_topology_cache.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_clear_topology_cache(const char* path);
+
+/// Load the chemical component dictionary in binary format at `path`, to be
+/// used when creating bonds in residues read from PDB and mmCIF files. If
+/// `path` is `NULL`, the currently loaded dictionary is removed.
+///
+/// When a dictionary is loaded, bonds are created for all the residues defined
+/// in the dictionary, and not only for standard residues. The binary file can
+/// be created with `chfl_build_component_dictionary`.
+///
+/// @example{capi/chfl_load_component_dictionary.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_load_component_dictionary(const char* path);
+
+/// Convert the chemical component dictionary in mmCIF format (e.g.
+/// `components.cif` or `components.cif.gz`) at `input` to the binary format
+/// used by `chfl_load_component_dictionary`, and write it to `output`.
+///
+/// @example{capi/chfl_build_component_dictionary.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_build_component_dictionary(const char* input, const char* output);
+
+/// Read the first frame of each of the `count` files in `paths` in parallel,
+/// and store them in `frames`.
+///
+/// `frames` must point to an array of at least `count` elements. The files are
+/// read by the chemfiles thread pool (see `chfl_set_num_threads`), and
+/// `frames[i]` contains the first frame of the file at `paths[i]`. `format`
+/// is used to open all the files, and follows the same rules as in
+/// `chfl_trajectory_with_format`. If `format` is an empty string, the format of
+/// each file is guessed from its extension and content.
+///
+/// If some files can not be read, the corresponding entries in `frames` are
+/// set to `NULL`, all the other files are still read, and this function
+/// returns the status code and error of the first failed file (for example
+/// `CHFL_FILE_ERROR` for missing files or `CHFL_FORMAT_ERROR` for invalid
+/// content). All entries in `frames` are set to `NULL` before any error
+/// can happen.
+///
+/// The caller of this function should free the allocated frames using
+/// `chfl_free`.
+///
+/// @example{capi/chfl_read_files.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_read_files(
+    const char* const paths[], uint64_t count, const char* format, CHFL_FRAME* frames[]
+);
+
 /// Free the memory associated with a chemfiles object.
 ///
 /// This function is NOT equivalent to the standard C function `free`, as memory
@@ -17,6 +17,9 @@ extern "C" {
 ///
 /// Valid modes are `'r'` for read, `'w'` for write and `'a'` for append.
 ///
+/// Files inside a tar or zip archive can be read with a path of the form
+/// `<archive>::<member>`, e.g. `"structures.tar.gz::1abc.pdb"`.
+///
 /// The caller of this function should free the allocated memory using
 /// `chfl_trajectory_close`.
 ///
@@ -32,7 +35,8 @@ CHFL_EXPORT CHFL_TRAJECTORY* chfl_trajectory_open(const char* path, char mode);
 ///
 /// The `format` parameter is needed when the file format does not match the
 /// extension, or when there is not standard extension for this format. If
-/// `format` is an empty string, the format will be guessed from the extension.
+/// `format` is an empty string, the format will be guessed from the extension,
+/// or from the beginning of the file content (see `chfl_guess_format`).
 ///
 /// The caller of this function should free the allocated memory using
 /// `chfl_trajectory_close`.
@@ -111,6 +115,24 @@ CHFL_EXPORT chfl_status chfl_trajectory_read_step(
     CHFL_TRAJECTORY* trajectory, uint64_t step, CHFL_FRAME* frame
 );
 
+/// Read the `count` steps of the `trajectory` given in `steps`, storing the
+/// step `steps[i]` in `frames[i]`.
+///
+/// This gives the same result as calling `chfl_trajectory_read_step` for each
+/// step, but allows binary formats with random access (XTC, TRR and DCD) to
+/// fetch the data of all the frames together, which is much faster when
+/// reading scattered steps from large files.
+///
+/// @example{capi/chfl_trajectory/read_steps.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_read_steps(
+    CHFL_TRAJECTORY* trajectory,
+    const uint64_t* steps,
+    uint64_t count,
+    CHFL_FRAME* const* frames
+);
+
 /// Write a single `frame` to the `trajectory`.
 ///
 /// @example{capi/chfl_trajectory/write.c}
@@ -120,6 +142,35 @@ CHFL_EXPORT chfl_status chfl_trajectory_write(
     CHFL_TRAJECTORY* trajectory, const CHFL_FRAME* frame
 );
 
+/// Write a single frame to the `trajectory`, using the `natoms` `positions`
+/// and optionally `velocities` stored in raw arrays.
+///
+/// This function does not copy the positions and velocities into a frame
+/// for the XTC, TRR, DCD and Amber NetCDF formats, which makes it a good fit
+/// for simulation codes writing trajectories from their own arrays.
+///
+/// `velocities` can be `NULL` if there are no velocities to write. `cell`
+/// can be `NULL` to use an infinite unit cell. `topology` can be `NULL`, in
+/// which case a topology containing `natoms` atoms without name or type will
+/// be created for each call; it should contain `natoms` atoms otherwise. If a
+/// topology or unit cell was set with `chfl_trajectory_set_topology`,
+/// `chfl_trajectory_topology_file` or `chfl_trajectory_set_cell`, they are
+/// used instead of `topology` and `cell`. The written frame uses the given
+/// simulation `step`.
+///
+/// @example{capi/chfl_trajectory/write_positions.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_write_positions(
+    CHFL_TRAJECTORY* trajectory,
+    const chfl_vector3d* positions,
+    const chfl_vector3d* velocities,
+    uint64_t natoms,
+    const CHFL_TOPOLOGY* topology,
+    const CHFL_CELL* cell,
+    uint64_t step
+);
+
 /// Set the `topology` associated with a `trajectory`. This topology will be
 /// used when reading and writing the files, replacing any topology in the
 /// frames or files.
@@ -138,6 +189,10 @@ CHFL_EXPORT chfl_status chfl_trajectory_set_topology(
 /// If `format` is an empty string or `NULL`, the format will be guessed from
 /// the path extension.
 ///
+/// The topology is stored in a process-wide cache, and using the same file
+/// again will not read it again unless it was modified. See
+/// `chfl_set_topology_cache_limit` to control the memory used by this cache.
+///
 /// @example{capi/chfl_trajectory/topology_file.c}
 /// @return The operation status code. You can use `chfl_last_error` to learn
 ///         about the error if the status code is not `CHFL_SUCCESS`.
@@ -165,6 +220,50 @@ CHFL_EXPORT chfl_status chfl_trajectory_nsteps(
     CHFL_TRAJECTORY* trajectory, uint64_t* nsteps
 );
 
+/// Look for new steps appended to the file used by this `trajectory` since it
+/// was opened or since the last call to this function, and store the updated
+/// number of steps in `nsteps`.
+///
+/// This allows to follow a trajectory which is still being written by another
+/// process. Steps which are not completely written yet are not counted.
+///
+/// @example{capi/chfl_trajectory/refresh.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_refresh(
+    CHFL_TRAJECTORY* trajectory, uint64_t* nsteps
+);
+
+/// Keep the frames read from this `trajectory` in memory, using at most
+/// `limit` bytes, so that reading them again does not need to decode the file.
+///
+/// The least recently used frames are removed when the cache is full, and a
+/// `limit` of 0 disables the cache. When `prefetch` is not zero, the
+/// `prefetch` steps before and after each step read from the trajectory are
+/// also added to the cache.
+///
+/// @example{capi/chfl_trajectory/set_frame_cache.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_set_frame_cache(
+    CHFL_TRAJECTORY* trajectory, uint64_t limit, uint64_t prefetch
+);
+
+/// Locate the steps of this `trajectory` by bisection over the file content
+/// when reading them, instead of finding all the steps in the file
+/// beforehand. `chfl_trajectory_nsteps` then gives an estimate of the number
+/// of steps.
+///
+/// This assumes that the simulation steps stored in the file are increasing
+/// and evenly spaced, and is currently supported by the XTC and TRR formats.
+///
+/// @example{capi/chfl_trajectory/bisect_steps.c}
+/// @return The operation status code. You can use `chfl_last_error` to learn
+///         about the error if the status code is not `CHFL_SUCCESS`.
+CHFL_EXPORT chfl_status chfl_trajectory_bisect_steps(
+    CHFL_TRAJECTORY* trajectory
+);
+
 /// Obtain the memory buffer written to by the `trajectory`.
 ///
 /// The user is **not** responsible for freeing `data` and this will be done
@@ -216,6 +216,60 @@ typedef struct {
     bool residues;
 } chfl_format_metadata;
 
+/// Device description in a `chfl_dlpack_tensor`. This is compatible with
+/// `DLDevice` from DLPack.
+typedef struct {  // NOLINT: this is both a C and C++ file
+    /// Kind of device where the data lives, always 1 (`kDLCPU`) for chemfiles
+    int32_t device_type;
+    /// Index of the device, always 0 for chemfiles
+    int32_t device_id;
+} chfl_dlpack_device;
+
+/// Type of the elements in a `chfl_dlpack_tensor`. This is compatible with
+/// `DLDataType` from DLPack.
+typedef struct {  // NOLINT: this is both a C and C++ file
+    /// Kind of data, always 2 (`kDLFloat`) for chemfiles
+    uint8_t code;
+    /// Number of bits in a single element, always 64 for chemfiles
+    uint8_t bits;
+    /// Number of lanes in a single element, always 1 for chemfiles
+    uint16_t lanes;
+} chfl_dlpack_dtype;
+
+/// Description of a strided array. This is compatible with `DLTensor` from
+/// DLPack.
+typedef struct {  // NOLINT: this is both a C and C++ file
+    /// Pointer to the beginning of the data
+    void* data;
+    /// Device where the data lives
+    chfl_dlpack_device device;
+    /// Number of dimensions of the array
+    int32_t ndim;
+    /// Type of the elements of the array
+    chfl_dlpack_dtype dtype;
+    /// Shape of the array, containing `ndim` values
+    int64_t* shape;
+    /// Strides of the array, in number of elements (not bytes), containing
+    /// `ndim` values
+    int64_t* strides;
+    /// Offset in bytes of the first element with respect to `data`
+    uint64_t byte_offset;
+} chfl_dlpack_tensor;
+
+/// An array exported by chemfiles, together with the function to call when
+/// the array is no longer needed. This is compatible with `DLManagedTensor`
+/// from DLPack, and pointers to `chfl_dlpack_managed_tensor` can be cast to
+/// pointers to `DLManagedTensor` to give them to other libraries.
+typedef struct chfl_dlpack_managed_tensor {  // NOLINT: this is both a C and C++ file
+    /// The array data and description
+    chfl_dlpack_tensor dl_tensor;
+    /// Private data used by chemfiles to manage the lifetime of the array
+    void* manager_ctx;
+    /// Function to call with this structure as argument when the array is no
+    /// longer needed
+    void (*deleter)(struct chfl_dlpack_managed_tensor* self);
+} chfl_dlpack_managed_tensor;
+
 #ifdef __cplusplus
 }
 #endif
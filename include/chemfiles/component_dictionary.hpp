@@ -0,0 +1,147 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_COMPONENT_DICTIONARY_HPP
+#define CHEMFILES_COMPONENT_DICTIONARY_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Binary version of the PDB [Chemical Component Dictionary][CCD], used to
+/// create bonds in residues which are not part of the compiled-in
+/// `PDBConnectivity` table.
+///
+/// The binary file is created once from `components.cif` with
+/// `ComponentDictionary::build`, and then memory-mapped when loaded. Lookup
+/// by residue name uses a minimal perfect hash stored in the file, so loading
+/// and querying the dictionary does not require parsing any text.
+///
+/// The file contains (all integers are little-endian):
+///
+/// - a 32 bytes header: the `CHFL-CCD` magic string, and the version, number
+///   of components, number of hash buckets, number of atoms, number of bonds,
+///   and size of the string table as `uint32_t`;
+/// - the hash displacements for each bucket, as `uint32_t`;
+/// - the components, ordered by hash slot, as 5 `uint32_t`: offset of the
+///   name in the string table, index of the first atom, number of atoms, index
+///   of the first bond, and number of bonds. The highest bit of the number of
+///   atoms is set for components which can be linked in a polymer chain;
+/// - the atoms, as the `uint32_t` offset of their name in the string table;
+/// - the bonds, as 4 `uint16_t`: the two atomic indexes inside the component,
+///   the bond order, and a reserved value;
+/// - the string table, containing NULL-terminated strings.
+///
+/// [CCD]: https://www.wwpdb.org/data/ccd
+class ComponentDictionary final {
+public:
+    /// A bond between two atoms in a `Component`
+    struct ComponentBond {
+        /// Index of the first atom in the component
+        size_t i;
+        /// Index of the second atom in the component
+        size_t j;
+        /// Order of the bond
+        Bond::BondOrder order;
+    };
+
+    /// A single component (i.e. residue template) in the dictionary
+    class Component {
+    public:
+        /// Get the name of this component, e.g. `ATP`
+        std::string_view name() const;
+        /// Get the number of atoms in this component
+        size_t size() const;
+        /// Get the name of the atom at `index` in this component
+        std::string_view atom(size_t index) const;
+        /// Get the number of bonds in this component
+        size_t bonds_count() const;
+        /// Get the bond at `index` in this component
+        ComponentBond bond(size_t index) const;
+        /// Can this component be linked to other components in a polymer
+        /// chain (peptide or nucleic acid)?
+        bool polymer() const;
+
+    private:
+        Component(const ComponentDictionary& dictionary, size_t index);
+
+        const ComponentDictionary* dictionary_;
+        uint32_t name_;
+        uint32_t first_atom_;
+        uint32_t natoms_;
+        uint32_t first_bond_;
+        uint32_t nbonds_;
+        bool polymer_;
+
+        friend class ComponentDictionary;
+    };
+
+    /// Open the binary dictionary at `path`, created by `build`
+    ///
+    /// @throws FileError if the file can not be opened
+    /// @throws FormatError if the file is not a valid dictionary
+    explicit ComponentDictionary(const std::string& path);
+    ~ComponentDictionary();
+
+    ComponentDictionary(ComponentDictionary&&) = delete;
+    ComponentDictionary& operator=(ComponentDictionary&&) = delete;
+    ComponentDictionary(const ComponentDictionary&) = delete;
+    ComponentDictionary& operator=(const ComponentDictionary&) = delete;
+
+    /// Get the number of components in this dictionary
+    size_t size() const {
+        return ncomponents_;
+    }
+
+    /// Find the component with the given `name`, if it exists
+    optional<Component> find(std::string_view name) const;
+
+    /// Convert the chemical component dictionary in mmCIF format at `input`
+    /// (possibly compressed) to the binary format, and write it to `output`.
+    static void build(const std::string& input, const std::string& output);
+
+    /// Get the dictionary loaded with `chemfiles::load_component_dictionary`,
+    /// or `nullptr` if no dictionary was loaded.
+    static std::shared_ptr<const ComponentDictionary> global();
+
+private:
+    /// Get the NULL-terminated string at `offset` in the string table
+    std::string_view string(uint32_t offset) const;
+    /// Read the `uint32_t` at byte `offset`
+    uint32_t read_u32(size_t offset) const;
+    /// Read the `uint16_t` at byte `offset`
+    uint16_t read_u16(size_t offset) const;
+
+    /// Data of the file, either memory-mapped or stored in `buffer_`
+    const char* data_ = nullptr;
+    /// Size of `data_`
+    size_t size_ = 0;
+    /// Is `data_` memory-mapped?
+    bool mapped_ = false;
+    /// Storage for the data when memory mapping is not available
+    std::vector<char> buffer_;
+
+    uint32_t ncomponents_ = 0;
+    uint32_t nbuckets_ = 0;
+    uint32_t natoms_ = 0;
+    uint32_t nbonds_ = 0;
+    uint32_t strings_size_ = 0;
+
+    /// offsets of the different sections in `data_`
+    size_t displacements_ = 0;
+    size_t components_ = 0;
+    size_t atoms_ = 0;
+    size_t bonds_ = 0;
+    size_t strings_ = 0;
+};
+
+} // namespace chemfiles
+
+#endif
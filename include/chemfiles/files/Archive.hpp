@@ -0,0 +1,128 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_ARCHIVE_HPP
+#define CHEMFILES_ARCHIVE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class MemoryBuffer;
+
+/// Separator between the path to an archive and the name of a member inside
+/// this archive, as in `structures.tar::1abc.pdb`
+constexpr const char* ARCHIVE_MEMBER_SEPARATOR = "::";
+
+/// Read-only access to the files stored inside a tar or zip archive.
+///
+/// The archive is indexed once when it is opened, and individual members can
+/// then be read without scanning the whole archive again. Plain tar and zip
+/// archives are memory-mapped when possible; compressed tar archives
+/// (`.tar.gz`, `.tar.xz`, `.tar.bz2` and their short `.tgz`, `.txz` and
+/// `.tbz2` versions) are decompressed in memory once. Members of zip archives
+/// can be stored without compression or with deflate.
+///
+/// Since compressed tar archives have no index, the whole decompressed
+/// archive is kept in memory while the `Archive` exists, even to list or read
+/// a single member. Plain tar or zip archives should be preferred for large
+/// collections of files.
+class Archive final {
+public:
+    /// Open and index the archive at `path`. The kind of archive is guessed
+    /// from the extension of the path.
+    ///
+    /// @throws FileError if the file can not be opened
+    /// @throws FormatError if the file is not a valid archive
+    explicit Archive(const std::string& path);
+    ~Archive();
+
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+    Archive(Archive&&) = delete;
+    Archive& operator=(Archive&&) = delete;
+
+    /// Get the archive at `path`, re-using the index of a recently opened
+    /// archive if the file did not change since then. This function can be
+    /// called concurrently from multiple threads.
+    static std::shared_ptr<const Archive> open(const std::string& path);
+
+    /// Check if `path` refers to a member of an archive, i.e. has the form
+    /// `<archive>::<member>` where `<archive>` has a tar or zip extension. If
+    /// it does, return the path to the archive and the name of the member.
+    static optional<std::pair<std::string, std::string>> split_path(const std::string& path);
+
+    /// Check if `path` has one of the extensions used for tar or zip archives
+    static bool is_archive(const std::string& path);
+
+    /// Get the names of all the regular files in this archive, in the order
+    /// they are stored in the archive
+    const std::vector<std::string>& members() const {
+        return names_;
+    }
+
+    /// Check if this archive contains a member with the given `name`
+    bool contains(const std::string& name) const {
+        return index_.find(name) != index_.end();
+    }
+
+    /// Read the member with the given `name` in a new `MemoryBuffer`, which
+    /// owns a copy of the (decompressed) member data.
+    ///
+    /// @throws FileError if the member does not exist or can not be
+    ///                   decompressed
+    std::shared_ptr<MemoryBuffer> read(const std::string& name) const;
+
+private:
+    /// Position of a member inside the archive data
+    struct Member {
+        /// Offset of the member data for tar archives, or of the local file
+        /// header for zip archives
+        uint64_t offset;
+        /// Size of the member data inside the archive
+        uint64_t stored_size;
+        /// Size of the member data after decompression
+        uint64_t size;
+        /// Compression method, only used by zip archives (0 for stored, 8 for
+        /// deflate)
+        uint16_t method;
+    };
+
+    /// Add a new member to the index
+    void add_member(std::string name, Member member);
+    /// Index the members of a tar archive
+    void index_tar();
+    /// Index the members of a zip archive
+    void index_zip();
+    /// Get the offset of the data of a zip member from its local file header
+    uint64_t zip_data_offset(const std::string& name, const Member& member) const;
+
+    /// Path to the archive
+    std::string path_;
+    /// Is this a zip archive?
+    bool zip_ = false;
+    /// Start of the archive data
+    const char* data_ = nullptr;
+    /// Size of the archive data
+    size_t size_ = 0;
+    /// Was `data_` created with mmap?
+    bool mapped_ = false;
+    /// Storage for the archive data when not using mmap
+    std::vector<char> buffer_;
+    /// Storage for the decompressed data of compressed tar archives
+    std::unique_ptr<MemoryBuffer> decompressed_;
+    /// Names of the members, in archive order
+    std::vector<std::string> names_;
+    /// Members by name
+    std::unordered_map<std::string, Member> index_;
+};
+
+} // namespace chemfiles
+
+#endif
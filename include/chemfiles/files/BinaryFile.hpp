@@ -4,11 +4,13 @@
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <type_traits>
 #include <vector>
+#include <functional>
+#include <type_traits>
 
 #include "chemfiles/config.h"
 #include "chemfiles/File.hpp"
+#include "chemfiles/misc.hpp"
 
 static_assert(sizeof(char) == sizeof(int8_t), "char must be 8-bits");
 
@@ -63,6 +65,53 @@ public:
     /// Get the size of the file
     uint64_t file_size();
 
+    /// Update the view of a file opened in read mode to include data appended
+    /// to it (by another process) since it was opened or since the last call
+    /// to this function, and get the new size of the file. The current
+    /// position in the file is not changed.
+    uint64_t refresh();
+
+    /// A range of `size` bytes starting at `offset` in the file
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /// Request the data in all the `ranges` from the operating system with
+    /// `will_need`, and call `callback(i)` for each range in order.
+    ///
+    /// This is intended to read multiple frames at once: the data is
+    /// requested by chunks of limited size, one chunk ahead of the callbacks,
+    /// and then decoded with the usual reading functions, which find it in
+    /// the operating system cache instead of waiting on the storage for each
+    /// frame. The data itself is only read once, by the callbacks.
+    void prefetch(const std::vector<Range>& ranges, const std::function<void(size_t)>& callback);
+
+    /// Tell the operating system how the file will be accessed. The hint is
+    /// only used for files opened in read mode, and ignored on systems
+    /// without `madvise`/`posix_fadvise`.
+    void set_access_pattern(AccessPattern pattern);
+
+    /// Get the access pattern given to `set_access_pattern`
+    AccessPattern access_pattern() const {
+        return access_pattern_;
+    }
+
+    /// Tell the operating system that the data in `range` will be read soon,
+    /// allowing it to start reading this data in the background.
+    void will_need(Range range);
+
+    /// Tell the operating system that the data in `range` will not be read
+    /// again, allowing it to drop this data from the cache.
+    void drop_cache(Range range);
+
+    /// Give hints to the operating system after reading the data in `current`
+    /// when the data in `next` will be read afterward, depending on the
+    /// access pattern: the `next` data is requested in advance for
+    /// `SEQUENTIAL` and `STREAMING` access, and the `current` data is dropped
+    /// from the cache for `STREAMING` access.
+    void sequential_hints(Range current, Range next);
+
     /// Read exactly `count` char, and store them in the `data` array
     void read_char(char* data, size_t count);
     /// Read exactly as many char as fit in the pre-allocated vector
@@ -344,6 +393,14 @@ private:
     /// destructor and move assignment operator
     void close_file() noexcept;
 
+    /// Access pattern given to `set_access_pattern`
+    AccessPattern access_pattern_ = AccessPattern::NORMAL;
+
+#ifndef CHEMFILES_WINDOWS
+    /// Get the file descriptor used by this file
+    int native_fd() const;
+#endif
+
 #if CHEMFILES_BINARY_FILE_USE_MMAP
     int file_descriptor_ = -1;
     char* mmap_data_ = nullptr;
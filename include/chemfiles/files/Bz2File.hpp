@@ -29,9 +29,13 @@ public:
 
     void clear() noexcept override;
     void seek(uint64_t position) override;
+    void flush() override;
 
 private:
     void compress_and_write(int action);
+    /// Start decompressing a new bzip2 stream, keeping the remaining input
+    /// data
+    void restart_decompression();
 
     FILE* file_ = nullptr;
     /// Store the mode used to open this file
@@ -43,6 +47,9 @@ private:
     /// compressed data buffer, straight out from the file when reading, to be
     /// written to the file when writing.
     std::vector<char> buffer_;
+    /// Does the current bzip2 stream need to be finished before closing the
+    /// file when writing?
+    bool unfinished_ = false;
 };
 
 /// Inflates BZIP2 data from the `src` buffer
@@ -26,6 +26,7 @@ public:
 
     void clear() noexcept override;
     void seek(uint64_t position) override;
+    void flush() override;
 
 private:
     /// Check if any error happened while reading/writing the file. Returns the
@@ -33,6 +34,8 @@ private:
     const char* check_error() const;
 
     gzFile file_ = nullptr;
+    /// Was some data written since the start of the current gzip member?
+    bool written_ = false;
 };
 
 /// Inflates GZipped data from the `src` buffer
@@ -14,6 +14,7 @@ class MemoryBuffer;
 MemoryBuffer decompress_xz(const char*, size_t);
 MemoryBuffer decompress_gz(const char*, size_t);
 MemoryBuffer decompress_bz2(const char*, size_t);
+MemoryBuffer decompress_deflate(const char*, size_t, size_t);
 
 /// A class for handling memory passed directly instead of through a file
 /// handle. Unlike a `std::vector`, it does not assume ownership of the data
@@ -81,6 +82,7 @@ private:
     friend MemoryBuffer chemfiles::decompress_xz(const char*, size_t);
     friend MemoryBuffer chemfiles::decompress_gz(const char*, size_t);
     friend MemoryBuffer chemfiles::decompress_bz2(const char*, size_t);
+    friend MemoryBuffer chemfiles::decompress_deflate(const char*, size_t, size_t);
 
     /// Start of the memory buffer
     char* ptr_;
@@ -28,6 +28,7 @@ public:
 
     void clear() noexcept override {}
     void seek(uint64_t position) override;
+    optional<uint64_t> size() override;
 
 private:
     /// Current reading location
@@ -24,6 +24,8 @@ public:
 
     void clear() noexcept override;
     void seek(uint64_t position) override;
+    optional<uint64_t> size() override;
+    void flush() override;
 
 private:
     std::FILE* file_;
@@ -38,8 +38,10 @@ class XDRFile final : public BigEndianFile {
     /// Write a non-compliant GROMACS string
     void write_gmx_string(const std::string& value);
 
-    /// Read compressed GROMACS floats and returns the precision
-    float read_gmx_compressed_floats(std::vector<float>& data);
+    /// Read compressed GROMACS floats and returns the precision. Only the
+    /// values for (at least) the first `count` atoms are decoded, the other
+    /// values in `data` are left unchanged.
+    float read_gmx_compressed_floats(std::vector<float>& data, size_t count = SIZE_MAX);
     /// Write compressed GROMACS floats with a given precision
     void write_gmx_compressed_floats(const std::vector<float>& data, float precision);
 
@@ -28,6 +28,7 @@ public:
 
     void clear() noexcept override;
     void seek(uint64_t position) override;
+    void flush() override;
 
 private:
     /// Compress data from stream_.next_in, and write the data to the file.
@@ -44,6 +45,9 @@ private:
     /// compressed data buffer, straight out from the file when reading, to be
     /// written to the file when writing.
     std::vector<uint8_t> buffer_;
+    /// Does the current xz stream need to be finished before closing the
+    /// file when writing?
+    bool unfinished_ = false;
 };
 
 /// Inflates LZMA/XZ data from the `src` buffer
@@ -15,6 +15,8 @@
 namespace chemfiles {
 
 class Frame;
+class FrameView;
+class VectorsView;
 class UnitCell;
 class Vector3D;
 class FormatMetadata;
@@ -28,7 +30,7 @@ public:
 
     void read(Frame& frame) override final;
     void read_step(size_t step, Frame& frame) override final;
-    void write(const Frame& frame) override;
+    void write_view(const FrameView& frame) override;
 
 protected:
     struct variable_scale_t {
@@ -44,7 +46,7 @@ protected:
     /// write the unit cell at the current step
     void write_cell(const UnitCell& cell);
     /// write the values from the array to the variable at the current internal step
-    void write_array(variable_scale_t& variable, span<const Vector3D> array);
+    void write_array(variable_scale_t& variable, const VectorsView& array);
 
     /// associated NetCDF file.
     netcdf3::Netcdf3File file_;
@@ -66,7 +68,7 @@ protected:
     std::vector<float> buffer_f32_;
     std::vector<double> buffer_f64_;
 
-    virtual void initialize(const Frame& frame) = 0;
+    virtual void initialize(const FrameView& frame) = 0;
 
 private:
     /// Validate the common bits between AMBER and AMBERRESTART conventions
@@ -81,7 +83,7 @@ public:
     AmberTrajectory(std::string path, File::Mode mode, File::Compression compression);
 
     size_t nsteps() override;
-    void initialize(const Frame& frame) override;
+    void initialize(const FrameView& frame) override;
 
 private:
     void validate();
@@ -92,9 +94,9 @@ class AmberRestart final: public AmberNetCDFBase {
 public:
     AmberRestart(std::string path, File::Mode mode, File::Compression compression);
 
-    void write(const Frame& frame) override;
+    void write_view(const FrameView& frame) override;
     size_t nsteps() override;
-    void initialize(const Frame& frame) override;
+    void initialize(const FrameView& frame) override;
 
 private:
     void validate();
@@ -0,0 +1,150 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FORMAT_BINARY_CIF_HPP
+#define CHEMFILES_FORMAT_BINARY_CIF_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <string_view>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Format.hpp"
+#include "chemfiles/Connectivity.hpp"
+
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class Frame;
+class MemoryBuffer;
+class FormatMetadata;
+
+/// A single column of a BinaryCIF category, decoded to either numbers or
+/// strings
+struct BinaryCIFColumn {
+    /// Values of a numeric column
+    std::vector<double> numbers;
+    /// All the strings of a string column, one after the other
+    std::string string_data;
+    /// Start of each string in `string_data`, with an additional entry for
+    /// the end of the last string
+    std::vector<size_t> string_offsets;
+    /// Index of the string for each row of a string column, negative for
+    /// empty strings
+    std::vector<int64_t> string_indexes;
+    /// Mask for each row: 0 for values present in the file, 1 for values
+    /// marked as not specified (`.`) and 2 for values marked as unknown
+    /// (`?`). This is empty if all the values are present.
+    std::vector<uint8_t> mask;
+
+    /// Is the value at `row` present in the file?
+    bool present(size_t row) const {
+        return mask.empty() || mask[row] == 0;
+    }
+
+    /// Get the number at `row` in a numeric column
+    double number(size_t row) const {
+        return numbers[row];
+    }
+
+    /// Get the string at `row` in a string column
+    std::string_view string(size_t row) const {
+        auto index = string_indexes[row];
+        if (index < 0) {
+            return {};
+        }
+        auto start = string_offsets[static_cast<size_t>(index)];
+        auto stop = string_offsets[static_cast<size_t>(index) + 1];
+        return std::string_view(string_data).substr(start, stop - start);
+    }
+};
+
+/// BinaryCIF reader. BinaryCIF stores the same data as mmCIF files, encoded
+/// column by column with msgpack, and compressed with integer packing, delta
+/// and run-length encodings.
+///
+/// All the columns used by chemfiles are decoded when opening the file, and
+/// frames are then created from the decoded columns. Residues and chains use
+/// the same conventions as the mmCIF reader. Each model in the file
+/// (`_atom_site.pdbx_PDB_model_num`) is a different step.
+class BinaryCIFFormat final: public Format {
+public:
+    BinaryCIFFormat(std::string path, File::Mode mode, File::Compression compression);
+    BinaryCIFFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression);
+
+    void read_step(size_t step, Frame& frame) override;
+    void read(Frame& frame) override;
+    size_t nsteps() override;
+
+private:
+    /// Decode the BinaryCIF data in the `size` bytes at `data`
+    void decode(const char* data, size_t size);
+    /// Add the bonds from the `_struct_conn` category to the atoms in
+    /// `frame`, created from the rows `[first, first + frame.size())` of the
+    /// `_atom_site` category
+    void add_connections(Frame& frame, size_t first) const;
+
+    /// Columns of the `_atom_site` category
+    struct AtomSite {
+        BinaryCIFColumn type_symbol;
+        optional<BinaryCIFColumn> label_atom_id;
+        optional<BinaryCIFColumn> label_alt_id;
+        optional<BinaryCIFColumn> group_pdb;
+        optional<BinaryCIFColumn> formal_charge;
+
+        BinaryCIFColumn cartn_x;
+        BinaryCIFColumn cartn_y;
+        BinaryCIFColumn cartn_z;
+
+        optional<BinaryCIFColumn> label_comp_id;
+        optional<BinaryCIFColumn> label_asym_id;
+        optional<BinaryCIFColumn> auth_asym_id;
+        optional<BinaryCIFColumn> label_seq_id;
+        optional<BinaryCIFColumn> auth_seq_id;
+        optional<BinaryCIFColumn> label_entity_id;
+    };
+
+    /// One atom in a connection from the `_struct_conn` category
+    struct Partner {
+        std::string asym_id;
+        int64_t seq_id;
+        std::string atom_id;
+        std::string alt_id;
+    };
+
+    /// A bond from the `_struct_conn` category
+    struct Connection {
+        Partner first;
+        Partner second;
+        Bond::BondOrder order;
+    };
+
+    /// Name of the file, or "memory", used in error messages
+    std::string source_;
+    /// Decoded `_atom_site` columns
+    AtomSite atom_site_;
+    /// Index of the first row of each model in `_atom_site`, with an
+    /// additional entry for the total number of rows
+    std::vector<size_t> models_;
+    /// Bonds from the `_struct_conn` category
+    std::vector<Connection> connections_;
+    /// Are the atoms in `connections_` identified by `auth_seq_id` instead of
+    /// `label_seq_id`?
+    bool auth_seq_ids_ = false;
+    /// The cell for all frames
+    UnitCell cell_;
+    /// Frame properties
+    std::string name_;
+    std::string pdb_idcode_;
+    /// The next step to read
+    size_t step_ = 0;
+};
+
+template<> const FormatMetadata& format_metadata<BinaryCIFFormat>();
+
+} // namespace chemfiles
+
+#endif
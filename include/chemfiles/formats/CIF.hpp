@@ -37,6 +37,11 @@ public:
         init_();
     }
 
+    explicit CIFFormat(TextFile file) :
+        file_(std::move(file)), current_step_(0) {
+        init_();
+    }
+
     void read_step(size_t step, Frame& frame) override;
     void read(Frame& frame) override;
     void write(const Frame& frame) override;
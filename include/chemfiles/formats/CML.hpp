@@ -31,6 +31,11 @@ public:
         init_();
     }
 
+    explicit CMLFormat(TextFile file):
+        file_(std::move(file)) {
+        init_();
+    }
+
     ~CMLFormat() override;
 
     void read_step(size_t step, Frame& frame) override;
@@ -14,6 +14,7 @@
 namespace chemfiles {
 
 class Frame;
+class FrameView;
 class UnitCell;
 class Vector3D;
 class FormatMetadata;
@@ -53,9 +54,12 @@ public:
     DCDFormat(std::string path, File::Mode mode, File::Compression compression);
 
     size_t nsteps() override final;
+    size_t refresh() override final;
+    void set_access_pattern(AccessPattern pattern, size_t readahead) override final;
     void read(Frame& frame) override final;
     void read_step(size_t step, Frame& frame) override final;
-    void write(const Frame& frame) override;
+    void read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) override final;
+    void write_view(const FrameView& frame) override;
 
 private:
 
@@ -79,7 +83,10 @@ private:
 
     void write_header();
     void write_cell(const UnitCell& cell);
-    void write_positions(const Frame& frame);
+    void write_positions(const FrameView& frame);
+
+    /// Get the range of bytes containing `count` frames starting at `step`
+    BinaryFile::Range frame_range(size_t step, size_t count) const;
 
     std::unique_ptr<BinaryFile> file_;
     /// which variant of the DCD format are we trying to read?
@@ -129,6 +136,8 @@ private:
 
     /// total number of frames in the file
     size_t n_frames_ = 0;
+    /// Number of frames to request in advance when reading sequentially
+    size_t readahead_ = 1;
     /// simulation timestep metadata
     struct {
         double dt = 0;
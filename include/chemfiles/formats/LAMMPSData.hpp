@@ -47,8 +47,6 @@ private:
         FULL, LINE, MESO, MOLECULAR, PERI, SMD, SPHERE, TEMPLATE, TRI,
         WAVEPACKET, HYBRID
     } style_;
-    /// Did we send the hybrid style warning?
-    mutable bool warned_ = false;
 
 public:
     explicit atom_style(std::string name);
@@ -146,6 +144,12 @@ public:
         style_("full")
     {}
 
+    explicit LAMMPSDataFormat(TextFile file):
+        TextFormat(std::move(file)),
+        current_section_(HEADER),
+        style_("full")
+    {}
+
     void read_next(Frame& frame) override;
     void write_next(const Frame& frame) override;
     optional<uint64_t> forward() override;
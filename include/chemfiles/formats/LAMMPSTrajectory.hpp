@@ -30,6 +30,9 @@ class LAMMPSTrajectoryFormat final : public TextFormat {
                      File::Compression compression)
         : TextFormat(std::move(memory), mode, compression) {}
 
+    explicit LAMMPSTrajectoryFormat(TextFile file)
+        : TextFormat(std::move(file)) {}
+
     void read_next(Frame& frame) override;
     void write_next(const Frame& frame) override;
     optional<uint64_t> forward() override;
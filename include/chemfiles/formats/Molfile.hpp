@@ -26,7 +26,6 @@ class FormatMetadata;
 /// http://www.ks.uiuc.edu/Research/vmd/plugins/molfile/
 enum MolfileFormat {
     TRJ,                ///< Gromacs .trj file format
-    PSF,                ///< PSF topology files
     MOLDEN,             ///< Molden file format
 };
 
@@ -86,7 +85,6 @@ private:
 };
 
 template<> const FormatMetadata& format_metadata<Molfile<TRJ>>();
-template<> const FormatMetadata& format_metadata<Molfile<PSF>>();
 template<> const FormatMetadata& format_metadata<Molfile<MOLDEN>>();
 
 } // namespace chemfiles
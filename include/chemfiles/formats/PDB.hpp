@@ -49,10 +49,15 @@ public:
     PDBFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) :
         TextFormat(std::move(memory), mode, compression) {}
 
+    explicit PDBFormat(TextFile file) :
+        TextFormat(std::move(file)) {}
+
     ~PDBFormat() override;
 
     void read_next(Frame& frame) override;
     void write_next(const Frame& frame) override;
+    void write_views(const std::vector<FrameView>& frames) override;
+    bool format_next(const Frame& frame, size_t step, std::string& buffer) const override;
     optional<uint64_t> forward() override;
 
     // Connect residues based on a predefined table
@@ -78,7 +83,7 @@ private:
 
     /// Residue information in the current step
     std::map<FullResidueId, Residue> residues_;
-    /// Number of models written/read to the file.
+    /// Number of models read from the file.
     size_t models_ = 0;
     /// List of all atom offsets. This maybe pushed in read_ATOM or if a TER
     /// record is found. It is reset every time a frame is read.
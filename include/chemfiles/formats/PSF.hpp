@@ -0,0 +1,61 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FORMAT_PSF_HPP
+#define CHEMFILES_FORMAT_PSF_HPP
+
+#include <cstdint>
+#include <string>
+#include <memory>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Format.hpp"
+
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class Frame;
+class MemoryBuffer;
+class FormatMetadata;
+
+/// PSF (Protein Structure File) topology reader, supporting both the standard
+/// and the extended (`EXT`) variants of the format, as written by CHARMM,
+/// NAMD, X-PLOR and VMD.
+///
+/// Only the atoms (`!NATOM`), residues and bonds (`!NBOND`) are read. Angles,
+/// dihedrals and impropers are re-computed by chemfiles from the bonds, and
+/// the corresponding sections are not read.
+class PSFFormat final: public TextFormat {
+public:
+    PSFFormat(std::string path, File::Mode mode, File::Compression compression):
+        TextFormat(std::move(path), mode, compression) {}
+
+    PSFFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression):
+        TextFormat(std::move(memory), mode, compression) {}
+
+    explicit PSFFormat(TextFile file):
+        TextFormat(std::move(file)) {}
+
+    void read_next(Frame& frame) override;
+    optional<uint64_t> forward() override;
+
+private:
+    /// Read the header of the file, setting the `extended_` flag
+    void read_header();
+    /// Read the `!NATOM` section with `natoms` atoms in the frame
+    void read_atoms(Frame& frame, size_t natoms);
+    /// Read the `!NBOND` section with `nbonds` bonds in the frame
+    void read_bonds(Frame& frame, size_t nbonds);
+    /// Read the next section header, returning the number of entries and
+    /// the section name (e.g. `NATOM`), or `nullopt` at the end of the file.
+    optional<std::pair<size_t, std::string>> read_section_header();
+
+    /// Does this file uses the extended format, with larger columns?
+    bool extended_ = false;
+};
+
+template<> const FormatMetadata& format_metadata<PSFFormat>();
+
+} // namespace chemfiles
+
+#endif
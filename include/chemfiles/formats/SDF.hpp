@@ -26,6 +26,9 @@ public:
     SDFFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) :
         TextFormat(std::move(memory), mode, compression) {}
 
+    explicit SDFFormat(TextFile file) :
+        TextFormat(std::move(file)) {}
+
     void read_next(Frame& frame) override;
     void write_next(const Frame& frame) override;
     optional<uint64_t> forward() override;
@@ -0,0 +1,53 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_SNAPSHOT_FORMAT_HPP
+#define CHEMFILES_SNAPSHOT_FORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Format.hpp"
+#include "chemfiles/offset_index.hpp"
+
+#include "chemfiles/files/BinaryFile.hpp"
+
+namespace chemfiles {
+class Frame;
+class FormatMetadata;
+
+/// Reader and writer for files containing binary snapshots of frames, as
+/// created by `Frame::serialize`, stored one after the other. This format is
+/// intended to cache the result of parsing large or complex files, and
+/// contains all the data in a frame: topology, unit cell, positions,
+/// velocities and properties.
+///
+/// The file is scanned for the position of all snapshots when opened, using
+/// the size stored in each snapshot header.
+class SnapshotFormat final: public Format {
+public:
+    SnapshotFormat(std::string path, File::Mode mode, File::Compression compression);
+
+    void read_step(size_t step, Frame& frame) override;
+    void read(Frame& frame) override;
+    void write(const Frame& frame) override;
+    size_t nsteps() override;
+
+private:
+    /// Underlying binary file
+    LittleEndianFile file_;
+    /// Offsets of all snapshots in the file
+    OffsetIndex offsets_;
+    /// The next step to read
+    size_t step_ = 0;
+    /// Buffer used when reading and writing snapshots
+    std::vector<char> buffer_;
+};
+
+template <> const FormatMetadata& format_metadata<SnapshotFormat>();
+
+} // namespace chemfiles
+
+#endif
@@ -10,6 +10,7 @@
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/Format.hpp"
+#include "chemfiles/offset_index.hpp"
 
 #include "chemfiles/files/TNGFile.hpp"
 
@@ -42,7 +43,7 @@ private:
     size_t step_ = 0;
     /// The list of steps in the file -- in TNG numbering
     /// TNG frames are numbered by the MD step: 0, 10, 20, 30
-    std::vector<int64_t> tng_steps_;
+    OffsetIndex tng_steps_;
     /// The number of atoms in the current frame
     int64_t natoms_ = 0;
 };
@@ -5,16 +5,21 @@
 #define CHEMFILES_XTC_FORMAT_HPP
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/Format.hpp"
+#include "chemfiles/offset_index.hpp"
+#include "chemfiles/step_bisection.hpp"
+#include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/files/XDRFile.hpp"
 
 namespace chemfiles {
 class Frame;
+class FrameView;
 class FormatMetadata;
 
 /// GROMACS XTC file format reader.
@@ -23,9 +28,15 @@ class XTCFormat final : public Format {
     XTCFormat(std::string path, File::Mode mode, File::Compression compression);
 
     void read_step(size_t step, Frame& frame) override;
+    void read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) override;
     void read(Frame& frame) override;
-    void write(const Frame& frame) override;
+    void write_view(const FrameView& frame) override;
     size_t nsteps() override;
+    size_t refresh() override;
+    void set_access_pattern(AccessPattern pattern, size_t readahead) override;
+    void set_needed_atoms(optional<size_t> count) override;
+    bool lazy_steps() const override;
+    size_t bisect_steps() override;
 
   private:
     struct FrameHeader {
@@ -41,15 +52,39 @@ class XTCFormat final : public Format {
     /// Determine the number of frames
     /// and the corresponding offset within the file
     void determine_frame_offsets();
+    /// Add the offsets of all complete frames between `position` and
+    /// `filesize` to `frame_offsets_`, assuming a frame starts at `position`
+    void find_complete_frames(uint64_t position, uint64_t filesize);
+    /// Get the range of bytes containing `count` frames starting at `step`
+    BinaryFile::Range frame_range(size_t step, size_t count);
+    /// Find the offsets of all the frames in the file, if this was not done
+    /// yet
+    void index_steps();
+    /// Get the offset of the frame at `step`, using bisection if enabled
+    uint64_t frame_offset(size_t step);
+    /// Get the location of the frame starting at `offset`, if the frame
+    /// header there is valid
+    optional<FrameLocation> frame_location(uint64_t offset);
 
     /// Associated XDR file
     XDRFile file_;
     /// Offsets within file for fast indexing
-    std::vector<uint64_t> frame_offsets_;
+    OffsetIndex frame_offsets_;
+    /// Did we find the offsets of all the frames in the file?
+    bool indexed_ = false;
+    /// Bisection used to find frames when the offsets are not known,
+    /// `nullptr` if not enabled
+    std::unique_ptr<StepBisection> bisection_;
+    /// Estimated number of steps when using bisection
+    size_t bisection_nsteps_ = 0;
     /// The next step to read
     size_t step_ = 0;
     /// The number of atoms in the trajectory
     size_t natoms_ = 0;
+    /// Number of frames to request in advance when reading sequentially
+    size_t readahead_ = 1;
+    /// Number of atoms to decode at the beginning of each frame
+    size_t needed_atoms_ = SIZE_MAX;
 };
 
 template <> const FormatMetadata& format_metadata<XTCFormat>();
@@ -30,8 +30,11 @@ public:
     XYZFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) :
         TextFormat(std::move(memory), mode, compression){}
 
+    explicit XYZFormat(TextFile file) :
+        TextFormat(std::move(file)) {}
+
     void read_next(Frame& frame) override;
-    void write_next(const Frame& frame) override;
+    bool format_next(const Frame& frame, size_t step, std::string& buffer) const override;
     optional<uint64_t> forward() override;
 
 private:
@@ -12,6 +12,7 @@
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/Format.hpp"
+#include "chemfiles/offset_index.hpp"
 
 #include "chemfiles/Residue.hpp"
 #include "chemfiles/UnitCell.hpp"
@@ -35,6 +36,11 @@ public:
         init_();
     }
 
+    explicit mmCIFFormat(TextFile file) :
+        file_(std::move(file)), models_(0), atoms_(0) {
+        init_();
+    }
+
     void read_step(size_t step, Frame& frame) override;
     void read(Frame& frame) override;
     void write(const Frame& frame) override;
@@ -52,7 +58,7 @@ private:
     std::map<std::pair<std::string, int64_t>, size_t> map_residues_indexes;
     /// Storing the positions of all the steps in the file, so that we can
     /// just `seekpos` them instead of reading the whole step.
-    std::vector<uint64_t> steps_positions_;
+    OffsetIndex steps_positions_;
     /// The cell for all frames
     UnitCell cell_;
     /// Number of models written to the file.
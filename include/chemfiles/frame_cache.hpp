@@ -0,0 +1,114 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_FRAME_CACHE_HPP
+#define CHEMFILES_FRAME_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/Property.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class Frame;
+class Topology;
+
+/// Cache of decoded frames for a single `Trajectory`, used by
+/// `Trajectory::set_frame_cache`.
+///
+/// Entries are identified by their step in the trajectory, and are removed in
+/// least recently used order when the memory used by all cached frames goes
+/// over the limit. Consecutive frames with the same topology share a single
+/// copy of it, which is only accounted for once in the memory used.
+class FrameCache final {
+public:
+    /// Create a new cache using at most `limit` bytes
+    explicit FrameCache(size_t limit): limit_(limit) {}
+
+    ~FrameCache() = default;
+    FrameCache(FrameCache&&) = default;
+    FrameCache& operator=(FrameCache&&) = default;
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    /// Set `frame` to a copy of the frame at `step`, marking it as the most
+    /// recently used entry. If this frame is not in the cache, returns `false`
+    /// and leaves `frame` unchanged.
+    bool get(size_t step, Frame& frame);
+
+    /// Check if the frame at `step` is in the cache
+    bool contains(size_t step) const {
+        return index_.find(step) != index_.end();
+    }
+
+    /// Mark the frame at `step` as the most recently used entry, if it is in
+    /// the cache
+    void touch(size_t step) {
+        auto it = index_.find(step);
+        if (it != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+        }
+    }
+
+    /// Add a copy of `frame` to the cache as the frame at `step`
+    void insert(size_t step, const Frame& frame);
+
+    /// Set the maximal memory in bytes used by cached frames, removing
+    /// entries if needed
+    void set_limit(size_t limit);
+
+    /// Remove all entries from the cache
+    void clear();
+
+    /// Get the number of entries in the cache
+    size_t size() const {
+        return entries_.size();
+    }
+
+    /// Get the approximate memory in bytes used by the cached frames
+    size_t memory() const {
+        return memory_;
+    }
+
+private:
+    struct Entry {
+        /// Step of the frame in the trajectory
+        size_t step;
+        /// Value of `Frame::step` for this frame
+        size_t frame_step;
+        std::vector<Vector3D> positions;
+        optional<std::vector<Vector3D>> velocities;
+        /// Topology of the frame, possibly shared with other entries
+        std::shared_ptr<const Topology> topology;
+        UnitCell cell;
+        property_map properties;
+        /// Approximate memory used by this entry, excluding the topology
+        size_t memory;
+        /// Approximate memory used by the topology
+        size_t topology_memory;
+    };
+
+    /// Remove the least recently used entries until the memory used is below
+    /// the limit
+    void shrink();
+
+    /// Cached entries, the most recently used first
+    std::list<Entry> entries_;
+    /// Position of the entry for a given step in `entries_`
+    std::unordered_map<size_t, std::list<Entry>::iterator> index_;
+    /// Topology of the last inserted frame, to share it with the next one
+    std::weak_ptr<const Topology> last_topology_;
+    /// Total memory used by all entries and topologies
+    size_t memory_ = 0;
+    /// Maximal memory to use for all entries
+    size_t limit_;
+};
+
+} // namespace chemfiles
+
+#endif
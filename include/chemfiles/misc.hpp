@@ -16,6 +16,21 @@
 namespace chemfiles {
 class FormatMetadata;
 
+/// Possible access patterns when reading a trajectory, used to give hints to
+/// the operating system about which data should be read in advance and kept
+/// in cache (see `Trajectory::set_access_pattern`).
+enum class AccessPattern {
+    /// No specific access pattern
+    NORMAL,
+    /// The steps are read in order
+    SEQUENTIAL,
+    /// The steps are read in a random order
+    RANDOM,
+    /// The steps are read in order and only once, and should not stay in
+    /// cache after being read
+    STREAMING,
+};
+
 /// Callback type used to process a warning event
 typedef std::function<void(const std::string& message)> warning_callback_t; // NOLINT: doxygen fails to generate the right XLM from this
 
@@ -36,8 +51,10 @@ std::vector<std::reference_wrapper<const FormatMetadata>> CHFL_EXPORT formats_li
 ///
 /// Most of the time, the format is only guessed from the filename extension,
 /// without reading the file to guess the format. When two or more format can
-/// share the same extension (for example CIF and mmCIF), chemfiles tries to
-/// read the file to distinguish between them. If reading fails, the default
+/// share the same extension (for example CIF and mmCIF), or when the file does
+/// not have an extension or has an unknown extension, chemfiles reads the first
+/// bytes of the file (at most 64 KiB after decompression) to guess the format
+/// and compression method from the content. If reading fails, the default
 /// format for this extension is returned.
 ///
 /// Opening the file using the returned format string might still fail. For
@@ -58,6 +75,130 @@ std::vector<std::reference_wrapper<const FormatMetadata>> CHFL_EXPORT formats_li
 /// @example{guess_format.cpp}
 std::string CHFL_EXPORT guess_format(std::string path, char mode = 'r');
 
+/// Set the number of threads chemfiles can use to run parallel code.
+///
+/// All the parallel code in chemfiles uses a single internal thread pool,
+/// created the first time it is needed. By default, this pool contains as many
+/// threads as the value of the `CHEMFILES_NUM_THREADS` environment variable,
+/// or as many threads as the hardware supports if this variable is not set.
+/// Using `count = 0` resets the number of threads to this default value, and
+/// `count = 1` disables all parallelism. This function also removes any
+/// executor previously set with `set_executor`.
+///
+/// This function should not be called while chemfiles is running code in
+/// another thread.
+///
+/// @example{set_num_threads.cpp}
+///
+/// @param count the number of threads to use
+void CHFL_EXPORT set_num_threads(size_t count);
+
+/// Get the number of threads chemfiles uses to run parallel code.
+///
+/// @example{set_num_threads.cpp}
+size_t CHFL_EXPORT num_threads();
+
+/// Callback type used to run tasks on an external executor. The callback
+/// should arrange for `task` to be called exactly once, in any thread.
+typedef std::function<void(std::function<void()> task)> executor_t; // NOLINT: doxygen fails to generate the right XLM from this
+
+/// Use an external `executor` to run chemfiles parallel code instead of the
+/// internal thread pool.
+///
+/// This allows to share threads between chemfiles and the rest of the
+/// application (for example an OpenMP or TBB thread pool), preventing
+/// oversubscription. `concurrency` is the number of tasks the executor can run
+/// at the same time. Threads waiting for parallel tasks to finish will also
+/// help executing them, so the executor is allowed to run tasks late.
+///
+/// This function should not be called while chemfiles is running code in
+/// another thread.
+///
+/// @example{set_executor.cpp}
+///
+/// @param executor callback function that will be called to run tasks
+/// @param concurrency number of tasks the executor can run concurrently
+void CHFL_EXPORT set_executor(executor_t executor, size_t concurrency);
+
+/// Set the maximal memory (in bytes) used by the topology cache to `limit`.
+///
+/// `Trajectory::set_topology(const std::string&, const std::string&)` stores
+/// the topologies it reads in a process-wide cache, and re-uses them when the
+/// same file is used again with the same format. Files are identified by their
+/// canonical path, size, and last modification time, so modified files are
+/// always read again. When the memory used by the cached topologies goes over
+/// the limit, the least recently used topologies are removed from the cache.
+///
+/// The default limit is 1 GiB, and a limit of 0 disables the cache.
+///
+/// @example{topology_cache.cpp}
+///
+/// @param limit maximal memory used by the topology cache, in bytes
+void CHFL_EXPORT set_topology_cache_limit(size_t limit);
+
+/// Remove the topologies read from the file at `path` from the topology cache,
+/// or all the topologies if `path` is empty.
+///
+/// @example{topology_cache.cpp}
+///
+/// @param path path of the file to remove from the cache
+void CHFL_EXPORT clear_topology_cache(const std::string& path = "");
+
+/// Load the chemical component dictionary in binary format at `path`, to be
+/// used when creating bonds in residues read from PDB and mmCIF files.
+///
+/// By default, chemfiles only knows the bonds in standard residues (amino
+/// acids and nucleotides). When a dictionary is loaded, bonds are also created
+/// for all the other residues defined in the dictionary, such as ligands and
+/// modified residues. The dictionary file is memory-mapped and does not need
+/// to be parsed, so loading it is cheap.
+///
+/// The binary file should be created from the [PDB Chemical Component
+/// Dictionary][CCD] with `build_component_dictionary`. Using an empty `path`
+/// removes the currently loaded dictionary.
+///
+/// [CCD]: https://www.wwpdb.org/data/ccd
+///
+/// @example{component_dictionary.cpp}
+///
+/// @param path path to the binary component dictionary
+/// @throw FileError if the file can not be opened
+/// @throw FormatError if the file is not a valid binary component dictionary
+void CHFL_EXPORT load_component_dictionary(const std::string& path);
+
+/// Convert the chemical component dictionary in mmCIF format (e.g.
+/// `components.cif` or `components.cif.gz`) at `input` to the binary format
+/// used by `load_component_dictionary`, and write it to `output`.
+///
+/// @example{component_dictionary.cpp}
+///
+/// @param input path to the component dictionary in mmCIF format
+/// @param output path of the binary component dictionary to create
+/// @throw FileError if one of the files can not be opened
+/// @throw FormatError if the input file is not a valid component dictionary
+void CHFL_EXPORT build_component_dictionary(const std::string& input, const std::string& output);
+
+/// Get the paths of all the files matching the glob `pattern`, sorted in
+/// lexicographic order.
+///
+/// The `*` and `?` wildcards can be used in the last component of the
+/// pattern, for example `"dataset/*.sdf"`. If `pattern` is a directory, all
+/// the files in this directory are returned. As in shell globs, wildcards do
+/// not match hidden files, whose name starts with a dot. The returned paths
+/// can be used with `chemfiles::read_files`.
+///
+/// Files inside a tar or zip archive can be listed with a pattern like
+/// `"dataset.tar.gz::*.pdb"`. In this case, the wildcards apply to the full
+/// name of the archive members, and the returned paths have the
+/// `<archive>::<member>` form used to open archive members with `Trajectory`.
+///
+/// @example{trajectory/read_files.cpp}
+///
+/// @param pattern glob pattern, path to a directory, or archive member pattern
+/// @throw FileError if the directory or the archive can not be opened
+/// @throw FormatError if the archive is not a valid tar or zip archive
+std::vector<std::string> CHFL_EXPORT list_files(const std::string& pattern);
+
 } // namespace chemfiles
 
 #endif
@@ -0,0 +1,133 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_OFFSET_INDEX_HPP
+#define CHEMFILES_OFFSET_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chemfiles/bit_packing.hpp"
+
+namespace chemfiles {
+
+/// Compressed in-memory storage for a sequence of `uint64_t`, with constant
+/// time random access. This is used to store the position of each step in a
+/// file, which grows roughly linearly with the step index.
+///
+/// The values are stored by blocks of `OffsetIndex::BLOCK_SIZE`. For each
+/// complete block, the values are predicted with a line going from the first
+/// to the last value in the block, and only the difference to this prediction
+/// is stored, using the smallest number of bits that can represent all the
+/// differences in the block. The last incomplete block is stored without
+/// compression.
+///
+/// Files where all the steps have the same size need less than half a byte
+/// per step, and files with steps of varying size need a few bits per step in
+/// addition to this, instead of 8 bytes per step with a `std::vector`.
+class OffsetIndex final {
+public:
+    /// Number of values in a block
+    static constexpr size_t BLOCK_SIZE = bit_packing::BLOCK_SIZE;
+
+    OffsetIndex() = default;
+    ~OffsetIndex() = default;
+    OffsetIndex(const OffsetIndex&) = default;
+    OffsetIndex& operator=(const OffsetIndex&) = default;
+    OffsetIndex(OffsetIndex&&) = default;
+    OffsetIndex& operator=(OffsetIndex&&) = default;
+
+    /// Get the number of values in this index
+    size_t size() const {
+        return blocks_.size() * BLOCK_SIZE + tail_.size();
+    }
+
+    /// Check if this index is empty
+    bool empty() const {
+        return blocks_.empty() && tail_.empty();
+    }
+
+    /// Get the value at index `i`. This function does not check that `i` is
+    /// in bounds.
+    uint64_t operator[](size_t i) const {
+        auto block = i / BLOCK_SIZE;
+        if (block < blocks_.size()) {
+            return blocks_[block].get(data_, i % BLOCK_SIZE);
+        }
+        return tail_[i - blocks_.size() * BLOCK_SIZE];
+    }
+
+    /// Get the last value in this index. The index must not be empty.
+    uint64_t back() const {
+        return (*this)[size() - 1];
+    }
+
+    /// Add a new `value` at the end of this index
+    void push_back(uint64_t value) {
+        tail_.push_back(value);
+        if (tail_.size() == BLOCK_SIZE) {
+            this->compress_tail();
+        }
+    }
+
+    /// Add the `count` values `first, first + stride, first + 2 * stride, ...`
+    /// at the end of this index. Complete blocks of such values are added
+    /// directly, without storing any per-value data.
+    void extend(uint64_t first, uint64_t stride, size_t count);
+
+    /// Remove the last value of this index. The index must not be empty.
+    void pop_back();
+
+    /// Remove all values from this index
+    void clear();
+
+    /// Reserve memory for the metadata of `count` values
+    void reserve(size_t count) {
+        blocks_.reserve(count / BLOCK_SIZE);
+    }
+
+    /// Get the approximate memory used by this index, in bytes
+    size_t memory() const;
+
+private:
+    /// A compressed block of `BLOCK_SIZE` values
+    struct Block {
+        /// Value at the origin of the prediction line
+        uint64_t base;
+        /// Slope of the prediction line
+        uint64_t slope;
+        /// Index of the first word in `data_` used by this block (in the
+        /// higher 56 bits), and number of bits used for each value (in the
+        /// lower 8 bits). A block uses exactly `width` words in `data_`.
+        uint64_t start_width;
+
+        size_t start() const {
+            return static_cast<size_t>(start_width >> 8);
+        }
+
+        unsigned width() const {
+            return static_cast<unsigned>(start_width & 0xFF);
+        }
+
+        /// Get the value at index `i` in this block
+        uint64_t get(const std::vector<uint64_t>& data, size_t i) const {
+            auto packed = bit_packing::unpack(data.data() + this->start(), this->width(), i);
+            return base + i * slope + packed;
+        }
+    };
+
+    /// Compress the values in `tail_` to a new block
+    void compress_tail();
+
+    /// Compressed blocks
+    std::vector<Block> blocks_;
+    /// Packed differences to the prediction for all blocks
+    std::vector<uint64_t> data_;
+    /// Values in the last incomplete block
+    std::vector<uint64_t> tail_;
+};
+
+} // namespace chemfiles
+
+#endif
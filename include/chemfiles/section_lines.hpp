@@ -0,0 +1,76 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_SECTION_LINES_HPP
+#define CHEMFILES_SECTION_LINES_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <string_view>
+
+namespace chemfiles {
+class TextFile;
+
+/// Minimal number of lines in a chunk when parsing the lines of a section in
+/// parallel. Smaller sections are parsed in the calling thread.
+constexpr size_t PARALLEL_PARSE_GRAIN = 4096;
+
+/// Lines of a section in a text file, read from the file and stored
+/// contiguously in memory to allow parsing them in parallel.
+///
+/// Reading the lines is sequential and cheap compared to parsing them. Formats
+/// read all the lines of a section (for example all the atoms in a frame),
+/// parse them with `parallel_for` into pre-allocated arrays, and merge the
+/// data which depends on the previous lines (residues, bonds, ...) afterward.
+class SectionLines final {
+public:
+    /// Create an empty set of lines
+    SectionLines() {
+        starts_.push_back(0);
+    }
+
+    /// Read up to `count` lines from `file`, stopping early if the end of the
+    /// file is reached. Use `SectionLines::size` to check the number of lines
+    /// actually read.
+    SectionLines(TextFile& file, size_t count);
+
+    ~SectionLines() = default;
+    SectionLines(SectionLines&&) = default;
+    SectionLines& operator=(SectionLines&&) = default;
+    SectionLines(const SectionLines&) = delete;
+    SectionLines& operator=(const SectionLines&) = delete;
+
+    /// Add a copy of `line` at the end of this set of lines
+    void push_back(std::string_view line) {
+        data_.append(line.data(), line.size());
+        starts_.push_back(data_.size());
+    }
+
+    /// Get the number of lines
+    size_t size() const {
+        return starts_.size() - 1;
+    }
+
+    /// Check if there are no lines
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /// Get the line at index `i`
+    std::string_view operator[](size_t i) const {
+        assert(i < size());
+        return std::string_view(data_).substr(starts_[i], starts_[i + 1] - starts_[i]);
+    }
+
+private:
+    /// Content of all the lines, without line terminators
+    std::string data_;
+    /// Start of each line in `data_`, followed by the end of the last line
+    std::vector<size_t> starts_;
+};
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,85 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_SNAPSHOT_HPP
+#define CHEMFILES_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace chemfiles {
+class Frame;
+class Topology;
+
+/// Magic string at the beginning of all binary snapshots
+constexpr char SNAPSHOT_MAGIC[8] = {'C', 'H', 'F', 'L', '-', 'S', 'N', 'P'};
+/// Current version of the binary snapshot format
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+/// Size of the header at the beginning of all binary snapshots
+constexpr size_t SNAPSHOT_HEADER_SIZE = 32;
+
+/// Binary snapshots contain a full `Frame` or `Topology` in a compact form,
+/// which can be loaded back without parsing any text. Snapshots are created
+/// by `Frame::serialize` and `Topology::serialize`, and a file containing
+/// multiple frame snapshots one after the other is read and written by the
+/// `Chemfiles Snapshot` format.
+///
+/// All integers and floating point values are stored in little-endian order,
+/// and all strings (atom names and types, residue names, property names and
+/// values) are stored once in a string table and referenced by their index.
+/// A snapshot contains:
+///
+/// - a 32 bytes header: the `CHFL-SNP` magic string, the version and kind
+///   (0 for topology, 1 for frame) of the snapshot as `uint32_t`, the total
+///   size of the snapshot in bytes including the header and the number of
+///   atoms as `uint64_t`;
+/// - the string table: the number of strings as `uint64_t`, the offset of
+///   each string and the end of the last string as `uint64_t`, and the
+///   concatenated strings data;
+/// - the atoms, as flat columns: the name and type string indexes as
+///   `uint32_t`, then the masses and charges as `double`;
+/// - the atoms with properties: their number as `uint64_t`, and then for each
+///   the atom index as `uint64_t` followed by the property map;
+/// - the bonds: their number as `uint64_t`, the atomic indexes as pairs of
+///   `uint64_t`, and the bond orders as `uint8_t`;
+/// - the residues: their number as `uint64_t`, and then for each the name
+///   string index as `uint32_t`, a `uint32_t` set to 1 if the residue has an
+///   id, the id as `int64_t`, the number of atoms as `uint64_t`, the atomic
+///   indexes as `uint64_t`, and the property map;
+/// - for frame snapshots only: the step as `uint64_t`, the unit cell matrix
+///   as 9 `double`, the unit cell shape and a `uint32_t` set to 1 if the frame
+///   has velocities, the positions and velocities as 3 `double` per atom, and
+///   the frame property map.
+///
+/// Property maps are stored as the number of properties as `uint64_t`, and
+/// then for each property the name string index and the property kind as
+/// `uint32_t`, followed by the value: 8 bytes for booleans (as `uint64_t`),
+/// doubles, and strings (as a string index in `uint64_t`), and 24 bytes for
+/// 3D vectors.
+
+/// Append a snapshot of `frame` to `output`
+void write_snapshot(const Frame& frame, std::vector<char>& output);
+
+/// Append a snapshot of `topology` to `output`
+void write_snapshot(const Topology& topology, std::vector<char>& output);
+
+/// Check the snapshot header at the beginning of `data` and get the total
+/// size of the snapshot. Only `SNAPSHOT_HEADER_SIZE` bytes are read.
+///
+/// @throws FormatError if the header is invalid or for an unsupported version
+uint64_t snapshot_size(const char* data, size_t size);
+
+/// Read the frame snapshot in the `size` bytes starting at `data`
+///
+/// @throws FormatError if the data does not contain a valid frame snapshot
+Frame read_frame_snapshot(const char* data, size_t size);
+
+/// Read the topology in the snapshot in the `size` bytes starting at
+/// `data`. This works with both frame and topology snapshots.
+///
+/// @throws FormatError if the data does not contain a valid snapshot
+Topology read_topology_snapshot(const char* data, size_t size);
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,68 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_SNIFF_FORMAT_HPP
+#define CHEMFILES_SNIFF_FORMAT_HPP
+
+#include <string>
+#include <string_view>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+
+/// Maximal number of (decompressed) bytes read from a text file when guessing
+/// its format from the content
+constexpr size_t SNIFF_WINDOW_SIZE = 64 * 1024;
+
+/// Format of a file, as guessed by `sniff_format`
+struct SniffedFormat {
+    /// Name of the format, usable with `FormatFactory::by_name`
+    std::string format;
+    /// Compression of the file
+    File::Compression compression = File::DEFAULT;
+    /// The file opened to read its content, positioned at the beginning. This
+    /// is only set when the file was opened in read mode, and the format can
+    /// be created from an existing `TextFile`. The content already read from
+    /// the file is kept in the `TextFile` buffer, and does not need to be read
+    /// (and decompressed) again.
+    optional<TextFile> file;
+};
+
+/// Guess the format of the file at `path`, opened with the given `mode`.
+///
+/// The format is guessed from the extension of the file. When the extension
+/// is missing, unknown or shared between multiple formats (e.g. `.cif` for CIF
+/// and mmCIF), and the file is opened in read or append mode, the format is
+/// guessed from the first bytes of the file instead. No more than
+/// `SNIFF_WINDOW_SIZE` bytes are read from the file.
+///
+/// @throws FileError if the file does not have an extension, and the format
+///                   can not be guessed from the content
+/// @throws FormatError if the extension is not associated with a format, and
+///                     the format can not be guessed from the content
+SniffedFormat sniff_format(const std::string& path, File::Mode mode);
+
+/// Guess the format of a file named `name` from its in-memory `content`, for
+/// example a member of an archive. The same rules as for files on disk are
+/// used, and the `file` field of the returned value is never set. If the
+/// content is compressed, it is decompressed in memory to guess the format.
+///
+/// @throws FileError if the name does not have an extension, and the format
+///                   can not be guessed from the content
+/// @throws FormatError if the extension is not associated with a format, and
+///                     the format can not be guessed from the content
+SniffedFormat sniff_format(const std::string& name, std::string_view content);
+
+/// Guess the format of a text file from a prefix of its `content`, returning
+/// the format name or `nullopt` if no format matches.
+optional<std::string> sniff_text_format(std::string_view content);
+
+/// Guess the format of a binary file from the first bytes in `header`,
+/// returning the format name or `nullopt` if no format matches.
+optional<std::string> sniff_binary_format(std::string_view header);
+
+} // namespace chemfiles
+
+#endif
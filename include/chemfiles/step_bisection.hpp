@@ -0,0 +1,107 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_STEP_BISECTION_HPP
+#define CHEMFILES_STEP_BISECTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "chemfiles/external/optional.hpp"
+
+namespace chemfiles {
+class BinaryFile;
+
+/// A frame found in a binary trajectory file
+struct FrameLocation final {
+    /// Offset of the start of the frame in the file
+    uint64_t offset;
+    /// Size of the frame in the file, in bytes
+    uint64_t size;
+    /// Simulation step stored in the frame header
+    uint64_t step;
+};
+
+/// Locate frames in binary trajectory files where each frame starts with a
+/// 32-bit magic number and a header containing the simulation step, without
+/// reading all the frame headers in the file.
+///
+/// This assumes that the simulation steps of the frames are increasing and
+/// evenly spaced, which is the case for files written by a single simulation.
+/// Frame `i` then has the simulation step `first + i * stride`, and is found
+/// by bisection over the byte offsets in the file. Since arbitrary offsets
+/// usually fall in the middle of a frame, the search resynchronizes on the
+/// next offset containing the magic number and a valid frame header, followed
+/// by either another valid frame header or the end of the file.
+///
+/// Each frame found during the search is checked against these assumptions,
+/// and the search fails if they do not hold. When all the frames have the
+/// same size, the offset of each frame is checked exactly, which finds
+/// missing frames. Otherwise, only missing frames next to the frames visited
+/// by the search can be found.
+class StepBisection final {
+public:
+    /// Function checking if a valid frame starts at the given offset in the
+    /// file, and getting its size and step. This function can move the
+    /// current position in the file.
+    using frame_reader_t = std::function<optional<FrameLocation>(uint64_t offset)>;
+
+    /// Create a bisection over the frames in `file`, starting with the
+    /// `magic` number (as read by `BinaryFile::read_i32`). The frames are
+    /// validated with `read_frame`.
+    StepBisection(BinaryFile& file, int32_t magic, frame_reader_t read_frame);
+
+    ~StepBisection() = default;
+    StepBisection(StepBisection&&) = default;
+    StepBisection& operator=(StepBisection&&) = delete;
+    StepBisection(const StepBisection&) = delete;
+    StepBisection& operator=(const StepBisection&) = delete;
+
+    /// Find the first, second and last frames in the file, and get an
+    /// estimate of the number of frames. This returns `nullopt` if the steps
+    /// and offsets of these frames and of a few other frames across the file
+    /// are not compatible with evenly spaced steps.
+    optional<size_t> initialize();
+
+    /// Get the offset of the frame at `index` in the file, or `nullopt` if
+    /// the frame was not found. `initialize` must have been called before.
+    optional<uint64_t> locate(size_t index);
+
+    /// Get the location of the `count` frames starting with the frame at
+    /// `index`, as a single `FrameLocation` covering all of them, or
+    /// `nullopt` if the first frame was not found. If the end of the range
+    /// can not be found, the location only covers the first frame.
+    /// `initialize` must have been called before.
+    optional<FrameLocation> locate_range(size_t index, size_t count);
+
+private:
+    /// Get the frame starting at `offset`, checking that it is followed by
+    /// the magic number or the end of the file
+    optional<FrameLocation> frame_at(uint64_t offset);
+    /// Get the first valid frame starting at an offset in `[start, stop)`
+    optional<FrameLocation> resynchronize(uint64_t start, uint64_t stop);
+    /// Get the frame following `frame`, if any
+    optional<FrameLocation> next(const FrameLocation& frame);
+    /// Get the last complete frame in the file
+    optional<FrameLocation> find_last();
+    /// Check that `frame` can be the frame at `index` if the steps are
+    /// evenly spaced
+    bool is_at_index(const FrameLocation& frame, uint64_t index) const;
+
+    BinaryFile& file_;
+    int32_t magic_;
+    frame_reader_t read_frame_;
+    uint64_t file_size_ = 0;
+
+    FrameLocation first_ = {0, 0, 0};
+    FrameLocation last_ = {0, 0, 0};
+    /// Difference between the steps of consecutive frames
+    uint64_t stride_ = 1;
+    /// Size of all the frames in the file if they have the same size, or 0
+    uint64_t frame_size_ = 0;
+};
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,201 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_THREAD_POOL_HPP
+#define CHEMFILES_THREAD_POOL_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include "chemfiles/misc.hpp"
+
+namespace chemfiles {
+
+/// A single unit of work for the `ThreadPool`
+using task_t = std::function<void()>;
+
+/// Work-stealing task scheduler, shared by all the parallel code in chemfiles.
+///
+/// There is a single instance of this class, and the worker threads are only
+/// started the first time a task is submitted. Each worker thread owns a queue
+/// of tasks: workers take tasks from the back of their own queue, and steal
+/// tasks from the front of the other queues when they run out of work. Threads
+/// waiting on a `TaskGroup` execute pending tasks instead of blocking, which
+/// makes nested parallelism safe.
+///
+/// The number of threads defaults to the value of the `CHEMFILES_NUM_THREADS`
+/// environment variable if it is set, and to the number of hardware threads
+/// otherwise. With a single thread, all tasks are executed directly in the
+/// calling thread. Alternatively, an external executor can be used to run the
+/// tasks (see `chemfiles::set_executor`).
+class ThreadPool final {
+public:
+    /// Get the global instance of the `ThreadPool`
+    static ThreadPool& get();
+
+    ~ThreadPool();
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Get the number of threads which can execute tasks concurrently,
+    /// including the thread calling `TaskGroup::wait`.
+    size_t concurrency();
+
+    /// Use `count` threads to execute tasks. If `count` is 0, use the default
+    /// number of threads. This removes any external executor.
+    ///
+    /// This function waits for all queued tasks to finish, and should not be
+    /// called while chemfiles is executing parallel code.
+    void set_num_threads(size_t count);
+
+    /// Use the given `executor` to execute tasks, assuming it can run up to
+    /// `concurrency` tasks at the same time.
+    ///
+    /// This function waits for all queued tasks to finish, and should not be
+    /// called while chemfiles is executing parallel code.
+    void set_executor(executor_t executor, size_t concurrency);
+
+    /// Add a `task` to the queue. If there is a single thread and no executor,
+    /// the task is executed immediately in the calling thread.
+    ///
+    /// The task should not throw exceptions, use `TaskGroup` to propagate
+    /// errors to the caller.
+    void submit(task_t task);
+
+    /// Execute one pending task in the calling thread, returning `false` if
+    /// there was no pending task.
+    bool run_pending_task();
+
+private:
+    ThreadPool();
+
+    /// A queue of tasks, protected by a mutex
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    /// Create the worker threads if needed. Should be called with
+    /// `config_mutex_` locked.
+    void start();
+    /// Execute all remaining tasks, and join the worker threads. Should be
+    /// called with `config_mutex_` locked.
+    void stop();
+    /// Main loop of the worker thread `index`
+    void worker_loop(size_t index);
+    /// Get a task from the queues, starting with the queue at `index`
+    bool pop_task(size_t index, task_t& task);
+
+    /// Protects the configuration and the list of threads
+    std::mutex config_mutex_;
+    /// Number of threads to use, including the calling thread
+    size_t num_threads_;
+    /// External executor, if any
+    executor_t executor_;
+    /// Number of tasks which can run concurrently, either `num_threads_` or
+    /// the concurrency of the external executor
+    std::atomic<size_t> concurrency_;
+    /// Did we start the worker threads or configure the executor queue?
+    std::atomic<bool> started_;
+    /// Worker threads
+    std::vector<std::thread> threads_;
+    /// Tasks queues. The queue at index 0 is used for tasks submitted from
+    /// outside the pool, and the queue at index `i + 1` belongs to the worker
+    /// thread `i`.
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    /// Round-robin counter used to distribute external tasks
+    std::atomic<size_t> next_queue_;
+    /// Number of tasks currently in the queues
+    std::atomic<size_t> pending_;
+    /// Are the worker threads shutting down?
+    std::atomic<bool> stopping_;
+    /// Mutex and condition variable used to put idle workers to sleep
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+};
+
+/// A group of tasks executed by a `ThreadPool`, which can be waited on
+/// together.
+///
+/// The first exception thrown by any task in the group is captured and thrown
+/// again by `TaskGroup::wait`.
+class TaskGroup final {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::get());
+    /// Wait for all the tasks in this group, ignoring any error
+    ~TaskGroup();
+
+    TaskGroup(TaskGroup&&) = delete;
+    TaskGroup& operator=(TaskGroup&&) = delete;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /// Add a `task` to this group
+    void run(task_t task);
+
+    /// Wait for all the tasks in this group to finish, helping to execute
+    /// pending tasks in the meantime, and sleeping once there is no task
+    /// left to execute. If any task threw an exception, the first one is
+    /// re-thrown here.
+    void wait();
+
+private:
+    struct State {
+        std::atomic<size_t> remaining{0};
+        /// Protects `error`, and used with `done`
+        std::mutex mutex;
+        /// Notified when the last task of the group finishes
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    ThreadPool& pool_;
+    std::shared_ptr<State> state_;
+};
+
+/// Call `function(start, stop)` for sub-ranges covering the `[begin, end)`
+/// range, using the global `ThreadPool`. Sub-ranges contain at least `grain`
+/// elements (except for the last one), and the function is called directly if
+/// the range is smaller than `grain` or if there is a single thread.
+template<class Function>
+void parallel_for(size_t begin, size_t end, size_t grain, const Function& function) {
+    if (begin >= end) {
+        return;
+    }
+
+    auto& pool = ThreadPool::get();
+    auto count = end - begin;
+    auto threads = pool.concurrency();
+    grain = std::max<size_t>(grain, 1);
+    if (threads <= 1 || count <= grain) {
+        function(begin, end);
+        return;
+    }
+
+    // use a few chunks per thread to balance the load between threads
+    auto chunks = std::min((count + grain - 1) / grain, 4 * threads);
+    auto chunk_size = (count + chunks - 1) / chunks;
+
+    TaskGroup group(pool);
+    for (size_t start = begin; start < end; start += chunk_size) {
+        auto stop = std::min(start + chunk_size, end);
+        group.run([&function, start, stop]() {
+            function(start, stop);
+        });
+    }
+    group.wait();
+}
+
+} // namespace chemfiles
+
+#endif
@@ -0,0 +1,101 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#ifndef CHEMFILES_TOPOLOGY_CACHE_HPP
+#define CHEMFILES_TOPOLOGY_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/Property.hpp"
+
+namespace chemfiles {
+class Topology;
+
+/// Get the approximate memory in bytes used by the properties in `properties`
+size_t properties_memory(const property_map& properties);
+
+/// Get the approximate memory in bytes used by `topology`
+size_t topology_memory(const Topology& topology);
+
+/// Check if two topologies contain the same atoms, bonds and residues
+bool same_topology(const Topology& lhs, const Topology& rhs);
+
+/// Process-wide cache of topologies read from files, used by
+/// `Trajectory::set_topology(const std::string&, const std::string&)`.
+///
+/// Entries are identified by the canonical path of the file, the format used
+/// to read it, and the size and last modification time of the file. Modified
+/// files are thus read again, and the outdated entries are removed from the
+/// cache in least recently used order, when the memory used by all cached
+/// topologies goes over the limit.
+class TopologyCache final {
+public:
+    /// Get the instance of the `TopologyCache`
+    static TopologyCache& get();
+
+    /// Get the topology of the first frame of the file at `path` using the
+    /// given `format`, reading the file only if it is not already in the
+    /// cache.
+    std::shared_ptr<const Topology> read(const std::string& path, const std::string& format);
+
+    /// Set the maximal memory in bytes used by cached topologies, removing
+    /// entries if needed. Setting the limit to 0 disables the cache.
+    void set_limit(size_t limit);
+
+    /// Remove all entries corresponding to the file at `path` from the cache.
+    /// If `path` is empty, remove all entries.
+    void clear(const std::string& path = "");
+
+    /// Get the number of entries in the cache
+    size_t size();
+
+    /// Get the approximate memory in bytes used by the cached topologies
+    size_t memory();
+
+    /// Default memory limit for the cache, 1 GiB
+    static constexpr size_t DEFAULT_LIMIT = 1024 * 1024 * 1024;
+
+private:
+    TopologyCache() = default;
+
+    struct Key {
+        /// Canonical path to the file
+        std::string path;
+        /// Format used to read the file
+        std::string format;
+        /// File size in bytes
+        uint64_t size;
+        /// File last modification time, in implementation-defined units
+        int64_t mtime;
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const Topology> topology;
+        /// Approximate memory used by the topology
+        size_t memory;
+    };
+
+    struct State {
+        /// Cached entries, the most recently used first
+        std::list<Entry> entries;
+        /// Total memory used by all entries
+        size_t memory = 0;
+        /// Maximal memory to use for all entries
+        size_t limit = DEFAULT_LIMIT;
+
+        /// Remove the least recently used entries until the memory used is
+        /// below the limit
+        void shrink();
+    };
+
+    mutex<State> state_;
+};
+
+} // namespace chemfiles
+
+#endif
@@ -2,6 +2,7 @@
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
 #include <cassert>
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -115,6 +116,16 @@ void TextFile::clear() {
     file_->clear();
 }
 
+void TextFile::refresh() {
+    auto position = tellpos();
+    clear();
+    // actually seek the file, even if the position is inside the buffer
+    file_->seek(position);
+    position_ = position;
+    // mark buffer to be refilled
+    buffer_[0] = '\0';
+}
+
 bool TextFile::buffer_initialized() const {
     return buffer_[0] != '\0';
 }
@@ -122,7 +133,8 @@ bool TextFile::buffer_initialized() const {
 void TextFile::fill_buffer(size_t start) {
     auto count = buffer_.size() - start;
     if (buffer_initialized()) {
-        position_ += count;
+        // all the data before `line_start_` is removed from the buffer
+        position_ += static_cast<uint64_t>(line_start_ - buffer_.data());
     }
 
     auto read_count = file_->read(buffer_.data() + start, count);
@@ -199,6 +211,38 @@ std::string_view TextFile::readline() {
     return line;
 }
 
+std::string_view TextFile::peek(size_t count) {
+    if (!buffer_initialized()) {
+        fill_buffer(0);
+    }
+
+    while (true) {
+        auto remainder = static_cast<size_t>(end_ - line_start_);
+        if (remainder >= count || got_impl_eof_) {
+            auto size = std::min(count, remainder);
+            if (got_impl_eof_) {
+                // the buffer is padded with null characters after the end of
+                // the file
+                auto end = std::memchr(line_start_, '\0', size);
+                if (end != nullptr) {
+                    size = static_cast<size_t>(reinterpret_cast<const char*>(end) - line_start_);
+                }
+            }
+            return std::string_view(line_start_, size);
+        }
+
+        if (remainder >= buffer_.size()) {
+            auto delta = line_start_ - buffer_.data();
+            buffer_.resize(2 * buffer_.size(), 0);
+            line_start_ = buffer_.data() + delta;
+            end_ = buffer_.data() + buffer_.size();
+        }
+
+        std::memmove(buffer_.data(), line_start_, remainder);
+        fill_buffer(remainder);
+    }
+}
+
 void TextFile::vprint(fmt::string_view format, fmt::format_args args) {
     std::string buffer;
     buffer.reserve(128);
@@ -210,10 +254,25 @@ void TextFile::vprint(fmt::string_view format, fmt::format_args args) {
     position_ += buffer.size();
 }
 
+void TextFile::write(std::string_view data) {
+    if (data.empty()) {
+        return;
+    }
+    file_->write(data.data(), data.size());
+    position_ += data.size();
+}
+
 std::string TextFile::readall() {
+    auto position = this->tellpos();
     std::string buffer;
-    buffer.resize(2048, '\0');
     size_t start = 0;
+    if (buffer_initialized()) {
+        // start with the data already in the buffer
+        buffer = std::string(this->peek(static_cast<size_t>(end_ - line_start_)));
+        start = buffer.size();
+    }
+
+    buffer.resize(start + 2048, '\0');
     while (true) {
         auto count = buffer.size() - start;
         auto read_count = file_->read(&buffer[0] + start, count);
@@ -226,5 +285,9 @@ std::string TextFile::readall() {
         buffer.resize(2 * buffer.size(), '\0');
     }
 
+    position_ = position + buffer.size();
+    // mark buffer to be refilled
+    buffer_[0] = '\0';
+
     return buffer;
 }
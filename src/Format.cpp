@@ -1,20 +1,27 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <atomic>
+#include <cassert>
 #include <cstdint>
 #include <string>
+#include <exception>
 #include <vector>
 #include <memory>
 #include <utility>
 #include <typeinfo>
+#include <algorithm>
+#include <functional>
 
 #include "chemfiles/File.hpp"
+#include "chemfiles/Frame.hpp"
 #include "chemfiles/Format.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
 #include "chemfiles/external/optional.hpp"
 
 namespace chemfiles {
-    class Frame;
     class MemoryBuffer;
 }
 
@@ -54,9 +61,51 @@ void TextFormat::read_next(Frame& /*unused*/) {
     );
 }
 
-void TextFormat::write_next(const Frame& /*unused*/) {
+void TextFormat::write_next(const Frame& frame) {
+    if (write_buffers_.empty()) {
+        write_buffers_.resize(1);
+    }
+
+    auto& buffer = write_buffers_[0];
+    buffer.clear();
+    if (!this->format_next(frame, step_, buffer)) {
+        throw format_error(
+            "'write' is not implemented for this format ({})",
+            typeid(*this).name()
+        );
+    }
+    file_.write(buffer);
+}
+
+bool TextFormat::format_next(const Frame& /*unused*/, size_t /*unused*/, std::string& /*unused*/) const {
+    return false;
+}
+
+void Format::set_access_pattern(AccessPattern /*unused*/, size_t /*unused*/) {}
+
+void Format::set_needed_atoms(optional<size_t> /*unused*/) {}
+
+void Format::read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) {
+    assert(steps.size() == frames.size());
+    for (size_t i = 0; i < steps.size(); i++) {
+        this->read_step(steps[i], frames[i]);
+    }
+}
+
+size_t Format::refresh() {
     throw format_error(
-        "'write' is not implemented for this format ({})",
+        "'refresh' is not implemented for this format ({})",
+        typeid(*this).name()
+    );
+}
+
+bool Format::lazy_steps() const {
+    return false;
+}
+
+size_t Format::bisect_steps() {
+    throw format_error(
+        "locating steps by bisection is not supported by this format ({})",
         typeid(*this).name()
     );
 }
@@ -65,31 +114,71 @@ void TextFormat::write_next(const Frame& /*unused*/) {
 #pragma GCC diagnostic pop
 #endif
 
+void Format::write_view(const FrameView& frame) {
+    auto original = frame.frame();
+    if (original != nullptr) {
+        this->write(*original);
+    } else {
+        this->write(frame.to_frame());
+    }
+}
+
+void Format::write_views(const std::vector<FrameView>& frames) {
+    for (const auto& frame: frames) {
+        this->write_view(frame);
+    }
+}
+
 TextFormat::TextFormat(std::string path, File::Mode mode, File::Compression compression) :
     file_(std::move(path), mode, compression) {}
 
 TextFormat::TextFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) :
     file_(std::move(memory), mode, compression) {}
 
+TextFormat::TextFormat(TextFile file) : file_(std::move(file)) {}
+
+/// Number of steps read one after the other when scanning a file, before
+/// checking if all steps in the file have the same size
+static constexpr size_t FIXED_STRIDE_SCAN = 4;
+/// Number of steps read at computed positions to check that all steps in a
+/// file have the same size
+static constexpr size_t FIXED_STRIDE_CHECKS = 8;
+
 void TextFormat::scan_all() {
     if (eof_found_) {
         return;
     }
 
     optional<TextFile> tmp_read_file = nullopt;
-    if (file_.mode() == File::Mode::APPEND && file_.compression() == File::Compression::GZIP) {
-        tmp_read_file = TextFile(file_.path(), File::Mode::READ, file_.compression());
+    if (file_.mode() == File::Mode::APPEND) {
+        // count both the steps which were in the file before opening it and
+        // the steps written since then, using a separate file since
         // `forward()` needs a readable file
+        file_.flush();
+        steps_positions_.clear();
+        tmp_read_file = TextFile(file_.path(), File::Mode::READ, file_.compression());
         std::swap(*tmp_read_file, file_);
     }
 
     auto before = file_.tellpos();
+    auto check_fixed_stride = file_.mode() == File::READ && steps_positions_.empty();
     while (!file_.eof()) {
         auto position = forward();
         if (!position) {
             break;
         }
         steps_positions_.push_back(position.value());
+        last_step_at_eof_ = file_.eof();
+        if (!last_step_at_eof_) {
+            scan_end_ = file_.tellpos();
+        }
+
+        if (check_fixed_stride && steps_positions_.size() == FIXED_STRIDE_SCAN && !last_step_at_eof_) {
+            check_fixed_stride = false;
+            if (scan_fixed_stride()) {
+                break;
+            }
+        }
     }
 
     eof_found_ = true;
@@ -99,6 +188,7 @@ void TextFormat::scan_all() {
     if (tmp_read_file) {
         // use original file for all further write operations
         std::swap(file_, *tmp_read_file);
+        return;
     }
 
     if (before == 0 && !steps_positions_.empty()) {
@@ -108,6 +198,66 @@ void TextFormat::scan_all() {
     }
 }
 
+bool TextFormat::scan_fixed_stride() {
+    assert(steps_positions_.size() == FIXED_STRIDE_SCAN);
+    auto first = steps_positions_[0];
+    auto stride = steps_positions_[1] - first;
+    if (stride == 0) {
+        return false;
+    }
+    for (size_t i = 1; i < FIXED_STRIDE_SCAN; i++) {
+        if (steps_positions_[i] - steps_positions_[i - 1] != stride) {
+            return false;
+        }
+    }
+    if (scan_end_ - steps_positions_.back() != stride) {
+        return false;
+    }
+
+    auto size = file_.size();
+    if (!size || *size <= scan_end_ || (*size - first) % stride != 0) {
+        return false;
+    }
+    auto count = (*size - first) / stride;
+
+    // check that a step starts at the computed position, and ends right
+    // where the next one starts
+    auto check_step = [&](uint64_t step) {
+        auto position = first + step * stride;
+        file_.seekpos(position);
+        try {
+            auto found = forward();
+            return found && *found == position && file_.tellpos() == position + stride;
+        } catch (const Error&) {
+            return false;
+        }
+    };
+
+    // spread the checks over the whole file, always finishing with the last
+    // step
+    auto remaining = count - FIXED_STRIDE_SCAN;
+    auto last_at_eof = false;
+    for (uint64_t i = 1; i <= FIXED_STRIDE_CHECKS; i++) {
+        auto step = FIXED_STRIDE_SCAN - 1 + (remaining * i + FIXED_STRIDE_CHECKS - 1) / FIXED_STRIDE_CHECKS;
+        if (!check_step(step)) {
+            file_.clear();
+            file_.seekpos(scan_end_);
+            return false;
+        }
+        last_at_eof = file_.eof();
+    }
+
+    steps_positions_.extend(scan_end_, stride, static_cast<size_t>(remaining));
+    last_step_at_eof_ = last_at_eof;
+    if (last_step_at_eof_) {
+        scan_end_ = *size - stride;
+    } else {
+        scan_end_ = *size;
+    }
+
+    return true;
+}
+
 void TextFormat::read_step(size_t step, Frame& frame) {
     // Start by checking if we know this step, if not, look for all steps in
     // the file
@@ -147,7 +297,161 @@ void TextFormat::write(const Frame& frame) {
     ++step_;
 }
 
+void TextFormat::write_views(const std::vector<FrameView>& frames) {
+    // limit the number of frames formatted at once, to keep the memory used
+    // by the buffers under control
+    auto batch_size = 4 * ThreadPool::get().concurrency();
+
+    size_t start = 0;
+    while (start < frames.size()) {
+        auto stop = std::min(start + batch_size, frames.size());
+        if (write_buffers_.size() < stop - start) {
+            write_buffers_.resize(stop - start);
+        }
+
+        // errors are stored for each frame, to be able to write all the
+        // frames before the first one that failed
+        auto errors = std::vector<std::exception_ptr>(stop - start);
+        auto supported = std::atomic<bool>(true);
+        parallel_for(start, stop, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end && supported; i++) {
+                auto& buffer = write_buffers_[i - start];
+                buffer.clear();
+
+                auto step = step_ + i - start;
+                try {
+                    auto original = frames[i].frame();
+                    if (original != nullptr) {
+                        supported = this->format_next(*original, step, buffer);
+                    } else {
+                        supported = this->format_next(frames[i].to_frame(), step, buffer);
+                    }
+                } catch (...) {
+                    errors[i - start] = std::current_exception();
+                    break;
+                }
+            }
+        });
+
+        if (!supported) {
+            // this format needs to write the frames one by one
+            for (size_t i = start; i < frames.size(); i++) {
+                this->write_view(frames[i]);
+            }
+            return;
+        }
+
+        for (size_t i = start; i < stop; i++) {
+            if (errors[i - start]) {
+                std::rethrow_exception(errors[i - start]);
+            }
+            file_.write(write_buffers_[i - start]);
+            steps_positions_.push_back(file_.tellpos());
+            ++step_;
+        }
+
+        start = stop;
+    }
+}
+
+/// Number of items formatted together by `TextFormat::format_parallel`
+static constexpr size_t FORMAT_CHUNK_SIZE = 4096;
+
+void TextFormat::format_parallel(size_t count, std::string& buffer, const std::function<void(size_t, size_t, std::string&)>& format) {
+    if (count <= FORMAT_CHUNK_SIZE || ThreadPool::get().concurrency() == 1) {
+        format(0, count, buffer);
+        return;
+    }
+
+    auto nchunks = (count + FORMAT_CHUNK_SIZE - 1) / FORMAT_CHUNK_SIZE;
+    auto chunks = std::vector<std::string>(nchunks);
+    parallel_for(0, nchunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++) {
+            auto start = chunk * FORMAT_CHUNK_SIZE;
+            auto stop = std::min(start + FORMAT_CHUNK_SIZE, count);
+            format(start, stop, chunks[chunk]);
+        }
+    });
+
+    size_t size = buffer.size();
+    for (const auto& chunk: chunks) {
+        size += chunk.size();
+    }
+    buffer.reserve(size);
+    for (const auto& chunk: chunks) {
+        buffer += chunk;
+    }
+}
+
+bool TextFormat::lazy_steps() const {
+    // in append mode, the steps are only counted if needed, to allow
+    // appending to large (compressed) files without reading them
+    return file_.mode() == File::APPEND;
+}
+
 size_t TextFormat::nsteps() {
     scan_all();
     return steps_positions_.size();
 }
+
+size_t TextFormat::refresh() {
+    scan_all();
+    if (file_.mode() != File::READ) {
+        return steps_positions_.size();
+    }
+
+    auto before = file_.tellpos();
+
+    // the last step might have been incomplete when it was found, look for
+    // it again
+    auto pending = optional<uint64_t>();
+    if (last_step_at_eof_) {
+        pending = steps_positions_.back();
+        steps_positions_.pop_back();
+        last_step_at_eof_ = false;
+    }
+
+    file_.seekpos(scan_end_);
+    file_.refresh();
+
+    while (!file_.eof()) {
+        optional<uint64_t> position;
+        try {
+            position = forward();
+        } catch (const Error&) {
+            // the step is not completely written yet
+            break;
+        }
+
+        if (!position) {
+            break;
+        }
+
+        if (file_.eof()) {
+            // this step ends without a final newline, and might still be
+            // written to. Only count it if it was already counted before.
+            if (pending && *pending == *position) {
+                steps_positions_.push_back(*pending);
+                last_step_at_eof_ = true;
+                pending = nullopt;
+            }
+            break;
+        }
+
+        steps_positions_.push_back(*position);
+        scan_end_ = file_.tellpos();
+        pending = nullopt;
+    }
+
+    if (pending) {
+        // the pending step is no longer visible, keep counting it to stay
+        // consistent with the initial scan
+        steps_positions_.push_back(*pending);
+        last_step_at_eof_ = true;
+    }
+
+    file_.clear();
+    file_.seekpos(before);
+
+    return steps_positions_.size();
+}
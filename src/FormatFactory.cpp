@@ -27,10 +27,12 @@
 #include "chemfiles/formats/LAMMPSData.hpp"
 #include "chemfiles/formats/Tinker.hpp"
 #include "chemfiles/formats/PDB.hpp"
+#include "chemfiles/formats/PSF.hpp"
 #include "chemfiles/formats/XYZ.hpp"
 #include "chemfiles/formats/SDF.hpp"
 #include "chemfiles/formats/TNG.hpp"
 #include "chemfiles/formats/MMTF.hpp"
+#include "chemfiles/formats/BinaryCIF.hpp"
 #include "chemfiles/formats/CSSR.hpp"
 #include "chemfiles/formats/GRO.hpp"
 #include "chemfiles/formats/MOL2.hpp"
@@ -42,6 +44,7 @@
 #include "chemfiles/formats/XTC.hpp"
 #include "chemfiles/formats/CIF.hpp"
 #include "chemfiles/formats/DCD.hpp"
+#include "chemfiles/formats/Snapshot.hpp"
 
 #define SENTINEL_INDEX (static_cast<size_t>(-1))
 
@@ -50,7 +53,6 @@ namespace chemfiles {
     class Format;
 
     extern template class Molfile<TRJ>;
-    extern template class Molfile<PSF>;
     extern template class Molfile<MOLDEN>;
 }
 using namespace chemfiles;
@@ -64,6 +66,8 @@ FormatFactory::FormatFactory() {
     // add formats in alphabetic order
     this->add_format<AmberRestart>();
     this->add_format<AmberTrajectory>();
+    this->add_format<BinaryCIFFormat>();
+    this->add_format<SnapshotFormat>();
 #ifndef CHFL_DISABLE_GEMMI
     this->add_format<CIFFormat>();
 #endif
@@ -78,7 +82,7 @@ FormatFactory::FormatFactory() {
     this->add_format<MOL2Format>();
     this->add_format<Molfile<MOLDEN>>();
     this->add_format<PDBFormat>();
-    this->add_format<Molfile<PSF>>();
+    this->add_format<PSFFormat>();
     this->add_format<SDFFormat>();
     this->add_format<SMIFormat>();
     this->add_format<TinkerFormat>();
@@ -95,7 +99,7 @@ FormatFactory& FormatFactory::get() {
     return instance_;
 }
 
-void FormatFactory::register_format(const FormatMetadata& metadata, format_creator_t creator, memory_stream_t memory_stream) {
+void FormatFactory::register_format(const FormatMetadata& metadata, format_creator_t creator, memory_stream_t memory_stream, text_file_creator_t text_file_creator) {
     auto guard = formats_.lock();
     auto& formats = *guard;
 
@@ -117,14 +121,15 @@ void FormatFactory::register_format(const FormatMetadata& metadata, format_creat
     }
 
     // actually register the format
-    formats.push_back({metadata, creator, memory_stream});
+    formats.push_back({metadata, creator, memory_stream, text_file_creator});
 }
 
-void FormatFactory::register_format(const FormatMetadata& metadata, format_creator_t creator) {
+void FormatFactory::register_format(const FormatMetadata& metadata, format_creator_t creator, text_file_creator_t text_file_creator) {
     register_format(metadata, creator,
         [&metadata](std::shared_ptr<MemoryBuffer>, File::Mode, File::Compression) -> std::unique_ptr<Format> {
             throw format_error("in-memory IO is not supported for the '{}' format", metadata.name);
-        }
+        },
+        std::move(text_file_creator)
     );
 }
 
@@ -7,12 +7,16 @@
 #include <string>
 #include <vector>
 #include <iterator>
+#include <mutex>
+#include <utility>
 #include <algorithm>
 #include <unordered_map>
 
 #include "chemfiles/types.hpp"
 #include "chemfiles/error_fmt.hpp"
 #include "chemfiles/periodic_table.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/snapshot.hpp"
 #include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/Atom.hpp"
@@ -63,32 +67,44 @@ void Frame::guess_bonds() {
     topology_.clear_bonds();
     // This bond guessing algorithm comes from VMD
     auto cutoff = 0.833;
+    auto radii = std::vector<double>(size(), 0.0);
     for (size_t i = 0; i < size(); i++) {
-        auto rad = guess_bonds_radius(topology_[i]).value_or(0);
-        cutoff = std::max(cutoff, rad);
-    }
-    cutoff = 1.2 * cutoff;
-
-    for (size_t i = 0; i < size(); i++) {
-        auto i_radius = guess_bonds_radius(topology_[i]);
-        if (!i_radius) {
+        auto radius = guess_bonds_radius(topology_[i]);
+        if (!radius) {
             throw error(
                 "missing Van der Waals radius for '{}'", topology_[i].type()
             );
         }
-        for (size_t j = i + 1; j < size(); j++) {
-            auto j_radius = guess_bonds_radius(topology_[j]);
-            if (!j_radius) {
-                throw error(
-                    "missing Van der Waals radius for '{}'", topology_[j].type()
-                );
-            }
-            auto d = distance(i, j);
-            auto radii = i_radius.value() + j_radius.value();
-            if (0.03 < d && d < 0.6 * radii && d < cutoff) {
-                topology_.add_bond(i, j);
+        radii[i] = radius.value();
+        cutoff = std::max(cutoff, radii[i]);
+    }
+    cutoff = 1.2 * cutoff;
+
+    // Each chunk of atoms stores the bonds it found separately, and they are
+    // added to the topology once all the distances have been computed
+    auto chunks = std::vector<std::vector<std::pair<size_t, size_t>>>();
+    auto chunks_mutex = std::mutex();
+    // later atoms have less pairs to check, so use small chunks to balance the
+    // work between threads
+    parallel_for(0, size(), 64, [&](size_t start, size_t stop) {
+        auto bonds = std::vector<std::pair<size_t, size_t>>();
+        for (size_t i = start; i < stop; i++) {
+            for (size_t j = i + 1; j < size(); j++) {
+                auto d = distance(i, j);
+                if (0.03 < d && d < 0.6 * (radii[i] + radii[j]) && d < cutoff) {
+                    bonds.emplace_back(i, j);
+                }
             }
         }
+
+        auto guard = std::lock_guard<std::mutex>(chunks_mutex);
+        chunks.emplace_back(std::move(bonds));
+    });
+
+    for (const auto& bonds: chunks) {
+        for (auto bond: bonds) {
+            topology_.add_bond(bond.first, bond.second);
+        }
     }
 
     auto bonds = topology().bonds();
@@ -245,3 +261,13 @@ optional<double> guess_bonds_radius(const Atom& atom) {
         return atom.vdw_radius();
     }
 }
+
+std::vector<char> Frame::serialize() const {
+    auto output = std::vector<char>();
+    write_snapshot(*this, output);
+    return output;
+}
+
+Frame Frame::deserialize(const char* data, size_t size) {
+    return read_frame_snapshot(data, size);
+}
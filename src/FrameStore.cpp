@@ -0,0 +1,224 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "chemfiles/FrameStore.hpp"
+
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Property.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/bit_packing.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/topology_cache.hpp"
+#include "chemfiles/external/span.hpp"
+#include "chemfiles/external/optional.hpp"
+
+using namespace chemfiles;
+
+/// Number of values in a compressed block
+static constexpr size_t BLOCK_SIZE = bit_packing::BLOCK_SIZE;
+
+/// Largest quantized value, keeping differences between values in `int64_t`
+static constexpr double MAX_QUANTIZED = 4611686018427387904.0; // 2^62
+
+/// Map signed values to unsigned values, with small magnitudes giving small
+/// unsigned values
+static uint64_t zigzag_encode(uint64_t value) {
+    return (value << 1) ^ (0 - (value >> 63));
+}
+
+static uint64_t zigzag_decode(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+/// Convert `value` to an integer with the given `precision`. If `precision`
+/// is zero, use the bits of `value` instead, re-ordered to keep close values
+/// close in the integer representation.
+static uint64_t quantize(double value, double precision) {
+    if (precision == 0) {
+        int64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(double));
+        if (bits < 0) {
+            bits ^= INT64_MAX;
+        }
+        return static_cast<uint64_t>(bits);
+    }
+
+    auto scaled = value / precision;
+    if (!(std::abs(scaled) < MAX_QUANTIZED)) {
+        throw error(
+            "can not store the value {} in a FrameStore with a precision of {}",
+            value, precision
+        );
+    }
+    return static_cast<uint64_t>(std::llround(scaled));
+}
+
+static double dequantize(uint64_t value, double precision) {
+    auto integer = static_cast<int64_t>(value);
+    if (precision == 0) {
+        if (integer < 0) {
+            integer ^= INT64_MAX;
+        }
+        double result = 0;
+        std::memcpy(&result, &integer, sizeof(double));
+        return result;
+    }
+    return static_cast<double>(integer) * precision;
+}
+
+FrameStore::FrameStore(double precision): precision_(precision) {
+    if (!(precision >= 0) || std::isinf(precision)) {
+        throw error("invalid precision for FrameStore: expected a positive value, got {}", precision);
+    }
+}
+
+FrameStore::CompressedVectors FrameStore::compress(span<const Vector3D> vectors) const {
+    auto count = 3 * vectors.size();
+    auto nblocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    // difference between each coordinate and the same coordinate of the
+    // previous atom, which is small for atoms close in space
+    auto deltas = std::vector<uint64_t>(nblocks * BLOCK_SIZE, 0);
+    uint64_t previous[3] = {0, 0, 0};
+    for (size_t i = 0; i < vectors.size(); i++) {
+        for (size_t j = 0; j < 3; j++) {
+            auto value = quantize(vectors[i][j], precision_);
+            deltas[3 * i + j] = zigzag_encode(value - previous[j]);
+            previous[j] = value;
+        }
+    }
+
+    auto compressed = CompressedVectors();
+    compressed.widths.reserve(nblocks);
+    for (size_t block = 0; block < nblocks; block++) {
+        auto values = deltas.data() + block * BLOCK_SIZE;
+
+        auto width = bit_packing::width(values);
+        compressed.widths.push_back(static_cast<uint8_t>(width));
+        bit_packing::pack(compressed.data, values, width);
+    }
+    compressed.data.shrink_to_fit();
+
+    return compressed;
+}
+
+void FrameStore::decompress(const CompressedVectors& compressed, span<Vector3D> vectors) const {
+    auto count = 3 * vectors.size();
+
+    uint64_t previous[3] = {0, 0, 0};
+    size_t index = 0;
+    size_t start = 0;
+    uint64_t values[BLOCK_SIZE];
+    for (auto width: compressed.widths) {
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            values[i] = bit_packing::unpack(compressed.data.data() + start, width, i);
+        }
+        start += width;
+
+        for (size_t i = 0; i < BLOCK_SIZE && index < count; i++, index++) {
+            auto axis = index % 3;
+            previous[axis] += zigzag_decode(values[i]);
+            vectors[index / 3][axis] = dequantize(previous[axis], precision_);
+        }
+    }
+}
+
+static size_t compressed_memory(const std::vector<uint8_t>& widths, const std::vector<uint64_t>& data) {
+    return widths.capacity() + data.capacity() * sizeof(uint64_t);
+}
+
+void FrameStore::add(const Frame& frame) {
+    auto entry = Entry{
+        frame.step(),
+        frame.size(),
+        frame.cell(),
+        frame.properties(),
+        nullptr,
+        compress(frame.positions()),
+        nullopt,
+    };
+
+    auto velocities = frame.velocities();
+    if (velocities) {
+        entry.velocities = compress(*velocities);
+    }
+
+    auto memory = sizeof(Entry);
+    memory += compressed_memory(entry.positions.widths, entry.positions.data);
+    if (entry.velocities) {
+        memory += compressed_memory(entry.velocities->widths, entry.velocities->data);
+    }
+    memory += properties_memory(entry.properties);
+
+    if (!frames_.empty() && same_topology(*frames_.back().topology, frame.topology())) {
+        entry.topology = frames_.back().topology;
+    } else {
+        entry.topology = std::make_shared<const Topology>(frame.topology());
+        memory += topology_memory(*entry.topology);
+    }
+
+    frames_.emplace_back(std::move(entry));
+    memory_ += memory;
+}
+
+void FrameStore::check_index(size_t index) const {
+    if (index >= frames_.size()) {
+        throw out_of_bounds(
+            "out of bounds index in FrameStore: we have {} frames, but the index is {}",
+            frames_.size(), index
+        );
+    }
+}
+
+Frame FrameStore::get(size_t index) const {
+    check_index(index);
+    const auto& entry = frames_[index];
+
+    auto frame = Frame(entry.cell);
+    frame.resize(entry.natoms);
+    frame.set_topology(*entry.topology);
+    frame.set_step(entry.step);
+
+    decompress(entry.positions, frame.positions());
+    if (entry.velocities) {
+        frame.add_velocities();
+        decompress(*entry.velocities, *frame.velocities());
+    }
+
+    for (const auto& property: entry.properties) {
+        frame.set(property.first, property.second);
+    }
+
+    return frame;
+}
+
+void FrameStore::positions(size_t index, span<Vector3D> positions) const {
+    check_index(index);
+    const auto& entry = frames_[index];
+    if (positions.size() != entry.natoms) {
+        throw error(
+            "the frame at index {} in FrameStore contains {} atoms, but the positions array has space for {} atoms",
+            index, entry.natoms, positions.size()
+        );
+    }
+    decompress(entry.positions, positions);
+}
+
+const Topology& FrameStore::topology(size_t index) const {
+    check_index(index);
+    return *frames_[index].topology;
+}
+
+void FrameStore::clear() {
+    frames_.clear();
+    memory_ = 0;
+}
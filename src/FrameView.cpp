@@ -0,0 +1,129 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <string>
+#include <vector>
+
+#include "chemfiles/FrameView.hpp"
+
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Property.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/external/span.hpp"
+#include "chemfiles/external/optional.hpp"
+
+using namespace chemfiles;
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(double), "Vector3D must be made of 3 contiguous doubles");
+
+VectorsView::VectorsView(span<const Vector3D> vectors): size_(vectors.size()) {
+    if (!vectors.empty()) {
+        doubles_ = &vectors[0][0];
+    }
+}
+
+VectorsView::VectorsView(const double* data, size_t size, size_t stride):
+    doubles_(data), size_(size), stride_(stride)
+{
+    if (stride < 3) {
+        throw error("the stride of a VectorsView must be at least 3, got {}", stride);
+    }
+}
+
+VectorsView::VectorsView(const float* data, size_t size, size_t stride):
+    floats_(data), size_(size), stride_(stride)
+{
+    if (stride < 3) {
+        throw error("the stride of a VectorsView must be at least 3, got {}", stride);
+    }
+}
+
+FrameView::FrameView(const Frame& frame):
+    frame_(&frame),
+    topology_(&frame.topology()),
+    cell_(&frame.cell()),
+    positions_(frame.positions()),
+    step_(frame.step()),
+    properties_(&frame.properties())
+{
+    auto velocities = frame.velocities();
+    if (velocities) {
+        velocities_ = VectorsView(*velocities);
+    }
+}
+
+FrameView::FrameView(const Topology& topology, VectorsView positions, const UnitCell& cell):
+    topology_(&topology), cell_(&cell), positions_(positions)
+{
+    if (topology.size() != positions.size()) {
+        throw error(
+            "the topology contains {} atoms, but the positions contain {} atoms",
+            topology.size(), positions.size()
+        );
+    }
+}
+
+void FrameView::set_velocities(VectorsView velocities) {
+    if (velocities.size() != size()) {
+        throw error(
+            "the velocities contain {} atoms, but the frame view contains {} atoms",
+            velocities.size(), size()
+        );
+    }
+    velocities_ = velocities;
+    frame_ = nullptr;
+}
+
+void FrameView::set_topology(const Topology& topology) {
+    if (topology.size() != size()) {
+        throw error(
+            "the topology contains {} atoms, but the frame view contains {} atoms",
+            topology.size(), size()
+        );
+    }
+    topology_ = &topology;
+    frame_ = nullptr;
+}
+
+const Atom& FrameView::operator[](size_t i) const {
+    return (*topology_)[i];
+}
+
+const property_map& FrameView::properties() const {
+    static const property_map EMPTY_PROPERTIES;
+    if (properties_ == nullptr) {
+        return EMPTY_PROPERTIES;
+    }
+    return *properties_;
+}
+
+Frame FrameView::to_frame() const {
+    auto frame = Frame(*cell_);
+    frame.resize(size());
+    frame.set_topology(*topology_);
+    frame.set_step(step_);
+
+    auto positions = frame.positions();
+    for (size_t i = 0; i < size(); i++) {
+        positions[i] = positions_[i];
+    }
+
+    if (velocities_) {
+        frame.add_velocities();
+        auto velocities = *frame.velocities();
+        for (size_t i = 0; i < size(); i++) {
+            velocities[i] = (*velocities_)[i];
+        }
+    }
+
+    for (auto& it: properties()) {
+        frame.set(it.first, it.second);
+    }
+
+    return frame;
+}
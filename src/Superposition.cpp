@@ -0,0 +1,250 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <vector>
+
+#include "chemfiles/Superposition.hpp"
+
+#include "chemfiles/Frame.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/external/span.hpp"
+
+using namespace chemfiles;
+
+/// Relative precision of the largest eigenvalue in Newton's method
+static constexpr double EIGENVALUE_PRECISION = 1e-11;
+/// Threshold under which the computed eigenvector is considered degenerate
+static constexpr double EIGENVECTOR_PRECISION = 1e-6;
+/// Maximal number of iterations of Newton's method
+static constexpr size_t MAX_ITERATIONS = 50;
+
+/// Call `function(i)` for all the values in `indexes`, or for all values in
+/// `[0, size)` if `indexes` is empty.
+template <class Function>
+static void for_each_atom(size_t size, const std::vector<size_t>& indexes, const Function& function) {
+    if (indexes.empty()) {
+        for (size_t i = 0; i < size; i++) {
+            function(i);
+        }
+    } else {
+        for (auto i: indexes) {
+            function(i);
+        }
+    }
+}
+
+Superposition::Superposition(span<const Vector3D> reference, span<const Vector3D> mobile, const std::vector<size_t>& indexes) {
+    if (reference.size() != mobile.size()) {
+        throw error(
+            "can not superpose positions with different sizes: the reference contains {} atoms, but the mobile positions contain {} atoms",
+            reference.size(), mobile.size()
+        );
+    }
+
+    for (auto i: indexes) {
+        if (i >= reference.size()) {
+            throw out_of_bounds(
+                "out of bounds atomic index in superposition: we have {} atoms, but the index is {}",
+                reference.size(), i
+            );
+        }
+    }
+
+    if (reference.empty()) {
+        throw error("can not superpose an empty set of atoms");
+    }
+
+    this->compute(reference, mobile, indexes);
+}
+
+Superposition::Superposition(const Frame& reference, const Frame& frame, const std::vector<size_t>& indexes):
+    Superposition(reference.positions(), frame.positions(), indexes) {}
+
+void Superposition::compute(span<const Vector3D> reference, span<const Vector3D> mobile, const std::vector<size_t>& indexes) {
+    // single pass over the atoms to compute the centers, the inner product
+    // matrix and the squared norms of the positions
+    auto reference_sum = Vector3D();
+    auto mobile_sum = Vector3D();
+    double inner[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    double reference_norm = 0;
+    double mobile_norm = 0;
+    for_each_atom(reference.size(), indexes, [&](size_t i) {
+        const auto& x = reference[i];
+        const auto& y = mobile[i];
+        reference_sum += x;
+        mobile_sum += y;
+        reference_norm += x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+        mobile_norm += y[0] * y[0] + y[1] * y[1] + y[2] * y[2];
+        for (size_t a = 0; a < 3; a++) {
+            for (size_t b = 0; b < 3; b++) {
+                inner[a][b] += x[a] * y[b];
+            }
+        }
+    });
+
+    auto count = static_cast<double>(indexes.empty() ? reference.size() : indexes.size());
+    reference_center_ = reference_sum / count;
+    mobile_center_ = mobile_sum / count;
+
+    // remove the contribution of the centers
+    for (size_t a = 0; a < 3; a++) {
+        for (size_t b = 0; b < 3; b++) {
+            inner[a][b] -= count * reference_center_[a] * mobile_center_[b];
+        }
+    }
+    reference_norm -= count * dot(reference_center_, reference_center_);
+    mobile_norm -= count * dot(mobile_center_, mobile_center_);
+    auto e0 = (reference_norm + mobile_norm) / 2;
+
+    // coefficients of the characteristic polynomial of the key matrix, see
+    // Theobald (2005) https://doi.org/10.1107/S0108767305015266 and Liu et
+    // al. (2010) https://doi.org/10.1002/jcc.21439
+    auto sxx = inner[0][0], sxy = inner[0][1], sxz = inner[0][2];
+    auto syx = inner[1][0], syy = inner[1][1], syz = inner[1][2];
+    auto szx = inner[2][0], szy = inner[2][1], szz = inner[2][2];
+
+    auto sxx2 = sxx * sxx, syy2 = syy * syy, szz2 = szz * szz;
+    auto sxy2 = sxy * sxy, syz2 = syz * syz, sxz2 = sxz * sxz;
+    auto syx2 = syx * syx, szy2 = szy * szy, szx2 = szx * szx;
+
+    auto syzszymsyyszz2 = 2.0 * (syz * szy - syy * szz);
+    auto sxx2syy2szz2syz2szy2 = syy2 + szz2 - sxx2 + syz2 + szy2;
+
+    auto c2 = -2.0 * (sxx2 + syy2 + szz2 + sxy2 + syx2 + sxz2 + szx2 + syz2 + szy2);
+    auto c1 = 8.0 * (sxx * syz * szy + syy * szx * sxz + szz * sxy * syx - sxx * syy * szz - syz * szx * sxy - szy * syx * sxz);
+
+    auto sxzpszx = sxz + szx, syzpszy = syz + szy, sxypsyx = sxy + syx;
+    auto syzmszy = syz - szy, sxzmszx = sxz - szx, sxymsyx = sxy - syx;
+    auto sxxpsyy = sxx + syy, sxxmsyy = sxx - syy;
+    auto sxy2sxz2syx2szx2 = sxy2 + sxz2 - syx2 - szx2;
+
+    auto c0 = sxy2sxz2syx2szx2 * sxy2sxz2syx2szx2
+        + (sxx2syy2szz2syz2szy2 + syzszymsyyszz2) * (sxx2syy2szz2syz2szy2 - syzszymsyyszz2)
+        + (-sxzpszx * syzmszy + sxymsyx * (sxxmsyy - szz)) * (-sxzmszx * syzpszy + sxymsyx * (sxxmsyy + szz))
+        + (-sxzpszx * syzpszy - sxypsyx * (sxxpsyy - szz)) * (-sxzmszx * syzmszy - sxypsyx * (sxxpsyy + szz))
+        + (sxypsyx * syzpszy + sxzpszx * (sxxmsyy + szz)) * (-sxymsyx * syzmszy + sxzpszx * (sxxpsyy + szz))
+        + (sxypsyx * syzmszy + sxzmszx * (sxxmsyy - szz)) * (-sxymsyx * syzpszy + sxzmszx * (sxxpsyy - szz));
+
+    // Newton's method for the largest eigenvalue, starting from the upper
+    // bound e0
+    auto eigenvalue = e0;
+    for (size_t i = 0; i < MAX_ITERATIONS; i++) {
+        auto previous = eigenvalue;
+        auto x2 = eigenvalue * eigenvalue;
+        auto b = (x2 + c2) * eigenvalue;
+        auto a = b + c1;
+        auto delta = (a * eigenvalue + c0) / (2.0 * x2 * eigenvalue + b + a);
+        eigenvalue -= delta;
+        if (std::fabs(eigenvalue - previous) < std::fabs(EIGENVALUE_PRECISION * eigenvalue)) {
+            break;
+        }
+    }
+
+    rmsd_ = std::sqrt(std::fabs(2.0 * (e0 - eigenvalue) / count));
+
+    // eigenvector of the key matrix for this eigenvalue, computed from the
+    // adjoint matrix
+    auto a11 = sxxpsyy + szz - eigenvalue, a12 = syzmszy, a13 = -sxzmszx, a14 = sxymsyx;
+    auto a21 = syzmszy, a22 = sxxmsyy - szz - eigenvalue, a23 = sxypsyx, a24 = sxzpszx;
+    auto a31 = a13, a32 = a23, a33 = syy - sxx - szz - eigenvalue, a34 = syzpszy;
+    auto a41 = a14, a42 = a24, a43 = a34, a44 = szz - sxxpsyy - eigenvalue;
+    auto a3344_4334 = a33 * a44 - a43 * a34, a3244_4234 = a32 * a44 - a42 * a34;
+    auto a3243_4233 = a32 * a43 - a42 * a33, a3143_4133 = a31 * a43 - a41 * a33;
+    auto a3144_4134 = a31 * a44 - a41 * a34, a3142_4132 = a31 * a42 - a41 * a32;
+
+    auto q1 = a22 * a3344_4334 - a23 * a3244_4234 + a24 * a3243_4233;
+    auto q2 = -a21 * a3344_4334 + a23 * a3144_4134 - a24 * a3143_4133;
+    auto q3 = a21 * a3244_4234 - a22 * a3144_4134 + a24 * a3142_4132;
+    auto q4 = -a21 * a3243_4233 + a22 * a3143_4133 - a23 * a3142_4132;
+    auto qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+    // if the eigenvector is degenerate, try the other columns of the adjoint
+    if (qsqr < EIGENVECTOR_PRECISION) {
+        q1 = a12 * a3344_4334 - a13 * a3244_4234 + a14 * a3243_4233;
+        q2 = -a11 * a3344_4334 + a13 * a3144_4134 - a14 * a3143_4133;
+        q3 = a11 * a3244_4234 - a12 * a3144_4134 + a14 * a3142_4132;
+        q4 = -a11 * a3243_4233 + a12 * a3143_4133 - a13 * a3142_4132;
+        qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+        if (qsqr < EIGENVECTOR_PRECISION) {
+            auto a1324_1423 = a13 * a24 - a14 * a23, a1224_1422 = a12 * a24 - a14 * a22;
+            auto a1223_1322 = a12 * a23 - a13 * a22, a1124_1421 = a11 * a24 - a14 * a21;
+            auto a1123_1321 = a11 * a23 - a13 * a21, a1122_1221 = a11 * a22 - a12 * a21;
+
+            q1 = a42 * a1324_1423 - a43 * a1224_1422 + a44 * a1223_1322;
+            q2 = -a41 * a1324_1423 + a43 * a1124_1421 - a44 * a1123_1321;
+            q3 = a41 * a1224_1422 - a42 * a1124_1421 + a44 * a1122_1221;
+            q4 = -a41 * a1223_1322 + a42 * a1123_1321 - a43 * a1122_1221;
+            qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+            if (qsqr < EIGENVECTOR_PRECISION) {
+                q1 = a32 * a1324_1423 - a33 * a1224_1422 + a34 * a1223_1322;
+                q2 = -a31 * a1324_1423 + a33 * a1124_1421 - a34 * a1123_1321;
+                q3 = a31 * a1224_1422 - a32 * a1124_1421 + a34 * a1122_1221;
+                q4 = -a31 * a1223_1322 + a32 * a1123_1321 - a33 * a1122_1221;
+                qsqr = q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4;
+
+                if (qsqr < EIGENVECTOR_PRECISION) {
+                    // the positions are already superposed
+                    rotation_ = Matrix3D::unit();
+                    return;
+                }
+            }
+        }
+    }
+
+    auto norm = std::sqrt(qsqr);
+    q1 /= norm;
+    q2 /= norm;
+    q3 /= norm;
+    q4 /= norm;
+
+    auto a2 = q1 * q1, x2 = q2 * q2, y2 = q3 * q3, z2 = q4 * q4;
+    auto xy = q2 * q3, az = q1 * q4, zx = q4 * q2;
+    auto ay = q1 * q3, yz = q3 * q4, ax = q1 * q2;
+
+    rotation_ = Matrix3D(
+        a2 + x2 - y2 - z2, 2 * (xy + az), 2 * (zx - ay),
+        2 * (xy - az), a2 - x2 + y2 - z2, 2 * (yz + ax),
+        2 * (zx + ay), 2 * (yz - ax), a2 - x2 - y2 + z2
+    );
+}
+
+void Superposition::apply(Frame& frame) const {
+    for (auto& position: frame.positions()) {
+        position = this->apply(position);
+    }
+
+    auto velocities = frame.velocities();
+    if (velocities) {
+        for (auto& velocity: *velocities) {
+            velocity = rotation_ * velocity;
+        }
+    }
+}
+
+std::vector<Superposition> chemfiles::superpose(const Frame& reference, const std::vector<Frame>& frames, const std::vector<size_t>& indexes) {
+    auto superpositions = std::vector<Superposition>(frames.size());
+    parallel_for(0, frames.size(), 1, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            superpositions[i] = Superposition(reference, frames[i], indexes);
+        }
+    });
+    return superpositions;
+}
+
+std::vector<double> chemfiles::align(const Frame& reference, std::vector<Frame>& frames, const std::vector<size_t>& indexes) {
+    auto rmsds = std::vector<double>(frames.size());
+    parallel_for(0, frames.size(), 1, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto superposition = Superposition(reference, frames[i], indexes);
+            superposition.apply(frames[i]);
+            rmsds[i] = superposition.rmsd();
+        }
+    });
+    return rmsds;
+}
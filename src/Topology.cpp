@@ -11,6 +11,7 @@
 #include "chemfiles/Residue.hpp"
 #include "chemfiles/Topology.hpp"
 #include "chemfiles/sorted_set.hpp"
+#include "chemfiles/snapshot.hpp"
 #include "chemfiles/external/optional.hpp"
 
 using namespace chemfiles;
@@ -162,3 +163,13 @@ optional<const Residue&> Topology::residue_for_atom(size_t index) const {
         return residues_[it->second];
     }
 }
+
+std::vector<char> Topology::serialize() const {
+    auto output = std::vector<char>();
+    write_snapshot(*this, output);
+    return output;
+}
+
+Topology Topology::deserialize(const char* data, size_t size) {
+    return read_topology_snapshot(data, size);
+}
@@ -1,10 +1,12 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
-#include <cassert>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include "chemfiles/Trajectory.hpp"
 
@@ -12,14 +14,20 @@
 #include "chemfiles/File.hpp"
 #include "chemfiles/Format.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/UnitCell.hpp"
 #include "chemfiles/Topology.hpp"
 #include "chemfiles/FormatFactory.hpp"
 #include "chemfiles/FormatMetadata.hpp"
+#include "chemfiles/files/Archive.hpp"
 #include "chemfiles/files/MemoryBuffer.hpp"
 
 #include "chemfiles/misc.hpp"
 #include "chemfiles/utils.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/frame_cache.hpp"
+#include "chemfiles/sniff_format.hpp"
+#include "chemfiles/topology_cache.hpp"
 #include "chemfiles/error_fmt.hpp"
 #include "chemfiles/external/span.hpp"
 #include "chemfiles/external/optional.hpp"
@@ -81,14 +89,48 @@ static File::Mode char_to_file_mode(char mode) {
 Trajectory::Trajectory(std::string path, char mode, const std::string& format)
     : path_(std::move(path)), mode_(mode), format_(nullptr) {
 
-    auto info = file_open_info::parse(path_, format);
-    auto format_creator = FormatFactory::get().by_name(info.format).creator;
+    auto file_mode = char_to_file_mode(mode);
+    auto archive_member = Archive::split_path(path_);
+    if (archive_member) {
+        if (file_mode != File::READ) {
+            throw file_error(
+                "can not open '{}' with mode '{}': files inside archives can only be read",
+                path_, mode
+            );
+        }
 
-    format_ = format_creator(path_, char_to_file_mode(mode), info.compression);
+        const auto& member = archive_member->second;
+        auto buffer = Archive::open(archive_member->first)->read(member);
 
-    if (mode == 'r' || mode == 'a') {
-        nsteps_ = format_->nsteps();
+        auto info = file_open_info();
+        if (format.empty()) {
+            auto sniffed = sniff_format(member, std::string_view(buffer->data(), buffer->size()));
+            info.format = std::move(sniffed.format);
+            info.compression = sniffed.compression;
+        } else {
+            info = file_open_info::parse(member, format);
+        }
+
+        auto memory_creator = FormatFactory::get().by_name(info.format).memory_stream_creator;
+        // if in-memory I/O is not supported, this call will throw
+        format_ = memory_creator(buffer, File::READ, info.compression);
+        buffer_ = std::move(buffer);
+    } else if (format.empty()) {
+        auto sniffed = sniff_format(path_, file_mode);
+        const auto& registered = FormatFactory::get().by_name(sniffed.format);
+        if (sniffed.file) {
+            // re-use the file opened to guess the format
+            format_ = registered.text_file_creator(std::move(*sniffed.file));
+        } else {
+            format_ = registered.creator(path_, file_mode, sniffed.compression);
+        }
+    } else {
+        auto info = file_open_info::parse(path_, format);
+        auto format_creator = FormatFactory::get().by_name(info.format).creator;
+        format_ = format_creator(path_, file_mode, info.compression);
     }
+
+    init_nsteps();
 }
 
 Trajectory Trajectory::memory_reader(const char* data, size_t size, const std::string& format) {
@@ -123,18 +165,32 @@ Trajectory Trajectory::memory_writer(const std::string& format) {
 
 Trajectory::Trajectory(char mode, std::unique_ptr<Format> format, std::shared_ptr<MemoryBuffer> buffer)
     : mode_(mode), format_(std::move(format)), buffer_(std::move(buffer)) {
-    if (mode == 'r' || mode == 'a') {
-        nsteps_ = format_->nsteps();
-    }
+    init_nsteps();
 }
 
 Trajectory::~Trajectory() = default;
 Trajectory::Trajectory(Trajectory&&) = default;
 Trajectory& Trajectory::operator=(Trajectory&&) = default;
 
+void Trajectory::init_nsteps() {
+    if (mode_ != File::READ && mode_ != File::APPEND) {
+        nsteps_ = 0;
+    } else if (!format_->lazy_steps()) {
+        nsteps_ = format_->nsteps();
+    }
+}
+
+size_t Trajectory::current_nsteps() const {
+    if (!nsteps_) {
+        nsteps_ = format_->nsteps();
+    }
+    return *nsteps_;
+}
+
 void Trajectory::pre_read(size_t step) {
-    if (step >= nsteps_) {
-        if (nsteps_ == 0) {
+    auto nsteps = current_nsteps();
+    if (step >= nsteps) {
+        if (nsteps == 0) {
             throw file_error(
                 "can not read file '{}' at step {}, it does not contain any step",
                 path_, step
@@ -142,7 +198,7 @@ void Trajectory::pre_read(size_t step) {
         } else {
             throw file_error(
                 "can not read file '{}' at step {}: maximal step is {}",
-                path_, step, nsteps_ - 1
+                path_, step, nsteps - 1
             );
         }
     }
@@ -154,6 +210,12 @@ void Trajectory::pre_read(size_t step) {
 }
 
 void Trajectory::post_read(Frame& frame) {
+    if (nsteps_estimated_ && !format_->lazy_steps()) {
+        // the format found all the steps instead of using bisection
+        nsteps_ = format_->nsteps();
+        nsteps_estimated_ = false;
+    }
+
     if (custom_topology_) {
         frame.set_topology(*custom_topology_);
     }
@@ -161,6 +223,20 @@ void Trajectory::post_read(Frame& frame) {
     if (custom_cell_) {
         frame.set_cell(*custom_cell_);
     }
+
+    transformations_.apply(frame);
+}
+
+void Trajectory::update_needed_atoms() {
+    if (mode_ != File::READ) {
+        return;
+    }
+
+    if (custom_topology_) {
+        format_->set_needed_atoms(nullopt);
+    } else {
+        format_->set_needed_atoms(transformations_.needed_atoms());
+    }
 }
 
 void Trajectory::check_opened() const {
@@ -171,13 +247,75 @@ void Trajectory::check_opened() const {
 
 size_t Trajectory::nsteps() const  {
     check_opened();
-    return nsteps_;
+    return current_nsteps();
+}
+
+size_t Trajectory::refresh() {
+    check_opened();
+    if (mode_ != File::READ) {
+        throw file_error(
+            "can not refresh the trajectory at '{}', it was not opened in read mode",
+            path_
+        );
+    }
+    nsteps_ = format_->refresh();
+    return *nsteps_;
+}
+
+void Trajectory::set_access_pattern(AccessPattern pattern, size_t readahead) {
+    check_opened();
+    if (mode_ != File::READ) {
+        throw file_error(
+            "the file at '{}' was not opened in read mode", path_
+        );
+    }
+    format_->set_access_pattern(pattern, readahead);
+}
+
+void Trajectory::set_frame_cache(size_t limit, size_t prefetch) {
+    check_opened();
+    if (mode_ != File::READ) {
+        throw file_error(
+            "the file at '{}' was not opened in read mode", path_
+        );
+    }
+
+    if (limit == 0) {
+        frame_cache_.reset();
+        prefetch_ = 0;
+        return;
+    }
+
+    if (frame_cache_) {
+        frame_cache_->set_limit(limit);
+    } else {
+        frame_cache_ = std::make_unique<FrameCache>(limit);
+    }
+    prefetch_ = prefetch;
+}
+
+void Trajectory::locate_steps_by_bisection() {
+    check_opened();
+    if (mode_ != File::READ) {
+        throw file_error(
+            "the file at '{}' was not opened in read mode", path_
+        );
+    }
+
+    nsteps_ = format_->bisect_steps();
+    nsteps_estimated_ = format_->lazy_steps();
 }
 
 Frame Trajectory::read() {
     check_opened();
     pre_read(step_);
 
+    if (frame_cache_) {
+        auto frame = read_cached(step_);
+        step_++;
+        return frame;
+    }
+
     Frame frame;
     frame.set_step(SENTINEL_VALUE);
     format_->read(frame);
@@ -196,21 +334,128 @@ Frame Trajectory::read_step(const size_t step) {
     check_opened();
     pre_read(step);
 
+    step_ = step;
+    if (frame_cache_) {
+        return read_cached(step);
+    }
+    return read_from_format(step);
+}
+
+Frame Trajectory::read_from_format(size_t step) {
     Frame frame;
     frame.set_step(SENTINEL_VALUE);
-    step_ = step;
-    format_->read_step(step_, frame);
+    format_->read_step(step, frame);
 
     // Don't override the step set by a format
     if (frame.step() == SENTINEL_VALUE) {
-        frame.set_step(step_);
+        frame.set_step(step);
     }
 
     post_read(frame);
     return frame;
 }
 
+Frame Trajectory::read_cached(size_t step) {
+    Frame frame;
+    if (!frame_cache_->get(step, frame)) {
+        frame = read_from_format(step);
+        frame_cache_->insert(step, frame);
+    }
+
+    if (prefetch_ == 0) {
+        return frame;
+    }
+
+    // prefetch the missing steps around `step`, the farthest ones first so
+    // that the closest ones are the most recently used in the cache
+    auto missing = std::vector<size_t>();
+    for (size_t distance = prefetch_; distance > 0; distance--) {
+        if (distance <= step && !frame_cache_->contains(step - distance)) {
+            missing.push_back(step - distance);
+        }
+        if (step + distance < current_nsteps() && !frame_cache_->contains(step + distance)) {
+            missing.push_back(step + distance);
+        }
+    }
+
+    if (!missing.empty()) {
+        auto frames = std::vector<Frame>(missing.size());
+        for (auto& prefetched: frames) {
+            prefetched.set_step(SENTINEL_VALUE);
+        }
+        format_->read_steps(missing, frames);
+
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (frames[i].step() == SENTINEL_VALUE) {
+                frames[i].set_step(missing[i]);
+            }
+            post_read(frames[i]);
+            frame_cache_->insert(missing[i], frames[i]);
+        }
+
+        // keep the frame which was actually read as the most recently used
+        frame_cache_->touch(step);
+    }
+
+    return frame;
+}
+
+std::vector<Frame> Trajectory::read_steps(const std::vector<size_t>& steps) {
+    check_opened();
+    for (auto step: steps) {
+        pre_read(step);
+    }
+
+    auto frames = std::vector<Frame>(steps.size());
+    if (steps.empty()) {
+        return frames;
+    }
+
+    // only read the frames which are not already in the cache
+    auto missing = std::vector<size_t>();
+    auto missing_index = std::vector<size_t>();
+    for (size_t i = 0; i < steps.size(); i++) {
+        if (frame_cache_ && frame_cache_->get(steps[i], frames[i])) {
+            continue;
+        }
+        frames[i].set_step(SENTINEL_VALUE);
+        missing.push_back(steps[i]);
+        missing_index.push_back(i);
+    }
+
+    if (missing.size() == steps.size()) {
+        format_->read_steps(steps, frames);
+    } else if (!missing.empty()) {
+        auto missing_frames = std::vector<Frame>(missing.size());
+        for (auto& frame: missing_frames) {
+            frame.set_step(SENTINEL_VALUE);
+        }
+        format_->read_steps(missing, missing_frames);
+        for (size_t i = 0; i < missing.size(); i++) {
+            frames[missing_index[i]] = std::move(missing_frames[i]);
+        }
+    }
+    step_ = steps.back();
+
+    for (auto i: missing_index) {
+        // Don't override the step set by a format
+        if (frames[i].step() == SENTINEL_VALUE) {
+            frames[i].set_step(steps[i]);
+        }
+        post_read(frames[i]);
+        if (frame_cache_) {
+            frame_cache_->insert(steps[i], frames[i]);
+        }
+    }
+
+    return frames;
+}
+
 void Trajectory::write(const Frame& frame) {
+    this->write(FrameView(frame));
+}
+
+void Trajectory::write(const FrameView& frame) {
     check_opened();
     if (!(mode_ == File::WRITE || mode_ == File::APPEND)) {
         throw file_error(
@@ -219,50 +464,106 @@ void Trajectory::write(const Frame& frame) {
     }
 
     if (custom_topology_ || custom_cell_) {
-        Frame copy = frame.clone();
+        // the view only references the custom topology and cell, formats
+        // which need a full frame will make a single copy
+        auto view = frame;
         if (custom_topology_) {
-            copy.set_topology(*custom_topology_);
+            view.set_topology(*custom_topology_);
         }
         if (custom_cell_) {
-            copy.set_cell(*custom_cell_);
+            view.set_cell(*custom_cell_);
         }
-        format_->write(copy);
+        format_->write_view(view);
     } else {
-        format_->write(frame);
+        format_->write_view(frame);
     }
 
     step_++;
-    nsteps_++;
+    if (nsteps_) {
+        nsteps_ = *nsteps_ + 1;
+    }
+}
+
+void Trajectory::write(const std::vector<Frame>& frames) {
+    check_opened();
+    if (!(mode_ == File::WRITE || mode_ == File::APPEND)) {
+        throw file_error(
+            "the file at '{}' was not opened in write or append mode", path_
+        );
+    }
+
+    auto views = std::vector<FrameView>();
+    views.reserve(frames.size());
+    for (const auto& frame: frames) {
+        auto view = FrameView(frame);
+        if (custom_topology_) {
+            view.set_topology(*custom_topology_);
+        }
+        if (custom_cell_) {
+            view.set_cell(*custom_cell_);
+        }
+        views.emplace_back(std::move(view));
+    }
+
+    format_->write_views(views);
+
+    step_ += frames.size();
+    if (nsteps_) {
+        nsteps_ = *nsteps_ + frames.size();
+    }
 }
 
 void Trajectory::set_topology(const Topology& topology) {
     check_opened();
-    custom_topology_ = topology;
+    custom_topology_ = std::make_shared<const Topology>(topology);
+    update_needed_atoms();
+    if (frame_cache_) {
+        frame_cache_->clear();
+    }
 }
 
 void Trajectory::set_topology(const std::string& filename, const std::string& format) {
     check_opened();
-    Trajectory topology_file(filename, 'r', format);
-    assert(topology_file.nsteps() > 0);
-
-    auto frame = topology_file.read_step(0);
-    set_topology(frame.topology());
+    custom_topology_ = TopologyCache::get().read(filename, format);
+    update_needed_atoms();
+    if (frame_cache_) {
+        frame_cache_->clear();
+    }
 }
 
 void Trajectory::set_cell(const UnitCell& cell) {
     check_opened();
     custom_cell_ = cell;
+    if (frame_cache_) {
+        frame_cache_->clear();
+    }
+}
+
+void Trajectory::set_transformations(Transformations transformations) {
+    check_opened();
+    if (mode_ != File::READ) {
+        throw file_error(
+            "the file at '{}' was not opened in read mode", path_
+        );
+    }
+
+    transformations_ = std::move(transformations);
+    update_needed_atoms();
+    if (frame_cache_) {
+        frame_cache_->clear();
+    }
 }
 
 bool Trajectory::done() const {
     check_opened();
-    return step_ >= nsteps_;
+    return step_ >= current_nsteps();
 }
 
 void Trajectory::close() {
     check_opened();
     // delete the format and set the pointer to nullptr
     format_.reset();
+    frame_cache_.reset();
 }
 
 optional<span<const char>> Trajectory::memory_buffer() const {
@@ -272,3 +573,46 @@ optional<span<const char>> Trajectory::memory_buffer() const {
 
     return span<const char>(buffer_->data(), buffer_->data() + buffer_->size());
 }
+
+std::vector<FileFrames> chemfiles::read_files(const std::vector<std::string>& paths, const std::string& format, bool all_steps) {
+    auto results = std::vector<FileFrames>(paths.size());
+    auto next = std::atomic<size_t>(0);
+
+    auto worker = [&]() {
+        while (true) {
+            auto i = next.fetch_add(1);
+            if (i >= paths.size()) {
+                return;
+            }
+
+            auto& result = results[i];
+            result.path = paths[i];
+            try {
+                auto trajectory = Trajectory(paths[i], 'r', format);
+                if (all_steps) {
+                    result.frames.reserve(trajectory.nsteps());
+                    while (!trajectory.done()) {
+                        result.frames.emplace_back(trajectory.read());
+                    }
+                } else {
+                    result.frames.emplace_back(trajectory.read());
+                }
+            } catch (const std::exception& e) {
+                result.frames.clear();
+                result.error = e.what();
+                result.exception = std::current_exception();
+            }
+        }
+    };
+
+    // the calling thread is also used as a worker
+    auto workers = std::min(ThreadPool::get().concurrency(), paths.size());
+    TaskGroup group;
+    for (size_t i = 1; i < workers; i++) {
+        group.run(worker);
+    }
+    worker();
+    group.wait();
+
+    return results;
+}
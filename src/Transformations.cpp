@@ -0,0 +1,313 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "chemfiles/Transformations.hpp"
+
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Residue.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/Superposition.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/topology_cache.hpp"
+#include "chemfiles/external/optional.hpp"
+
+using namespace chemfiles;
+
+#define NOT_IN_SUBSET (static_cast<size_t>(-1))
+
+Transformations& Transformations::subset(std::vector<size_t> indexes) {
+    auto seen = std::vector<bool>();
+    for (auto i: indexes) {
+        if (i >= seen.size()) {
+            seen.resize(i + 1, false);
+        }
+        if (seen[i]) {
+            throw error("atom {} appears multiple times in the subset", i);
+        }
+        seen[i] = true;
+    }
+
+    subset_ = std::move(indexes);
+    last_topology_.reset();
+    last_subset_topology_.reset();
+    return *this;
+}
+
+Transformations& Transformations::scale(double factor) {
+    auto stage = Stage{Stage::SCALE};
+    stage.factor = factor;
+    stages_.emplace_back(std::move(stage));
+    return *this;
+}
+
+Transformations& Transformations::center(std::vector<size_t> indexes) {
+    if (indexes.empty()) {
+        throw error("can not center on an empty list of atoms");
+    }
+
+    auto stage = Stage{Stage::CENTER};
+    stage.indexes = std::move(indexes);
+    stages_.emplace_back(std::move(stage));
+    return *this;
+}
+
+Transformations& Transformations::wrap() {
+    stages_.emplace_back(Stage{Stage::WRAP});
+    return *this;
+}
+
+Transformations& Transformations::align(const Frame& reference, std::vector<size_t> indexes) {
+    auto positions = reference.positions();
+    if (indexes.empty()) {
+        indexes.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            indexes[i] = i;
+        }
+    }
+
+    if (indexes.empty()) {
+        throw error("can not align on an empty list of atoms");
+    }
+
+    auto stage = Stage{Stage::ALIGN};
+    stage.reference.reserve(indexes.size());
+    for (auto i: indexes) {
+        if (i >= positions.size()) {
+            throw out_of_bounds(
+                "out of bounds atomic index in alignment: the reference has {} atoms, but the index is {}",
+                positions.size(), i
+            );
+        }
+        stage.reference.push_back(positions[i]);
+    }
+    stage.indexes = std::move(indexes);
+    stages_.emplace_back(std::move(stage));
+    return *this;
+}
+
+optional<size_t> Transformations::needed_atoms() const {
+    if (subset_.empty()) {
+        return nullopt;
+    }
+
+    size_t count = 0;
+    for (auto i: subset_) {
+        count = std::max(count, i + 1);
+    }
+    for (const auto& stage: stages_) {
+        for (auto i: stage.indexes) {
+            count = std::max(count, i + 1);
+        }
+    }
+    return count;
+}
+
+Matrix3D Transformations::prepare(const Frame& frame) {
+    auto matrix = frame.cell().matrix();
+    auto infinite = frame.cell().shape() == UnitCell::INFINITE;
+    auto positions = frame.positions();
+
+    for (size_t i = 0; i < stages_.size(); i++) {
+        auto& stage = stages_[i];
+        switch (stage.kind) {
+        case Stage::SCALE:
+            matrix *= stage.factor;
+            break;
+        case Stage::CENTER: {
+            // apply the previous transformations to the atoms used as center
+            auto center = Vector3D();
+            for (auto atom: stage.indexes) {
+                center += transform(positions[atom], i);
+            }
+            stage.translation = -center / static_cast<double>(stage.indexes.size());
+            break;
+        }
+        case Stage::WRAP:
+            stage.infinite = infinite;
+            if (!infinite) {
+                stage.matrix = matrix;
+                stage.inverse = matrix.invert();
+            }
+            break;
+        case Stage::ALIGN: {
+            // apply the previous transformations to the atoms to superpose
+            auto mobile = std::vector<Vector3D>();
+            mobile.reserve(stage.indexes.size());
+            for (auto atom: stage.indexes) {
+                mobile.push_back(transform(positions[atom], i));
+            }
+            auto superposition = Superposition(stage.reference, mobile);
+            stage.rotation = superposition.rotation();
+            stage.translation = superposition.reference_center() - stage.rotation * superposition.mobile_center();
+            break;
+        }
+        }
+    }
+
+    return matrix;
+}
+
+Vector3D Transformations::transform(Vector3D position, size_t count) const {
+    for (size_t i = 0; i < count; i++) {
+        const auto& stage = stages_[i];
+        switch (stage.kind) {
+        case Stage::SCALE:
+            position *= stage.factor;
+            break;
+        case Stage::CENTER:
+            position += stage.translation;
+            break;
+        case Stage::WRAP:
+            if (!stage.infinite) {
+                auto fractional = stage.inverse * position;
+                fractional[0] -= std::round(fractional[0]);
+                fractional[1] -= std::round(fractional[1]);
+                fractional[2] -= std::round(fractional[2]);
+                position = stage.matrix * fractional;
+            }
+            break;
+        case Stage::ALIGN:
+            position = stage.rotation * position + stage.translation;
+            break;
+        }
+    }
+    return position;
+}
+
+std::shared_ptr<const Topology> Transformations::subset_topology(const Topology& topology) {
+    if (last_topology_ && same_topology(*last_topology_, topology)) {
+        return last_subset_topology_;
+    }
+
+    auto new_indexes = std::vector<size_t>(topology.size(), NOT_IN_SUBSET);
+    auto subset = std::make_shared<Topology>();
+    for (size_t i = 0; i < subset_.size(); i++) {
+        new_indexes[subset_[i]] = i;
+        subset->add_atom(topology[subset_[i]]);
+    }
+
+    const auto& bonds = topology.bonds();
+    const auto& bond_orders = topology.bond_orders();
+    for (size_t i = 0; i < bonds.size(); i++) {
+        auto first = new_indexes[bonds[i][0]];
+        auto second = new_indexes[bonds[i][1]];
+        if (first != NOT_IN_SUBSET && second != NOT_IN_SUBSET) {
+            subset->add_bond(first, second, bond_orders[i]);
+        }
+    }
+
+    for (const auto& residue: topology.residues()) {
+        auto id = residue.id();
+        auto new_residue = id ? Residue(residue.name(), *id) : Residue(residue.name());
+        for (const auto& property: residue.properties()) {
+            new_residue.set(property.first, property.second);
+        }
+
+        for (auto atom: residue) {
+            if (new_indexes[atom] != NOT_IN_SUBSET) {
+                new_residue.add_atom(new_indexes[atom]);
+            }
+        }
+
+        if (new_residue.size() != 0) {
+            subset->add_residue(std::move(new_residue));
+        }
+    }
+
+    last_topology_ = std::make_shared<const Topology>(topology);
+    last_subset_topology_ = std::move(subset);
+    return last_subset_topology_;
+}
+
+void Transformations::apply(Frame& frame) {
+    if (this->empty()) {
+        return;
+    }
+
+    auto check_index = [&frame](size_t i) {
+        if (i >= frame.size()) {
+            throw out_of_bounds(
+                "out of bounds atomic index in transformations: the frame has {} atoms, but the index is {}",
+                frame.size(), i
+            );
+        }
+    };
+
+    for (const auto& stage: stages_) {
+        for (auto i: stage.indexes) {
+            check_index(i);
+        }
+    }
+    for (auto i: subset_) {
+        check_index(i);
+    }
+
+    auto matrix = prepare(frame);
+    auto count = stages_.size();
+
+    // velocities are only affected by scaling and rotations
+    auto velocity_matrix = Matrix3D::unit();
+    for (const auto& stage: stages_) {
+        if (stage.kind == Stage::SCALE) {
+            velocity_matrix *= stage.factor;
+        } else if (stage.kind == Stage::ALIGN) {
+            velocity_matrix = stage.rotation * velocity_matrix;
+        }
+    }
+
+    if (subset_.empty()) {
+        for (auto& position: frame.positions()) {
+            position = transform(position, count);
+        }
+
+        auto velocities = frame.velocities();
+        if (velocities && velocity_matrix != Matrix3D::unit()) {
+            for (auto& velocity: *velocities) {
+                velocity = velocity_matrix * velocity;
+            }
+        }
+    } else {
+        auto topology = subset_topology(frame.topology());
+
+        auto result = Frame(frame.cell());
+        result.resize(subset_.size());
+        result.set_topology(*topology);
+        result.set_step(frame.step());
+
+        // gather and transform the positions in a single pass
+        auto input = frame.positions();
+        auto output = result.positions();
+        for (size_t i = 0; i < subset_.size(); i++) {
+            output[i] = transform(input[subset_[i]], count);
+        }
+
+        auto velocities = frame.velocities();
+        if (velocities) {
+            result.add_velocities();
+            auto output_velocities = *result.velocities();
+            for (size_t i = 0; i < subset_.size(); i++) {
+                output_velocities[i] = velocity_matrix * (*velocities)[subset_[i]];
+            }
+        }
+
+        for (const auto& property: frame.properties()) {
+            result.set(property.first, property.second);
+        }
+
+        frame = std::move(result);
+    }
+
+    if (frame.cell().matrix() != matrix) {
+        frame.set_cell(UnitCell(matrix));
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "chemfiles/capi/types.h"
 #include "chemfiles/capi/misc.h"
@@ -11,7 +12,9 @@
 
 #include "chemfiles/capi/frame.h"
 
+#include "chemfiles/Atom.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/UnitCell.hpp"
 #include "chemfiles/error_fmt.hpp"
 #include "chemfiles/Property.hpp"
 #include "chemfiles/Connectivity.hpp"
@@ -22,6 +25,32 @@
 
 using namespace chemfiles;
 
+namespace {
+    /// Storage for the tensors created by `chfl_frame_dlpack`. This is
+    /// allocated with the shared_allocator, and the address of `shape` is
+    /// registered as sharing the reference count of the exported frame.
+    struct DLPackTensor {
+        chfl_dlpack_managed_tensor managed;
+        int64_t shape[2];
+        int64_t strides[2];
+        /// Copy of the cell matrix, used for `CHFL_ARRAY_CELL`
+        double cell[3][3];
+        /// Copy of the masses or charges, used for `CHFL_ARRAY_MASSES` and
+        /// `CHFL_ARRAY_CHARGES`
+        std::vector<double> values;
+    };
+
+    void dlpack_deleter(chfl_dlpack_managed_tensor* self) {
+        if (self == nullptr) {
+            return;
+        }
+        auto tensor = static_cast<DLPackTensor*>(self->manager_ctx);
+        // release the reference to the frame first, and then the tensor
+        chfl_free(tensor->shape);
+        chfl_free(tensor);
+    }
+}
+
 extern "C" CHFL_FRAME* chfl_frame(void) {
     CHFL_FRAME* frame = nullptr;
     CHFL_ERROR_GOTO(
@@ -86,6 +115,98 @@ extern "C" chfl_status chfl_frame_velocities(CHFL_FRAME* const frame, chfl_vecto
     )
 }
 
+extern "C" chfl_status chfl_frame_dlpack(CHFL_FRAME* const frame, chfl_frame_array array, chfl_dlpack_managed_tensor** tensor) {
+    CHECK_POINTER(frame);
+    CHECK_POINTER(tensor);
+    CHFL_ERROR_CATCH(
+        auto natoms = static_cast<int64_t>(frame->size());
+
+        auto exported = DLPackTensor();
+        auto& dl_tensor = exported.managed.dl_tensor;
+        dl_tensor.device.device_type = 1;  // kDLCPU
+        dl_tensor.device.device_id = 0;
+        dl_tensor.dtype.code = 2;  // kDLFloat
+        dl_tensor.dtype.bits = 64;
+        dl_tensor.dtype.lanes = 1;
+        dl_tensor.byte_offset = 0;
+
+        switch (array) {
+        case CHFL_ARRAY_POSITIONS:
+        case CHFL_ARRAY_VELOCITIES: {
+            auto data = frame->positions().data();
+            if (array == CHFL_ARRAY_VELOCITIES) {
+                auto velocities = frame->velocities();
+                if (!velocities) {
+                    throw memory_error("velocity data is not defined in this frame");
+                }
+                data = velocities->data();
+            }
+            dl_tensor.data = reinterpret_cast<double*>(data);
+            dl_tensor.ndim = 2;
+            exported.shape[0] = natoms;
+            exported.shape[1] = 3;
+            exported.strides[0] = 3;
+            exported.strides[1] = 1;
+            break;
+        }
+        case CHFL_ARRAY_CELL: {
+            auto matrix = frame->cell().matrix();
+            for (size_t i = 0; i < 3; i++) {
+                for (size_t j = 0; j < 3; j++) {
+                    exported.cell[i][j] = matrix[i][j];
+                }
+            }
+            // the data pointer is set below, once the tensor is allocated
+            dl_tensor.data = nullptr;
+            dl_tensor.ndim = 2;
+            exported.shape[0] = 3;
+            exported.shape[1] = 3;
+            exported.strides[0] = 3;
+            exported.strides[1] = 1;
+            break;
+        }
+        case CHFL_ARRAY_MASSES:
+        case CHFL_ARRAY_CHARGES: {
+            exported.values.reserve(frame->size());
+            for (const auto& atom: *frame) {
+                if (array == CHFL_ARRAY_MASSES) {
+                    exported.values.push_back(atom.mass());
+                } else {
+                    exported.values.push_back(atom.charge());
+                }
+            }
+            // the data pointer is set below, once the tensor is allocated
+            dl_tensor.data = nullptr;
+            dl_tensor.ndim = 1;
+            exported.shape[0] = natoms;
+            exported.strides[0] = 1;
+            break;
+        }
+        default:
+            throw out_of_bounds("unknown frame array {}", static_cast<int>(array));
+        }
+
+        auto result = shared_allocator::make_shared<DLPackTensor>(std::move(exported));
+        result->managed.dl_tensor.shape = result->shape;
+        result->managed.dl_tensor.strides = result->strides;
+        if (array == CHFL_ARRAY_CELL) {
+            result->managed.dl_tensor.data = result->cell;
+        } else if (array == CHFL_ARRAY_MASSES || array == CHFL_ARRAY_CHARGES) {
+            result->managed.dl_tensor.data = result->values.data();
+        }
+        result->managed.manager_ctx = result;
+        result->managed.deleter = dlpack_deleter;
+        try {
+            // keep the frame alive as long as the tensor is not deleted
+            shared_allocator::shared_ptr(frame, result->shape);
+        } catch (...) {
+            chfl_free(result);
+            throw;
+        }
+        *tensor = &result->managed;
+    )
+}
+
 extern "C" chfl_status chfl_frame_add_atom(
 	CHFL_FRAME* const frame,
 	const CHFL_ATOM* const atom,
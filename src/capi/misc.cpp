@@ -4,8 +4,11 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <memory>
 #include <string>
 #include <vector>
+#include <utility>
+#include <exception>
 #include <functional>
 
 #include "chemfiles/config.h"
@@ -16,9 +19,10 @@
 
 #include "chemfiles/misc.hpp"
 #include "chemfiles/error_fmt.hpp"
-#include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/FormatMetadata.hpp"
+#include "chemfiles/Trajectory.hpp"
+#include "chemfiles/Frame.hpp"
 
 using namespace chemfiles;
 
@@ -105,3 +109,101 @@ extern "C" chfl_status chfl_guess_format(const char* const path, char* const for
         format[buffsize - 1] = '\0';
     )
 }
+
+extern "C" chfl_status chfl_set_num_threads(uint64_t count) {
+    CHFL_ERROR_CATCH(
+        set_num_threads(checked_cast(count));
+    )
+}
+
+extern "C" chfl_status chfl_num_threads(uint64_t* const count) {
+    CHECK_POINTER(count);
+    CHFL_ERROR_CATCH(
+        *count = static_cast<uint64_t>(num_threads());
+    )
+}
+
+static void run_cxx_task(void* task) {
+    auto function = std::unique_ptr<std::function<void()>>(static_cast<std::function<void()>*>(task));
+    (*function)();
+}
+
+extern "C" chfl_status chfl_set_executor(chfl_executor executor, void* user_data, uint64_t concurrency) {
+    CHECK_POINTER(executor);
+    CHFL_ERROR_CATCH(
+        set_executor([executor, user_data](std::function<void()> task) {
+            auto function = std::make_unique<std::function<void()>>(std::move(task));
+            executor(run_cxx_task, function.release(), user_data);
+        }, checked_cast(concurrency));
+    )
+}
+
+extern "C" chfl_status chfl_set_topology_cache_limit(uint64_t limit) {
+    CHFL_ERROR_CATCH(
+        set_topology_cache_limit(checked_cast(limit));
+    )
+}
+
+extern "C" chfl_status chfl_clear_topology_cache(const char* path) {
+    CHFL_ERROR_CATCH(
+        if (path == nullptr) {
+            clear_topology_cache();
+        } else {
+            clear_topology_cache(path);
+        }
+    )
+}
+
+extern "C" chfl_status chfl_load_component_dictionary(const char* path) {
+    CHFL_ERROR_CATCH(
+        if (path == nullptr) {
+            load_component_dictionary("");
+        } else {
+            load_component_dictionary(path);
+        }
+    )
+}
+
+extern "C" chfl_status chfl_build_component_dictionary(const char* input, const char* output) {
+    CHECK_POINTER(input);
+    CHECK_POINTER(output);
+    CHFL_ERROR_CATCH(
+        build_component_dictionary(input, output);
+    )
+}
+
+extern "C" chfl_status chfl_read_files(const char* const paths[], uint64_t count, const char* format, CHFL_FRAME* frames[]) {
+    CHECK_POINTER(paths);
+    CHECK_POINTER(format);
+    CHECK_POINTER(frames);
+    CHFL_ERROR_CATCH(
+        auto size = checked_cast(count);
+        auto paths_vector = std::vector<std::string>();
+        paths_vector.reserve(size);
+        // set all the frames to NULL before anything can fail, so the caller
+        // can always release all of them
+        for (size_t i = 0; i < size; i++) {
+            frames[i] = nullptr;
+        }
+        for (size_t i = 0; i < size; i++) {
+            if (paths[i] == nullptr) {
+                throw memory_error("path at index {} cannot be NULL in chfl_read_files", i);
+            }
+            paths_vector.emplace_back(paths[i]);
+        }
+
+        auto results = read_files(paths_vector, format);
+        std::exception_ptr first_error = nullptr;
+        for (size_t i = 0; i < size; i++) {
+            if (!results[i].exception) {
+                frames[i] = shared_allocator::make_shared<Frame>(std::move(results[i].frames[0]));
+            } else if (!first_error) {
+                first_error = results[i].exception;
+            }
+        }
+
+        if (first_error) {
+            std::rethrow_exception(first_error);
+        }
+    )
+}
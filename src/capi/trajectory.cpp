@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include "chemfiles/capi/types.h"
 #include "chemfiles/capi/misc.h"
@@ -14,6 +15,9 @@
 
 #include "chemfiles/Error.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
 #include "chemfiles/Trajectory.hpp"
 #include "chemfiles/external/span.hpp"
 #include "chemfiles/external/optional.hpp"
@@ -91,6 +95,27 @@ extern "C" chfl_status chfl_trajectory_read_step(CHFL_TRAJECTORY* const trajecto
     )
 }
 
+extern "C" chfl_status chfl_trajectory_read_steps(CHFL_TRAJECTORY* const trajectory, const uint64_t* steps, uint64_t count, CHFL_FRAME* const* frames) {
+    CHECK_POINTER(trajectory);
+    CHECK_POINTER(steps);
+    CHECK_POINTER(frames);
+    for (uint64_t i = 0; i < count; i++) {
+        CHECK_POINTER(frames[i]);
+    }
+    CHFL_ERROR_CATCH(
+        auto size = checked_cast(count);
+        auto steps_vector = std::vector<size_t>(size);
+        for (size_t i = 0; i < size; i++) {
+            steps_vector[i] = checked_cast(steps[i]);
+        }
+
+        auto result = trajectory->read_steps(steps_vector);
+        for (size_t i = 0; i < size; i++) {
+            *frames[i] = std::move(result[i]);
+        }
+    )
+}
+
 extern "C" chfl_status chfl_trajectory_read(CHFL_TRAJECTORY* const trajectory, CHFL_FRAME* const frame) {
     CHECK_POINTER(trajectory);
     CHECK_POINTER(frame);
@@ -107,6 +132,40 @@ extern "C" chfl_status chfl_trajectory_write(CHFL_TRAJECTORY* const trajectory,
     )
 }
 
+extern "C" chfl_status chfl_trajectory_write_positions(
+    CHFL_TRAJECTORY* const trajectory,
+    const chfl_vector3d* const positions,
+    const chfl_vector3d* const velocities,
+    uint64_t natoms,
+    const CHFL_TOPOLOGY* const topology,
+    const CHFL_CELL* const cell,
+    uint64_t step
+) {
+    CHECK_POINTER(trajectory);
+    CHECK_POINTER(positions);
+    CHFL_ERROR_CATCH(
+        auto size = checked_cast(natoms);
+
+        auto default_topology = Topology();
+        if (topology == nullptr) {
+            default_topology.resize(size);
+        }
+
+        auto infinite_cell = UnitCell();
+        auto view = FrameView(
+            topology != nullptr ? *topology : default_topology,
+            VectorsView(&positions[0][0], size),
+            cell != nullptr ? *cell : infinite_cell
+        );
+        if (velocities != nullptr) {
+            view.set_velocities(VectorsView(&velocities[0][0], size));
+        }
+        view.set_step(checked_cast(step));
+
+        trajectory->write(view);
+    )
+}
+
 extern "C" chfl_status chfl_trajectory_set_topology(CHFL_TRAJECTORY* const trajectory, const CHFL_TOPOLOGY* const topology) {
     CHECK_POINTER(trajectory);
     CHECK_POINTER(topology);
@@ -142,6 +201,28 @@ extern "C" chfl_status chfl_trajectory_nsteps(CHFL_TRAJECTORY* const trajectory,
     )
 }
 
+extern "C" chfl_status chfl_trajectory_refresh(CHFL_TRAJECTORY* const trajectory, uint64_t* nsteps) {
+    CHECK_POINTER(trajectory);
+    CHECK_POINTER(nsteps);
+    CHFL_ERROR_CATCH(
+        *nsteps = trajectory->refresh();
+    )
+}
+
+extern "C" chfl_status chfl_trajectory_set_frame_cache(CHFL_TRAJECTORY* const trajectory, uint64_t limit, uint64_t prefetch) {
+    CHECK_POINTER(trajectory);
+    CHFL_ERROR_CATCH(
+        trajectory->set_frame_cache(checked_cast(limit), checked_cast(prefetch));
+    )
+}
+
+extern "C" chfl_status chfl_trajectory_bisect_steps(CHFL_TRAJECTORY* const trajectory) {
+    CHECK_POINTER(trajectory);
+    CHFL_ERROR_CATCH(
+        trajectory->locate_steps_by_bisection();
+    )
+}
+
 extern "C" chfl_status chfl_trajectory_memory_buffer(const CHFL_TRAJECTORY* trajectory, const char** data, uint64_t* size) {
     CHECK_POINTER(trajectory);
     CHECK_POINTER(data);
@@ -0,0 +1,669 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+#include "chemfiles/misc.hpp"
+#include "chemfiles/File.hpp"
+#include "chemfiles/utils.hpp"
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/files/BinaryFile.hpp"
+#include "chemfiles/external/optional.hpp"
+
+#include "chemfiles/component_dictionary.hpp"
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace chemfiles;
+
+static constexpr char MAGIC[8] = {'C', 'H', 'F', 'L', '-', 'C', 'C', 'D'};
+static constexpr uint32_t VERSION = 1;
+static constexpr size_t HEADER_SIZE = 32;
+static constexpr size_t COMPONENT_SIZE = 5 * sizeof(uint32_t);
+static constexpr size_t BOND_SIZE = 4 * sizeof(uint16_t);
+/// Bit set in the number of atoms of polymer components
+static constexpr uint32_t POLYMER_FLAG = 0x80000000;
+
+/// Hash `name` with the given `seed`, using FNV-1a followed by the murmur3
+/// finalizer to improve the distribution of the low bits.
+static uint32_t hash_name(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (auto c: name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/******************************************************************************/
+
+ComponentDictionary::ComponentDictionary(const std::string& path) {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    auto file_descriptor = open(path.c_str(), O_RDONLY);
+    if (file_descriptor == -1) {
+        throw file_error(
+            "could not open component dictionary at '{}': {}", path, std::strerror(errno)
+        );
+    }
+
+    struct stat file_stat;
+    if (fstat(file_descriptor, &file_stat) < 0) {
+        close(file_descriptor);
+        throw file_error("could not get the file size with fstat: {}", std::strerror(errno));
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    if (size_ != 0) {
+        auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        close(file_descriptor);
+        if (data == MAP_FAILED) {
+            throw file_error("mmap failed for '{}': {}", path, std::strerror(errno));
+        }
+        data_ = static_cast<const char*>(data);
+        mapped_ = true;
+    } else {
+        close(file_descriptor);
+    }
+#else
+    auto file = LittleEndianFile(path, File::READ);
+    buffer_.resize(static_cast<size_t>(file.file_size()));
+    file.read_char(buffer_);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+
+    // the destructor does not run if the constructor throws, release the
+    // mapping here instead
+    try {
+        if (size_ < HEADER_SIZE || std::memcmp(data_, MAGIC, sizeof(MAGIC)) != 0) {
+            throw format_error("'{}' is not a chemfiles component dictionary", path);
+        }
+
+        auto version = read_u32(8);
+        if (version != VERSION) {
+            throw format_error(
+                "unsupported component dictionary version {} in '{}', expected {}",
+                version, path, VERSION
+            );
+        }
+
+        ncomponents_ = read_u32(12);
+        nbuckets_ = read_u32(16);
+        natoms_ = read_u32(20);
+        nbonds_ = read_u32(24);
+        strings_size_ = read_u32(28);
+
+        displacements_ = HEADER_SIZE;
+        components_ = displacements_ + sizeof(uint32_t) * nbuckets_;
+        atoms_ = components_ + COMPONENT_SIZE * ncomponents_;
+        bonds_ = atoms_ + sizeof(uint32_t) * natoms_;
+        strings_ = bonds_ + BOND_SIZE * nbonds_;
+
+        if (strings_ + strings_size_ != size_ || (ncomponents_ != 0 && nbuckets_ == 0) ||
+            strings_size_ == 0 || data_[size_ - 1] != '\0') {
+            throw format_error("invalid component dictionary in '{}': the file is corrupted", path);
+        }
+    } catch (...) {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+        if (mapped_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+        throw;
+    }
+}
+
+ComponentDictionary::~ComponentDictionary() {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+uint32_t ComponentDictionary::read_u32(size_t offset) const {
+    auto bytes = reinterpret_cast<const uint8_t*>(data_ + offset);
+    return static_cast<uint32_t>(bytes[0]) |
+           static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 |
+           static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+uint16_t ComponentDictionary::read_u16(size_t offset) const {
+    auto bytes = reinterpret_cast<const uint8_t*>(data_ + offset);
+    return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+}
+
+std::string_view ComponentDictionary::string(uint32_t offset) const {
+    if (offset >= strings_size_) {
+        throw format_error("invalid string offset in component dictionary");
+    }
+    // the string table always ends with a NULL byte, so this can not go out
+    // of bounds
+    return std::string_view(data_ + strings_ + offset);
+}
+
+optional<ComponentDictionary::Component> ComponentDictionary::find(std::string_view name) const {
+    if (ncomponents_ == 0) {
+        return nullopt;
+    }
+
+    auto bucket = hash_name(name, 0) % nbuckets_;
+    auto displacement = read_u32(displacements_ + sizeof(uint32_t) * bucket);
+    auto slot = hash_name(name, displacement) % ncomponents_;
+
+    auto component = Component(*this, slot);
+    if (component.name() == name) {
+        return component;
+    } else {
+        return nullopt;
+    }
+}
+
+ComponentDictionary::Component::Component(const ComponentDictionary& dictionary, size_t index): dictionary_(&dictionary) {
+    auto offset = dictionary.components_ + COMPONENT_SIZE * index;
+    name_ = dictionary.read_u32(offset);
+    first_atom_ = dictionary.read_u32(offset + 4);
+    natoms_ = dictionary.read_u32(offset + 8);
+    first_bond_ = dictionary.read_u32(offset + 12);
+    nbonds_ = dictionary.read_u32(offset + 16);
+
+    polymer_ = (natoms_ & POLYMER_FLAG) != 0;
+    natoms_ &= ~POLYMER_FLAG;
+
+    if (static_cast<uint64_t>(first_atom_) + natoms_ > dictionary.natoms_ ||
+        static_cast<uint64_t>(first_bond_) + nbonds_ > dictionary.nbonds_) {
+        throw format_error("invalid component in component dictionary: the file is corrupted");
+    }
+}
+
+std::string_view ComponentDictionary::Component::name() const {
+    return dictionary_->string(name_);
+}
+
+size_t ComponentDictionary::Component::size() const {
+    return natoms_;
+}
+
+std::string_view ComponentDictionary::Component::atom(size_t index) const {
+    if (index >= natoms_) {
+        throw out_of_bounds(
+            "out of bounds atomic index in component '{}': we have {} atoms, but the index is {}",
+            name(), natoms_, index
+        );
+    }
+    auto offset = dictionary_->atoms_ + sizeof(uint32_t) * (first_atom_ + index);
+    return dictionary_->string(dictionary_->read_u32(offset));
+}
+
+size_t ComponentDictionary::Component::bonds_count() const {
+    return nbonds_;
+}
+
+ComponentDictionary::ComponentBond ComponentDictionary::Component::bond(size_t index) const {
+    if (index >= nbonds_) {
+        throw out_of_bounds(
+            "out of bounds bond index in component '{}': we have {} bonds, but the index is {}",
+            name(), nbonds_, index
+        );
+    }
+    auto offset = dictionary_->bonds_ + BOND_SIZE * (first_bond_ + index);
+    auto i = dictionary_->read_u16(offset);
+    auto j = dictionary_->read_u16(offset + 2);
+    auto order = dictionary_->read_u16(offset + 4);
+    if (i >= natoms_ || j >= natoms_) {
+        throw format_error("invalid bond in component '{}': the file is corrupted", name());
+    }
+    if ((order > Bond::QUINTUPLET && order < Bond::DOWN) || order > Bond::AROMATIC) {
+        throw format_error("invalid bond in component '{}': the file is corrupted", name());
+    }
+    return {i, j, static_cast<Bond::BondOrder>(order)};
+}
+
+bool ComponentDictionary::Component::polymer() const {
+    return polymer_;
+}
+
+/******************************************************************************/
+
+/// A token in a CIF file
+struct cif_token_t {
+    std::string_view value;
+    /// Was this token quoted or a text field? Quoted tokens are always values
+    bool quoted;
+};
+
+/// Streaming tokenizer for the subset of the CIF syntax used by the chemical
+/// component dictionary
+class CIFTokenizer {
+public:
+    explicit CIFTokenizer(TextFile& file): file_(file) {}
+
+    /// Get the next token, or `nullopt` at the end of the file. The token is
+    /// only valid until the next call to this function.
+    optional<cif_token_t> next() {
+        while (true) {
+            while (!line_.empty() && is_ascii_whitespace(line_[0])) {
+                line_.remove_prefix(1);
+            }
+
+            if (line_.empty() || line_[0] == '#') {
+                if (file_.eof()) {
+                    return nullopt;
+                }
+                line_ = file_.readline();
+                if (!line_.empty() && line_[0] == ';') {
+                    return text_field();
+                }
+                continue;
+            }
+
+            if (line_[0] == '\'' || line_[0] == '"') {
+                return quoted();
+            }
+
+            size_t end = 0;
+            while (end < line_.size() && !is_ascii_whitespace(line_[end])) {
+                end++;
+            }
+            auto value = line_.substr(0, end);
+            line_.remove_prefix(end);
+            return cif_token_t{value, false};
+        }
+    }
+
+private:
+    /// Read a quoted value, which ends with a quote followed by whitespace
+    cif_token_t quoted() {
+        auto quote = line_[0];
+        for (size_t end = 1; end < line_.size(); end++) {
+            if (line_[end] == quote && (end + 1 == line_.size() || is_ascii_whitespace(line_[end + 1]))) {
+                auto value = line_.substr(1, end - 1);
+                line_.remove_prefix(end + 1);
+                return {value, true};
+            }
+        }
+        throw format_error("unterminated quoted value in CIF file: {}", line_);
+    }
+
+    /// Read a multi-lines text field, delimited by lines starting with `;`
+    cif_token_t text_field() {
+        text_ = std::string(line_.substr(1));
+        while (!file_.eof()) {
+            auto line = file_.readline();
+            if (!line.empty() && line[0] == ';') {
+                line_ = line.substr(1);
+                return {text_, true};
+            }
+            text_ += '\n';
+            text_ += line;
+        }
+        throw format_error("unterminated text field in CIF file");
+    }
+
+    TextFile& file_;
+    /// Remaining part of the current line
+    std::string_view line_;
+    /// Storage for text fields
+    std::string text_;
+};
+
+/// Data for a single component, read from the CIF file
+struct cif_component_t {
+    std::string name;
+    bool polymer = false;
+    std::vector<std::string> atoms;
+    std::vector<std::pair<std::array<std::string, 2>, Bond::BondOrder>> bonds;
+};
+
+static Bond::BondOrder cif_bond_order(std::string_view value) {
+    if (value == "SING" || value == "sing") {
+        return Bond::SINGLE;
+    } else if (value == "DOUB" || value == "doub") {
+        return Bond::DOUBLE;
+    } else if (value == "TRIP" || value == "trip") {
+        return Bond::TRIPLE;
+    } else if (value == "QUAD" || value == "quad") {
+        return Bond::QUADRUPLE;
+    } else if (value == "AROM" || value == "arom") {
+        return Bond::AROMATIC;
+    } else {
+        return Bond::UNKNOWN;
+    }
+}
+
+/// Check if the `_chem_comp.type` value corresponds to a polymer component,
+/// e.g. `L-PEPTIDE LINKING` or `DNA linking`
+static bool is_polymer_type(std::string_view type) {
+    auto upper = std::string(type);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return to_ascii_uppercase(c); });
+    return upper.find("PEPTIDE LINKING") != std::string::npos ||
+           upper.find("NA LINKING") != std::string::npos;
+}
+
+/// Read all components from the CIF file at `path`
+static std::vector<cif_component_t> read_cif_components(const std::string& path) {
+    auto compression = File::DEFAULT;
+    if (path.size() > 3 && path.substr(path.size() - 3) == ".gz") {
+        compression = File::GZIP;
+    } else if (path.size() > 3 && path.substr(path.size() - 3) == ".xz") {
+        compression = File::LZMA;
+    } else if (path.size() > 4 && path.substr(path.size() - 4) == ".bz2") {
+        compression = File::BZIP2;
+    }
+
+    auto file = TextFile(path, File::READ, compression);
+    auto tokens = CIFTokenizer(file);
+
+    auto components = std::vector<cif_component_t>();
+    // single values (outside of loops) in the current block
+    auto values = std::unordered_map<std::string, std::string>();
+
+    auto finish_component = [&]() {
+        if (components.empty()) {
+            return;
+        }
+        auto& component = components.back();
+        auto atom = values.find("_chem_comp_atom.atom_id");
+        if (atom != values.end()) {
+            component.atoms.emplace_back(atom->second);
+        }
+        auto atom_1 = values.find("_chem_comp_bond.atom_id_1");
+        auto atom_2 = values.find("_chem_comp_bond.atom_id_2");
+        if (atom_1 != values.end() && atom_2 != values.end()) {
+            component.bonds.push_back({{{atom_1->second, atom_2->second}}, cif_bond_order(values["_chem_comp_bond.value_order"])});
+        }
+        auto type = values.find("_chem_comp.type");
+        if (type != values.end()) {
+            component.polymer = is_polymer_type(type->second);
+        }
+        values.clear();
+    };
+
+    // loop state
+    auto loop_tags = std::vector<std::string>();
+    bool reading_tags = false;
+    size_t column = 0;
+    // columns of interest in the current loop, or SIZE_MAX
+    size_t atom_id = SIZE_MAX;
+    size_t atom_id_1 = SIZE_MAX;
+    size_t atom_id_2 = SIZE_MAX;
+    size_t value_order = SIZE_MAX;
+    std::array<std::string, 2> bond_atoms;
+    Bond::BondOrder bond_order = Bond::UNKNOWN;
+
+    std::string pending_tag;
+    while (auto token = tokens.next()) {
+        auto value = token->value;
+        if (!token->quoted) {
+            if (value.substr(0, 5) == "data_") {
+                finish_component();
+                components.emplace_back();
+                components.back().name = std::string(value.substr(5));
+                loop_tags.clear();
+                reading_tags = false;
+                continue;
+            } else if (value == "loop_") {
+                loop_tags.clear();
+                reading_tags = true;
+                column = 0;
+                continue;
+            } else if (!value.empty() && value[0] == '_') {
+                if (reading_tags) {
+                    loop_tags.emplace_back(value);
+                } else {
+                    loop_tags.clear();
+                    pending_tag = std::string(value);
+                }
+                continue;
+            }
+        }
+
+        if (!pending_tag.empty()) {
+            values[pending_tag] = std::string(value);
+            pending_tag.clear();
+            continue;
+        }
+
+        if (loop_tags.empty() || components.empty()) {
+            throw format_error("unexpected value '{}' in CIF file", value);
+        }
+
+        if (reading_tags) {
+            // first value in the loop, find the columns we are interested in
+            reading_tags = false;
+            atom_id = atom_id_1 = atom_id_2 = value_order = SIZE_MAX;
+            for (size_t i = 0; i < loop_tags.size(); i++) {
+                const auto& tag = loop_tags[i];
+                if (tag == "_chem_comp_atom.atom_id") {
+                    atom_id = i;
+                } else if (tag == "_chem_comp_bond.atom_id_1") {
+                    atom_id_1 = i;
+                } else if (tag == "_chem_comp_bond.atom_id_2") {
+                    atom_id_2 = i;
+                } else if (tag == "_chem_comp_bond.value_order") {
+                    value_order = i;
+                }
+            }
+        }
+
+        auto& component = components.back();
+        if (column == atom_id) {
+            component.atoms.emplace_back(value);
+        } else if (column == atom_id_1) {
+            bond_atoms[0] = std::string(value);
+        } else if (column == atom_id_2) {
+            bond_atoms[1] = std::string(value);
+        } else if (column == value_order) {
+            bond_order = cif_bond_order(value);
+        }
+
+        column += 1;
+        if (column == loop_tags.size()) {
+            if (atom_id_1 != SIZE_MAX && atom_id_2 != SIZE_MAX) {
+                component.bonds.push_back({bond_atoms, bond_order});
+                bond_order = Bond::UNKNOWN;
+            }
+            column = 0;
+        }
+    }
+    finish_component();
+
+    return components;
+}
+
+void ComponentDictionary::build(const std::string& input, const std::string& output) {
+    auto components = read_cif_components(input);
+    auto ncomponents = components.size();
+    if (ncomponents >= POLYMER_FLAG) {
+        throw format_error("too many components in '{}'", input);
+    }
+
+    // String table, with de-duplicated strings
+    auto strings = std::string();
+    auto strings_offsets = std::unordered_map<std::string, uint32_t>();
+    auto add_string = [&](const std::string& value) {
+        auto it = strings_offsets.find(value);
+        if (it != strings_offsets.end()) {
+            return it->second;
+        }
+        auto offset = static_cast<uint32_t>(strings.size());
+        strings.append(value);
+        strings.push_back('\0');
+        strings_offsets.emplace(value, offset);
+        return offset;
+    };
+    // make sure the string table is never empty
+    add_string("");
+
+    // Build the perfect hash function with the "hash, displace and compress"
+    // algorithm: keys are split in buckets, and a displacement value is
+    // searched for each bucket (starting with the largest ones) such that all
+    // keys in the bucket map to free slots.
+    auto nbuckets = static_cast<uint32_t>(std::max<size_t>(ncomponents / 4, 1));
+    auto buckets = std::vector<std::vector<size_t>>(nbuckets);
+    for (size_t i = 0; i < ncomponents; i++) {
+        buckets[hash_name(components[i].name, 0) % nbuckets].push_back(i);
+    }
+
+    auto order = std::vector<uint32_t>(nbuckets);
+    for (uint32_t i = 0; i < nbuckets; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    auto displacements = std::vector<uint32_t>(nbuckets, 0);
+    // component index for each slot
+    auto slots = std::vector<size_t>(ncomponents, SIZE_MAX);
+    auto bucket_slots = std::vector<size_t>();
+    for (auto bucket: order) {
+        const auto& keys = buckets[bucket];
+        if (keys.empty()) {
+            break;
+        }
+
+        uint32_t displacement = 1;
+        while (true) {
+            bucket_slots.clear();
+            for (auto key: keys) {
+                auto slot = hash_name(components[key].name, displacement) % ncomponents;
+                if (slots[slot] != SIZE_MAX || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+
+            if (bucket_slots.size() == keys.size()) {
+                break;
+            }
+
+            displacement++;
+            if (displacement == 0) {
+                throw format_error(
+                    "could not build the perfect hash function for the component dictionary, "
+                    "are there duplicated components in '{}'?", input
+                );
+            }
+        }
+
+        displacements[bucket] = displacement;
+        for (size_t k = 0; k < keys.size(); k++) {
+            slots[bucket_slots[k]] = keys[k];
+        }
+    }
+
+    // Serialize the components in slot order
+    auto component_data = std::vector<uint32_t>();
+    component_data.reserve(5 * ncomponents);
+    auto atoms_data = std::vector<uint32_t>();
+    auto bonds_data = std::vector<uint16_t>();
+    for (auto index: slots) {
+        const auto& component = components[index];
+        if (component.atoms.size() >= UINT16_MAX) {
+            throw format_error("too many atoms in component '{}'", component.name);
+        }
+
+        auto atom_indexes = std::unordered_map<std::string, uint16_t>();
+        auto first_atom = static_cast<uint32_t>(atoms_data.size());
+        for (const auto& atom: component.atoms) {
+            atom_indexes.emplace(atom, static_cast<uint16_t>(atoms_data.size() - first_atom));
+            atoms_data.push_back(add_string(atom));
+        }
+
+        auto first_bond = static_cast<uint32_t>(bonds_data.size() / 4);
+        for (const auto& bond: component.bonds) {
+            auto i = atom_indexes.find(bond.first[0]);
+            auto j = atom_indexes.find(bond.first[1]);
+            if (i == atom_indexes.end() || j == atom_indexes.end() || i->second == j->second) {
+                throw format_error(
+                    "invalid bond between '{}' and '{}' in component '{}'",
+                    bond.first[0], bond.first[1], component.name
+                );
+            }
+            bonds_data.push_back(i->second);
+            bonds_data.push_back(j->second);
+            bonds_data.push_back(static_cast<uint16_t>(bond.second));
+            bonds_data.push_back(0);
+        }
+
+        auto natoms = static_cast<uint32_t>(component.atoms.size());
+        if (component.polymer) {
+            natoms |= POLYMER_FLAG;
+        }
+
+        component_data.push_back(add_string(component.name));
+        component_data.push_back(first_atom);
+        component_data.push_back(natoms);
+        component_data.push_back(first_bond);
+        component_data.push_back(static_cast<uint32_t>(component.bonds.size()));
+    }
+
+    if (strings.size() > UINT32_MAX || atoms_data.size() > UINT32_MAX || bonds_data.size() / 4 > UINT32_MAX) {
+        throw format_error("the component dictionary in '{}' is too large", input);
+    }
+
+    auto file = LittleEndianFile(output, File::WRITE);
+    file.write_char(MAGIC, sizeof(MAGIC));
+    file.write_single_u32(VERSION);
+    file.write_single_u32(static_cast<uint32_t>(ncomponents));
+    file.write_single_u32(nbuckets);
+    file.write_single_u32(static_cast<uint32_t>(atoms_data.size()));
+    file.write_single_u32(static_cast<uint32_t>(bonds_data.size() / 4));
+    file.write_single_u32(static_cast<uint32_t>(strings.size()));
+
+    file.write_u32(displacements.data(), displacements.size());
+    file.write_u32(component_data.data(), component_data.size());
+    file.write_u32(atoms_data.data(), atoms_data.size());
+    file.write_u16(bonds_data.data(), bonds_data.size());
+    file.write_char(strings.data(), strings.size());
+}
+
+/******************************************************************************/
+
+static mutex<std::shared_ptr<const ComponentDictionary>>& global_dictionary() {
+    static mutex<std::shared_ptr<const ComponentDictionary>> instance;
+    return instance;
+}
+
+std::shared_ptr<const ComponentDictionary> ComponentDictionary::global() {
+    return *global_dictionary().lock();
+}
+
+void chemfiles::load_component_dictionary(const std::string& path) {
+    if (path.empty()) {
+        *global_dictionary().lock() = nullptr;
+        return;
+    }
+
+    auto dictionary = std::make_shared<const ComponentDictionary>(path);
+    *global_dictionary().lock() = std::move(dictionary);
+}
+
+void chemfiles::build_component_dictionary(const std::string& input, const std::string& output) {
+    ComponentDictionary::build(input, output);
+}
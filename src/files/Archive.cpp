@@ -0,0 +1,571 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/mutex.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/external/optional.hpp"
+
+#include "chemfiles/files/Archive.hpp"
+#include "chemfiles/files/BinaryFile.hpp"
+#include "chemfiles/files/MemoryBuffer.hpp"
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace chemfiles;
+
+static constexpr size_t TAR_BLOCK_SIZE = 512;
+
+static constexpr uint32_t ZIP_LOCAL_HEADER = 0x04034b50;
+static constexpr uint32_t ZIP_CENTRAL_HEADER = 0x02014b50;
+static constexpr uint32_t ZIP_END_OF_CENTRAL_DIRECTORY = 0x06054b50;
+static constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY = 0x06064b50;
+static constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR = 0x07064b50;
+static constexpr size_t ZIP_END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+static constexpr uint16_t ZIP_STORED = 0;
+static constexpr uint16_t ZIP_DEFLATE = 8;
+
+/// Maximal number of archives kept in `Archive::open` cache
+static constexpr size_t MAX_CACHED_ARCHIVES = 4;
+
+static bool ends_with(const std::string& string, std::string_view suffix) {
+    return string.size() >= suffix.size() &&
+           std::string_view(string).substr(string.size() - suffix.size()) == suffix;
+}
+
+/// Get the compression used by a tar archive from its extension
+static File::Compression tar_compression(const std::string& path) {
+    if (ends_with(path, ".tar.gz") || ends_with(path, ".tgz")) {
+        return File::GZIP;
+    } else if (ends_with(path, ".tar.xz") || ends_with(path, ".txz")) {
+        return File::LZMA;
+    } else if (ends_with(path, ".tar.bz2") || ends_with(path, ".tbz2") || ends_with(path, ".tbz")) {
+        return File::BZIP2;
+    }
+    return File::DEFAULT;
+}
+
+static uint16_t read_u16(const char* data) {
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+}
+
+static uint32_t read_u32(const char* data) {
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    return static_cast<uint32_t>(bytes[0]) |
+           static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 |
+           static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+static uint64_t read_u64(const char* data) {
+    return static_cast<uint64_t>(read_u32(data)) |
+           static_cast<uint64_t>(read_u32(data + 4)) << 32;
+}
+
+/// Get a NULL-terminated string from a fixed size tar header field
+static std::string tar_string(const char* field, size_t size) {
+    auto end = static_cast<const char*>(std::memchr(field, '\0', size));
+    return std::string(field, end == nullptr ? size : static_cast<size_t>(end - field));
+}
+
+/// Parse a numeric tar header field, stored either as octal text or as a
+/// base-256 big-endian number when the highest bit of the first byte is set
+static optional<uint64_t> tar_number(const char* field, size_t size) {
+    auto bytes = reinterpret_cast<const uint8_t*>(field);
+    if (bytes[0] & 0x80) {
+        uint64_t value = bytes[0] & 0x7f;
+        for (size_t i = 1; i < size; i++) {
+            if (value >> 56 != 0) {
+                return nullopt;
+            }
+            value = value << 8 | bytes[i];
+        }
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < size && field[i] == ' ') {
+        i++;
+    }
+
+    uint64_t value = 0;
+    for (; i < size && field[i] != '\0' && field[i] != ' '; i++) {
+        if (field[i] < '0' || field[i] > '7' || value >> 61 != 0) {
+            return nullopt;
+        }
+        value = value * 8 + static_cast<uint64_t>(field[i] - '0');
+    }
+    return value;
+}
+
+/// Check the checksum of the tar header starting at `header`
+static bool tar_checksum_is_valid(const char* header) {
+    auto expected = tar_number(header + 148, 8);
+    if (!expected) {
+        return false;
+    }
+
+    // the checksum is computed with the checksum field filled with spaces.
+    // Some old implementations used signed char, so both are accepted.
+    uint64_t unsigned_sum = 8 * static_cast<uint64_t>(' ');
+    int64_t signed_sum = 8 * static_cast<int64_t>(' ');
+    for (size_t i = 0; i < TAR_BLOCK_SIZE; i++) {
+        if (i >= 148 && i < 156) {
+            continue;
+        }
+        unsigned_sum += static_cast<uint8_t>(header[i]);
+        signed_sum += static_cast<int8_t>(header[i]);
+    }
+    return *expected == unsigned_sum || static_cast<int64_t>(*expected) == signed_sum;
+}
+
+/// Get the value of the `path` record in pax extended header `data`. Records
+/// have the form `<length> <key>=<value>\n`.
+static optional<std::string> pax_path(std::string_view data) {
+    optional<std::string> path = nullopt;
+    while (!data.empty()) {
+        auto space = data.find(' ');
+        if (space == std::string_view::npos || space == 0) {
+            break;
+        }
+
+        size_t length = 0;
+        for (size_t i = 0; i < space; i++) {
+            if (data[i] < '0' || data[i] > '9') {
+                return path;
+            }
+            length = length * 10 + static_cast<size_t>(data[i] - '0');
+        }
+        if (length <= space + 1 || length > data.size()) {
+            break;
+        }
+
+        auto record = data.substr(space + 1, length - space - 2);
+        if (record.substr(0, 5) == "path=") {
+            path = std::string(record.substr(5));
+        }
+        data.remove_prefix(length);
+    }
+    return path;
+}
+
+/// Remove any leading `./` from a member name
+static std::string normalize_name(std::string name) {
+    while (name.size() > 2 && name[0] == '.' && name[1] == '/') {
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+Archive::Archive(const std::string& path): path_(path) {
+    zip_ = ends_with(path, ".zip");
+    auto compression = tar_compression(path);
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (compression == File::DEFAULT) {
+        auto file_descriptor = ::open(path.c_str(), O_RDONLY);
+        if (file_descriptor == -1) {
+            throw file_error("could not open the archive at '{}': {}", path, std::strerror(errno));
+        }
+
+        struct stat file_stat;
+        if (fstat(file_descriptor, &file_stat) < 0) {
+            close(file_descriptor);
+            throw file_error("could not get the file size with fstat: {}", std::strerror(errno));
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+
+        if (size_ != 0) {
+            auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            close(file_descriptor);
+            if (data == MAP_FAILED) {
+                throw file_error("mmap failed for '{}': {}", path, std::strerror(errno));
+            }
+            data_ = static_cast<const char*>(data);
+            mapped_ = true;
+        } else {
+            close(file_descriptor);
+        }
+    }
+#endif
+
+    if (!mapped_ && size_ == 0) {
+        auto file = LittleEndianFile(path, File::READ);
+        buffer_.resize(static_cast<size_t>(file.file_size()));
+        file.read_char(buffer_);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    if (compression != File::DEFAULT && size_ != 0) {
+        auto memory = MemoryBuffer(data_, size_);
+        memory.decompress(compression);
+        decompressed_ = std::make_unique<MemoryBuffer>(std::move(memory));
+        data_ = decompressed_->data();
+        size_ = decompressed_->size();
+
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+    try {
+        if (zip_) {
+            this->index_zip();
+        } else {
+            this->index_tar();
+        }
+    } catch (...) {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+        if (mapped_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+        throw;
+    }
+}
+
+Archive::~Archive() {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+void Archive::add_member(std::string name, Member member) {
+    name = normalize_name(std::move(name));
+    if (name.empty() || name.back() == '/') {
+        return;
+    }
+
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        // the last entry wins, as when extracting the archive
+        it->second = member;
+        return;
+    }
+
+    index_.emplace(name, member);
+    names_.emplace_back(std::move(name));
+}
+
+void Archive::index_tar() {
+    size_t offset = 0;
+    optional<std::string> long_name = nullopt;
+    while (offset + TAR_BLOCK_SIZE <= size_) {
+        const char* header = data_ + offset;
+        bool empty = std::all_of(header, header + TAR_BLOCK_SIZE, [](char c) { return c == '\0'; });
+        if (empty) {
+            // end of archive marker
+            break;
+        }
+
+        if (!tar_checksum_is_valid(header)) {
+            throw format_error(
+                "invalid tar archive at '{}': wrong header checksum at offset {}",
+                path_, offset
+            );
+        }
+
+        auto size = tar_number(header + 124, 12);
+        if (!size || *size > size_ - offset - TAR_BLOCK_SIZE) {
+            throw format_error(
+                "invalid tar archive at '{}': invalid member size at offset {}",
+                path_, offset
+            );
+        }
+
+        auto data = offset + TAR_BLOCK_SIZE;
+        auto type = header[156];
+        if (type == 'L') {
+            // GNU long name for the next member
+            long_name = tar_string(data_ + data, static_cast<size_t>(*size));
+        } else if (type == 'x') {
+            // pax extended header for the next member
+            auto path = pax_path(std::string_view(data_ + data, static_cast<size_t>(*size)));
+            if (path) {
+                long_name = std::move(path);
+            }
+        } else if (type == '0' || type == '\0' || type == '7') {
+            std::string name;
+            if (long_name) {
+                name = std::move(*long_name);
+            } else {
+                name = tar_string(header, 100);
+                auto prefix = tar_string(header + 345, 155);
+                if (std::memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty()) {
+                    name = prefix + "/" + name;
+                }
+            }
+            this->add_member(std::move(name), Member{data, *size, *size, ZIP_STORED});
+            long_name = nullopt;
+        } else if (type != 'g') {
+            // directories, links, devices, ... are not readable members
+            long_name = nullopt;
+        }
+
+        auto blocks = (*size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE;
+        offset = data + static_cast<size_t>(blocks * TAR_BLOCK_SIZE);
+    }
+
+    if (offset < size_ && offset + TAR_BLOCK_SIZE > size_) {
+        throw format_error("invalid tar archive at '{}': truncated header at offset {}", path_, offset);
+    }
+}
+
+void Archive::index_zip() {
+    if (size_ < ZIP_END_OF_CENTRAL_DIRECTORY_SIZE) {
+        throw format_error("invalid zip archive at '{}': the file is too small", path_);
+    }
+
+    // the end of central directory record is at the end of the file, followed
+    // by a comment of up to 65535 bytes
+    auto min_offset = size_ > 0xFFFF + ZIP_END_OF_CENTRAL_DIRECTORY_SIZE ? size_ - 0xFFFF - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE : 0;
+    auto end = size_ - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE;
+    while (read_u32(data_ + end) != ZIP_END_OF_CENTRAL_DIRECTORY) {
+        if (end == min_offset) {
+            throw format_error(
+                "invalid zip archive at '{}': could not find the central directory", path_
+            );
+        }
+        end--;
+    }
+
+    uint64_t count = read_u16(data_ + end + 10);
+    uint64_t directory_size = read_u32(data_ + end + 12);
+    uint64_t directory_offset = read_u32(data_ + end + 16);
+
+    if (count == 0xFFFF || directory_size == 0xFFFFFFFF || directory_offset == 0xFFFFFFFF) {
+        // zip64 archive, the values are in the zip64 end of central directory
+        if (end < 20 || read_u32(data_ + end - 20) != ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR) {
+            throw format_error(
+                "invalid zip archive at '{}': missing zip64 end of central directory", path_
+            );
+        }
+        auto zip64_end = read_u64(data_ + end - 20 + 8);
+        if (size_ < 56 || zip64_end > size_ - 56 || read_u32(data_ + zip64_end) != ZIP64_END_OF_CENTRAL_DIRECTORY) {
+            throw format_error(
+                "invalid zip archive at '{}': invalid zip64 end of central directory", path_
+            );
+        }
+        count = read_u64(data_ + zip64_end + 32);
+        directory_size = read_u64(data_ + zip64_end + 40);
+        directory_offset = read_u64(data_ + zip64_end + 48);
+    }
+
+    if (directory_offset > size_ || directory_size > size_ - directory_offset) {
+        throw format_error("invalid zip archive at '{}': invalid central directory", path_);
+    }
+
+    auto offset = static_cast<size_t>(directory_offset);
+    auto directory_end = static_cast<size_t>(directory_offset + directory_size);
+    for (uint64_t i = 0; i < count; i++) {
+        if (offset + 46 > directory_end || read_u32(data_ + offset) != ZIP_CENTRAL_HEADER) {
+            throw format_error(
+                "invalid zip archive at '{}': invalid central directory entry", path_
+            );
+        }
+
+        auto method = read_u16(data_ + offset + 10);
+        uint64_t stored_size = read_u32(data_ + offset + 20);
+        uint64_t size = read_u32(data_ + offset + 24);
+        auto name_length = read_u16(data_ + offset + 28);
+        auto extra_length = read_u16(data_ + offset + 30);
+        auto comment_length = read_u16(data_ + offset + 32);
+        uint64_t local_offset = read_u32(data_ + offset + 42);
+
+        auto next = offset + 46 + name_length + extra_length + comment_length;
+        if (next > directory_end) {
+            throw format_error(
+                "invalid zip archive at '{}': invalid central directory entry", path_
+            );
+        }
+
+        auto name = std::string(data_ + offset + 46, name_length);
+
+        // the zip64 extra field contains the values which did not fit in 32
+        // bits, in this order
+        auto extra = offset + 46 + name_length;
+        auto extra_end = extra + extra_length;
+        while (extra + 4 <= extra_end) {
+            auto id = read_u16(data_ + extra);
+            auto length = read_u16(data_ + extra + 2);
+            if (extra + 4 + length > extra_end) {
+                break;
+            }
+
+            if (id == 0x0001) {
+                auto field = extra + 4;
+                auto field_end = field + length;
+                for (auto value: {&size, &stored_size, &local_offset}) {
+                    if (*value == 0xFFFFFFFF && field + 8 <= field_end) {
+                        *value = read_u64(data_ + field);
+                        field += 8;
+                    }
+                }
+            }
+            extra += 4 + length;
+        }
+
+        if (local_offset > size_ || stored_size > size_) {
+            throw format_error(
+                "invalid zip archive at '{}': invalid offset for '{}'", path_, name
+            );
+        }
+
+        this->add_member(std::move(name), Member{local_offset, stored_size, size, method});
+        offset = next;
+    }
+}
+
+uint64_t Archive::zip_data_offset(const std::string& name, const Member& member) const {
+    auto offset = static_cast<size_t>(member.offset);
+    if (offset + 30 > size_ || read_u32(data_ + offset) != ZIP_LOCAL_HEADER) {
+        throw file_error(
+            "invalid zip archive at '{}': invalid local header for '{}'", path_, name
+        );
+    }
+
+    if (read_u16(data_ + offset + 6) & 0x0001) {
+        throw file_error("can not read '{}' in '{}': encrypted files are not supported", name, path_);
+    }
+
+    auto name_length = read_u16(data_ + offset + 26);
+    auto extra_length = read_u16(data_ + offset + 28);
+    auto data = member.offset + 30 + name_length + extra_length;
+    if (data > size_ || member.stored_size > size_ - data) {
+        throw file_error(
+            "invalid zip archive at '{}': '{}' is truncated", path_, name
+        );
+    }
+    return data;
+}
+
+std::shared_ptr<MemoryBuffer> Archive::read(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        throw file_error("could not find '{}' in the archive at '{}'", name, path_);
+    }
+    const auto& member = it->second;
+
+    auto offset = member.offset;
+    if (zip_) {
+        offset = this->zip_data_offset(name, member);
+    }
+    const char* data = data_ + offset;
+    auto stored_size = static_cast<size_t>(member.stored_size);
+
+    if (member.method == ZIP_STORED) {
+        // +1 to always have a NULL byte at the end of the buffer
+        auto buffer = std::make_shared<MemoryBuffer>(stored_size + 1);
+        buffer->write(data, stored_size);
+        return buffer;
+    } else if (member.method == ZIP_DEFLATE) {
+        return std::make_shared<MemoryBuffer>(
+            decompress_deflate(data, stored_size, static_cast<size_t>(member.size))
+        );
+    } else {
+        throw file_error(
+            "can not read '{}' in '{}': unsupported zip compression method {}",
+            name, path_, member.method
+        );
+    }
+}
+
+bool Archive::is_archive(const std::string& path) {
+    return ends_with(path, ".tar") || ends_with(path, ".zip") ||
+           tar_compression(path) != File::DEFAULT;
+}
+
+optional<std::pair<std::string, std::string>> Archive::split_path(const std::string& path) {
+    auto separator = std::string_view(ARCHIVE_MEMBER_SEPARATOR);
+    auto position = path.find(separator);
+    while (position != std::string::npos) {
+        auto archive = path.substr(0, position);
+        auto member = path.substr(position + separator.size());
+        if (!member.empty() && is_archive(archive)) {
+            return std::make_pair(std::move(archive), std::move(member));
+        }
+        position = path.find(separator, position + 1);
+    }
+    return nullopt;
+}
+
+namespace {
+    struct CachedArchive {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+        std::shared_ptr<const Archive> archive;
+    };
+}
+
+std::shared_ptr<const Archive> Archive::open(const std::string& path) {
+    static mutex<std::list<CachedArchive>> CACHE;
+
+    std::error_code error;
+    auto canonical = std::filesystem::canonical(path, error);
+    auto size = error ? 0 : std::filesystem::file_size(canonical, error);
+    auto mtime = error ? std::filesystem::file_time_type() : std::filesystem::last_write_time(canonical, error);
+    if (error) {
+        // let the constructor produce the error message
+        return std::make_shared<const Archive>(path);
+    }
+
+    auto entry = CachedArchive{
+        canonical.string(),
+        static_cast<uint64_t>(size),
+        static_cast<int64_t>(mtime.time_since_epoch().count()),
+        nullptr,
+    };
+
+    {
+        auto cache = CACHE.lock();
+        for (auto it = cache->begin(); it != cache->end(); it++) {
+            if (it->path == entry.path) {
+                if (it->size == entry.size && it->mtime == entry.mtime) {
+                    // move the entry to the front of the list
+                    cache->splice(cache->begin(), *cache, it);
+                    return cache->front().archive;
+                }
+                cache->erase(it);
+                break;
+            }
+        }
+    }
+
+    // index the archive outside of the lock, to allow other threads to use
+    // other archives
+    entry.archive = std::make_shared<const Archive>(path);
+    auto archive = entry.archive;
+
+    auto cache = CACHE.lock();
+    // another thread might have indexed the same archive in the meantime
+    cache->remove_if([&](const CachedArchive& cached) { return cached.path == entry.path; });
+    cache->push_front(std::move(entry));
+    if (cache->size() > MAX_CACHED_ARCHIVES) {
+        cache->pop_back();
+    }
+
+    return archive;
+}
@@ -2,6 +2,7 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <type_traits>
 
 #include "chemfiles/error_fmt.hpp"
@@ -17,6 +18,8 @@
 
 #ifdef CHEMFILES_WINDOWS
 #include <io.h>
+#else
+#include <unistd.h>
 #endif
 
 #ifdef __CYGWIN__
@@ -42,6 +45,12 @@
     #include <unistd.h>
 #endif
 
+#if !defined(CHEMFILES_WINDOWS) && defined(POSIX_FADV_NORMAL)
+    #define CHEMFILES_HAS_FADVISE 1
+#else
+    #define CHEMFILES_HAS_FADVISE 0
+#endif
+
 using namespace chemfiles;
 
 BinaryFile::BinaryFile(std::string path, File::Mode mode):
@@ -169,6 +178,7 @@ BinaryFile& BinaryFile::operator=(BinaryFile&& other) noexcept {
 #else
     std::swap(this->file_, other.file_);
 #endif
+    std::swap(this->access_pattern_, other.access_pattern_);
 
     return *this;
 }
@@ -388,6 +398,230 @@ uint64_t BinaryFile::file_size() {
 #endif
 }
 
+uint64_t BinaryFile::refresh() {
+    if (this->mode() != File::READ) {
+        throw file_error(
+            "can not refresh the file at '{}', it was not opened in read mode",
+            this->path()
+        );
+    }
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    struct stat file_stat;
+    auto status = fstat(file_descriptor_, &file_stat);
+    if (status < 0) {
+        throw file_error("could not get the file size with fstat: {}", std::strerror(errno));
+    }
+
+    auto size = static_cast<size_t>(file_stat.st_size);
+    if (size != file_size_) {
+        // the mapping only covers the file as it was when mapped, create a
+        // new one with the updated size
+        if (mmap_data_ != nullptr) {
+            status = munmap(mmap_data_, mmap_size_);
+            if (status != 0) {
+                throw file_error("failed to unmap file: {}", std::strerror(errno));
+            }
+            mmap_data_ = nullptr;
+        }
+
+        file_size_ = size;
+        mmap_size_ = size;
+        total_written_size_ = size;
+
+        if (size != 0) {
+            mmap_data_ = static_cast<char*>(mmap(
+                nullptr, mmap_size_, mmap_prot_, MAP_SHARED, file_descriptor_, 0
+            ));
+
+            if (mmap_data_ == MAP_FAILED) {
+                mmap_data_ = nullptr;
+                throw file_error("mmap failed for '{}': {}", this->path(), std::strerror(errno));
+            }
+
+            // the hints only apply to the previous mapping
+            if (access_pattern_ != AccessPattern::NORMAL) {
+                this->set_access_pattern(access_pattern_);
+            }
+        }
+    }
+    return file_size_;
+#else
+    // clear the end of file indicator, and drop any buffered data by seeking
+    // to the current position
+    std::clearerr(file_);
+    this->seek(this->tell());
+    return this->file_size();
+#endif
+}
+
+/// Maximal size of the data requested at once by `BinaryFile::prefetch`
+static constexpr uint64_t PREFETCH_CHUNK_SIZE = 64 * 1024 * 1024;
+
+void BinaryFile::prefetch(const std::vector<Range>& ranges, const std::function<void(size_t)>& callback) {
+    // group the ranges in chunks of limited size, containing at least one
+    // range, and return the end of the chunk starting at `start`
+    auto chunk_end = [&](size_t start) {
+        uint64_t total = ranges[start].size;
+        size_t stop = start + 1;
+        while (stop < ranges.size() && total + ranges[stop].size <= PREFETCH_CHUNK_SIZE) {
+            total += ranges[stop].size;
+            stop++;
+        }
+        return stop;
+    };
+
+    // request the data of a chunk from the operating system, which reads it
+    // in the background while the previous chunk is decoded. The decoders
+    // then find the data in the cache, without reading it a second time.
+    auto request = [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            this->will_need(ranges[i]);
+        }
+    };
+
+    if (ranges.empty()) {
+        return;
+    }
+
+    size_t start = 0;
+    size_t stop = chunk_end(start);
+    request(start, stop);
+    while (start < ranges.size()) {
+        size_t next_stop = stop;
+        if (stop < ranges.size()) {
+            next_stop = chunk_end(stop);
+            request(stop, next_stop);
+        }
+
+        for (size_t i = start; i < stop; i++) {
+            callback(i);
+        }
+        start = stop;
+        stop = next_stop;
+    }
+}
+
+#ifndef CHEMFILES_WINDOWS
+int BinaryFile::native_fd() const {
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    return file_descriptor_;
+#else
+    return fileno(file_);
+#endif
+}
+#endif
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+static int madvise_advice(AccessPattern pattern) {
+    switch (pattern) {
+    case AccessPattern::NORMAL:
+        return MADV_NORMAL;
+    case AccessPattern::SEQUENTIAL:
+    case AccessPattern::STREAMING:
+        return MADV_SEQUENTIAL;
+    case AccessPattern::RANDOM:
+        return MADV_RANDOM;
+    }
+    unreachable();
+}
+#endif
+
+#if CHEMFILES_HAS_FADVISE
+static int fadvise_advice(AccessPattern pattern) {
+    switch (pattern) {
+    case AccessPattern::NORMAL:
+        return POSIX_FADV_NORMAL;
+    case AccessPattern::SEQUENTIAL:
+    case AccessPattern::STREAMING:
+        return POSIX_FADV_SEQUENTIAL;
+    case AccessPattern::RANDOM:
+        return POSIX_FADV_RANDOM;
+    }
+    unreachable();
+}
+#endif
+
+// All the functions below only give hints to the operating system, and ignore
+// errors from madvise/posix_fadvise.
+
+void BinaryFile::set_access_pattern(AccessPattern pattern) {
+    access_pattern_ = pattern;
+    if (this->mode() != File::READ) {
+        return;
+    }
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (mmap_data_ != nullptr) {
+        madvise(mmap_data_, mmap_size_, madvise_advice(pattern));
+    }
+#endif
+
+#if CHEMFILES_HAS_FADVISE
+    posix_fadvise(this->native_fd(), 0, 0, fadvise_advice(pattern));
+#endif
+}
+
+void BinaryFile::will_need(Range range) {
+    if (this->mode() != File::READ || range.size == 0) {
+        return;
+    }
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (mmap_data_ != nullptr && range.offset < mmap_size_) {
+        auto start = range.offset - range.offset % page_size_;
+        auto end = std::min<uint64_t>(range.offset + range.size, mmap_size_);
+        madvise(mmap_data_ + start, static_cast<size_t>(end - start), MADV_WILLNEED);
+    }
+#elif CHEMFILES_HAS_FADVISE
+    posix_fadvise(
+        this->native_fd(),
+        static_cast<off_t>(range.offset),
+        static_cast<off_t>(range.size),
+        POSIX_FADV_WILLNEED
+    );
+#endif
+}
+
+void BinaryFile::drop_cache(Range range) {
+    if (this->mode() != File::READ || range.size == 0) {
+        return;
+    }
+
+#if CHEMFILES_BINARY_FILE_USE_MMAP
+    if (mmap_data_ != nullptr && range.offset < mmap_size_) {
+        // only unmap the pages entirely inside the range, the data around it
+        // might still be used
+        auto start = range.offset + (page_size_ - range.offset % page_size_) % page_size_;
+        auto end = std::min<uint64_t>(range.offset + range.size, mmap_size_);
+        if (end != mmap_size_) {
+            end -= end % page_size_;
+        }
+        if (start < end) {
+            madvise(mmap_data_ + start, static_cast<size_t>(end - start), MADV_DONTNEED);
+        }
+    }
+#endif
+
+#if CHEMFILES_HAS_FADVISE
+    posix_fadvise(
+        this->native_fd(),
+        static_cast<off_t>(range.offset),
+        static_cast<off_t>(range.size),
+        POSIX_FADV_DONTNEED
+    );
+#endif
+}
+
+void BinaryFile::sequential_hints(Range current, Range next) {
+    if (access_pattern_ == AccessPattern::STREAMING) {
+        this->drop_cache(current);
+    }
+
+    if (access_pattern_ == AccessPattern::SEQUENTIAL || access_pattern_ == AccessPattern::STREAMING) {
+        this->will_need(next);
+    }
+}
 
 /******************************************************************************/
 
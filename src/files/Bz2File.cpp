@@ -65,15 +65,23 @@ Bz2File::Bz2File(const std::string& path, File::Mode mode): TextFileImpl(path),
         openmode = "rb";
         stream_end_ = BZ2_bzDecompressEnd;
         check(BZ2_bzDecompressInit(&stream_, 0, 0));
-    } else if (mode == File::WRITE) {
-        openmode = "wb";
+    } else {
         stream_end_ = BZ2_bzCompressEnd;
         check(BZ2_bzCompressInit(&stream_, 6, 0, 0));
 
         stream_.next_out = buffer_.data();
         stream_.avail_out = checked_cast(buffer_.size());
-    } else if (mode == File::APPEND) {
-        throw file_error("appending (open mode 'a') is not supported with bzip2 files");
+
+        if (mode == File::WRITE) {
+            openmode = "wb";
+            // always write a stream, to get a valid bzip2 file even if it is
+            // empty
+            unfinished_ = true;
+        } else {
+            // new data is written in a separate bzip2 stream at the end of
+            // the file, without reading the existing streams
+            openmode = "ab";
+        }
     }
 
     file_ = std::fopen(path.c_str(), openmode);
@@ -84,7 +92,7 @@ Bz2File::Bz2File(const std::string& path, File::Mode mode): TextFileImpl(path),
 }
 
 Bz2File::~Bz2File() {
-    if (mode_ == File::WRITE) {
+    if (unfinished_) {
         compress_and_write(BZ_FINISH);
     }
 
@@ -112,7 +120,20 @@ size_t Bz2File::read(char* data, size_t count) {
         auto status = BZ2_bzDecompress(&stream_);
 
         if (status == BZ_STREAM_END) {
-            return count - stream_.avail_out;
+            if (stream_.avail_in == 0 && !std::feof(file_)) {
+                stream_.next_in = buffer_.data();
+                stream_.avail_in = checked_cast(std::fread(buffer_.data(), 1, buffer_.size(), file_));
+                if (std::ferror(file_)) {
+                    throw file_error("IO error while reading bzip2 file");
+                }
+            }
+
+            if (stream_.avail_in == 0) {
+                return count - stream_.avail_out;
+            }
+
+            // multiple bzip2 streams, as created when appending to a file
+            restart_decompression();
         } else {
             // Check for error
             check(status);
@@ -121,6 +142,22 @@ size_t Bz2File::read(char* data, size_t count) {
     return count;
 }
 
+void Bz2File::restart_decompression() {
+    auto next_in = stream_.next_in;
+    auto avail_in = stream_.avail_in;
+    auto next_out = stream_.next_out;
+    auto avail_out = stream_.avail_out;
+
+    check(BZ2_bzDecompressEnd(&stream_));
+    std::memset(&stream_, 0, sizeof(bz_stream));
+    check(BZ2_bzDecompressInit(&stream_, 0, 0));
+
+    stream_.next_in = next_in;
+    stream_.avail_in = avail_in;
+    stream_.next_out = next_out;
+    stream_.avail_out = avail_out;
+}
+
 void Bz2File::clear() noexcept {
     std::clearerr(file_);
 }
@@ -158,6 +195,26 @@ void Bz2File::write(const char* data, size_t count) {
     if (actual != count) {
         throw file_error("could not write data to the file at '{}'", this->path());
     }
+    unfinished_ = true;
+}
+
+void Bz2File::flush() {
+    if (mode_ == File::READ || !unfinished_) {
+        return;
+    }
+
+    // finish the current stream, and start a new one for the next writes
+    compress_and_write(BZ_FINISH);
+    unfinished_ = false;
+    check(BZ2_bzCompressEnd(&stream_));
+    std::memset(&stream_, 0, sizeof(bz_stream));
+    check(BZ2_bzCompressInit(&stream_, 6, 0, 0));
+    stream_.next_out = buffer_.data();
+    stream_.avail_out = checked_cast(buffer_.size());
+
+    if (std::fflush(file_) != 0) {
+        throw file_error("error while flushing bzip2 file");
+    }
 }
 
 void Bz2File::compress_and_write(int action) {
@@ -200,10 +257,13 @@ MemoryBuffer chemfiles::decompress_bz2(const char* src, size_t size) {
     stream.bzfree = nullptr;
     check(BZ2_bzDecompressInit(&stream, 0, 0));
 
+    // total size of the data from previous bzip2 streams, since the
+    // counters in `stream` are reset for each stream
+    uint64_t previous = 0;
     bool done = false;
     do {
         // if we need more space, resize the vector
-        auto total_out = full_total_out(stream);
+        auto total_out = previous + full_total_out(stream);
         if (total_out >= output.capacity()) {
             output.reserve_extra(output.capacity());
         }
@@ -212,7 +272,17 @@ MemoryBuffer chemfiles::decompress_bz2(const char* src, size_t size) {
         stream.avail_out = checked_cast(output.capacity() - total_out);
 
         auto status = BZ2_bzDecompress(&stream);
-        if (status == BZ_STREAM_END) {
+        if (status == BZ_STREAM_END && stream.avail_in != 0) {
+            // multiple bzip2 streams, as created when appending to a file
+            previous += full_total_out(stream);
+            auto next_in = stream.next_in;
+            auto avail_in = stream.avail_in;
+            check(BZ2_bzDecompressEnd(&stream));
+            std::memset(&stream, 0, sizeof(bz_stream));
+            stream.next_in = next_in;
+            stream.avail_in = avail_in;
+            check(BZ2_bzDecompressInit(&stream, 0, 0));
+        } else if (status == BZ_STREAM_END) {
 		    done = true;
         } else if (status != BZ_OK) {
 		    BZ2_bzDecompressEnd(&stream);
@@ -222,7 +292,7 @@ MemoryBuffer chemfiles::decompress_bz2(const char* src, size_t size) {
 
     check(BZ2_bzDecompressEnd(&stream));
 
-    auto total_out = full_total_out(stream);
+    auto total_out = previous + full_total_out(stream);
     if (total_out >= output.capacity()) {
         // make sure the buffer always contains a terminal NULL
         output.reserve_extra(1);
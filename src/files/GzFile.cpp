@@ -72,6 +72,21 @@ void GzFile::write(const char* data, size_t count) {
     if (static_cast<size_t>(actual) != count) {
         throw file_error("could not write data to the file at '{}'", this->path());
     }
+    written_ = true;
+}
+
+void GzFile::flush() {
+    if (!written_) {
+        return;
+    }
+
+    // zlib starts a new gzip member on the next write
+    auto status = gzflush(file_, Z_FINISH);
+    if (status != Z_OK) {
+        auto message = check_error();
+        throw file_error("error while flushing gziped file: {}", message);
+    }
+    written_ = false;
 }
 
 const char* GzFile::check_error() const {
@@ -115,18 +130,30 @@ MemoryBuffer chemfiles::decompress_gz(const char* src, size_t size) {
 	    throw file_error("error creating gz stream: {}", stream.msg);
     }
 
+    // total size of the data from previous gzip members, since
+    // `stream.total_out` is reset for each member
+    size_t previous = 0;
     bool done = false;
     do {
+        auto total_out = previous + stream.total_out;
         // if we need more space, resize the vector
-        if (stream.total_out >= output.capacity()) {
+        if (total_out >= output.capacity()) {
             output.reserve_extra(output.capacity());
         }
 
-	    stream.next_out = reinterpret_cast<Bytef*>(output.data_mut() + stream.total_out);
-        stream.avail_out = checked_cast(output.capacity() - stream.total_out);
+	    stream.next_out = reinterpret_cast<Bytef*>(output.data_mut() + total_out);
+        stream.avail_out = checked_cast(output.capacity() - total_out);
 
         status = inflate(&stream, Z_SYNC_FLUSH);
-        if (status == Z_STREAM_END) {
+        if (status == Z_STREAM_END && stream.avail_in != 0) {
+            // multiple gzip members, as created when appending to a file
+            previous += stream.total_out;
+            status = inflateReset(&stream);
+            if (status != Z_OK) {
+                inflateEnd(&stream);
+                throw file_error("error resetting gz stream: {}", stream.msg);
+            }
+        } else if (status == Z_STREAM_END) {
 		    done = true;
         } else if (status != Z_OK) {
 		    inflateEnd(&stream);
@@ -139,10 +166,51 @@ MemoryBuffer chemfiles::decompress_gz(const char* src, size_t size) {
 	    throw file_error("error finishing gz stream: {}", stream.msg);
     }
 
-    if (stream.total_out >= output.capacity()) {
+    auto total_out = previous + stream.total_out;
+    if (total_out >= output.capacity()) {
         // make sure the buffer always contains a terminal NULL
         output.reserve_extra(1);
     }
+    output.set_size(total_out);
+    return output;
+}
+
+MemoryBuffer chemfiles::decompress_deflate(const char* src, size_t size, size_t decompressed_size) {
+    // +1 to always have a terminal NULL in the buffer
+    auto output = MemoryBuffer(decompressed_size + 1);
+
+    z_stream stream;
+    stream.next_in = reinterpret_cast<const Bytef*>(src);
+    stream.avail_in = checked_cast(size);
+    stream.next_out = reinterpret_cast<Bytef*>(output.data_mut());
+    stream.avail_out = checked_cast(decompressed_size);
+    stream.total_out = 0;
+    stream.zalloc = nullptr;
+    stream.zfree = nullptr;
+
+    // negative window size to read raw deflate data, without zlib or gzip
+    // header, as used in zip archives
+    auto status = inflateInit2(&stream, -15);
+    if (status != Z_OK) {
+        auto message = stream.msg != nullptr ? std::string(stream.msg) : std::string("unknown error");
+        throw file_error("error creating deflate stream: {}", message);
+    }
+
+    status = inflate(&stream, Z_FINISH);
+    if (status != Z_STREAM_END) {
+        auto message = stream.msg != nullptr ? std::string(stream.msg) : std::string("corrupted or truncated data");
+        inflateEnd(&stream);
+        throw file_error("error inflating deflated memory: {}", message);
+    }
+    inflateEnd(&stream);
+
+    if (stream.total_out != decompressed_size) {
+        throw file_error(
+            "error inflating deflated memory: expected {} bytes, got {}",
+            decompressed_size, stream.total_out
+        );
+    }
+
     output.set_size(stream.total_out);
     return output;
 }
@@ -11,6 +11,7 @@
 #include "chemfiles/files/MemoryBuffer.hpp"
 
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/external/optional.hpp"
 
 using namespace chemfiles;
 
@@ -26,6 +27,10 @@ void MemoryFile::seek(uint64_t position) {
     current_location_ = static_cast<size_t>(position);
 }
 
+optional<uint64_t> MemoryFile::size() {
+    return static_cast<uint64_t>(buffer_->size());
+}
+
 size_t MemoryFile::read(char* data, size_t count) {
     if (mode_ != File::READ) {
         throw file_error("cannot read a memory file unless it is opened in read mode");
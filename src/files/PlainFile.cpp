@@ -8,6 +8,7 @@
 
 #include "chemfiles/unreachable.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/files/PlainFile.hpp"
@@ -17,14 +18,17 @@ using namespace chemfiles;
 #ifdef __CYGWIN__
     #include <sys/types.h>
     #define fseek64 fseek
+    #define ftell64 ftell
     #define off64_t off_t
 #elif defined(_MSC_VER)
     #define fseek64 _fseeki64
+    #define ftell64 _ftelli64
     #define off64_t __int64
 #else
     // assume unix by default
     #include <sys/types.h>
     #define fseek64 fseeko
+    #define ftell64 ftello
     #define off64_t off_t
     static_assert(_FILE_OFFSET_BITS == 64, "_FILE_OFFSET_BITS must be 64");
 #endif
@@ -80,6 +84,26 @@ void PlainFile::seek(uint64_t position) {
     }
 }
 
+optional<uint64_t> PlainFile::size() {
+    auto position = ftell64(file_);
+    if (position < 0 || fseek64(file_, 0, SEEK_END) != 0) {
+        return nullopt;
+    }
+    auto size = ftell64(file_);
+
+    // go back to the initial position for the next read/write
+    auto status = fseek64(file_, position, SEEK_SET);
+    if (status != 0) {
+        auto message = std::strerror(errno);
+        throw file_error("error while seeking file: {}", message);
+    }
+
+    if (size < 0) {
+        return nullopt;
+    }
+    return static_cast<uint64_t>(size);
+}
+
 size_t PlainFile::read(char* data, size_t count) {
     auto result = std::fread(data, 1, count, file_);
 
@@ -96,3 +120,10 @@ void PlainFile::write(const char* data, size_t count) {
         throw file_error("could not write data to the file at '{}'", this->path());
     }
 }
+
+void PlainFile::flush() {
+    if (std::fflush(file_) != 0) {
+        auto message = std::strerror(errno);
+        throw file_error("error while flushing file: {}", message);
+    }
+}
@@ -1,6 +1,7 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cmath>
@@ -416,7 +417,7 @@ static const int MAGICINTS[] = {
 
 /***** from xdrfile (end) *****/
 
-float XDRFile::read_gmx_compressed_floats(std::vector<float>& data) {
+float XDRFile::read_gmx_compressed_floats(std::vector<float>& data, size_t count) {
     const float precision = read_single_f32();
     const int minint[3] = {
         read_single_i32(),
@@ -448,7 +449,10 @@ float XDRFile::read_gmx_compressed_floats(std::vector<float>& data) {
     intbuf_.resize(data.size());
 
     assert(data.size() % 3 == 0 && "internal Error: invalid allocation size");
-    const size_t natoms = data.size() / 3;
+    // atoms are stored sequentially, so we can stop decoding after the
+    // requested atoms. The whole compressed data was already read, so the
+    // file is still positioned after this frame.
+    const size_t natoms = std::min(data.size() / 3, count);
 
     DecodeState state = {0, 0, 0};
     int run = 0;
@@ -60,6 +60,12 @@ static void open_stream_read(lzma_stream* stream) {
     check(lzma_stream_decoder(stream, memory_limit, flags));
 }
 
+static void open_stream_write(lzma_stream* stream, std::vector<uint8_t>& buffer) {
+    check(lzma_easy_encoder(stream, 6, LZMA_CHECK_CRC64));
+    stream->next_out = buffer.data();
+    stream->avail_out = buffer.size();
+}
+
 XzFile::XzFile(const std::string& path, File::Mode mode): TextFileImpl(path), mode_(mode), buffer_(8192) {
     const char* openmode = nullptr;
     if (mode == File::READ) {
@@ -67,12 +73,14 @@ XzFile::XzFile(const std::string& path, File::Mode mode): TextFileImpl(path), mo
         open_stream_read(&stream_);
     } else if (mode == File::WRITE) {
         openmode = "wb";
-        check(lzma_easy_encoder(&stream_, 6, LZMA_CHECK_CRC64));
-
-        stream_.next_out = buffer_.data();
-        stream_.avail_out = buffer_.size();
+        open_stream_write(&stream_, buffer_);
+        // always write a stream, to get a valid xz file even if it is empty
+        unfinished_ = true;
     } else if (mode == File::APPEND) {
-        throw file_error("appending (open mode 'a') is not supported with xz files");
+        // new data is written in a separate xz stream at the end of the
+        // file, without reading the existing streams
+        openmode = "ab";
+        open_stream_write(&stream_, buffer_);
     }
 
     file_ = std::fopen(path.c_str(), openmode);
@@ -83,7 +91,7 @@ XzFile::XzFile(const std::string& path, File::Mode mode): TextFileImpl(path), mo
 }
 
 XzFile::~XzFile() {
-    if (mode_ == File::WRITE) {
+    if (unfinished_) {
         compress_and_write(LZMA_FINISH);
     }
 
@@ -163,6 +171,24 @@ void XzFile::write(const char* data, size_t count) {
     if (actual != count) {
         throw file_error("could not write data to the file at '{}'", this->path());
     }
+    unfinished_ = true;
+}
+
+void XzFile::flush() {
+    if (mode_ == File::READ || !unfinished_) {
+        return;
+    }
+
+    // finish the current stream, and start a new one for the next writes
+    compress_and_write(LZMA_FINISH);
+    unfinished_ = false;
+    lzma_end(&stream_);
+    stream_ = LZMA_STREAM_INIT;
+    open_stream_write(&stream_, buffer_);
+
+    if (std::fflush(file_) != 0) {
+        throw file_error("error while flushing xz file");
+    }
 }
 
 void XzFile::compress_and_write(lzma_action action) {
@@ -16,6 +16,7 @@
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/UnitCell.hpp"
 #include "chemfiles/FormatMetadata.hpp"
 
@@ -218,7 +219,7 @@ void AmberNetCDFBase::read_step(const size_t step, Frame& frame) {
     }
 }
 
-void AmberNetCDFBase::write(const Frame& frame) {
+void AmberNetCDFBase::write_view(const FrameView& frame) {
     if (!file_.initialized()) {
         this->initialize(frame);
 
@@ -379,17 +380,30 @@ void AmberNetCDFBase::write_cell(const UnitCell& cell) {
     }
 }
 
-void AmberNetCDFBase::write_array(variable_scale_t& variable, span<const Vector3D> array) {
+void AmberNetCDFBase::write_array(variable_scale_t& variable, const VectorsView& array) {
     if (variable.var->type() == netcdf3::constants::NC_FLOAT) {
         buffer_f32_.resize(3 * array.size());
         for (size_t i=0; i<n_atoms_; i++) {
-            buffer_f32_[3 * i + 0] = static_cast<float>(array[i][0]);
-            buffer_f32_[3 * i + 1] = static_cast<float>(array[i][1]);
-            buffer_f32_[3 * i + 2] = static_cast<float>(array[i][2]);
+            auto vector = array[i];
+            buffer_f32_[3 * i + 0] = static_cast<float>(vector[0]);
+            buffer_f32_[3 * i + 1] = static_cast<float>(vector[1]);
+            buffer_f32_[3 * i + 2] = static_cast<float>(vector[2]);
         }
         variable.var->write(step_, buffer_f32_);
     } else if (variable.var->type() == netcdf3::constants::NC_DOUBLE) {
-        variable.var->write(step_, &array[0][0], 3 * array.size());
+        auto data = array.contiguous();
+        if (data != nullptr) {
+            variable.var->write(step_, data, 3 * array.size());
+        } else {
+            buffer_f64_.resize(3 * array.size());
+            for (size_t i=0; i<n_atoms_; i++) {
+                auto vector = array[i];
+                buffer_f64_[3 * i + 0] = vector[0];
+                buffer_f64_[3 * i + 1] = vector[1];
+                buffer_f64_[3 * i + 2] = vector[2];
+            }
+            variable.var->write(step_, buffer_f64_.data(), buffer_f64_.size());
+        }
     } else {
         throw format_error("invalid type for variable, expected floating point");
     }
@@ -485,7 +499,7 @@ void AmberTrajectory::validate() {
     }
 }
 
-void AmberTrajectory::initialize(const Frame& frame) {
+void AmberTrajectory::initialize(const FrameView& frame) {
     netcdf3::Netcdf3Builder builder = base_builder(
         "AMBER",
         frame.get<Property::STRING>("name").value_or(""),
@@ -539,11 +553,11 @@ AmberRestart::AmberRestart(std::string path, File::Mode mode, File::Compression
     }
 }
 
-void AmberRestart::write(const Frame& frame) {
+void AmberRestart::write_view(const FrameView& frame) {
     if (step_ != 0) {
         throw format_error("AMBER Restart format only supports writing one frame");
     }
-    AmberNetCDFBase::write(frame);
+    AmberNetCDFBase::write_view(frame);
 }
 
 size_t AmberRestart::nsteps() {
@@ -607,7 +621,7 @@ void AmberRestart::validate() {
     }
 }
 
-void AmberRestart::initialize(const Frame& frame) {
+void AmberRestart::initialize(const FrameView& frame) {
     netcdf3::Netcdf3Builder builder = base_builder(
         "AMBERRESTART",
         frame.get<Property::STRING>("name").value_or(""),
@@ -0,0 +1,925 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <exception>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <msgpack.hpp>
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/parse.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/section_lines.hpp"
+#include "chemfiles/external/span.hpp"
+#include "chemfiles/external/optional.hpp"
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Residue.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/FormatMetadata.hpp"
+
+#include "chemfiles/files/MemoryBuffer.hpp"
+
+#include "chemfiles/formats/PDB.hpp"
+#include "chemfiles/formats/BinaryCIF.hpp"
+
+using namespace chemfiles;
+
+template<> const FormatMetadata& chemfiles::format_metadata<BinaryCIFFormat>() {
+    static FormatMetadata metadata;
+    metadata.name = "BinaryCIF";
+    metadata.extension = ".bcif";
+    metadata.description = "Binary encoding of Crystallographic Information Framework files for MacroMolecules";
+    metadata.reference = "https://github.com/molstar/BinaryCIF";
+
+    metadata.read = true;
+    metadata.write = false;
+    metadata.memory = true;
+
+    metadata.positions = true;
+    metadata.velocities = false;
+    metadata.unit_cell = true;
+    metadata.atoms = true;
+    metadata.bonds = true;
+    metadata.residues = true;
+    return metadata;
+}
+
+/// Sentinel used for missing sequence ids in `_struct_conn`
+static constexpr int64_t MISSING_SEQ_ID = INT64_MIN;
+
+/******************************************************************************/
+/*                          msgpack helper functions                          */
+/******************************************************************************/
+
+/// Get the value associated with `key` in `map`, or `nullptr` if `map` is not
+/// a map or does not contain this key.
+static const msgpack::object* find_key(const msgpack::object& map, std::string_view key) {
+    if (map.type != msgpack::type::MAP) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < map.via.map.size; i++) {
+        const auto& entry = map.via.map.ptr[i];
+        if (entry.key.type == msgpack::type::STR &&
+            std::string_view(entry.key.via.str.ptr, entry.key.via.str.size) == key) {
+            return &entry.val;
+        }
+    }
+    return nullptr;
+}
+
+/// Get the value associated with `key` in `map`
+static const msgpack::object& get_key(const msgpack::object& map, std::string_view key) {
+    auto value = find_key(map, key);
+    if (value == nullptr) {
+        throw format_error("missing '{}' entry in BinaryCIF data", key);
+    }
+    return *value;
+}
+
+static std::string_view as_string(const msgpack::object& value, std::string_view context) {
+    if (value.type != msgpack::type::STR) {
+        throw format_error("expected a string for '{}' in BinaryCIF data", context);
+    }
+    return {value.via.str.ptr, value.via.str.size};
+}
+
+static std::string_view as_binary(const msgpack::object& value, std::string_view context) {
+    if (value.type == msgpack::type::BIN) {
+        return {value.via.bin.ptr, value.via.bin.size};
+    } else if (value.type == msgpack::type::STR) {
+        return {value.via.str.ptr, value.via.str.size};
+    }
+    throw format_error("expected binary data for '{}' in BinaryCIF data", context);
+}
+
+static double as_number(const msgpack::object& value, std::string_view context) {
+    switch (value.type) {
+    case msgpack::type::POSITIVE_INTEGER:
+        return static_cast<double>(value.via.u64);
+    case msgpack::type::NEGATIVE_INTEGER:
+        return static_cast<double>(value.via.i64);
+    case msgpack::type::FLOAT32:
+    case msgpack::type::FLOAT64:
+        return value.via.f64;
+    default:
+        throw format_error("expected a number for '{}' in BinaryCIF data", context);
+    }
+}
+
+static int64_t as_integer(const msgpack::object& value, std::string_view context) {
+    if (value.type == msgpack::type::POSITIVE_INTEGER && value.via.u64 <= static_cast<uint64_t>(INT64_MAX)) {
+        return static_cast<int64_t>(value.via.u64);
+    } else if (value.type == msgpack::type::NEGATIVE_INTEGER) {
+        return value.via.i64;
+    }
+    throw format_error("expected an integer for '{}' in BinaryCIF data", context);
+}
+
+static span<const msgpack::object> as_array(const msgpack::object& value, std::string_view context) {
+    if (value.type != msgpack::type::ARRAY) {
+        throw format_error("expected an array for '{}' in BinaryCIF data", context);
+    }
+    const msgpack::object* data = value.via.array.ptr;
+    return {data, value.via.array.size};
+}
+
+/// Get the category with the given `name` in a data `block`, or `nullptr`.
+/// Category names can be given with or without the initial underscore.
+static const msgpack::object* find_category(const msgpack::object& block, std::string_view name) {
+    for (const auto& category: as_array(get_key(block, "categories"), "categories")) {
+        auto category_name = as_string(get_key(category, "name"), "name");
+        if (!category_name.empty() && category_name[0] == '_') {
+            category_name.remove_prefix(1);
+        }
+        if (category_name == name) {
+            return &category;
+        }
+    }
+    return nullptr;
+}
+
+/// Get the column with the given `name` in a `category`, or `nullptr`
+static const msgpack::object* find_column(const msgpack::object* category, std::string_view name) {
+    if (category == nullptr) {
+        return nullptr;
+    }
+    for (const auto& column: as_array(get_key(*category, "columns"), "columns")) {
+        if (as_string(get_key(column, "name"), "name") == name) {
+            return &column;
+        }
+    }
+    return nullptr;
+}
+
+/******************************************************************************/
+/*                             BinaryCIF decoding                             */
+/******************************************************************************/
+
+/// Data of a column in the middle of decoding
+struct EncodedData {
+    enum Kind {
+        /// raw bytes
+        BYTES,
+        /// integer values, in `integers`
+        INTEGERS,
+        /// floating point values, in `numbers`
+        NUMBERS,
+        /// strings, with the string index of each row in `integers`
+        STRINGS,
+    } kind = BYTES;
+
+    std::string_view bytes;
+    std::vector<int64_t> integers;
+    std::vector<double> numbers;
+    std::string string_data;
+    std::vector<size_t> string_offsets;
+};
+
+/// Read a little-endian value of type `T` from `data`
+template <typename T> static T read_little_endian(const char* data) {
+    using unsigned_t = typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type;
+    unsigned_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        bits |= static_cast<unsigned_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    T value;
+    if constexpr (sizeof(T) == sizeof(unsigned_t)) {
+        std::memcpy(&value, &bits, sizeof(T));
+    } else {
+        // sign-extend the smaller integer types
+        using small_unsigned_t = typename std::make_unsigned<T>::type;
+        value = static_cast<T>(static_cast<small_unsigned_t>(bits));
+    }
+    return value;
+}
+
+template <typename T> static std::vector<T> read_array(std::string_view bytes) {
+    if (bytes.size() % sizeof(T) != 0) {
+        throw format_error(
+            "invalid BinaryCIF ByteArray: size {} is not a multiple of {}",
+            bytes.size(), sizeof(T)
+        );
+    }
+    auto count = bytes.size() / sizeof(T);
+    auto result = std::vector<T>(count);
+    for (size_t i = 0; i < count; i++) {
+        result[i] = read_little_endian<T>(bytes.data() + i * sizeof(T));
+    }
+    return result;
+}
+
+template <typename T> static std::vector<int64_t> read_integers(std::string_view bytes) {
+    auto values = read_array<T>(bytes);
+    return std::vector<int64_t>(values.begin(), values.end());
+}
+
+static void expect_kind(const EncodedData& data, EncodedData::Kind kind, std::string_view encoding) {
+    if (data.kind != kind) {
+        throw format_error("invalid BinaryCIF data: unexpected input for {} encoding", encoding);
+    }
+}
+
+static void decode_data(EncodedData& data, const msgpack::object& encodings);
+
+static void decode_byte_array(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::BYTES, "ByteArray");
+    auto type = as_integer(get_key(encoding, "type"), "type");
+    switch (type) {
+    case 1:
+        data.integers = read_integers<int8_t>(data.bytes);
+        break;
+    case 2:
+        data.integers = read_integers<int16_t>(data.bytes);
+        break;
+    case 3:
+        data.integers = read_integers<int32_t>(data.bytes);
+        break;
+    case 4:
+        data.integers = read_integers<uint8_t>(data.bytes);
+        break;
+    case 5:
+        data.integers = read_integers<uint16_t>(data.bytes);
+        break;
+    case 6:
+        data.integers = read_integers<uint32_t>(data.bytes);
+        break;
+    case 32: {
+        auto values = read_array<float>(data.bytes);
+        data.numbers = std::vector<double>(values.begin(), values.end());
+        data.kind = EncodedData::NUMBERS;
+        return;
+    }
+    case 33:
+        data.numbers = read_array<double>(data.bytes);
+        data.kind = EncodedData::NUMBERS;
+        return;
+    default:
+        throw format_error("unknown BinaryCIF ByteArray type {}", type);
+    }
+    data.kind = EncodedData::INTEGERS;
+}
+
+static void decode_fixed_point(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::INTEGERS, "FixedPoint");
+    auto factor = as_number(get_key(encoding, "factor"), "factor");
+    if (factor == 0 || !std::isfinite(factor)) {
+        throw format_error("invalid factor in BinaryCIF FixedPoint: {}", factor);
+    }
+    data.numbers.resize(data.integers.size());
+    for (size_t i = 0; i < data.integers.size(); i++) {
+        data.numbers[i] = static_cast<double>(data.integers[i]) / factor;
+    }
+    data.integers.clear();
+    data.kind = EncodedData::NUMBERS;
+}
+
+static void decode_interval_quantization(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::INTEGERS, "IntervalQuantization");
+    auto min = as_number(get_key(encoding, "min"), "min");
+    auto max = as_number(get_key(encoding, "max"), "max");
+    auto steps = as_integer(get_key(encoding, "numSteps"), "numSteps");
+    if (steps < 2) {
+        throw format_error("invalid number of steps in BinaryCIF IntervalQuantization: {}", steps);
+    }
+    auto delta = (max - min) / static_cast<double>(steps - 1);
+    data.numbers.resize(data.integers.size());
+    for (size_t i = 0; i < data.integers.size(); i++) {
+        data.numbers[i] = min + delta * static_cast<double>(data.integers[i]);
+    }
+    data.integers.clear();
+    data.kind = EncodedData::NUMBERS;
+}
+
+static void decode_run_length(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::INTEGERS, "RunLength");
+    auto size = as_integer(get_key(encoding, "srcSize"), "srcSize");
+    if (data.integers.size() % 2 != 0 || size < 0) {
+        throw format_error("invalid BinaryCIF RunLength data");
+    }
+
+    // check the number of values before allocating anything
+    int64_t total = 0;
+    for (size_t i = 1; i < data.integers.size(); i += 2) {
+        auto count = data.integers[i];
+        if (count < 0 || count > INT64_MAX - total) {
+            throw format_error("invalid BinaryCIF RunLength data: invalid count {}", count);
+        }
+        total += count;
+    }
+    if (total != size) {
+        throw format_error(
+            "invalid BinaryCIF RunLength data: expected {} values, got {}",
+            size, total
+        );
+    }
+
+    auto output = std::vector<int64_t>();
+    output.reserve(static_cast<size_t>(size));
+    for (size_t i = 0; i < data.integers.size(); i += 2) {
+        output.insert(output.end(), static_cast<size_t>(data.integers[i + 1]), data.integers[i]);
+    }
+    data.integers = std::move(output);
+}
+
+static void decode_delta(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::INTEGERS, "Delta");
+    auto value = as_integer(get_key(encoding, "origin"), "origin");
+    for (auto& integer: data.integers) {
+        if ((integer > 0 && value > INT64_MAX - integer) || (integer < 0 && value < INT64_MIN - integer)) {
+            throw format_error("invalid BinaryCIF Delta data: the values overflow");
+        }
+        value += integer;
+        integer = value;
+    }
+}
+
+static void decode_integer_packing(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::INTEGERS, "IntegerPacking");
+    auto byte_count = as_integer(get_key(encoding, "byteCount"), "byteCount");
+    auto size = as_integer(get_key(encoding, "srcSize"), "srcSize");
+    auto unsigned_value = get_key(encoding, "isUnsigned");
+    auto is_unsigned = unsigned_value.type == msgpack::type::BOOLEAN && unsigned_value.via.boolean;
+    // each output value uses at least one input value
+    if ((byte_count != 1 && byte_count != 2) || size < 0 || static_cast<uint64_t>(size) > data.integers.size()) {
+        throw format_error("invalid BinaryCIF IntegerPacking data");
+    }
+
+    // values at the limits continue in the next value
+    int64_t upper = 0;
+    int64_t lower = 0;
+    if (is_unsigned) {
+        upper = byte_count == 1 ? 0xFF : 0xFFFF;
+        lower = -1;
+    } else {
+        upper = byte_count == 1 ? 0x7F : 0x7FFF;
+        lower = -upper - 1;
+    }
+
+    auto output = std::vector<int64_t>();
+    output.reserve(static_cast<size_t>(size));
+    const auto& input = data.integers;
+    size_t i = 0;
+    while (i < input.size()) {
+        int64_t value = 0;
+        while (input[i] == upper || input[i] == lower) {
+            value += input[i];
+            i++;
+            if (i == input.size()) {
+                throw format_error("invalid BinaryCIF IntegerPacking data: truncated value");
+            }
+        }
+        value += input[i];
+        output.push_back(value);
+        i++;
+    }
+    if (output.size() != static_cast<size_t>(size)) {
+        throw format_error(
+            "invalid BinaryCIF IntegerPacking data: expected {} values, got {}",
+            size, output.size()
+        );
+    }
+    data.integers = std::move(output);
+}
+
+static void decode_string_array(EncodedData& data, const msgpack::object& encoding) {
+    expect_kind(data, EncodedData::BYTES, "StringArray");
+    auto string_data = as_string(get_key(encoding, "stringData"), "stringData");
+
+    auto offsets = EncodedData();
+    offsets.bytes = as_binary(get_key(encoding, "offsets"), "offsets");
+    decode_data(offsets, get_key(encoding, "offsetEncoding"));
+    expect_kind(offsets, EncodedData::INTEGERS, "StringArray offsets");
+
+    data.string_offsets.reserve(offsets.integers.size());
+    for (auto offset: offsets.integers) {
+        if (offset < 0 || static_cast<size_t>(offset) > string_data.size() ||
+            (!data.string_offsets.empty() && static_cast<size_t>(offset) < data.string_offsets.back())) {
+            throw format_error("invalid BinaryCIF StringArray offset: {}", offset);
+        }
+        data.string_offsets.push_back(static_cast<size_t>(offset));
+    }
+    if (data.string_offsets.empty()) {
+        data.string_offsets.push_back(0);
+    }
+    data.string_data = std::string(string_data.substr(0, data.string_offsets.back()));
+
+    decode_data(data, get_key(encoding, "dataEncoding"));
+    expect_kind(data, EncodedData::INTEGERS, "StringArray indexes");
+    auto strings_count = static_cast<int64_t>(data.string_offsets.size() - 1);
+    for (auto index: data.integers) {
+        if (index >= strings_count) {
+            throw format_error(
+                "invalid BinaryCIF StringArray index: {} for {} strings", index, strings_count
+            );
+        }
+    }
+    data.kind = EncodedData::STRINGS;
+}
+
+/// Decode `data` with the list of `encodings`, starting from the last one
+static void decode_data(EncodedData& data, const msgpack::object& encodings) {
+    auto list = as_array(encodings, "encoding");
+    for (size_t i = list.size(); i > 0; i--) {
+        const auto& encoding = list[i - 1];
+        auto kind = as_string(get_key(encoding, "kind"), "kind");
+        if (kind == "ByteArray") {
+            decode_byte_array(data, encoding);
+        } else if (kind == "FixedPoint") {
+            decode_fixed_point(data, encoding);
+        } else if (kind == "IntervalQuantization") {
+            decode_interval_quantization(data, encoding);
+        } else if (kind == "RunLength") {
+            decode_run_length(data, encoding);
+        } else if (kind == "Delta") {
+            decode_delta(data, encoding);
+        } else if (kind == "IntegerPacking") {
+            decode_integer_packing(data, encoding);
+        } else if (kind == "StringArray") {
+            decode_string_array(data, encoding);
+        } else {
+            throw format_error("unknown BinaryCIF encoding '{}'", kind);
+        }
+    }
+}
+
+/// Decode a `column` with `rows` values, containing either numbers or strings
+static BinaryCIFColumn decode_column(const msgpack::object& column, size_t rows, bool strings) {
+    auto name = as_string(get_key(column, "name"), "name");
+    const auto& encoded = get_key(column, "data");
+
+    auto data = EncodedData();
+    data.bytes = as_binary(get_key(encoded, "data"), "data");
+    decode_data(data, get_key(encoded, "encoding"));
+
+    auto result = BinaryCIFColumn();
+    auto size = data.kind == EncodedData::NUMBERS ? data.numbers.size() : data.integers.size();
+    if (data.kind == EncodedData::BYTES || size != rows) {
+        throw format_error(
+            "invalid BinaryCIF column '{}': expected {} values, got {}", name, rows,
+            data.kind == EncodedData::BYTES ? 0 : size
+        );
+    }
+
+    auto mask = find_key(column, "mask");
+    if (mask != nullptr && mask->type != msgpack::type::NIL) {
+        auto mask_data = EncodedData();
+        mask_data.bytes = as_binary(get_key(*mask, "data"), "mask");
+        decode_data(mask_data, get_key(*mask, "encoding"));
+        if (mask_data.kind != EncodedData::INTEGERS || mask_data.integers.size() != rows) {
+            throw format_error("invalid mask for BinaryCIF column '{}'", name);
+        }
+        result.mask.reserve(rows);
+        for (auto value: mask_data.integers) {
+            result.mask.push_back(static_cast<uint8_t>(value));
+        }
+    }
+
+    if (strings) {
+        if (data.kind == EncodedData::STRINGS) {
+            result.string_data = std::move(data.string_data);
+            result.string_offsets = std::move(data.string_offsets);
+            result.string_indexes = std::move(data.integers);
+        } else {
+            // format the numbers, one string for each row
+            result.string_offsets.reserve(rows + 1);
+            result.string_offsets.push_back(0);
+            result.string_indexes.reserve(rows);
+            for (size_t i = 0; i < rows; i++) {
+                if (data.kind == EncodedData::INTEGERS) {
+                    result.string_data += std::to_string(data.integers[i]);
+                } else {
+                    result.string_data += fmt::format("{}", data.numbers[i]);
+                }
+                result.string_offsets.push_back(result.string_data.size());
+                result.string_indexes.push_back(static_cast<int64_t>(i));
+            }
+        }
+    } else {
+        if (data.kind == EncodedData::NUMBERS) {
+            result.numbers = std::move(data.numbers);
+        } else if (data.kind == EncodedData::INTEGERS) {
+            result.numbers = std::vector<double>(data.integers.begin(), data.integers.end());
+        } else {
+            // parse each of the strings used by a present value once
+            auto strings_count = data.string_offsets.size() - 1;
+            auto parsed = std::vector<optional<double>>(strings_count);
+            result.numbers.resize(rows, 0.0);
+            for (size_t i = 0; i < rows; i++) {
+                auto index = data.integers[i];
+                if (!result.present(i) || index < 0) {
+                    continue;
+                }
+                auto& value = parsed[static_cast<size_t>(index)];
+                if (!value) {
+                    auto start = data.string_offsets[static_cast<size_t>(index)];
+                    auto stop = data.string_offsets[static_cast<size_t>(index) + 1];
+                    auto text = std::string_view(data.string_data).substr(start, stop - start);
+                    try {
+                        value = parse<double>(text);
+                    } catch (const Error& e) {
+                        throw format_error("invalid number in BinaryCIF column '{}': {}", name, e.what());
+                    }
+                }
+                result.numbers[i] = *value;
+            }
+        }
+    }
+
+    return result;
+}
+
+/// Get the number of rows in a category
+static size_t row_count(const msgpack::object& category) {
+    auto count = as_integer(get_key(category, "rowCount"), "rowCount");
+    if (count < 0) {
+        throw format_error("invalid negative row count in BinaryCIF data");
+    }
+    return static_cast<size_t>(count);
+}
+
+/// Decode the column `name` in `category` if it exists
+static optional<BinaryCIFColumn> optional_column(const msgpack::object* category, std::string_view name, bool strings) {
+    auto column = find_column(category, name);
+    if (column == nullptr) {
+        return nullopt;
+    }
+    return decode_column(*column, row_count(*category), strings);
+}
+
+/// Get the first present value of the string column `name` in `category`
+static std::string first_string(const msgpack::object* category, std::string_view name) {
+    auto column = optional_column(category, name, true);
+    if (!column || column->string_indexes.empty() || !column->present(0)) {
+        return "";
+    }
+    return std::string(column->string(0));
+}
+
+static Bond::BondOrder bond_order(std::string_view order) {
+    if (order == "sing") {
+        return Bond::SINGLE;
+    } else if (order == "doub") {
+        return Bond::DOUBLE;
+    } else if (order == "trip") {
+        return Bond::TRIPLE;
+    } else if (order == "quad") {
+        return Bond::QUADRUPLE;
+    } else {
+        return Bond::UNKNOWN;
+    }
+}
+
+/******************************************************************************/
+/*                              BinaryCIFFormat                               */
+/******************************************************************************/
+
+BinaryCIFFormat::BinaryCIFFormat(std::string path, File::Mode mode, File::Compression compression) {
+    if (mode != File::READ) {
+        throw format_error("only read mode ('r') is supported for the BinaryCIF format");
+    }
+    auto file = TextFile(std::move(path), mode, compression);
+    source_ = file.path();
+    auto buffer = file.readall();
+    decode(buffer.data(), buffer.size());
+}
+
+BinaryCIFFormat::BinaryCIFFormat(std::shared_ptr<MemoryBuffer> memory, File::Mode mode, File::Compression compression) {
+    if (mode != File::READ) {
+        throw format_error("only read mode ('r') is supported for the BinaryCIF format");
+    }
+    source_ = "memory";
+    memory->decompress(compression);
+    decode(memory->data(), memory->size());
+}
+
+void BinaryCIFFormat::decode(const char* data, size_t size) {
+    auto handle = msgpack::object_handle();
+    try {
+        msgpack::unpack(handle, data, size);
+    } catch (const std::exception& e) {
+        throw format_error("error while decoding BinaryCIF from {}: '{}'", source_, e.what());
+    }
+
+    const auto& root = handle.get();
+    if (root.type != msgpack::type::MAP) {
+        throw format_error("error while decoding BinaryCIF from {}: expected a msgpack map", source_);
+    }
+    auto blocks = as_array(get_key(root, "dataBlocks"), "dataBlocks");
+    if (blocks.empty()) {
+        throw format_error("could not find any data block in BinaryCIF from {}", source_);
+    }
+    const auto& block = blocks[0];
+
+    pdb_idcode_ = first_string(find_category(block, "entry"), "id");
+    name_ = first_string(find_category(block, "struct"), "title");
+
+    Vector3D lengths;
+    Vector3D angles = {90, 90, 90};
+    auto cell = find_category(block, "cell");
+    const char* cell_columns[6] = {
+        "length_a", "length_b", "length_c", "angle_alpha", "angle_beta", "angle_gamma"
+    };
+    for (size_t i = 0; i < 6; i++) {
+        auto column = optional_column(cell, cell_columns[i], false);
+        if (column && !column->numbers.empty() && column->present(0)) {
+            auto& value = i < 3 ? lengths[i] : angles[i - 3];
+            value = column->number(0);
+        }
+    }
+    cell_ = UnitCell(lengths, angles);
+
+    auto atom_site = find_category(block, "atom_site");
+    if (atom_site == nullptr) {
+        throw format_error("could not find _atom_site category in BinaryCIF from {}", source_);
+    }
+    auto rows = row_count(*atom_site);
+
+    auto required = [&](std::string_view name, bool strings) {
+        auto column = optional_column(atom_site, name, strings);
+        if (!column) {
+            throw format_error("could not find column '{}' in _atom_site category in BinaryCIF from {}", name, source_);
+        }
+        return std::move(*column);
+    };
+
+    atom_site_.type_symbol = required("type_symbol", true);
+    atom_site_.cartn_x = required("Cartn_x", false);
+    atom_site_.cartn_y = required("Cartn_y", false);
+    atom_site_.cartn_z = required("Cartn_z", false);
+
+    atom_site_.label_atom_id = optional_column(atom_site, "label_atom_id", true);
+    if (!atom_site_.label_atom_id) {
+        atom_site_.label_atom_id = optional_column(atom_site, "auth_atom_id", true);
+    }
+    atom_site_.label_alt_id = optional_column(atom_site, "label_alt_id", true);
+    atom_site_.group_pdb = optional_column(atom_site, "group_PDB", true);
+    atom_site_.formal_charge = optional_column(atom_site, "pdbx_formal_charge", false);
+
+    atom_site_.label_comp_id = optional_column(atom_site, "label_comp_id", true);
+    atom_site_.label_asym_id = optional_column(atom_site, "label_asym_id", true);
+    atom_site_.auth_asym_id = optional_column(atom_site, "auth_asym_id", true);
+    atom_site_.label_seq_id = optional_column(atom_site, "label_seq_id", false);
+    atom_site_.auth_seq_id = optional_column(atom_site, "auth_seq_id", false);
+    atom_site_.label_entity_id = optional_column(atom_site, "label_entity_id", false);
+
+    // Each model is a different step
+    models_.clear();
+    models_.push_back(0);
+    auto model = optional_column(atom_site, "pdbx_PDB_model_num", false);
+    if (model) {
+        for (size_t i = 1; i < rows; i++) {
+            if (model->number(i) != model->number(i - 1)) {
+                models_.push_back(i);
+            }
+        }
+    }
+    models_.push_back(rows);
+    if (rows == 0) {
+        models_.clear();
+        models_.push_back(0);
+    }
+
+    // Bonds between residues, and with ligands
+    auto struct_conn = find_category(block, "struct_conn");
+    auto conn_type = optional_column(struct_conn, "conn_type_id", true);
+    if (conn_type) {
+        // use the author sequence id to identify atoms if possible, since it
+        // is also defined for non-polymer residues
+        auth_seq_ids_ = atom_site_.auth_seq_id && find_column(struct_conn, "ptnr1_auth_seq_id") != nullptr;
+        auto seq_prefix = std::string(auth_seq_ids_ ? "auth" : "label");
+
+        auto partner_columns = [&](const std::string& prefix, const std::string& alt_prefix) {
+            return std::make_tuple(
+                optional_column(struct_conn, prefix + "_label_asym_id", true),
+                optional_column(struct_conn, prefix + "_" + seq_prefix + "_seq_id", false),
+                optional_column(struct_conn, prefix + "_label_atom_id", true),
+                optional_column(struct_conn, alt_prefix + "_label_alt_id", true),
+                optional_column(struct_conn, prefix + "_symmetry", true)
+            );
+        };
+        auto columns_1 = partner_columns("ptnr1", "pdbx_ptnr1");
+        auto columns_2 = partner_columns("ptnr2", "pdbx_ptnr2");
+        auto value_order = optional_column(struct_conn, "pdbx_value_order", true);
+
+        auto partner = [](decltype(columns_1)& columns, size_t row) {
+            const auto& asym_id = std::get<0>(columns);
+            const auto& seq_id = std::get<1>(columns);
+            const auto& atom_id = std::get<2>(columns);
+            const auto& alt_id = std::get<3>(columns);
+            auto result = Partner{"", MISSING_SEQ_ID, "", ""};
+            result.asym_id = std::string(asym_id->string(row));
+            if (seq_id && seq_id->present(row)) {
+                result.seq_id = static_cast<int64_t>(seq_id->number(row));
+            }
+            result.atom_id = std::string(atom_id->string(row));
+            if (alt_id && alt_id->present(row)) {
+                result.alt_id = std::string(alt_id->string(row));
+            }
+            return result;
+        };
+
+        auto has_partners = std::get<0>(columns_1) && std::get<2>(columns_1) &&
+                            std::get<0>(columns_2) && std::get<2>(columns_2);
+        for (size_t i = 0; has_partners && i < row_count(*struct_conn); i++) {
+            // hydrogen bonds, salt bridges, etc. are not chemical bonds
+            auto type = conn_type->string(i);
+            if (type.substr(0, 6) != "covale" && type != "disulf" && type != "metalc") {
+                continue;
+            }
+
+            // skip bonds with symmetry images of atoms
+            const auto& symmetry_1 = std::get<4>(columns_1);
+            const auto& symmetry_2 = std::get<4>(columns_2);
+            if (symmetry_1 && symmetry_2 && symmetry_1->present(i) && symmetry_2->present(i) &&
+                symmetry_1->string(i) != symmetry_2->string(i)) {
+                continue;
+            }
+
+            auto order = Bond::UNKNOWN;
+            if (value_order && value_order->present(i)) {
+                order = bond_order(value_order->string(i));
+            }
+            connections_.push_back({partner(columns_1, i), partner(columns_2, i), order});
+        }
+    }
+}
+
+size_t BinaryCIFFormat::nsteps() {
+    return models_.size() - 1;
+}
+
+void BinaryCIFFormat::read_step(size_t step, Frame& frame) {
+    step_ = step;
+    read(frame);
+}
+
+void BinaryCIFFormat::read(Frame& frame) {
+    auto first = models_[step_];
+    auto count = models_[step_ + 1] - first;
+
+    frame.set_cell(cell_);
+    if (!name_.empty()) {
+        frame.set("name", name_);
+    }
+    if (!pdb_idcode_.empty()) {
+        frame.set("pdb_idcode", pdb_idcode_);
+    }
+
+    const auto& site = atom_site_;
+    const auto& names = site.label_atom_id ? *site.label_atom_id : site.type_symbol;
+
+    frame.resize(count);
+    auto positions = frame.positions();
+    parallel_for(0, count, PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto row = first + i;
+            auto atom = Atom(
+                std::string(names.string(row)),
+                std::string(site.type_symbol.string(row))
+            );
+
+            if (site.label_alt_id && site.label_alt_id->present(row)) {
+                atom.set("altloc", std::string(site.label_alt_id->string(row)));
+            }
+
+            if (site.formal_charge && site.formal_charge->present(row)) {
+                atom.set_charge(site.formal_charge->number(row));
+            }
+
+            frame[i] = std::move(atom);
+            positions[i] = Vector3D(
+                site.cartn_x.number(row),
+                site.cartn_y.number(row),
+                site.cartn_z.number(row)
+            );
+        }
+    });
+
+    if (site.label_comp_id && site.label_asym_id) {
+        auto residue_id = [&](size_t row) -> int64_t {
+            if (site.label_seq_id && site.label_seq_id->present(row)) {
+                return static_cast<int64_t>(site.label_seq_id->number(row));
+            }
+            // In this case, we need to use the entity id
+            if (site.label_entity_id && site.label_entity_id->present(row)) {
+                return static_cast<int64_t>(site.label_entity_id->number(row));
+            }
+            throw format_error("invalid CIF residue or entity numeric for atom {} in BinaryCIF from {}", row, source_);
+        };
+
+        auto residues = std::vector<Residue>();
+        // residues are identified by the index of the chain name in the
+        // column strings and the residue id, to avoid comparing strings
+        const auto& chains = site.label_asym_id->string_indexes;
+        auto residues_indexes = std::map<std::pair<int64_t, int64_t>, size_t>();
+
+        // atoms in the same residue are usually consecutive, so only look up
+        // the residue when the residue id or the chain changes
+        size_t last_residue = 0;
+        int64_t last_resid = 0;
+        for (size_t i = 0; i < count; i++) {
+            auto row = first + i;
+            auto resid = residue_id(row);
+            if (i != 0 && resid == last_resid && chains[row] == chains[row - 1]) {
+                residues[last_residue].add_atom(i);
+                continue;
+            }
+            last_resid = resid;
+
+            auto key = std::make_pair(chains[row], resid);
+            auto it = residues_indexes.find(key);
+            if (it == residues_indexes.end()) {
+                Residue residue(std::string(site.label_comp_id->string(row)), resid);
+                residue.add_atom(i);
+
+                // This will be saved as a string on purpose to match MMTF
+                residue.set("chainid", std::string(site.label_asym_id->string(row)));
+
+                if (site.auth_asym_id) {
+                    residue.set("chainname", std::string(site.auth_asym_id->string(row)));
+                }
+
+                if (site.group_pdb) {
+                    residue.set("is_standard_pdb", site.group_pdb->string(row) == "ATOM");
+                }
+
+                last_residue = residues.size();
+                residues_indexes.emplace(key, last_residue);
+                residues.emplace_back(std::move(residue));
+            } else {
+                last_residue = it->second;
+                residues[last_residue].add_atom(i);
+            }
+        }
+
+        for (auto& residue: residues) {
+            frame.add_residue(std::move(residue));
+        }
+    }
+
+    PDBFormat::link_standard_residue_bonds(frame);
+    add_connections(frame, first);
+
+    step_++;
+}
+
+void BinaryCIFFormat::add_connections(Frame& frame, size_t first) const {
+    const auto& site = atom_site_;
+    const auto& seq_ids = auth_seq_ids_ ? site.auth_seq_id : site.label_seq_id;
+    if (connections_.empty() || !site.label_asym_id || !site.label_atom_id) {
+        return;
+    }
+
+    // find the atoms used in connections with a single pass over the atoms
+    using key_t = std::tuple<std::string_view, int64_t, std::string_view, std::string_view>;
+    auto key = [](const Partner& partner) {
+        return key_t(partner.asym_id, partner.seq_id, partner.atom_id, partner.alt_id);
+    };
+
+    auto atoms = std::map<key_t, size_t>();
+    for (const auto& connection: connections_) {
+        atoms.emplace(key(connection.first), SIZE_MAX);
+        atoms.emplace(key(connection.second), SIZE_MAX);
+    }
+
+    for (size_t i = 0; i < frame.size(); i++) {
+        auto row = first + i;
+        auto seq_id = MISSING_SEQ_ID;
+        if (seq_ids && seq_ids->present(row)) {
+            seq_id = static_cast<int64_t>(seq_ids->number(row));
+        }
+        auto alt_id = std::string_view();
+        if (site.label_alt_id && site.label_alt_id->present(row)) {
+            alt_id = site.label_alt_id->string(row);
+        }
+
+        auto it = atoms.find(key_t(site.label_asym_id->string(row), seq_id, site.label_atom_id->string(row), alt_id));
+        if (it != atoms.end() && it->second == SIZE_MAX) {
+            it->second = i;
+        }
+    }
+
+    for (const auto& connection: connections_) {
+        auto i = atoms.at(key(connection.first));
+        auto j = atoms.at(key(connection.second));
+        if (i != SIZE_MAX && j != SIZE_MAX && i != j) {
+            frame.add_bond(i, j, connection.order);
+        }
+    }
+}
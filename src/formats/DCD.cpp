@@ -1,15 +1,17 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
-#include <utility>
-#include <memory>
 #include <set>
+#include <memory>
+#include <utility>
+#include <algorithm>
 
 #include "chemfiles/utils.hpp"
 #include "chemfiles/warnings.hpp"
 #include "chemfiles/error_fmt.hpp"
 
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/UnitCell.hpp"
 #include "chemfiles/FormatMetadata.hpp"
 
@@ -144,6 +146,19 @@ size_t DCDFormat::nsteps() {
     return n_frames_;
 }
 
+size_t DCDFormat::refresh() {
+    // all frames after the first one have the same size, we only need to
+    // check the new file size
+    auto file_size = file_->refresh();
+    if (file_size < header_size_ + first_frame_size_) {
+        n_frames_ = 0;
+    } else {
+        auto n_frames = (file_size - header_size_ - first_frame_size_) / frame_size_ + 1;
+        n_frames_ = static_cast<size_t>(n_frames);
+    }
+    return n_frames_;
+}
+
 void DCDFormat::read(Frame& frame) {
     this->read_step(step_, frame);
     step_++;
@@ -170,6 +185,38 @@ void DCDFormat::read_step(size_t step, Frame& frame) {
     if (!title_.empty()) {
         frame.set("title", title_);
     }
+
+    file_->sequential_hints(frame_range(step_, 1), frame_range(step_ + 1, readahead_));
+}
+
+void DCDFormat::read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) {
+    auto ranges = std::vector<BinaryFile::Range>();
+    ranges.reserve(steps.size());
+    for (auto step: steps) {
+        ranges.push_back(this->frame_range(step, 1));
+    }
+
+    file_->prefetch(ranges, [&](size_t i) {
+        this->read_step(steps[i], frames[i]);
+    });
+}
+
+void DCDFormat::set_access_pattern(AccessPattern pattern, size_t readahead) {
+    file_->set_access_pattern(pattern);
+    readahead_ = readahead;
+}
+
+BinaryFile::Range DCDFormat::frame_range(size_t step, size_t count) const {
+    if (step >= n_frames_ || count == 0) {
+        return {0, 0};
+    }
+
+    count = std::min(count, n_frames_ - step);
+    if (step == 0) {
+        return {header_size_, first_frame_size_ + (count - 1) * frame_size_};
+    } else {
+        return {header_size_ + first_frame_size_ + (step - 1) * frame_size_, count * frame_size_};
+    }
 }
 
 size_t DCDFormat::read_marker() {
@@ -485,7 +532,7 @@ void DCDFormat::read_fixed_coordinates() {
 
 /******************************************************************************/
 
-void DCDFormat::write(const Frame& frame) {
+void DCDFormat::write_view(const FrameView& frame) {
     if (n_frames_ == 0) {
         // initialize data that will be constant for this file
         n_atoms_ = frame.size();
@@ -642,8 +689,8 @@ void DCDFormat::write_cell(const UnitCell& cell) {
 }
 
 
-void DCDFormat::write_positions(const Frame& frame) {
-    const auto& positions = frame.positions();
+void DCDFormat::write_positions(const FrameView& frame) {
+    auto positions = frame.positions();
 
     buffer_.resize(n_atoms_);
     for (size_t i=0; i<n_atoms_; i++) {
@@ -9,13 +9,18 @@
 #include <array>
 #include <string>
 #include <vector>
+#include <iterator>
 #include <string_view>
 
+#include <fmt/format.h>
+
 #include "chemfiles/types.hpp"
 #include "chemfiles/utils.hpp"
 #include "chemfiles/parse.hpp"
 #include "chemfiles/warnings.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/section_lines.hpp"
 #include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/File.hpp"
@@ -74,52 +79,76 @@ void GROFormat::read_next(Frame& frame) {
         throw format_error("can not read number of atoms in GRO file: {}", e.what());
     }
 
-    frame.add_velocities();
-    frame.reserve(natoms);
+    auto lines = SectionLines(file_, natoms);
+    if (lines.size() != natoms) {
+        throw format_error(
+            "not enough lines in GRO file: expected {} atoms, got {}",
+            natoms, lines.size()
+        );
+    }
 
-    for (size_t i=0; i<natoms; i++) {
-        auto line = file_.readline();
-        if (line.length() < 44) {
-            throw format_error("GRO Atom line is too small: '{}'", line);
-        }
+    frame.add_velocities();
+    frame.resize(natoms);
+    auto positions = frame.positions();
+    auto velocities = *frame.velocities();
+
+    // residue id and name for all atoms, the names point inside `lines`
+    auto resids = std::vector<optional<int64_t>>(natoms);
+    auto resnames = std::vector<std::string_view>(natoms);
+
+    parallel_for(0, natoms, PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto line = lines[i];
+            if (line.length() < 44) {
+                throw format_error("GRO Atom line is too small: '{}'", line);
+            }
 
-        optional<int64_t> resid = nullopt;
-        try {
-            resid = parse<int64_t>(line.substr(0, 5));
-        } catch (const Error&) {
-            // Invalid residue, we'll skip it
-            warning("GRO Reader", "skiping invalid residue with resid '{}'", line.substr(0, 5));
-        }
+            try {
+                resids[i] = parse<int64_t>(line.substr(0, 5));
+            } catch (const Error&) {
+                // Invalid residue, we'll skip it
+                warning("GRO Reader", "skiping invalid residue with resid '{}'", line.substr(0, 5));
+            }
+            resnames[i] = trim(line.substr(5, 5));
 
-        auto resname = std::string(trim(line.substr(5, 5)));
-        auto name = std::string(trim(line.substr(10, 5)));
+            // GRO files store atoms in nanometer, we need to convert to Angstroms
+            positions[i] = Vector3D(
+                parse<double>(line.substr(20, 8)) * 10,
+                parse<double>(line.substr(28, 8)) * 10,
+                parse<double>(line.substr(36, 8)) * 10
+            );
 
-        // GRO files store atoms in nanometer, we need to convert to Angstroms
-        auto x = parse<double>(line.substr(20, 8)) * 10;
-        auto y = parse<double>(line.substr(28, 8)) * 10;
-        auto z = parse<double>(line.substr(36, 8)) * 10;
+            if (line.length() >= 68) {
+                velocities[i] = Vector3D(
+                    parse<double>(line.substr(44, 8)) * 10,
+                    parse<double>(line.substr(52, 8)) * 10,
+                    parse<double>(line.substr(60, 8)) * 10
+                );
+            }
 
-        double vx = 0, vy = 0, vz=0;
-        if (line.length() >= 68) {
-            vx = parse<double>(line.substr(44, 8)) * 10;
-            vy = parse<double>(line.substr(52, 8)) * 10;
-            vz = parse<double>(line.substr(60, 8)) * 10;
+            frame[i] = Atom(std::string(trim(line.substr(10, 5))));
         }
-        frame.add_atom(Atom(name), {x, y, z}, {vx, vy, vz});
-
+    });
+
+    // atoms in the same residue are usually consecutive, so only look up the
+    // residue when the id changes
+    Residue* last_residue = nullptr;
+    optional<int64_t> last_resid = nullopt;
+    for (size_t i = 0; i < natoms; i++) {
+        auto resid = resids[i];
         if (!resid) {
             continue;
         }
 
-        if (residues_.find(*resid) == residues_.end()) {
-            Residue residue(resname, *resid);
-            residue.add_atom(frame.size() - 1);
-
-            residues_.insert({*resid, residue});
-        } else {
-            // Just add this atom to the residue
-            residues_.at(*resid).add_atom(frame.size() - 1);
+        if (!last_resid || *last_resid != *resid) {
+            auto it = residues_.find(*resid);
+            if (it == residues_.end()) {
+                it = residues_.emplace(*resid, Residue(std::string(resnames[i]), *resid)).first;
+            }
+            last_residue = &it->second;
+            last_resid = resid;
         }
+        last_residue->add_atom(i);
     }
 
     auto box = file_.readline();
@@ -173,9 +202,10 @@ static std::string to_gro_index(uint64_t i) {
     }
 }
 
-void GROFormat::write_next(const Frame& frame) {
-    file_.print("{}\n", frame.get<Property::STRING>("name").value_or("GRO File produced by chemfiles"));
-    file_.print("{: >5d}\n", frame.size());
+bool GROFormat::format_next(const Frame& frame, size_t /*unused*/, std::string& buffer) const {
+    auto output = std::back_inserter(buffer);
+    fmt::format_to(output, "{}\n", frame.get<Property::STRING>("name").value_or("GRO File produced by chemfiles"));
+    fmt::format_to(output, "{: >5d}\n", frame.size());
 
     // Only use numbers bigger than the biggest residue id as "resSeq" for
     // atoms without associated residue, and start generated residue id at
@@ -188,61 +218,75 @@ void GROFormat::write_next(const Frame& frame) {
         }
     }
 
-    auto& positions = frame.positions();
+    // Generated residue ids depend on all the previous atoms, so compute
+    // them before formatting the atoms in parallel. Atoms using the id of
+    // their residue get 0 here.
+    const auto& topology = frame.topology();
+    auto generated_resids = std::vector<int64_t>(frame.size(), 0);
     for (size_t i = 0; i < frame.size(); i++) {
-        std::string resname = "XXXXX";
-        std::string resid = "-1";
-        auto residue = frame.topology().residue_for_atom(i);
-        if (residue) {
-            resname = residue->name();
-            if (resname.length() > 5) {
-                warning("GRO writer",
-                    "residue '{}' name is too long, it will be truncated",
-                    resname
-                );
-                resname = resname.substr(0, 5);
-            }
-        }
-
+        auto residue = topology.residue_for_atom(i);
         if (residue && residue->id()) {
             auto value = residue->id().value();
             if (value <= 0) {
                 warning("GRO writer", "the residue id '{}' should not be negative or zero, treating it as blank", value);
-                value = max_resid++;
+                generated_resids[i] = max_resid++;
+            }
+        } else {
+            generated_resids[i] = max_resid++;
+        }
+    }
+
+    auto& positions = frame.positions();
+    auto velocities = frame.velocities();
+    format_parallel(frame.size(), buffer, [&](size_t start, size_t stop, std::string& chunk) {
+        auto chunk_output = std::back_inserter(chunk);
+        for (size_t i = start; i < stop; i++) {
+            std::string resname = "XXXXX";
+            std::string resid = "-1";
+            auto residue = topology.residue_for_atom(i);
+            if (residue) {
+                resname = residue->name();
+                if (resname.length() > 5) {
+                    warning("GRO writer",
+                        "residue '{}' name is too long, it will be truncated",
+                        resname
+                    );
+                    resname = resname.substr(0, 5);
+                }
+            }
+
+            if (generated_resids[i] != 0) {
+                if (generated_resids[i] <= 99999) {
+                    resid = std::to_string(generated_resids[i]);
+                }
+            } else {
+                auto value = residue->id().value();
                 if (value <= 99999) {
                     resid = std::to_string(value);
+                } else {
+                    warning("GRO writer", "too many residues, removing residue id");
                 }
-            } else if (value <= 99999) {
-                resid = std::to_string(value);
-            } else {
-                warning("GRO writer", "too many residues, removing residue id");
             }
-        } else {
-            // We need to manually assign a residue ID
-            auto value = max_resid++;
-            if (value <= 99999) {
-                resid = std::to_string(value);
-            }
-        }
 
-        assert(resname.length() <= 5);
-        auto pos = positions[i] / 10;
-        check_values_size(pos, 8, "atomic position");
+            assert(resname.length() <= 5);
+            auto pos = positions[i] / 10;
+            check_values_size(pos, 8, "atomic position");
 
-        if (frame.velocities()) {
-            auto vel = (*frame.velocities())[i] / 10;
-            check_values_size(vel, 8, "atomic velocity");
-            file_.print(
-                "{: >5}{: <5}{: >5}{: >5}{:8.3f}{:8.3f}{:8.3f}{:8.4f}{:8.4f}{:8.4f}\n",
-                resid, resname, frame[i].name(), to_gro_index(i), pos[0], pos[1], pos[2], vel[0], vel[1], vel[2]
-            );
-        } else {
-            file_.print(
-                "{: >5}{: <5}{: >5}{: >5}{:8.3f}{:8.3f}{:8.3f}\n",
-                resid, resname, frame[i].name(), to_gro_index(i), pos[0], pos[1], pos[2]
-            );
+            if (velocities) {
+                auto vel = (*velocities)[i] / 10;
+                check_values_size(vel, 8, "atomic velocity");
+                fmt::format_to(chunk_output,
+                    "{: >5}{: <5}{: >5}{: >5}{:8.3f}{:8.3f}{:8.3f}{:8.4f}{:8.4f}{:8.4f}\n",
+                    resid, resname, frame[i].name(), to_gro_index(i), pos[0], pos[1], pos[2], vel[0], vel[1], vel[2]
+                );
+            } else {
+                fmt::format_to(chunk_output,
+                    "{: >5}{: <5}{: >5}{: >5}{:8.3f}{:8.3f}{:8.3f}\n",
+                    resid, resname, frame[i].name(), to_gro_index(i), pos[0], pos[1], pos[2]
+                );
+            }
         }
-    }
+    });
 
     const auto& cell = frame.cell();
     // While this line is free form, we should try to print it in a pretty way that most gro parsers expect
@@ -251,7 +295,7 @@ void GROFormat::write_next(const Frame& frame) {
         auto lengths = cell.lengths() / 10;
         check_values_size(lengths, 8, "unit cell");
         // print zeros if the cell is infinite, this line is still required
-        file_.print("   {:8.5f} {:8.5f} {:8.5f}\n", lengths[0], lengths[1], lengths[2]);
+        fmt::format_to(output, "   {:8.5f} {:8.5f} {:8.5f}\n", lengths[0], lengths[1], lengths[2]);
     } else { // Triclinic
         const auto& matrix = cell.matrix() / 10;
         if (!is_upper_triangular(matrix)) {
@@ -259,11 +303,13 @@ void GROFormat::write_next(const Frame& frame) {
         }
         check_values_size(Vector3D(matrix[0][0], matrix[1][1], matrix[2][2]), 8, "unit cell");
         check_values_size(Vector3D(matrix[0][1], matrix[0][2], matrix[1][2]), 8, "unit cell");
-        file_.print(
+        fmt::format_to(output,
             "   {:8.5f} {:8.5f} {:8.5f} 0.0 0.0 {:8.5f} 0.0 {:8.5f} {:8.5f}\n",
             matrix[0][0], matrix[1][1], matrix[2][2], matrix[0][1], matrix[0][2], matrix[1][2]
         );
     }
+
+    return true;
 }
 
 void check_values_size(const Vector3D& values, unsigned width, const std::string& context) {
@@ -9,18 +9,23 @@
 #include <array>
 #include <string>
 #include <vector>
+#include <iterator>
 #include <algorithm>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
+#include <fmt/format.h>
+
 #include "chemfiles/types.hpp"
 #include "chemfiles/utils.hpp"
 #include "chemfiles/parse.hpp"
 #include "chemfiles/warnings.hpp"
 #include "chemfiles/error_fmt.hpp"
 #include "chemfiles/sorted_set.hpp"
+#include "chemfiles/thread_pool.hpp"
 #include "chemfiles/unreachable.hpp"
+#include "chemfiles/section_lines.hpp"
 #include "chemfiles/external/span.hpp"
 #include "chemfiles/external/optional.hpp"
 
@@ -107,6 +112,7 @@ atom_style::atom_style(std::string name): name_(std::move(name)) {
         style_ = WAVEPACKET;
     } else if (name_ == "hybrid") {
         style_ = HYBRID;
+        warning("LAMMPS Data reader", "only reading the first style for atom_style hybrid");
     } else {
         throw format_error("LAMMPS Data: unknown atom style '{}'", name_);
     }
@@ -187,10 +193,6 @@ atom_data atom_style::read_line(std::string_view line, size_t index) const {
         scan(line, d.index, d.type, d.charge, SKIP, SKIP, SKIP, SKIP, SKIP, d.x, d.y, d.z);
         break;
     case HYBRID:
-        if (!warned_) {
-            warning("LAMMPS Data reader", "only reading the first style for atom_style hybrid");
-            warned_ = true;
-        }
         // atom-ID atom-type x y z sub-style1 sub-style2 ...
         scan(line, d.index, d.type, d.x, d.y, d.z);
         break;
@@ -367,59 +369,82 @@ void LAMMPSDataFormat::read_atoms(Frame& frame) {
     }
     style_ = atom_style(atom_style_name_);
 
-    frame.resize(natoms_);
-    auto positions = frame.positions();
-    auto residues = std::unordered_map<size_t, Residue>();
-
-    size_t n = 0;
-    while (n < natoms_ && !file_.eof()) {
+    // read all the non-empty lines of the section first, to parse them in
+    // parallel
+    auto lines = SectionLines();
+    while (lines.size() < natoms_ && !file_.eof()) {
         auto line = file_.readline();
-        auto comment = split_comment(line);
-        if (line.empty()) {
-            continue;
+        auto content = line;
+        split_comment(content);
+        if (!content.empty()) {
+            lines.push_back(line);
+        }
+    }
+
+    auto count = lines.size();
+    auto data = std::vector<atom_data>(count);
+    auto atoms = std::vector<Atom>(count);
+    // comments for all lines, pointing inside `lines`
+    auto comments = std::vector<std::string_view>(count);
+    parallel_for(0, count, PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t n = start; n < stop; n++) {
+            auto line = lines[n];
+            comments[n] = split_comment(line);
+            data[n] = style_.read_line(line, n);
+
+            auto atom = Atom(std::to_string(data[n].type));
+            if (!std::isnan(data[n].charge)) {
+                atom.set_charge(data[n].charge);
+            }
+            if (!std::isnan(data[n].mass)) {
+                atom.set_mass(data[n].mass);
+            }
+            atoms[n] = std::move(atom);
         }
+    });
 
-        auto data = style_.read_line(line, n);
-        if (data.index >= natoms_) {
+    frame.resize(natoms_);
+    auto positions = frame.positions();
+    auto residues = std::unordered_map<size_t, Residue>();
+    Residue* last_residue = nullptr;
+    size_t last_molid = 0;
+    for (size_t n = 0; n < count; n++) {
+        const auto& values = data[n];
+        if (values.index >= natoms_) {
             throw format_error(
                 "too many atoms in [Atoms] section: expected {} atoms, got atom with index {}",
-                natoms_, data.index
+                natoms_, values.index
             );
         }
 
-        if (!comment.empty()) {
+        if (!comments[n].empty()) {
             // Read the first string after the comment, and use it as atom name
-            auto name = split(comment, ' ')[0];
+            auto name = split(comments[n], ' ')[0];
             if (names_.empty()) {
                 names_.resize(natoms_);
             }
-            names_[data.index] = std::string(name);
+            names_[values.index] = std::string(name);
         }
 
-        auto atom = Atom(std::to_string(data.type));
-        if (!std::isnan(data.charge)) {
-            atom.set_charge(data.charge);
-        }
-        if (!std::isnan(data.mass)) {
-            atom.set_mass(data.mass);
-        }
-
-        if (data.molid != 0) {
-            auto residue_iter = residues.find(data.molid);
-            if (residue_iter != residues.end()) {
-                residue_iter->second.add_atom(data.index);
-            } else {
-                auto residue = Residue("", static_cast<int64_t>(data.molid));
-                residue.add_atom(data.index);
-                residues.emplace(data.molid, std::move(residue));
+        if (values.molid != 0) {
+            // atoms in the same molecule are usually consecutive, so only
+            // look up the residue when the molecule id changes
+            if (values.molid != last_molid) {
+                auto residue_iter = residues.find(values.molid);
+                if (residue_iter == residues.end()) {
+                    auto residue = Residue("", static_cast<int64_t>(values.molid));
+                    residue_iter = residues.emplace(values.molid, std::move(residue)).first;
+                }
+                last_residue = &residue_iter->second;
+                last_molid = values.molid;
             }
+            last_residue->add_atom(values.index);
         }
 
-        frame[data.index] = atom;
-        positions[data.index][0] = data.x;
-        positions[data.index][1] = data.y;
-        positions[data.index][2] = data.z;
-        n++;
+        frame[values.index] = std::move(atoms[n]);
+        positions[values.index][0] = values.x;
+        positions[values.index][1] = values.y;
+        positions[values.index][2] = values.z;
     }
 
     for (auto it: std::move(residues)) {
@@ -831,15 +856,21 @@ void LAMMPSDataFormat::write_atoms(const DataTypes& types, const Frame& frame) {
     file_.print("\nAtoms # full\n\n");
     auto positions = frame.positions();
     auto molids = guess_molecules(frame);
-    for (size_t i=0; i<frame.size(); i++) {
-        auto& atom = frame.topology()[i];
-        auto molid = molids[i];
-        file_.print("{} {} {} {:#g} {:#g} {:#g} {:#g} # {}\n",
-            i + 1, molid + 1, types.atom_type_id(atom) + 1, atom.charge(),
-            positions[i][0], positions[i][1], positions[i][2],
-            atom.type()
-        );
-    }
+
+    auto buffer = std::string();
+    format_parallel(frame.size(), buffer, [&](size_t start, size_t stop, std::string& chunk) {
+        auto output = std::back_inserter(chunk);
+        for (size_t i=start; i<stop; i++) {
+            auto& atom = frame.topology()[i];
+            auto molid = molids[i];
+            fmt::format_to(output, "{} {} {} {:#g} {:#g} {:#g} {:#g} # {}\n",
+                i + 1, molid + 1, types.atom_type_id(atom) + 1, atom.charge(),
+                positions[i][0], positions[i][1], positions[i][2],
+                atom.type()
+            );
+        }
+    });
+    file_.write(buffer);
 }
 
 void LAMMPSDataFormat::write_velocities(const Frame& frame) {
@@ -847,11 +878,17 @@ void LAMMPSDataFormat::write_velocities(const Frame& frame) {
 
     file_.print("\nVelocities\n\n");
     auto velocities = *frame.velocities();
-    for (size_t i=0; i<frame.size(); i++) {
-        file_.print("{} {} {} {}\n",
-            i + 1, velocities[i][0], velocities[i][1], velocities[i][2]
-        );
-    }
+
+    auto buffer = std::string();
+    format_parallel(frame.size(), buffer, [&](size_t start, size_t stop, std::string& chunk) {
+        auto output = std::back_inserter(chunk);
+        for (size_t i=start; i<stop; i++) {
+            fmt::format_to(output, "{} {} {} {}\n",
+                i + 1, velocities[i][0], velocities[i][1], velocities[i][2]
+            );
+        }
+    });
+    file_.write(buffer);
 }
 
 void LAMMPSDataFormat::write_bonds(const DataTypes& types, const Topology& topology) {
@@ -50,7 +50,6 @@ using namespace chemfiles;
 
 namespace chemfiles {
     PLUGINS_DATA(TRJ,     gromacsplugin, trj,    false);
-    PLUGINS_DATA(PSF,     psfplugin,     psf,    false);
     PLUGINS_DATA(MOLDEN,  moldenplugin,  molden, false);
 }
 
@@ -378,7 +377,6 @@ template <MolfileFormat F> void Molfile<F>::read_topology() {
 
 // Instantiate all the templates
 template class chemfiles::Molfile<TRJ>;
-template class chemfiles::Molfile<PSF>;
 template class chemfiles::Molfile<MOLDEN>;
 
 template<> const FormatMetadata& chemfiles::format_metadata<Molfile<TRJ>>() {
@@ -401,28 +399,6 @@ template<> const FormatMetadata& chemfiles::format_metadata<Molfile<TRJ>>() {
     return metadata;
 }
 
-template<> const FormatMetadata& chemfiles::format_metadata<Molfile<PSF>>() {
-    static FormatMetadata metadata;
-    metadata.name = "PSF";
-    metadata.extension = ".psf";
-    metadata.description = "Protein Structure File text format";
-    metadata.reference = "https://www.ks.uiuc.edu/Training/Tutorials/namd/namd-tutorial-unix-html/node23.html";
-
-    metadata.read = true;
-    metadata.write = false;
-    metadata.memory = false;
-
-    metadata.positions = false;
-    metadata.velocities = false;
-    metadata.unit_cell = false;
-    metadata.atoms = true;
-    metadata.bonds = true;
-    // FIXME: the molfile plugin does not read residue information, we should
-    // add it when re-implementing a PSF reader.
-    metadata.residues = false;
-    return metadata;
-}
-
 template<> const FormatMetadata& chemfiles::format_metadata<Molfile<MOLDEN>>() {
     static FormatMetadata metadata;
     metadata.name = "Molden";
@@ -11,10 +11,13 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <iterator>
 #include <algorithm>
 #include <string_view>
 #include <unordered_map>
 
+#include <fmt/format.h>
+
 #include "chemfiles/types.hpp"
 #include "chemfiles/utils.hpp"
 #include "chemfiles/parse.hpp"
@@ -34,6 +37,7 @@
 
 #include "chemfiles/formats/PDB.hpp"
 #include "chemfiles/pdb_connectivity.hpp"
+#include "chemfiles/component_dictionary.hpp"
 
 using namespace chemfiles;
 
@@ -536,15 +540,40 @@ void PDBFormat::chain_ended(Frame& frame) {
     residues_.clear();
 }
 
+/// Add the bonds from the dictionary `component` between the atoms in
+/// `atom_name_to_index`, skipping atoms missing from the residue
+static void add_component_bonds(Frame& frame, const ComponentDictionary::Component& component, const std::map<std::string, size_t>& atom_name_to_index) {
+    auto atoms = std::vector<size_t>(component.size(), SIZE_MAX);
+    for (size_t i = 0; i < component.size(); i++) {
+        auto it = atom_name_to_index.find(std::string(component.atom(i)));
+        if (it != atom_name_to_index.end()) {
+            atoms[i] = it->second;
+        }
+    }
+
+    for (size_t k = 0; k < component.bonds_count(); k++) {
+        auto bond = component.bond(k);
+        if (atoms[bond.i] != SIZE_MAX && atoms[bond.j] != SIZE_MAX) {
+            frame.add_bond(atoms[bond.i], atoms[bond.j], bond.order);
+        }
+    }
+}
+
 void PDBFormat::link_standard_residue_bonds(Frame& frame) {
     bool link_previous_peptide = false;
     bool link_previous_nucleic = false;
     int64_t previous_residue_id = 0;
     size_t previous_carboxylic_id = 0;
 
+    auto dictionary = ComponentDictionary::global();
     for (const auto& residue: frame.topology().residues()) {
         auto residue_table = PDBConnectivity::find(residue.name());
-        if (!residue_table) {
+        auto component = optional<ComponentDictionary::Component>();
+        if (!residue_table && dictionary) {
+            component = dictionary->find(residue.name());
+        }
+
+        if (!residue_table && !component) {
             continue;
         }
 
@@ -553,6 +582,13 @@ void PDBFormat::link_standard_residue_bonds(Frame& frame) {
             atom_name_to_index[frame[atom].name()] =  atom;
         }
 
+        if (component && !component->polymer()) {
+            // ligands and other non-polymer components are not linked to
+            // their neighbors
+            add_component_bonds(frame, *component, atom_name_to_index);
+            continue;
+        }
+
         const auto& amide_nitrogen = atom_name_to_index.find("N");
         const auto& amide_carbon = atom_name_to_index.find("C");
 
@@ -598,6 +634,11 @@ void PDBFormat::link_standard_residue_bonds(Frame& frame) {
             frame.add_bond(atom_name_to_index["HO5'"], atom_name_to_index["O5'"]);
         }
 
+        if (component) {
+            add_component_bonds(frame, *component, atom_name_to_index);
+            continue;
+        }
+
         for (const auto& link: *residue_table) {
             const auto& first_atom = atom_name_to_index.find(link.first);
             const auto& second_atom = atom_name_to_index.find(link.second);
@@ -784,7 +825,17 @@ static int64_t adjust_for_ter_residues(size_t v, const std::vector<size_t>& ters
 
 void PDBFormat::write_next(const Frame& frame) {
     written_ = true;
-    file_.print("MODEL {:>4}\n", models_ + 1);
+    TextFormat::write_next(frame);
+}
+
+void PDBFormat::write_views(const std::vector<FrameView>& frames) {
+    written_ = written_ || !frames.empty();
+    TextFormat::write_views(frames);
+}
+
+bool PDBFormat::format_next(const Frame& frame, size_t step, std::string& buffer) const {
+    auto output = std::back_inserter(buffer);
+    fmt::format_to(output, "MODEL {:>4}\n", step + 1);
 
     auto lengths = frame.cell().lengths();
     auto angles = frame.cell().angles();
@@ -792,7 +843,7 @@ void PDBFormat::write_next(const Frame& frame) {
     check_values_size(angles, 7, "cell angles");
     // Do not try to guess the space group and the z value, just use the
     // default one.
-    file_.print("CRYST1{:9.3f}{:9.3f}{:9.3f}{:7.2f}{:7.2f}{:7.2f} P 1           1\n",
+    fmt::format_to(output, "CRYST1{:9.3f}{:9.3f}{:9.3f}{:7.2f}{:7.2f}{:7.2f} P 1           1\n",
         lengths[0], lengths[1], lengths[2], angles[0], angles[1], angles[2]
     );
 
@@ -834,7 +885,7 @@ void PDBFormat::write_next(const Frame& frame) {
         assert(resinfo.resname.length() <= 3);
 
         if (last_residue && last_residue->chainid != resinfo.chainid && needs_ter_record(*last_residue)) {
-            file_.print("TER   {: >5}      {:3} {:1}{: >4s}{:1}\n",
+            fmt::format_to(output, "TER   {: >5}      {:3} {:1}{: >4s}{:1}\n",
                 to_pdb_index(static_cast<int64_t>(i + ter_count), 5),
                 last_residue->resname, last_residue->chainid, last_residue->resid, last_residue->insertion_code);
             ter_serial_numbers.push_back(i + ter_count);
@@ -843,7 +894,7 @@ void PDBFormat::write_next(const Frame& frame) {
 
         auto& pos = positions[i];
         check_values_size(pos, 8, "atomic position");
-        file_.print(
+        fmt::format_to(output,
             "{: <6}{: >5} {: <4s}{:1}{:3} {:1}{: >4s}{:1}   {:8.3f}{:8.3f}{:8.3f}{:6.2f}{:6.2f}      {: <4s}{: >2s}\n",
             resinfo.atom_hetatm, to_pdb_index(static_cast<int64_t>(i + ter_count), 5), frame[i].name(), altloc,
             resinfo.resname, resinfo.chainid, resinfo.resid, resinfo.insertion_code,
@@ -882,19 +933,19 @@ void PDBFormat::write_next(const Frame& frame) {
         auto correction = adjust_for_ter_residues(i, ter_serial_numbers);
 
         for (size_t conect_line = 0; conect_line < lines; conect_line++) {
-            file_.print("CONECT{: >5}", to_pdb_index(correction, 5));
+            fmt::format_to(output, "CONECT{: >5}", to_pdb_index(correction, 5));
 
             auto last = std::min(connections, 4 * (conect_line + 1));
             for (size_t j = 4 * conect_line; j < last; j++) {
-                file_.print("{: >5}", to_pdb_index(connect[i][j], 5));
+                fmt::format_to(output, "{: >5}", to_pdb_index(connect[i][j], 5));
             }
-            file_.print("\n");
+            fmt::format_to(output, "\n");
         }
     }
 
-    file_.print("ENDMDL\n");
+    fmt::format_to(output, "ENDMDL\n");
 
-    models_++;
+    return true;
 }
 
 void check_values_size(const Vector3D& values, unsigned width, const std::string& context) {
@@ -0,0 +1,366 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdint>
+#include <cassert>
+
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+#include "chemfiles/utils.hpp"
+#include "chemfiles/parse.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/section_lines.hpp"
+#include "chemfiles/external/optional.hpp"
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Residue.hpp"
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/FormatMetadata.hpp"
+
+#include "chemfiles/formats/PSF.hpp"
+
+using namespace chemfiles;
+
+template<> const FormatMetadata& chemfiles::format_metadata<PSFFormat>() {
+    static FormatMetadata metadata;
+    metadata.name = "PSF";
+    metadata.extension = ".psf";
+    metadata.description = "Protein Structure File text format";
+    metadata.reference = "https://www.ks.uiuc.edu/Training/Tutorials/namd/namd-tutorial-unix-html/node23.html";
+
+    metadata.read = true;
+    metadata.write = false;
+    metadata.memory = true;
+
+    metadata.positions = false;
+    metadata.velocities = false;
+    metadata.unit_cell = false;
+    metadata.atoms = true;
+    metadata.bonds = true;
+    metadata.residues = true;
+    return metadata;
+}
+
+/// Read `count` lines from the PSF `section` in `file`
+static SectionLines read_section(TextFile& file, size_t count, const char* section) {
+    auto lines = SectionLines(file, count);
+    if (lines.size() != count) {
+        throw format_error(
+            "unexpected end of file in PSF {} section: expected {} lines, got {}",
+            section, count, lines.size()
+        );
+    }
+    return lines;
+}
+
+/// Split `line` on whitespace into at most `N` values, returning the number
+/// of values found. Additional values are ignored.
+template<size_t N>
+static size_t split_values(std::string_view line, std::array<std::string_view, N>& values) {
+    size_t count = 0;
+    size_t i = 0;
+    while (count < N) {
+        while (i < line.size() && is_ascii_whitespace(line[i])) {
+            i++;
+        }
+        if (i == line.size()) {
+            break;
+        }
+        auto start = i;
+        while (i < line.size() && !is_ascii_whitespace(line[i])) {
+            i++;
+        }
+        values[count] = line.substr(start, i - start);
+        count++;
+    }
+    return count;
+}
+
+/// Get the field `[start, start + width)` of `line`, without whitespace
+static std::string_view fixed_field(std::string_view line, size_t start, size_t width) {
+    if (start >= line.size()) {
+        return {};
+    }
+    return trim(line.substr(start, width));
+}
+
+/// Atomic data in the `!NATOM` section, in file order:
+/// id, segname, resid, resname, name, type, charge and mass.
+using atom_fields_t = std::array<std::string_view, 8>;
+
+/// Get the fields of an atom line in the `!NATOM` section
+static atom_fields_t atom_fields(std::string_view line, bool extended) {
+    // Most files can be read by splitting on whitespace, with an additional
+    // `imove` flag after the mass
+    std::array<std::string_view, 9> values;
+    if (split_values(line, values) == values.size()) {
+        atom_fields_t fields;
+        std::copy(values.begin(), values.begin() + 8, fields.begin());
+        return fields;
+    }
+
+    // Some values are missing or touching each other, fall back to the fixed
+    // columns format.
+    //  - standard: (I8,1X,A4,1X,A4,1X,A4,1X,A4,1X,A4,1X,2G14.6,I8)
+    //  - extended: (I10,1X,A8,1X,A8,1X,A8,1X,A8,1X,A6,1X,2G14.6,I8)
+    if (extended) {
+        return {{
+            fixed_field(line, 0, 10), fixed_field(line, 11, 8),
+            fixed_field(line, 20, 8), fixed_field(line, 29, 8),
+            fixed_field(line, 38, 8), fixed_field(line, 47, 6),
+            fixed_field(line, 54, 14), fixed_field(line, 68, 14),
+        }};
+    } else {
+        return {{
+            fixed_field(line, 0, 8), fixed_field(line, 9, 4),
+            fixed_field(line, 14, 4), fixed_field(line, 19, 4),
+            fixed_field(line, 24, 4), fixed_field(line, 29, 4),
+            fixed_field(line, 34, 14), fixed_field(line, 48, 14),
+        }};
+    }
+}
+
+/// Parse a residue id, which can contain an insertion code after the number
+/// (e.g. `12A`), returning the number and the insertion code.
+static std::pair<optional<int64_t>, std::string_view> parse_resid(std::string_view resid) {
+    size_t end = 0;
+    if (end < resid.size() && (resid[end] == '-' || resid[end] == '+')) {
+        end++;
+    }
+    while (end < resid.size() && is_ascii_digit(resid[end])) {
+        end++;
+    }
+
+    try {
+        return {parse<int64_t>(resid.substr(0, end)), resid.substr(end)};
+    } catch (const Error&) {
+        return {nullopt, resid};
+    }
+}
+
+void PSFFormat::read_next(Frame& frame) {
+    read_header();
+
+    auto title = read_section_header();
+    if (!title || title->second != "NTITLE") {
+        throw format_error("missing !NTITLE section in PSF file '{}'", file_.path());
+    }
+    for (size_t i = 0; i < title->first; i++) {
+        file_.readline();
+    }
+
+    auto atoms = read_section_header();
+    if (!atoms || atoms->second != "NATOM") {
+        throw format_error("missing !NATOM section in PSF file '{}'", file_.path());
+    }
+    read_atoms(frame, atoms->first);
+
+    auto bonds = read_section_header();
+    if (bonds && bonds->second == "NBOND") {
+        read_bonds(frame, bonds->first);
+    }
+
+    // The other sections (angles, dihedrals, impropers, ...) are not read:
+    // chemfiles computes angles, dihedrals and impropers from the bonds.
+}
+
+void PSFFormat::read_header() {
+    auto line = trim(file_.readline());
+    if (line.substr(0, 3) != "PSF") {
+        throw format_error(
+            "invalid PSF file '{}': expected the file to start with 'PSF', got '{}'",
+            file_.path(), line
+        );
+    }
+
+    extended_ = false;
+    for (auto flag: split(line.substr(3), ' ')) {
+        if (flag == "EXT") {
+            extended_ = true;
+        }
+    }
+}
+
+optional<std::pair<size_t, std::string>> PSFFormat::read_section_header() {
+    while (!file_.eof()) {
+        auto line = trim(file_.readline());
+        if (line.empty()) {
+            continue;
+        }
+
+        auto bang = line.find('!');
+        if (bang == std::string_view::npos) {
+            throw format_error("expected a section header in PSF file, got '{}'", line);
+        }
+
+        auto name = line.substr(bang + 1);
+        auto name_end = std::min(name.find(':'), name.find(' '));
+        name = name.substr(0, name_end);
+
+        // sections like NGRP contain multiple counts, we only need the first
+        std::array<std::string_view, 1> count;
+        if (split_values(line.substr(0, bang), count) != 1) {
+            throw format_error("missing number of entries in PSF section header '{}'", line);
+        }
+
+        try {
+            return std::make_pair(parse<size_t>(count[0]), std::string(name));
+        } catch (const Error& e) {
+            throw format_error(
+                "invalid number of entries in PSF section header '{}': {}", line, e.what()
+            );
+        }
+    }
+    return nullopt;
+}
+
+void PSFFormat::read_atoms(Frame& frame, size_t natoms) {
+    auto lines = read_section(file_, natoms, "!NATOM");
+
+    // residue data for all atoms, pointing inside `lines`
+    auto residues_data = std::vector<std::array<std::string_view, 3>>(natoms);
+
+    auto initial_size = frame.size();
+    frame.resize(initial_size + natoms);
+    parallel_for(0, natoms, PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto fields = atom_fields(lines[i], extended_);
+            if (fields[4].empty()) {
+                throw format_error("missing atom name in PSF atom line '{}'", lines[i]);
+            }
+
+            auto atom = Atom(std::string(fields[4]), std::string(fields[5]));
+            try {
+                atom.set_charge(parse<double>(fields[6]));
+                atom.set_mass(parse<double>(fields[7]));
+            } catch (const Error& e) {
+                throw format_error("invalid PSF atom line '{}': {}", lines[i], e.what());
+            }
+            frame[initial_size + i] = std::move(atom);
+
+            // segname, resid, resname
+            residues_data[i] = {{fields[1], fields[2], fields[3]}};
+        }
+    });
+
+    // Group atoms in residues, using the segment name, residue id and residue
+    // name to identify residues. Residues are added to the frame in the order
+    // of their first atom.
+    auto residues = std::vector<Residue>();
+    auto residues_index = std::unordered_map<std::string, size_t>();
+    std::string key;
+    size_t previous = static_cast<size_t>(-1);
+    for (size_t i = 0; i < natoms; i++) {
+        const auto& data = residues_data[i];
+        if (data[2].empty()) {
+            previous = static_cast<size_t>(-1);
+            continue;
+        }
+
+        // fast path: atoms from the same residue are usually contiguous
+        if (previous != static_cast<size_t>(-1) && residues_data[i - 1] == data) {
+            residues[previous].add_atom(initial_size + i);
+            continue;
+        }
+
+        key.clear();
+        key.append(data[0]).append(1, '\0').append(data[1]).append(1, '\0').append(data[2]);
+        auto inserted = residues_index.emplace(key, residues.size());
+        if (inserted.second) {
+            auto resid = parse_resid(data[1]);
+            auto residue = resid.first ?
+                Residue(std::string(data[2]), *resid.first) :
+                Residue(std::string(data[2]));
+
+            if (resid.first && !resid.second.empty()) {
+                residue.set("insertion_code", std::string(resid.second));
+            }
+
+            if (!data[0].empty()) {
+                residue.set("segname", std::string(data[0]));
+                residue.set("chainname", std::string(data[0].substr(0, 1)));
+                residue.set("chainid", std::string(data[0].substr(0, 1)));
+            }
+            residues.emplace_back(std::move(residue));
+        }
+
+        previous = inserted.first->second;
+        residues[previous].add_atom(initial_size + i);
+    }
+
+    for (auto& residue: residues) {
+        frame.add_residue(std::move(residue));
+    }
+}
+
+void PSFFormat::read_bonds(Frame& frame, size_t nbonds) {
+    // bonds are stored as 4 pairs of atomic indexes per line
+    constexpr size_t VALUES_PER_LINE = 8;
+    auto nvalues = 2 * nbonds;
+    auto lines = read_section(file_, (nvalues + VALUES_PER_LINE - 1) / VALUES_PER_LINE, "!NBOND");
+
+    auto natoms = frame.size();
+    auto bonds = std::vector<Bond>(nbonds, Bond(0, 1));
+    parallel_for(0, lines.size(), PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        std::array<std::string_view, VALUES_PER_LINE> values;
+        for (size_t line = start; line < stop; line++) {
+            auto first_value = line * VALUES_PER_LINE;
+            auto expected = std::min(VALUES_PER_LINE, nvalues - first_value);
+            auto count = split_values(lines[line], values);
+            if (count != expected) {
+                throw format_error(
+                    "expected {} values in PSF !NBOND line '{}', got {}",
+                    expected, lines[line], count
+                );
+            }
+
+            for (size_t k = 0; k < count; k += 2) {
+                size_t i = 0;
+                size_t j = 0;
+                try {
+                    i = parse<size_t>(values[k]);
+                    j = parse<size_t>(values[k + 1]);
+                } catch (const Error& e) {
+                    throw format_error("invalid PSF !NBOND line '{}': {}", lines[line], e.what());
+                }
+
+                if (i == 0 || j == 0 || i > natoms || j > natoms || i == j) {
+                    throw format_error(
+                        "invalid bond between atoms {} and {} in PSF file with {} atoms",
+                        i, j, natoms
+                    );
+                }
+                // PSF indexes start at 1
+                bonds[(first_value + k) / 2] = Bond(i - 1, j - 1);
+            }
+        }
+    });
+
+    // adding the bonds in sorted order appends them at the end of the
+    // topology bond storage, instead of inserting them in the middle.
+    std::sort(bonds.begin(), bonds.end());
+    for (const auto& bond: bonds) {
+        frame.add_bond(bond[0], bond[1]);
+    }
+}
+
+optional<uint64_t> PSFFormat::forward() {
+    // PSF only supports one step, so always act like there is only one
+    auto position = file_.tellpos();
+    if (position == 0) {
+        // advance the pointer for the next call
+        file_.readline();
+        return position;
+    } else {
+        return nullopt;
+    }
+}
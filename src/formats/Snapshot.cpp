@@ -0,0 +1,110 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/FormatMetadata.hpp"
+
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/snapshot.hpp"
+
+#include "chemfiles/files/BinaryFile.hpp"
+#include "chemfiles/formats/Snapshot.hpp"
+
+using namespace chemfiles;
+
+template <> const FormatMetadata& chemfiles::format_metadata<SnapshotFormat>() {
+    static FormatMetadata metadata;
+    metadata.name = "Chemfiles Snapshot";
+    metadata.extension = ".chfl";
+    metadata.description = "Binary snapshots of chemfiles frames";
+    metadata.reference = "https://chemfiles.org/chemfiles/latest/formats.html#binary-snapshots";
+
+    metadata.read = true;
+    metadata.write = true;
+    metadata.memory = false;
+
+    metadata.positions = true;
+    metadata.velocities = true;
+    metadata.unit_cell = true;
+    metadata.atoms = true;
+    metadata.bonds = true;
+    metadata.residues = true;
+    return metadata;
+}
+
+SnapshotFormat::SnapshotFormat(std::string path, File::Mode mode, File::Compression compression):
+    file_(std::move(path), mode)
+{
+    if (compression != File::DEFAULT) {
+        throw format_error("compression is not supported for Chemfiles Snapshot files");
+    }
+
+    if (mode == File::WRITE) {
+        return;
+    }
+
+    auto file_size = file_.file_size();
+    uint64_t offset = 0;
+    char header[SNAPSHOT_HEADER_SIZE];
+    while (offset < file_size) {
+        if (file_size - offset < SNAPSHOT_HEADER_SIZE) {
+            throw format_error(
+                "invalid Chemfiles Snapshot file: truncated snapshot at offset {}", offset
+            );
+        }
+
+        file_.seek(offset);
+        file_.read_char(header, SNAPSHOT_HEADER_SIZE);
+        auto size = snapshot_size(header, SNAPSHOT_HEADER_SIZE);
+        if (size > file_size - offset) {
+            throw format_error(
+                "invalid Chemfiles Snapshot file: truncated snapshot at offset {}", offset
+            );
+        }
+
+        offsets_.push_back(offset);
+        offset += size;
+    }
+
+    if (mode == File::APPEND) {
+        file_.seek(file_size);
+    } else {
+        file_.seek(0);
+    }
+}
+
+size_t SnapshotFormat::nsteps() {
+    return offsets_.size();
+}
+
+void SnapshotFormat::read_step(size_t step, Frame& frame) {
+    step_ = step;
+    this->read(frame);
+}
+
+void SnapshotFormat::read(Frame& frame) {
+    auto offset = offsets_[step_];
+    auto end = step_ + 1 < offsets_.size() ? offsets_[step_ + 1] : file_.file_size();
+
+    buffer_.resize(static_cast<size_t>(end - offset));
+    file_.seek(offset);
+    file_.read_char(buffer_);
+
+    frame = read_frame_snapshot(buffer_.data(), buffer_.size());
+    step_++;
+}
+
+void SnapshotFormat::write(const Frame& frame) {
+    buffer_.clear();
+    write_snapshot(frame, buffer_);
+
+    offsets_.push_back(file_.tell());
+    file_.write_char(buffer_.data(), buffer_.size());
+}
@@ -104,7 +104,7 @@ TNGFormat::TNGFormat(std::string path, File::Mode mode, File::Compression compre
 
         if (status == TNG_SUCCESS) {
             current_frame = next_frame;
-            tng_steps_.push_back(current_frame);
+            tng_steps_.push_back(static_cast<uint64_t>(current_frame));
         } else if (status == TNG_FAILURE) {
             // We found the end of the file
             break;
@@ -127,7 +127,8 @@ void TNGFormat::read_step(size_t step, Frame& frame) {
 }
 
 void TNGFormat::read(Frame& frame) {
-    frame.set_step(static_cast<size_t>(tng_steps_[step_]));
+    auto tng_step = static_cast<int64_t>(tng_steps_[step_]);
+    frame.set_step(static_cast<size_t>(tng_step));
     natoms_ = 0;
     CHECK(tng_num_particles_get(tng_, &natoms_));
     assert(natoms_ > 0);
@@ -135,7 +136,7 @@ void TNGFormat::read(Frame& frame) {
 
     double time = 0;
     tng_function_status status =
-        tng_util_time_of_frame_get(tng_, tng_steps_[step_], &time);
+        tng_util_time_of_frame_get(tng_, tng_step, &time);
     if (status == TNG_SUCCESS) {
         // TNG stores time in seconds
         // convert to pico seconds
@@ -153,9 +154,10 @@ void TNGFormat::read(Frame& frame) {
 void TNGFormat::read_positions(Frame& frame) {
     TngBuffer<float> buffer;
     int64_t unused = 0;
+    auto tng_step = static_cast<int64_t>(tng_steps_[step_]);
 
     CHECK(tng_util_pos_read_range(
-        tng_, tng_steps_[step_], tng_steps_[step_], buffer.ptr(), &unused
+        tng_, tng_step, tng_step, buffer.ptr(), &unused
     ));
 
     auto positions = frame.positions();
@@ -169,9 +171,10 @@ void TNGFormat::read_positions(Frame& frame) {
 void TNGFormat::read_velocities(Frame& frame) {
     TngBuffer<float> buffer;
     int64_t unused = 0;
+    auto tng_step = static_cast<int64_t>(tng_steps_[step_]);
 
     auto status = tng_util_vel_read_range(
-        tng_, tng_steps_[step_], tng_steps_[step_], buffer.ptr(), &unused
+        tng_, tng_step, tng_step, buffer.ptr(), &unused
     );
 
     switch (status) {
@@ -199,9 +202,10 @@ void TNGFormat::read_velocities(Frame& frame) {
 void TNGFormat::read_cell(Frame& frame) {
     TngBuffer<float> buffer;
     int64_t unused = 0;
+    auto tng_step = static_cast<int64_t>(tng_steps_[step_]);
 
     auto status = tng_util_box_shape_read_range(
-        tng_, tng_steps_[step_], tng_steps_[step_], buffer.ptr(), &unused
+        tng_, tng_step, tng_step, buffer.ptr(), &unused
     );
 
     switch (status) {
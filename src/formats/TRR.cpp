@@ -5,6 +5,7 @@
 #include <cstdint>
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,10 +13,12 @@
 #include "chemfiles/external/optional.hpp"
 #include "chemfiles/external/span.hpp"
 #include "chemfiles/types.hpp"
+#include "chemfiles/step_bisection.hpp"
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/FormatMetadata.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/Property.hpp"
 #include "chemfiles/UnitCell.hpp"
 
@@ -64,9 +67,9 @@ template <> const FormatMetadata& chemfiles::format_metadata<TRRFormat>() {
     return metadata;
 }
 
-static void get_cell(std::vector<float>& box, const Frame& frame);
-static void get_positions(std::vector<float>& x, const Frame& frame);
-static void get_velocities(std::vector<float>& v, const Frame& frame);
+static void get_cell(std::vector<float>& box, const FrameView& frame);
+static void get_positions(std::vector<float>& x, const FrameView& frame);
+static void get_velocities(std::vector<float>& v, const FrameView& frame);
 
 TRRFormat::TRRFormat(std::string path, File::Mode mode, File::Compression compression)
     : file_(std::move(path), mode) {
@@ -75,7 +78,10 @@ TRRFormat::TRRFormat(std::string path, File::Mode mode, File::Compression compre
     }
 
     if (mode == File::READ) {
-        determine_frame_offsets();
+        // only check the first frame header, the other frames are found when
+        // they are needed
+        natoms_ = read_frame_header().natoms;
+        file_.seek(0);
     } else if (mode == File::APPEND) {
         try {
             determine_frame_offsets();
@@ -83,17 +89,138 @@ TRRFormat::TRRFormat(std::string path, File::Mode mode, File::Compression compre
             // Ignore exceptions, because the file might not exist. If it does,
             // we need to get the number of atoms and frames for appending.
         }
+        indexed_ = true;
+    } else {
+        indexed_ = true;
+    }
+}
+
+size_t TRRFormat::nsteps() {
+    if (bisection_) {
+        return bisection_nsteps_;
+    }
+    index_steps();
+    return frame_offsets_.size();
+}
+
+bool TRRFormat::lazy_steps() const {
+    return !indexed_;
+}
+
+size_t TRRFormat::bisect_steps() {
+    if (indexed_) {
+        return frame_offsets_.size();
+    }
+
+    if (!bisection_) {
+        auto bisection = std::make_unique<StepBisection>(file_, TRR_MAGIC, [this](uint64_t offset) {
+            return this->frame_location(offset);
+        });
+
+        auto current = file_.tell();
+        auto nsteps = bisection->initialize();
+        file_.seek(current);
+        if (!nsteps) {
+            // the steps are not evenly spaced, find all of them instead
+            index_steps();
+            return frame_offsets_.size();
+        }
+
+        bisection_ = std::move(bisection);
+        bisection_nsteps_ = *nsteps;
+    }
+
+    return bisection_nsteps_;
+}
+
+void TRRFormat::index_steps() {
+    if (!indexed_) {
+        determine_frame_offsets();
+        indexed_ = true;
+        bisection_.reset();
+    }
+}
+
+uint64_t TRRFormat::frame_offset(size_t step) {
+    if (bisection_) {
+        auto offset = bisection_->locate(step);
+        if (offset) {
+            return *offset;
+        }
+        // the steps are not evenly spaced, find all of them instead
+        index_steps();
+    }
+
+    if (step >= frame_offsets_.size()) {
+        throw format_error(
+            "can not find step {} in TRR file at '{}': the file only contains {} steps",
+            step, file_.path(), frame_offsets_.size()
+        );
     }
+    return frame_offsets_[step];
 }
 
-size_t TRRFormat::nsteps() { return frame_offsets_.size(); }
+optional<FrameLocation> TRRFormat::frame_location(uint64_t offset) {
+    file_.seek(offset);
+    auto header = read_frame_header();
+    if (header.natoms != natoms_) {
+        return nullopt;
+    }
+
+    auto framebytes = static_cast<uint64_t>(
+        header.ir_size + header.e_size + header.box_size + header.vir_size + header.pres_size +
+        header.top_size + header.sym_size + header.x_size + header.v_size + header.f_size);
+    framebytes += file_.tell() - offset;
+
+    return FrameLocation{offset, framebytes, header.step};
+}
 
 void TRRFormat::read_step(size_t step, Frame& frame) {
     step_ = step;
-    file_.seek(frame_offsets_[step_]);
+    file_.seek(frame_offset(step_));
     read(frame);
 }
 
+void TRRFormat::read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) {
+    auto ranges = std::vector<BinaryFile::Range>();
+    ranges.reserve(steps.size());
+    for (auto step: steps) {
+        ranges.push_back(this->frame_range(step, 1));
+    }
+
+    file_.prefetch(ranges, [&](size_t i) {
+        this->read_step(steps[i], frames[i]);
+    });
+}
+
+void TRRFormat::set_access_pattern(AccessPattern pattern, size_t readahead) {
+    file_.set_access_pattern(pattern);
+    readahead_ = readahead;
+}
+
+BinaryFile::Range TRRFormat::frame_range(size_t step, size_t count) {
+    if (bisection_ && count != 0) {
+        // locate the frames without falling back to finding all the steps,
+        // the range is only used for hints to the operating system
+        auto position = file_.tell();
+        auto location = bisection_->locate_range(step, count);
+        file_.seek(position);
+        if (!location) {
+            return {0, 0};
+        }
+        return {location->offset, location->size};
+    }
+
+    if (step >= frame_offsets_.size() || count == 0) {
+        return {0, 0};
+    }
+
+    auto start = frame_offsets_[step];
+    auto last = step + count;
+    auto end = last < frame_offsets_.size() ? frame_offsets_[last] : file_.file_size();
+    return {start, end - start};
+}
+
 void TRRFormat::read(Frame& frame) {
     FrameHeader header = read_frame_header();
 
@@ -173,6 +300,9 @@ void TRRFormat::read(Frame& frame) {
         file_.skip(static_cast<uint64_t>(header.f_size));
     }
 
+    if (file_.access_pattern() == AccessPattern::SEQUENTIAL || file_.access_pattern() == AccessPattern::STREAMING) {
+        file_.sequential_hints(frame_range(step_, 1), frame_range(step_ + 1, readahead_));
+    }
     step_++;
 }
 
@@ -268,7 +398,7 @@ void TRRFormat::determine_frame_offsets() {
     const size_t est_nframes = static_cast<size_t>(filesize / (framebytes + TRR_MIN_HEADER_SIZE));
 
     frame_offsets_.clear();
-    frame_offsets_.emplace_back(0);
+    frame_offsets_.push_back(0);
     frame_offsets_.reserve(est_nframes);
 
     while (true) {
@@ -280,7 +410,7 @@ void TRRFormat::determine_frame_offsets() {
         } catch (const Error&) {
             break;
         }
-        frame_offsets_.emplace_back(frame_pos);
+        frame_offsets_.push_back(frame_pos);
 
         framebytes = calc_framebytes();
     }
@@ -288,7 +418,48 @@ void TRRFormat::determine_frame_offsets() {
     file_.seek(cur_pos);
 }
 
-void TRRFormat::write(const Frame& frame) {
+size_t TRRFormat::refresh() {
+    index_steps();
+    auto current = file_.tell();
+    auto filesize = file_.refresh();
+
+    // the last known frame might be incomplete, check it again
+    uint64_t position = 0;
+    if (!frame_offsets_.empty()) {
+        position = frame_offsets_.back();
+        frame_offsets_.pop_back();
+    }
+    find_complete_frames(position, filesize);
+
+    file_.seek(current);
+    return frame_offsets_.size();
+}
+
+void TRRFormat::find_complete_frames(uint64_t position, uint64_t filesize) {
+    while (position + TRR_MIN_HEADER_SIZE <= filesize) {
+        file_.seek(position);
+        auto header = FrameHeader();
+        try {
+            header = read_frame_header();
+        } catch (const Error&) {
+            // the frame header is not fully written yet
+            break;
+        }
+
+        auto framebytes = static_cast<uint64_t>(
+            header.ir_size + header.e_size + header.box_size + header.vir_size + header.pres_size +
+            header.top_size + header.sym_size + header.x_size + header.v_size + header.f_size);
+        auto end = file_.tell() + framebytes;
+        if (end > filesize) {
+            break;
+        }
+
+        frame_offsets_.push_back(position);
+        position = end;
+    }
+}
+
+void TRRFormat::write_view(const FrameView& frame) {
     const size_t natoms = frame.size();
     if (frame_offsets_.empty() && step_ == 0) {
         natoms_ = natoms;
@@ -384,7 +555,7 @@ void TRRFormat::write_frame_header(const FrameHeader& header) {
     file_.write_single_f32(static_cast<float>(header.lambda));
 }
 
-void get_cell(std::vector<float>& box, const Frame& frame) {
+void get_cell(std::vector<float>& box, const FrameView& frame) {
     assert(box.size() == 3 * 3);
     // Factor 10 because the lengths are in nm in the TRR format
     auto matrix = frame.cell().matrix() / 10.0;
@@ -399,7 +570,7 @@ void get_cell(std::vector<float>& box, const Frame& frame) {
     box[8] = static_cast<float>(matrix[2][2]);
 }
 
-void get_positions(std::vector<float>& x, const Frame& frame) {
+void get_positions(std::vector<float>& x, const FrameView& frame) {
     auto positions = frame.positions();
     assert(x.size() == 3 * positions.size());
     for (size_t i = 0; i < frame.size(); ++i) {
@@ -410,7 +581,7 @@ void get_positions(std::vector<float>& x, const Frame& frame) {
     }
 }
 
-void get_velocities(std::vector<float>& v, const Frame& frame) {
+void get_velocities(std::vector<float>& v, const FrameView& frame) {
     auto velocities = *frame.velocities();
     assert(v.size() == 3 * velocities.size());
     for (size_t i = 0; i < frame.size(); i++) {
@@ -4,7 +4,9 @@
 #include <cassert>
 #include <cstdint>
 
+#include <algorithm>
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,10 +14,12 @@
 #include "chemfiles/external/optional.hpp"
 #include "chemfiles/external/span.hpp"
 #include "chemfiles/types.hpp"
+#include "chemfiles/step_bisection.hpp"
 
 #include "chemfiles/File.hpp"
 #include "chemfiles/FormatMetadata.hpp"
 #include "chemfiles/Frame.hpp"
+#include "chemfiles/FrameView.hpp"
 #include "chemfiles/UnitCell.hpp"
 
 #include "chemfiles/files/XDRFile.hpp"
@@ -71,8 +75,9 @@ template <> const FormatMetadata& chemfiles::format_metadata<XTCFormat>() {
     return metadata;
 }
 
-static void get_cell(std::vector<float>& box, const Frame& frame);
-static void get_positions(std::vector<float>& x, const Frame& frame);
+static void get_cell(std::vector<float>& box, const FrameView& frame);
+static int32_t round_to_int_boundary(int32_t x);
+static void get_positions(std::vector<float>& x, const FrameView& frame);
 
 XTCFormat::XTCFormat(std::string path, File::Mode mode, File::Compression compression)
     : file_(std::move(path), mode) {
@@ -81,7 +86,10 @@ XTCFormat::XTCFormat(std::string path, File::Mode mode, File::Compression compre
     }
 
     if (mode == File::READ) {
-        determine_frame_offsets();
+        // only check the first frame header, the other frames are found when
+        // they are needed
+        natoms_ = read_frame_header().natoms;
+        file_.seek(0);
     } else if (mode == File::APPEND) {
         try {
             determine_frame_offsets();
@@ -89,23 +97,161 @@ XTCFormat::XTCFormat(std::string path, File::Mode mode, File::Compression compre
             // Ignore exceptions, because the file might not exist. If it does,
             // we need to get the number of atoms and frames for appending.
         }
+        indexed_ = true;
+    } else {
+        indexed_ = true;
+    }
+}
+
+size_t XTCFormat::nsteps() {
+    if (bisection_) {
+        return bisection_nsteps_;
+    }
+    index_steps();
+    return frame_offsets_.size();
+}
+
+bool XTCFormat::lazy_steps() const {
+    return !indexed_;
+}
+
+size_t XTCFormat::bisect_steps() {
+    if (indexed_) {
+        return frame_offsets_.size();
+    }
+
+    if (!bisection_) {
+        auto bisection = std::make_unique<StepBisection>(file_, XTC_MAGIC, [this](uint64_t offset) {
+            return this->frame_location(offset);
+        });
+
+        auto current = file_.tell();
+        auto nsteps = bisection->initialize();
+        file_.seek(current);
+        if (!nsteps) {
+            // the steps are not evenly spaced, find all of them instead
+            index_steps();
+            return frame_offsets_.size();
+        }
+
+        bisection_ = std::move(bisection);
+        bisection_nsteps_ = *nsteps;
+    }
+
+    return bisection_nsteps_;
+}
+
+void XTCFormat::index_steps() {
+    if (!indexed_) {
+        determine_frame_offsets();
+        indexed_ = true;
+        bisection_.reset();
+    }
+}
+
+uint64_t XTCFormat::frame_offset(size_t step) {
+    if (bisection_) {
+        auto offset = bisection_->locate(step);
+        if (offset) {
+            return *offset;
+        }
+        // the steps are not evenly spaced, find all of them instead
+        index_steps();
+    }
+
+    if (step >= frame_offsets_.size()) {
+        throw format_error(
+            "can not find step {} in XTC file at '{}': the file only contains {} steps",
+            step, file_.path(), frame_offsets_.size()
+        );
     }
+    return frame_offsets_[step];
 }
 
-size_t XTCFormat::nsteps() { return frame_offsets_.size(); }
+optional<FrameLocation> XTCFormat::frame_location(uint64_t offset) {
+    file_.seek(offset);
+    auto header = read_frame_header();
+    if (header.natoms != natoms_) {
+        return nullopt;
+    }
+
+    file_.seek(offset + XTC_SMALL_HEADER_SIZE - sizeof(int32_t));
+    if (file_.read_single_size_as_i32() != header.natoms) {
+        return nullopt;
+    }
+
+    uint64_t framebytes = 0;
+    if (header.natoms <= 9) {
+        framebytes = XTC_SMALL_HEADER_SIZE + header.natoms * XTC_SMALL_COORDS_SIZE;
+    } else {
+        file_.seek(offset + XTC_HEADER_SIZE);
+        auto compressed = file_.read_single_i32();
+        if (compressed <= 0) {
+            return nullopt;
+        }
+        framebytes = XTC_HEADER_SIZE + sizeof(int32_t) + static_cast<uint64_t>(round_to_int_boundary(compressed));
+    }
+
+    return FrameLocation{offset, framebytes, header.step};
+}
 
 void XTCFormat::read_step(size_t step, Frame& frame) {
     step_ = step;
-    file_.seek(frame_offsets_[step_]);
+    file_.seek(frame_offset(step_));
     read(frame);
 }
 
+void XTCFormat::read_steps(const std::vector<size_t>& steps, std::vector<Frame>& frames) {
+    auto ranges = std::vector<BinaryFile::Range>();
+    ranges.reserve(steps.size());
+    for (auto step: steps) {
+        ranges.push_back(this->frame_range(step, 1));
+    }
+
+    file_.prefetch(ranges, [&](size_t i) {
+        this->read_step(steps[i], frames[i]);
+    });
+}
+
+void XTCFormat::set_access_pattern(AccessPattern pattern, size_t readahead) {
+    file_.set_access_pattern(pattern);
+    readahead_ = readahead;
+}
+
+void XTCFormat::set_needed_atoms(optional<size_t> count) {
+    needed_atoms_ = count.value_or(SIZE_MAX);
+}
+
+BinaryFile::Range XTCFormat::frame_range(size_t step, size_t count) {
+    if (bisection_ && count != 0) {
+        // locate the frames without falling back to finding all the steps,
+        // the range is only used for hints to the operating system
+        auto position = file_.tell();
+        auto location = bisection_->locate_range(step, count);
+        file_.seek(position);
+        if (!location) {
+            return {0, 0};
+        }
+        return {location->offset, location->size};
+    }
+
+    if (step >= frame_offsets_.size() || count == 0) {
+        return {0, 0};
+    }
+
+    auto start = frame_offsets_[step];
+    auto last = step + count;
+    auto end = last < frame_offsets_.size() ? frame_offsets_[last] : file_.file_size();
+    return {start, end - start};
+}
+
 void XTCFormat::read(Frame& frame) {
     FrameHeader header = read_frame_header();
 
     frame.set_step(header.step);                         // actual step of MD Simulation
     frame.set("time", static_cast<double>(header.time)); // time in pico seconds
-    frame.resize(header.natoms);
+    // only keep the atoms needed by the caller, see `set_needed_atoms`
+    frame.resize(std::min(header.natoms, needed_atoms_));
 
     const auto box = file_.read_gmx_box();
     frame.set_cell(box);
@@ -120,11 +266,11 @@ void XTCFormat::read(Frame& frame) {
     if (header.natoms <= 9) {
         file_.read_f32(x);
     } else {
-        float precision = file_.read_gmx_compressed_floats(x);
+        float precision = file_.read_gmx_compressed_floats(x, needed_atoms_);
         frame.set("xtc_precision", static_cast<double>(precision));
     }
     auto positions = frame.positions();
-    assert(x.size() == 3 * positions.size());
+    assert(x.size() >= 3 * positions.size());
     for (size_t i = 0; i < frame.size(); i++) {
         // Factor 10 because the cell lengths are in nm in the XTC format
         positions[i][0] = static_cast<double>(x[i * 3]) * 10.0;
@@ -132,6 +278,9 @@ void XTCFormat::read(Frame& frame) {
         positions[i][2] = static_cast<double>(x[i * 3 + 2]) * 10.0;
     }
 
+    if (file_.access_pattern() == AccessPattern::SEQUENTIAL || file_.access_pattern() == AccessPattern::STREAMING) {
+        file_.sequential_hints(frame_range(step_, 1), frame_range(step_ + 1, readahead_));
+    }
     step_++;
 }
 
@@ -156,7 +305,7 @@ XTCFormat::FrameHeader XTCFormat::read_frame_header() {
     }
 }
 
-static int32_t round_to_int_boundary(int32_t x) {
+int32_t round_to_int_boundary(int32_t x) {
     // Rounding to the next 32-bit boundary
     return (x + 3) & ~0x03;
 }
@@ -171,7 +320,7 @@ void XTCFormat::determine_frame_offsets() {
     const uint64_t filesize = file_.file_size();
 
     frame_offsets_.clear();
-    frame_offsets_.emplace_back(0);
+    frame_offsets_.push_back(0);
 
     // GROMACS does not bother with compression for nine atoms or less
     if (header.natoms <= 9) {
@@ -183,7 +332,7 @@ void XTCFormat::determine_frame_offsets() {
         frame_offsets_.reserve(static_cast<size_t>(nframes));
 
         for (uint64_t i = 1; i < nframes; ++i) {
-            frame_offsets_.emplace_back(i * framebytes);
+            frame_offsets_.push_back(i * framebytes);
         }
     } else {
         file_.seek(XTC_HEADER_SIZE);
@@ -202,14 +351,61 @@ void XTCFormat::determine_frame_offsets() {
             } catch (const Error&) {
                 break;
             }
-            frame_offsets_.emplace_back(frame_pos);
+            frame_offsets_.push_back(frame_pos);
         }
     }
 
     file_.seek(cur_pos);
 }
 
-void XTCFormat::write(const Frame& frame) {
+size_t XTCFormat::refresh() {
+    index_steps();
+    auto current = file_.tell();
+    auto filesize = file_.refresh();
+
+    // the last known frame might be incomplete, check it again
+    uint64_t position = 0;
+    if (!frame_offsets_.empty()) {
+        position = frame_offsets_.back();
+        frame_offsets_.pop_back();
+    }
+    find_complete_frames(position, filesize);
+
+    file_.seek(current);
+    return frame_offsets_.size();
+}
+
+void XTCFormat::find_complete_frames(uint64_t position, uint64_t filesize) {
+    while (position + XTC_SMALL_HEADER_SIZE <= filesize) {
+        file_.seek(position);
+        uint64_t framebytes = 0;
+        try {
+            auto header = read_frame_header();
+            if (header.natoms <= 9) {
+                framebytes = XTC_SMALL_HEADER_SIZE + header.natoms * XTC_SMALL_COORDS_SIZE;
+            } else {
+                if (position + XTC_HEADER_SIZE + sizeof(int32_t) > filesize) {
+                    break;
+                }
+                file_.seek(position + XTC_HEADER_SIZE);
+                auto compressed = static_cast<uint64_t>(round_to_int_boundary(file_.read_single_i32()));
+                framebytes = XTC_HEADER_SIZE + sizeof(int32_t) + compressed;
+            }
+        } catch (const Error&) {
+            // the frame header is not fully written yet
+            break;
+        }
+
+        if (position + framebytes > filesize) {
+            break;
+        }
+
+        frame_offsets_.push_back(position);
+        position += framebytes;
+    }
+}
+
+void XTCFormat::write_view(const FrameView& frame) {
     const size_t natoms = frame.size();
     if (frame_offsets_.empty() && step_ == 0) {
         natoms_ = natoms;
@@ -253,7 +449,7 @@ void XTCFormat::write_frame_header(const FrameHeader& header) {
     file_.write_single_f32(static_cast<float>(header.time));
 }
 
-void get_cell(std::vector<float>& box, const Frame& frame) {
+void get_cell(std::vector<float>& box, const FrameView& frame) {
     assert(box.size() == 3 * 3);
     // Factor 10 because the lengths are in nm in the XTC format
     auto matrix = frame.cell().matrix() / 10.0;
@@ -268,7 +464,7 @@ void get_cell(std::vector<float>& box, const Frame& frame) {
     box[8] = static_cast<float>(matrix[2][2]);
 }
 
-void get_positions(std::vector<float>& x, const Frame& frame) {
+void get_positions(std::vector<float>& x, const FrameView& frame) {
     auto positions = frame.positions();
     assert(x.size() == 3 * positions.size());
     for (size_t i = 0; i < frame.size(); ++i) {
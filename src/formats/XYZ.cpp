@@ -9,6 +9,7 @@
 #include <array>
 #include <string>
 #include <vector>
+#include <iterator>
 #include <exception>
 #include <string_view>
 #include <unordered_map>
@@ -20,7 +21,9 @@
 #include "chemfiles/utils.hpp"
 #include "chemfiles/warnings.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
 #include "chemfiles/unreachable.hpp"
+#include "chemfiles/section_lines.hpp"
 #include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/File.hpp"
@@ -84,58 +87,76 @@ void XYZFormat::read_next(Frame& frame) {
 
     auto properties = read_extended_comment_line(file_.readline(), frame);
 
-    frame.reserve(n_atoms);
-    for (size_t i=0; i<n_atoms; i++) {
-        auto line = file_.readline();
-        double x = 0, y = 0, z = 0;
-        std::string name;
-        auto count = scan(line, name, x, y, z);
-        auto atom = Atom(std::move(name));
-        read_atomic_properties(properties, line.substr(count), atom);
-        frame.add_atom(std::move(atom), Vector3D(x, y, z));
+    auto lines = SectionLines(file_, n_atoms);
+    if (lines.size() != n_atoms) {
+        throw format_error(
+            "not enough lines in XYZ file: expected {} atoms, got {}",
+            n_atoms, lines.size()
+        );
     }
+
+    frame.resize(n_atoms);
+    auto positions = frame.positions();
+    parallel_for(0, n_atoms, PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto line = lines[i];
+            double x = 0, y = 0, z = 0;
+            std::string name;
+            auto count = scan(line, name, x, y, z);
+            auto atom = Atom(std::move(name));
+            read_atomic_properties(properties, line.substr(count), atom);
+            frame[i] = std::move(atom);
+            positions[i] = Vector3D(x, y, z);
+        }
+    });
 }
 
-void XYZFormat::write_next(const Frame& frame) {
+bool XYZFormat::format_next(const Frame& frame, size_t /*unused*/, std::string& buffer) const {
     auto& positions = frame.positions();
     auto properties = get_atom_properties(frame);
 
-    file_.print("{}\n", frame.size());
-    file_.print("{}\n", write_extended_comment_line(frame, properties));
+    auto output = std::back_inserter(buffer);
+    fmt::format_to(output, "{}\n", frame.size());
+    fmt::format_to(output, "{}\n", write_extended_comment_line(frame, properties));
 
-    for (size_t i = 0; i < frame.size(); i++) {
-        const auto& atom = frame[i];
+    format_parallel(frame.size(), buffer, [&](size_t start, size_t stop, std::string& chunk) {
+        auto chunk_output = std::back_inserter(chunk);
+        for (size_t i = start; i < stop; i++) {
+            const auto& atom = frame[i];
 
-        auto name = atom.name();
-        if (name.empty()) {
-            name = "X";
-        }
+            auto name = atom.name();
+            if (name.empty()) {
+                name = "X";
+            }
 
-        file_.print("{} {:g} {:g} {:g}",
-            name, positions[i][0], positions[i][1], positions[i][2]
-        );
+            fmt::format_to(chunk_output, "{} {:g} {:g} {:g}",
+                name, positions[i][0], positions[i][1], positions[i][2]
+            );
 
-        for (const auto& property: properties) {
-            const auto& value = atom.get(property.name).value();
+            for (const auto& property: properties) {
+                const auto& value = atom.get(property.name).value();
 
-            if (property.type == Property::STRING) {
-                file_.print(" {}", value.as_string());
-            } else if (property.type == Property::BOOL) {
-                if (value.as_bool()) {
-                    file_.print(" T");
-                } else {
-                    file_.print(" F");
+                if (property.type == Property::STRING) {
+                    fmt::format_to(chunk_output, " {}", value.as_string());
+                } else if (property.type == Property::BOOL) {
+                    if (value.as_bool()) {
+                        chunk += " T";
+                    } else {
+                        chunk += " F";
+                    }
+                } else if (property.type == Property::DOUBLE) {
+                    fmt::format_to(chunk_output, " {:g}", value.as_double());
+                } else if (property.type == Property::VECTOR3D) {
+                    const auto& vector = value.as_vector3d();
+                    fmt::format_to(chunk_output, " {:g} {:g} {:g}", vector[0], vector[1], vector[2]);
                 }
-            } else if (property.type == Property::DOUBLE) {
-                file_.print(" {:g}", value.as_double());
-            } else if (property.type == Property::VECTOR3D) {
-                const auto& vector = value.as_vector3d();
-                file_.print(" {:g} {:g} {:g}", vector[0], vector[1], vector[2]);
             }
+
+            chunk += '\n';
         }
+    });
 
-        file_.print("\n");
-    }
+    return true;
 }
 
 optional<uint64_t> XYZFormat::forward() {
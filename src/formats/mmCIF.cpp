@@ -15,6 +15,8 @@
 #include "chemfiles/utils.hpp"
 #include "chemfiles/parse.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/thread_pool.hpp"
+#include "chemfiles/section_lines.hpp"
 #include "chemfiles/external/optional.hpp"
 
 #include "chemfiles/File.hpp"
@@ -57,6 +59,10 @@ template<> const FormatMetadata& chemfiles::format_metadata<mmCIFFormat>() {
 /// function handle this
 static double cif_to_double(std::string_view line);
 
+/// Get the field at `index` in `line`, where fields are separated by spaces.
+/// This returns an empty string if there are not enough fields in the line.
+static std::string_view nth_field(std::string_view line, size_t index);
+
 void mmCIFFormat::init_() {
     if (file_.mode() == File::WRITE) {
         return;
@@ -250,110 +256,149 @@ void mmCIFFormat::read(Frame& frame) {
 
     auto model_position = atom_site_map_.find("pdbx_PDB_model_num");
 
+    // Read all the lines for this model first, to parse them in parallel
+    auto lines = SectionLines();
     auto position = file_.tellpos();
-
-    size_t last_position = 0;
-    if (model_position != atom_site_map_.end()) {
-        auto line = file_.readline();
-        last_position = parse<size_t>(split(line, ' ')[model_position->second]);
-        // Reset file position so that the loop below can start by reading the
-        // first line
-        file_.seekpos(position);
-    }
-
+    optional<size_t> last_position = nullopt;
+    std::string last_position_text;
     while (!file_.eof()) {
         auto line = file_.readline();
-        auto line_split = split(line, ' ');
         if (line.empty() || line == "loop_" || line[0] == '#') {
             break;
         }
 
-        if (line_split.size() != atom_site_map_.size()) {
-            throw format_error("line '{}' has {} items not {}",
-                line, line_split.size(), atom_site_map_.size()
-            );
-        }
-
-        size_t current_position = 0;
         if (model_position != atom_site_map_.end()) {
-            current_position = parse<size_t>(line_split[model_position->second]);
+            // only parse the model number when its text changes, since all
+            // the atoms in a model share the same text
+            auto model = nth_field(line, model_position->second);
+            if (!model.empty() && model != last_position_text) {
+                auto current_position = parse<size_t>(model);
+                if (last_position && current_position != *last_position) {
+                    break;
+                }
+                last_position = current_position;
+                last_position_text = std::string(model);
+            }
         }
 
-        if (current_position != last_position) {
-            break;
-        }
+        lines.push_back(line);
+        position = file_.tellpos();
+    }
 
-        auto atom = Atom(
-            std::string(line_split[label_atom_id->second]),
-            std::string(line_split[type_symbol])
-        );
+    // Reset state to previous line
+    file_.seekpos(position);
 
-        if (label_alt_id != atom_site_map_.end() &&
-            line_split[label_alt_id->second] != ".") {
-            atom.set("altloc", std::string(line_split[label_alt_id->second]));
-        }
+    auto has_residues = label_comp_id != atom_site_map_.end() && label_asym_id != atom_site_map_.end();
 
-        if (formal_charge != atom_site_map_.end()) {
-            atom.set_charge(cif_to_double(line_split[formal_charge->second]));
-        }
+    // residue data for all atoms, pointing inside `lines`
+    struct residue_data {
+        int64_t resid = 0;
+        std::string_view chainid;
+        std::string_view name;
+        std::string_view chainname;
+        bool is_standard_pdb = false;
+    };
+    auto residues_data = std::vector<residue_data>(has_residues ? lines.size() : 0);
+
+    auto initial_size = frame.size();
+    frame.resize(initial_size + lines.size());
+    auto positions = frame.positions();
+    parallel_for(0, lines.size(), PARALLEL_PARSE_GRAIN, [&](size_t start, size_t stop) {
+        for (size_t i = start; i < stop; i++) {
+            auto line = lines[i];
+            auto line_split = split(line, ' ');
+            if (line_split.size() != atom_site_map_.size()) {
+                throw format_error("line '{}' has {} items not {}",
+                    line, line_split.size(), atom_site_map_.size()
+                );
+            }
 
-        auto x = cif_to_double(line_split[cartn_x]);
-        auto y = cif_to_double(line_split[cartn_y]);
-        auto z = cif_to_double(line_split[cartn_z]);
-        frame.add_atom(std::move(atom), Vector3D(x, y, z));
+            auto atom = Atom(
+                std::string(line_split[label_atom_id->second]),
+                std::string(line_split[type_symbol])
+            );
 
-        position = file_.tellpos();
+            if (label_alt_id != atom_site_map_.end() &&
+                line_split[label_alt_id->second] != ".") {
+                atom.set("altloc", std::string(line_split[label_alt_id->second]));
+            }
 
-        if (label_comp_id == atom_site_map_.end() || label_asym_id == atom_site_map_.end()) {
-            continue;
-        }
+            if (formal_charge != atom_site_map_.end()) {
+                atom.set_charge(cif_to_double(line_split[formal_charge->second]));
+            }
 
-        auto atom_id = frame.size() - 1;
-        int64_t resid = 0;
-        auto resid_text = line_split[label_seq_id->second];
+            frame[initial_size + i] = std::move(atom);
+            positions[initial_size + i] = Vector3D(
+                cif_to_double(line_split[cartn_x]),
+                cif_to_double(line_split[cartn_y]),
+                cif_to_double(line_split[cartn_z])
+            );
 
-        try {
-            if (resid_text == ".") { // In this case, we need to use the entity id
-                resid = parse<int64_t>(line_split[label_entity_id->second]);
-            } else {
-                resid = parse<int64_t>(line_split[label_seq_id->second]);
+            if (!has_residues) {
+                continue;
             }
-        } catch (const Error& e) {
-            throw format_error("invalid CIF residue or entity numeric: {}", e.what());
-        }
 
-        auto chainid = std::string(line_split[label_asym_id->second]);
+            auto& residue = residues_data[i];
+            auto resid_text = line_split[label_seq_id->second];
+            try {
+                if (resid_text == ".") { // In this case, we need to use the entity id
+                    residue.resid = parse<int64_t>(line_split[label_entity_id->second]);
+                } else {
+                    residue.resid = parse<int64_t>(resid_text);
+                }
+            } catch (const Error& e) {
+                throw format_error("invalid CIF residue or entity numeric: {}", e.what());
+            }
 
-        if (map_residues_indexes.find({chainid, resid}) == map_residues_indexes.end()) {
+            residue.chainid = line_split[label_asym_id->second];
+            residue.name = line_split[label_comp_id->second];
+            if (auth_asym_id != atom_site_map_.end()) {
+                residue.chainname = line_split[auth_asym_id->second];
+            }
+            if (group_pdb != atom_site_map_.end()) {
+                residue.is_standard_pdb = line_split[group_pdb->second] == "ATOM";
+            }
+        }
+    });
+
+    // atoms in the same residue are usually consecutive, so only look up the
+    // residue when the residue id or the chain changes
+    size_t last_residue = 0;
+    for (size_t i = 0; i < residues_data.size(); i++) {
+        const auto& data = residues_data[i];
+        auto atom_id = initial_size + i;
+        if (i != 0 && data.resid == residues_data[i - 1].resid && data.chainid == residues_data[i - 1].chainid) {
+            residues_[last_residue].add_atom(atom_id);
+            continue;
+        }
 
-            auto name = line_split[label_comp_id->second];
-            Residue residue(std::string(name), resid);
+        auto chainid = std::string(data.chainid);
+        auto it = map_residues_indexes.find({chainid, data.resid});
+        if (it == map_residues_indexes.end()) {
+            Residue residue(std::string(data.name), data.resid);
             residue.add_atom(atom_id);
 
             // This will be saved as a string on purpose to match MMTF
-            if (label_asym_id != atom_site_map_.end()) {
-                residue.set("chainid", chainid);
-            }
+            residue.set("chainid", chainid);
 
             if (auth_asym_id != atom_site_map_.end()) {
-                residue.set("chainname", std::string(line_split[auth_asym_id->second]));
+                residue.set("chainname", std::string(data.chainname));
             }
 
             if (group_pdb != atom_site_map_.end()) {
-                residue.set("is_standard_pdb", line_split[group_pdb->second] == "ATOM");
+                residue.set("is_standard_pdb", data.is_standard_pdb);
             }
 
-            map_residues_indexes.emplace(std::make_pair(chainid, resid), residues_.size());
+            last_residue = residues_.size();
+            map_residues_indexes.emplace(std::make_pair(std::move(chainid), data.resid), last_residue);
             residues_.emplace_back(std::move(residue));
         } else {
             // Just add this atom to the residue
-            residues_[map_residues_indexes.at({ chainid, resid })].add_atom(atom_id);
+            last_residue = it->second;
+            residues_[last_residue].add_atom(atom_id);
         }
     }
 
-    // Reset state to previous line
-    file_.seekpos(position);
-
     for (const auto& residue: residues_) {
         frame.add_residue(residue);
     }
@@ -452,3 +497,26 @@ double cif_to_double(std::string_view line) {
 
     return parse<double>(line);
 }
+
+std::string_view nth_field(std::string_view line, size_t index) {
+    // same splitting rules as `split(line, ' ')`, without allocating
+    size_t current = 0;
+    size_t i = 0;
+    while (i < line.length()) {
+        while (i < line.length() && line[i] == ' ') {
+            i++;
+        }
+        auto start = i;
+        while (i < line.length() && line[i] != ' ') {
+            i++;
+        }
+        if (start == i) {
+            break;
+        }
+        if (current == index) {
+            return line.substr(start, i - start);
+        }
+        current++;
+    }
+    return {};
+}
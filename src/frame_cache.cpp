@@ -0,0 +1,129 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <list>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Property.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/frame_cache.hpp"
+#include "chemfiles/topology_cache.hpp"
+#include "chemfiles/external/optional.hpp"
+
+using namespace chemfiles;
+
+bool FrameCache::get(size_t step, Frame& frame) {
+    auto it = index_.find(step);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    // move the entry to the front of the list
+    entries_.splice(entries_.begin(), entries_, it->second);
+    const auto& entry = *it->second;
+
+    frame = Frame(entry.cell);
+    frame.resize(entry.positions.size());
+    frame.set_topology(*entry.topology);
+    frame.set_step(entry.frame_step);
+
+    auto positions = frame.positions();
+    std::copy(entry.positions.begin(), entry.positions.end(), positions.begin());
+
+    if (entry.velocities) {
+        frame.add_velocities();
+        auto velocities = *frame.velocities();
+        std::copy(entry.velocities->begin(), entry.velocities->end(), velocities.begin());
+    }
+
+    for (const auto& property: entry.properties) {
+        frame.set(property.first, property.second);
+    }
+
+    return true;
+}
+
+void FrameCache::insert(size_t step, const Frame& frame) {
+    auto existing = index_.find(step);
+    if (existing != index_.end()) {
+        auto& entry = *existing->second;
+        memory_ -= entry.memory;
+        if (entry.topology.use_count() == 1) {
+            memory_ -= entry.topology_memory;
+        }
+        entries_.erase(existing->second);
+        index_.erase(existing);
+    }
+
+    auto positions = frame.positions();
+    auto entry = Entry{
+        step,
+        frame.step(),
+        std::vector<Vector3D>(positions.begin(), positions.end()),
+        nullopt,
+        nullptr,
+        frame.cell(),
+        frame.properties(),
+        0,
+        0,
+    };
+
+    auto velocities = frame.velocities();
+    if (velocities) {
+        entry.velocities = std::vector<Vector3D>(velocities->begin(), velocities->end());
+    }
+
+    entry.memory = sizeof(Entry) + sizeof(Vector3D) * frame.size();
+    if (entry.velocities) {
+        entry.memory += sizeof(Vector3D) * frame.size();
+    }
+    entry.memory += properties_memory(entry.properties);
+
+    auto last_topology = last_topology_.lock();
+    if (last_topology && same_topology(*last_topology, frame.topology())) {
+        entry.topology = std::move(last_topology);
+        entry.topology_memory = topology_memory(*entry.topology);
+    } else {
+        entry.topology = std::make_shared<const Topology>(frame.topology());
+        entry.topology_memory = topology_memory(*entry.topology);
+        memory_ += entry.topology_memory;
+        last_topology_ = entry.topology;
+    }
+    memory_ += entry.memory;
+
+    entries_.push_front(std::move(entry));
+    index_.emplace(step, entries_.begin());
+    this->shrink();
+}
+
+void FrameCache::shrink() {
+    while (memory_ > limit_ && !entries_.empty()) {
+        auto& entry = entries_.back();
+        memory_ -= entry.memory;
+        // the topology is only kept alive by this entry
+        if (entry.topology.use_count() == 1) {
+            memory_ -= entry.topology_memory;
+        }
+        index_.erase(entry.step);
+        entries_.pop_back();
+    }
+}
+
+void FrameCache::set_limit(size_t limit) {
+    limit_ = limit;
+    this->shrink();
+}
+
+void FrameCache::clear() {
+    entries_.clear();
+    index_.clear();
+    last_topology_.reset();
+    memory_ = 0;
+}
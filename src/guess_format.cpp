@@ -1,7 +1,11 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <cstdint>
 #include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
 #include <string_view>
 
 #include "chemfiles/FormatFactory.hpp"
@@ -9,23 +13,252 @@
 #include "chemfiles/File.hpp"
 
 #include "chemfiles/misc.hpp"
+#include "chemfiles/parse.hpp"
 #include "chemfiles/utils.hpp"
 #include "chemfiles/error_fmt.hpp"
+#include "chemfiles/unreachable.hpp"
+#include "chemfiles/sniff_format.hpp"
+#include "chemfiles/files/MemoryBuffer.hpp"
 #include "chemfiles/external/optional.hpp"
 
 using namespace chemfiles;
 
+/// Number of raw bytes read from the file to check for compression and binary
+/// formats magic numbers
+static constexpr size_t RAW_HEADER_SIZE = 4096;
+
 /// try to distinguish CIF and mmCIF files, since they share the same
 /// `.cif` extension
-static optional<std::string> distinguish_cif_variants(const std::string& path, const std::string& compression);
+static optional<std::string> distinguish_cif_variants(std::string_view content);
 
 static bool contains(std::string_view haystack, std::string_view needle) {
     return haystack.find(needle) != std::string_view::npos;
 }
 
-std::string chemfiles::guess_format(std::string path, char mode) {
+static bool starts_with(std::string_view string, std::string_view prefix) {
+    return string.substr(0, prefix.size()) == prefix;
+}
+
+/// Split `content` in lines, stopping after `max` lines
+static std::vector<std::string_view> split_lines(std::string_view content, size_t max) {
+    auto lines = std::vector<std::string_view>();
+    while (!content.empty() && lines.size() < max) {
+        auto end = content.find('\n');
+        auto line = content.substr(0, end);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        lines.push_back(line);
+
+        if (end == std::string_view::npos) {
+            break;
+        }
+        content.remove_prefix(end + 1);
+    }
+    return lines;
+}
+
+/// Split `line` into whitespace separated tokens
+static std::vector<std::string_view> tokenize(std::string_view line) {
+    auto tokens = std::vector<std::string_view>();
+    size_t start = 0;
+    while (start < line.size()) {
+        while (start < line.size() && is_ascii_whitespace(line[start])) {
+            start++;
+        }
+        auto end = start;
+        while (end < line.size() && !is_ascii_whitespace(line[end])) {
+            end++;
+        }
+        if (end != start) {
+            tokens.push_back(line.substr(start, end - start));
+        }
+        start = end;
+    }
+    return tokens;
+}
+
+static bool is_integer(std::string_view token) {
+    try {
+        parse<int64_t>(token);
+        return true;
+    } catch (const Error&) {
+        return false;
+    }
+}
+
+static bool is_number(std::string_view token) {
+    try {
+        parse<double>(token);
+        return true;
+    } catch (const Error&) {
+        return false;
+    }
+}
+
+/// Check if `line` looks like an atom in Tinker XYZ format:
+/// `<index> <name> <x> <y> <z> <type> [<bonded atoms>...]`
+static bool is_tinker_atom(std::string_view line) {
+    auto tokens = tokenize(line);
+    return tokens.size() >= 6 && is_integer(tokens[0]) &&
+           is_number(tokens[2]) && is_number(tokens[3]) && is_number(tokens[4]) &&
+           is_integer(tokens[5]);
+}
+
+/// Check if `line` looks like an atom in XYZ format: `<name> <x> <y> <z> ...`
+static bool is_xyz_atom(std::string_view line) {
+    auto tokens = tokenize(line);
+    return tokens.size() >= 4 && !is_number(tokens[0]) &&
+           is_number(tokens[1]) && is_number(tokens[2]) && is_number(tokens[3]);
+}
+
+/// Check if `line` looks like an atom in GRO format, using fixed columns
+static bool is_gro_atom(std::string_view line) {
+    if (line.size() < 44) {
+        return false;
+    }
+    return is_integer(trim(line.substr(0, 5))) &&
+           is_number(trim(line.substr(20, 8))) &&
+           is_number(trim(line.substr(28, 8))) &&
+           is_number(trim(line.substr(36, 8)));
+}
+
+static bool is_pdb_record(std::string_view line) {
+    static const char* RECORDS[] = {
+        "HEADER", "TITLE ", "COMPND", "REMARK", "CRYST1", "MODEL ", "ATOM  ", "HETATM"
+    };
+    for (auto record: RECORDS) {
+        if (starts_with(line, record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+optional<std::string> chemfiles::sniff_text_format(std::string_view content) {
+    auto lines = split_lines(content, 64);
+    if (lines.empty()) {
+        return nullopt;
+    }
+
+    // formats starting with a magic string
+    auto first = trim(lines[0]);
+    if (starts_with(first, "PSF")) {
+        return std::string("PSF");
+    } else if (starts_with(first, "ITEM: TIMESTEP")) {
+        return std::string("LAMMPS");
+    } else if (starts_with(first, "[Molden Format]")) {
+        return std::string("Molden");
+    }
+
+    if (contains(content, "@<TRIPOS>")) {
+        return std::string("MOL2");
+    } else if (contains(content, "<cml") || (starts_with(first, "<?xml") && contains(content, "<molecule"))) {
+        return std::string("CML");
+    }
+
+    auto cif = distinguish_cif_variants(content);
+    if (cif) {
+        return cif;
+    }
+
+    if (contains(content, "\n_atom_site.")) {
+        return std::string("mmCIF");
+    } else if (contains(content, "\n_atom_site_")) {
+        return std::string("CIF");
+    }
+
+    if ((lines.size() > 3 && (contains(lines[3], "V2000") || contains(lines[3], "V3000")))
+        || contains(content, "\nM  END")) {
+        return std::string("SDF");
+    }
+
+    for (auto line: lines) {
+        if (is_pdb_record(line)) {
+            return std::string("PDB");
+        }
+    }
+
+    if (contains(content, " atoms\n") && contains(content, " atom types")) {
+        return std::string("LAMMPS Data");
+    }
+
+    auto tokens = tokenize(lines[0]);
+    if (!tokens.empty() && is_integer(tokens[0])) {
+        // Tinker files can have the unit cell on the second line
+        if ((lines.size() > 1 && is_tinker_atom(lines[1])) || (lines.size() > 2 && is_tinker_atom(lines[2]))) {
+            return std::string("Tinker");
+        }
+
+        if (tokens.size() == 1 && lines.size() > 2 && is_xyz_atom(lines[2])) {
+            return std::string("XYZ");
+        }
+    }
+
+    if (lines.size() > 2 && is_integer(trim(lines[1])) && is_gro_atom(lines[2])) {
+        return std::string("GRO");
+    }
+
+    return nullopt;
+}
+
+optional<std::string> chemfiles::sniff_binary_format(std::string_view header) {
+    auto header_start = header.substr(0, 64);
+    if (starts_with(header, std::string_view("\x00\x00\x07\xcb", 4))) {
+        return std::string("XTC");
+    } else if (starts_with(header, std::string_view("\x00\x00\x07\xc9", 4))) {
+        return std::string("TRR");
+    } else if (starts_with(header, "CDF\x01") || starts_with(header, "CDF\x02")) {
+        if (contains(header, "AMBERRESTART")) {
+            return std::string("Amber Restart");
+        }
+        return std::string("Amber NetCDF");
+    } else if (header.size() >= 12 &&
+        (starts_with(header, std::string_view("\x54\x00\x00\x00", 4)) || starts_with(header, std::string_view("\x00\x00\x00\x54", 4))) &&
+        (contains(header.substr(4, 8), "CORD") || contains(header.substr(4, 8), "VELD"))
+    ) {
+        return std::string("DCD");
+    } else if (contains(header_start, "GENERAL INFO")) {
+        return std::string("TNG");
+    } else if (contains(header.substr(0, 32), "VERSION")) {
+        return std::string("TPR");
+    } else if (contains(header, "mmtfVersion")) {
+        return std::string("MMTF");
+    } else if (contains(header, "dataBlocks")) {
+        return std::string("BinaryCIF");
+    }
+
+    return nullopt;
+}
+
+/// Get the compression of a file from its first bytes
+static File::Compression sniff_compression(std::string_view header) {
+    if (starts_with(header, "\x1f\x8b")) {
+        return File::GZIP;
+    } else if (starts_with(header, "BZh")) {
+        return File::BZIP2;
+    } else if (starts_with(header, std::string_view("\xfd\x37\x7a\x58\x5a\x00", 6))) {
+        return File::LZMA;
+    }
+    return File::DEFAULT;
+}
+
+static std::string read_raw_header(const std::string& path) {
+    auto header = std::string(RAW_HEADER_SIZE, '\0');
+    auto file = std::ifstream(path, std::ios::binary);
+    if (!file) {
+        throw file_error("could not open the file at '{}'", path);
+    }
+    file.read(&header[0], static_cast<std::streamsize>(header.size()));
+    header.resize(static_cast<size_t>(file.gcount()));
+    return header;
+}
+
+/// Get the extension of the file at `path`, ignoring compression extensions
+/// (`.gz`, `.bz2` and `.xz`). The corresponding compression method is stored
+/// in `compression`.
+static std::string path_extension(const std::string& path, File::Compression& compression) {
     std::string extension;
-    std::string compression;
 
     auto dot1 = path.rfind('.');
     if (dot1 != std::string::npos) {
@@ -34,13 +267,13 @@ std::string chemfiles::guess_format(std::string path, char mode) {
         // check file extension for compressed file extension
         if (extension == ".gz") {
             new_extension = true;
-            compression = "GZ";
+            compression = File::GZIP;
         } else if (extension == ".bz2") {
             new_extension = true;
-            compression = "BZ2";
+            compression = File::BZIP2;
         } else if (extension == ".xz") {
             new_extension = true;
-            compression = "XZ";
+            compression = File::LZMA;
         }
 
         if (new_extension) {
@@ -52,69 +285,190 @@ std::string chemfiles::guess_format(std::string path, char mode) {
         }
     }
 
+    return extension;
+}
+
+/// Guess the format of a text file from the (decompressed) `content`. If
+/// the extension is already known, the content is only used to distinguish
+/// CIF and mmCIF.
+static optional<std::string> sniff_text_content(std::string_view content, bool known_extension) {
+    if (known_extension) {
+        return distinguish_cif_variants(content);
+    } else {
+        return sniff_text_format(content);
+    }
+}
+
+/// Throw the error corresponding to a file at `path` whose format could not
+/// be guessed
+[[noreturn]] static void unknown_format(const std::string& path, const std::string& extension) {
     if (extension.empty()) {
         throw file_error(
             "file at '{}' does not have an extension, provide a format name to read it",
             path
         );
+    } else {
+        // this throws the right error message for unknown extensions
+        FormatFactory::get().by_extension(extension);
+        unreachable();
+    }
+}
+
+SniffedFormat chemfiles::sniff_format(const std::string& path, File::Mode mode) {
+    auto result = SniffedFormat();
+    auto extension = path_extension(path, result.compression);
+
+    bool known_extension = false;
+    if (!extension.empty()) {
+        try {
+            result.format = FormatFactory::get().by_extension(extension).metadata.name;
+            known_extension = true;
+        } catch (const FormatError&) {
+            if (mode == File::WRITE) {
+                throw;
+            }
+        }
     }
 
-    if (extension == ".cif" && (mode == 'r' || mode == 'a')) {
-        extension = distinguish_cif_variants(path, compression).value_or(extension);
+    if (known_extension && extension != ".cif") {
+        return result;
     }
 
-    auto registered_format = FormatFactory::get().by_extension(extension);
-    auto format = std::string(registered_format.metadata.name);
+    if (mode != File::WRITE) {
+        try {
+            auto compression = result.compression;
+            if (compression == File::DEFAULT) {
+                auto header = read_raw_header(path);
+                compression = sniff_compression(header);
+                if (compression == File::DEFAULT && header.find('\0') != std::string::npos) {
+                    // this is not a text file
+                    auto format = known_extension ? nullopt : sniff_binary_format(header);
+                    if (format) {
+                        result.format = std::move(*format);
+                        return result;
+                    }
+                    compression = File::DEFAULT;
+                }
+            }
 
-    if (!compression.empty()) {
-        format += " / " + compression;
+            auto file = TextFile(path, File::READ, compression);
+            auto format = sniff_text_content(file.peek(SNIFF_WINDOW_SIZE), known_extension);
+            if (format) {
+                result.format = std::move(*format);
+                result.compression = compression;
+                const auto& registered = FormatFactory::get().by_name(result.format);
+                if (mode == File::READ && registered.text_file_creator) {
+                    result.file = std::move(file);
+                }
+                return result;
+            }
+        } catch (const FileError&) {
+            // in case of error while reading, just use the file extension for
+            // now, the user will get a proper error when trying to open the
+            // file
+        }
     }
 
-    return format;
+    if (known_extension) {
+        return result;
+    }
+    unknown_format(path, extension);
 }
 
+SniffedFormat chemfiles::sniff_format(const std::string& name, std::string_view content) {
+    auto result = SniffedFormat();
+    auto extension = path_extension(name, result.compression);
 
-static optional<std::string> distinguish_cif_variants(
-    const std::string& path,
-    const std::string& compression
-) {
-    auto c = File::DEFAULT;
-    if (compression == "GZ") {
-        c = File::GZIP;
-    } else if (compression == "BZ2") {
-        c = File::BZIP2;
-    } else if (compression == "XZ") {
-        c = File::LZMA;
+    bool known_extension = false;
+    if (!extension.empty()) {
+        try {
+            result.format = FormatFactory::get().by_extension(extension).metadata.name;
+            known_extension = true;
+        } catch (const FormatError&) {
+            // try to use the content below
+        }
     }
 
-    try {
-        auto file = TextFile(path, File::READ, c);
-        while (!file.eof()) {
-            auto line = file.readline();
-            // check a few mmCIF/CIF specific tags that are more likely to be
-            // close to the top of the file
-            if (contains(line, "_audit_conform.dict_name")
-                || contains(line, "_cell.length_a")
-                || contains(line, "_atom_site.type_symbol")
-            ) {
-                return std::string(".mmcif");
-            }
+    if (known_extension && extension != ".cif") {
+        return result;
+    }
 
-            if (contains(line, "_symmetry_equiv_pos_as_xyz")
-                || contains(line, "_cell_length_a")
-                || contains(line, "_atom_site_type_symbol")
-            ) {
-                return std::string(".cif");
+    try {
+        auto compression = result.compression;
+        if (compression == File::DEFAULT) {
+            auto header = content.substr(0, RAW_HEADER_SIZE);
+            compression = sniff_compression(header);
+            if (compression == File::DEFAULT && header.find('\0') != std::string_view::npos) {
+                auto format = known_extension ? nullopt : sniff_binary_format(header);
+                if (format) {
+                    result.format = std::move(*format);
+                    return result;
+                }
             }
         }
 
-        // if we could not find any of the above strings in the file, it is very
-        // likely the file is invalid. As below, the user will get a proper
-        // error when trying to open the file
-        return nullopt;
+        // this does not copy the content if it is not compressed
+        auto buffer = MemoryBuffer(content.data(), content.size());
+        buffer.decompress(compression);
+        auto text = std::string_view(buffer.data(), std::min(buffer.size(), SNIFF_WINDOW_SIZE));
+        auto format = sniff_text_content(text, known_extension);
+        if (format) {
+            result.format = std::move(*format);
+            result.compression = compression;
+            return result;
+        }
     } catch (const FileError&) {
-        // in case of error while reading, just use the file extension for now,
-        // the user will get a proper error when trying to open the file
-        return nullopt;
+        // invalid compressed data, use the extension
+    }
+
+    if (known_extension) {
+        return result;
+    }
+    unknown_format(name, extension);
+}
+
+std::string chemfiles::guess_format(std::string path, char mode) {
+    auto file_mode = File::READ;
+    if (mode == 'a' || mode == 'A') {
+        file_mode = File::APPEND;
+    } else if (mode == 'w' || mode == 'W') {
+        file_mode = File::WRITE;
+    }
+
+    auto sniffed = sniff_format(path, file_mode);
+    auto format = std::move(sniffed.format);
+    if (sniffed.compression == File::GZIP) {
+        format += " / GZ";
+    } else if (sniffed.compression == File::BZIP2) {
+        format += " / BZ2";
+    } else if (sniffed.compression == File::LZMA) {
+        format += " / XZ";
+    }
+
+    return format;
+}
+
+static optional<std::string> distinguish_cif_variants(std::string_view content) {
+    for (auto line: split_lines(content, static_cast<size_t>(-1))) {
+        // check a few mmCIF/CIF specific tags that are more likely to be
+        // close to the top of the file
+        if (contains(line, "_audit_conform.dict_name")
+            || contains(line, "_cell.length_a")
+            || contains(line, "_atom_site.type_symbol")
+        ) {
+            return std::string("mmCIF");
+        }
+
+        if (contains(line, "_symmetry_equiv_pos_as_xyz")
+            || contains(line, "_cell_length_a")
+            || contains(line, "_atom_site_type_symbol")
+        ) {
+            return std::string("CIF");
+        }
     }
+
+    // if we could not find any of the above strings in the file prefix, we
+    // can not distinguish between the two formats. As below, the user will
+    // get a proper error when trying to open the file if it is invalid.
+    return nullopt;
 }
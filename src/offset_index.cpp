@@ -0,0 +1,88 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "chemfiles/offset_index.hpp"
+
+using namespace chemfiles;
+
+void OffsetIndex::compress_tail() {
+    assert(tail_.size() == BLOCK_SIZE);
+
+    // All the computations use wrapping unsigned arithmetic, and
+    // `Block::get` reverses them exactly. Differences are interpreted as
+    // signed values, so this also works for decreasing sequences.
+    auto first = tail_.front();
+    auto delta = static_cast<int64_t>(tail_.back() - first);
+    auto slope = static_cast<uint64_t>(delta / static_cast<int64_t>(BLOCK_SIZE - 1));
+
+    // find the smallest difference to the prediction line starting at `first`
+    int64_t min = 0;
+    for (size_t i = 1; i < BLOCK_SIZE; i++) {
+        auto difference = static_cast<int64_t>(tail_[i] - i * slope - first);
+        min = std::min(min, difference);
+    }
+    auto base = first + static_cast<uint64_t>(min);
+
+    uint64_t packed[BLOCK_SIZE];
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        packed[i] = tail_[i] - i * slope - base;
+    }
+
+    auto width = bit_packing::width(packed);
+    auto start = data_.size();
+    bit_packing::pack(data_, packed, width);
+
+    blocks_.push_back({base, slope, (static_cast<uint64_t>(start) << 8) | width});
+    tail_.clear();
+}
+
+void OffsetIndex::extend(uint64_t first, uint64_t stride, size_t count) {
+    size_t i = 0;
+    // complete the current block first
+    for (; i < count && !tail_.empty(); i++) {
+        this->push_back(first + i * stride);
+    }
+
+    // all values in these blocks are exactly on the prediction line
+    for (; count - i >= BLOCK_SIZE; i += BLOCK_SIZE) {
+        auto start = static_cast<uint64_t>(data_.size());
+        blocks_.push_back({first + i * stride, stride, start << 8});
+    }
+
+    for (; i < count; i++) {
+        tail_.push_back(first + i * stride);
+    }
+}
+
+void OffsetIndex::pop_back() {
+    assert(!this->empty());
+    if (tail_.empty()) {
+        // decompress the last block
+        auto block = blocks_.back();
+        tail_.resize(BLOCK_SIZE);
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            tail_[i] = block.get(data_, i);
+        }
+        data_.resize(block.start());
+        blocks_.pop_back();
+    }
+    tail_.pop_back();
+}
+
+void OffsetIndex::clear() {
+    blocks_.clear();
+    data_.clear();
+    tail_.clear();
+}
+
+size_t OffsetIndex::memory() const {
+    return sizeof(OffsetIndex)
+        + blocks_.capacity() * sizeof(Block)
+        + data_.capacity() * sizeof(uint64_t)
+        + tail_.capacity() * sizeof(uint64_t);
+}
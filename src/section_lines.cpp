@@ -0,0 +1,21 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstddef>
+
+#include "chemfiles/File.hpp"
+#include "chemfiles/section_lines.hpp"
+
+using namespace chemfiles;
+
+SectionLines::SectionLines(TextFile& file, size_t count) {
+    starts_.reserve(count + 1);
+    starts_.push_back(0);
+    for (size_t i = 0; i < count; i++) {
+        auto line = file.readline();
+        if (file.eof() && line.empty()) {
+            break;
+        }
+        this->push_back(line);
+    }
+}
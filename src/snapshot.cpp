@@ -0,0 +1,566 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstring>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Residue.hpp"
+#include "chemfiles/Property.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/UnitCell.hpp"
+#include "chemfiles/Connectivity.hpp"
+
+#include "chemfiles/types.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/snapshot.hpp"
+
+using namespace chemfiles;
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(double), "Vector3D must be 3 contiguous doubles");
+
+enum SnapshotKind: uint32_t {
+    TOPOLOGY_SNAPSHOT = 0,
+    FRAME_SNAPSHOT = 1,
+};
+
+static bool is_little_endian() {
+    uint16_t value = 1;
+    char byte = 0;
+    std::memcpy(&byte, &value, 1);
+    return byte == 1;
+}
+
+/// Convert between native and little-endian representation of `value`
+template<typename T>
+static T little_endian(T value) {
+    if (!is_little_endian()) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        std::reverse(bytes, bytes + sizeof(T));
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    return value;
+}
+
+namespace {
+
+/// Write the different parts of a snapshot. The string table is built while
+/// writing the other sections, and `finish` puts everything together.
+class SnapshotWriter {
+public:
+    SnapshotWriter(std::vector<char>& output): output_(output) {}
+
+    template<typename T>
+    void put(T value) {
+        static_assert(std::is_arithmetic<T>::value, "only numbers can be written");
+        value = little_endian(value);
+        auto bytes = reinterpret_cast<const char*>(&value);
+        body_.insert(body_.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    void put_array(const T* data, size_t count) {
+        static_assert(std::is_arithmetic<T>::value, "only numbers can be written");
+        if (is_little_endian()) {
+            auto bytes = reinterpret_cast<const char*>(data);
+            body_.insert(body_.end(), bytes, bytes + count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                this->put(data[i]);
+            }
+        }
+    }
+
+    /// Get the index of `string` in the string table, adding it if needed
+    uint32_t string(std::string_view string) {
+        auto it = string_indexes_.find(string);
+        if (it != string_indexes_.end()) {
+            return it->second;
+        }
+
+        if (strings_.size() == UINT32_MAX) {
+            throw format_error("too many different strings in snapshot");
+        }
+        auto index = static_cast<uint32_t>(strings_.size());
+        strings_.push_back(string);
+        string_indexes_.emplace(string, index);
+        return index;
+    }
+
+    void put_properties(const property_map& properties) {
+        this->put<uint64_t>(properties.size());
+        for (const auto& it: properties) {
+            this->put<uint32_t>(this->string(it.first));
+            const auto& property = it.second;
+            this->put<uint32_t>(property.kind());
+            switch (property.kind()) {
+            case Property::BOOL:
+                this->put<uint64_t>(property.as_bool() ? 1 : 0);
+                break;
+            case Property::DOUBLE:
+                this->put<double>(property.as_double());
+                break;
+            case Property::STRING:
+                this->put<uint64_t>(this->string(property.as_string()));
+                break;
+            case Property::VECTOR3D: {
+                auto vector = property.as_vector3d();
+                this->put<double>(vector[0]);
+                this->put<double>(vector[1]);
+                this->put<double>(vector[2]);
+                break;
+            }
+            }
+        }
+    }
+
+    void put_topology(const Topology& topology) {
+        auto natoms = topology.size();
+        auto column = std::vector<uint32_t>(natoms);
+        for (size_t i = 0; i < natoms; i++) {
+            column[i] = this->string(topology[i].name());
+        }
+        this->put_array(column.data(), natoms);
+
+        for (size_t i = 0; i < natoms; i++) {
+            column[i] = this->string(topology[i].type());
+        }
+        this->put_array(column.data(), natoms);
+
+        auto values = std::vector<double>(natoms);
+        for (size_t i = 0; i < natoms; i++) {
+            values[i] = topology[i].mass();
+        }
+        this->put_array(values.data(), natoms);
+
+        for (size_t i = 0; i < natoms; i++) {
+            values[i] = topology[i].charge();
+        }
+        this->put_array(values.data(), natoms);
+
+        auto with_properties = std::vector<uint64_t>();
+        for (size_t i = 0; i < natoms; i++) {
+            const auto& properties = topology[i].properties();
+            if (properties && properties->size() != 0) {
+                with_properties.push_back(i);
+            }
+        }
+        this->put<uint64_t>(with_properties.size());
+        for (auto i: with_properties) {
+            this->put<uint64_t>(i);
+            this->put_properties(*topology[i].properties());
+        }
+
+        const auto& bonds = topology.bonds();
+        const auto& orders = topology.bond_orders();
+        auto indexes = std::vector<uint64_t>(2 * bonds.size());
+        auto bond_orders = std::vector<uint8_t>(bonds.size());
+        for (size_t i = 0; i < bonds.size(); i++) {
+            indexes[2 * i] = bonds[i][0];
+            indexes[2 * i + 1] = bonds[i][1];
+            bond_orders[i] = static_cast<uint8_t>(orders[i]);
+        }
+        this->put<uint64_t>(bonds.size());
+        this->put_array(indexes.data(), indexes.size());
+        this->put_array(bond_orders.data(), bond_orders.size());
+
+        const auto& residues = topology.residues();
+        this->put<uint64_t>(residues.size());
+        for (const auto& residue: residues) {
+            this->put<uint32_t>(this->string(residue.name()));
+            auto id = residue.id();
+            this->put<uint32_t>(id ? 1 : 0);
+            this->put<int64_t>(id.value_or(0));
+            this->put<uint64_t>(residue.size());
+            indexes.assign(residue.begin(), residue.end());
+            this->put_array(indexes.data(), indexes.size());
+            this->put_properties(residue.properties());
+        }
+    }
+
+    /// Write the header, string table and all the data to the output
+    void finish(SnapshotKind kind, uint64_t natoms) {
+        uint64_t table_size = sizeof(uint64_t) * (strings_.size() + 2);
+        uint64_t strings_size = 0;
+        for (auto string: strings_) {
+            strings_size += string.size();
+        }
+        uint64_t total = SNAPSHOT_HEADER_SIZE + table_size + strings_size + body_.size();
+
+        auto sections = std::move(body_);
+        body_ = std::vector<char>();
+        body_.reserve(static_cast<size_t>(total) - sections.size());
+        body_.insert(body_.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+        this->put<uint32_t>(SNAPSHOT_VERSION);
+        this->put<uint32_t>(kind);
+        this->put<uint64_t>(total);
+        this->put<uint64_t>(natoms);
+
+        this->put<uint64_t>(strings_.size());
+        uint64_t offset = 0;
+        for (auto string: strings_) {
+            this->put<uint64_t>(offset);
+            offset += string.size();
+        }
+        this->put<uint64_t>(offset);
+        for (auto string: strings_) {
+            body_.insert(body_.end(), string.begin(), string.end());
+        }
+
+        output_.reserve(output_.size() + static_cast<size_t>(total));
+        output_.insert(output_.end(), body_.begin(), body_.end());
+        output_.insert(output_.end(), sections.begin(), sections.end());
+    }
+
+private:
+    std::vector<char>& output_;
+    /// Data for all the sections after the string table
+    std::vector<char> body_;
+    /// All strings in the string table. The strings are owned by the
+    /// frame/topology being written.
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, uint32_t> string_indexes_;
+};
+
+/// Read the different parts of a snapshot, checking that all reads stay
+/// inside the snapshot data.
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size): data_(data), size_(size) {
+        auto total = snapshot_size(data, size);
+        if (total > size) {
+            throw format_error(
+                "invalid snapshot: expected {} bytes of data, got {}", total, size
+            );
+        }
+        size_ = static_cast<size_t>(total);
+        position_ = 12;
+        kind_ = this->get<uint32_t>();
+        if (kind_ != TOPOLOGY_SNAPSHOT && kind_ != FRAME_SNAPSHOT) {
+            throw format_error("invalid snapshot: unknown snapshot kind {}", kind_);
+        }
+        this->get<uint64_t>();
+        natoms_ = this->get<uint64_t>();
+        // each atom uses at least 24 bytes for its name, type, mass and
+        // charge. Check this before anything is allocated for the atoms.
+        this->checked_size(natoms_, 2 * sizeof(uint32_t) + 2 * sizeof(double));
+
+        auto count = this->get_count(sizeof(uint64_t));
+        auto offsets = this->take((count + 1) * sizeof(uint64_t));
+        auto end = load<uint64_t>(offsets, count);
+        auto strings = this->take(this->checked_size(end, 1));
+
+        strings_.reserve(count);
+        uint64_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            auto start = load<uint64_t>(offsets, i);
+            auto stop = load<uint64_t>(offsets, i + 1);
+            if (start != previous || stop < start || stop > end) {
+                throw format_error("invalid snapshot: corrupted string table");
+            }
+            strings_.emplace_back(strings + start, static_cast<size_t>(stop - start));
+            previous = stop;
+        }
+    }
+
+    uint32_t kind() const {
+        return kind_;
+    }
+
+    size_t natoms() const {
+        return static_cast<size_t>(natoms_);
+    }
+
+    /// Load the `index`-th value of type T in the data starting at `data`
+    template<typename T>
+    static T load(const char* data, size_t index) {
+        T value;
+        std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+        return little_endian(value);
+    }
+
+    /// Get a pointer to the next `size` bytes and advance past them
+    const char* take(size_t size) {
+        if (size > size_ - position_) {
+            throw format_error("invalid snapshot: unexpected end of data");
+        }
+        auto data = data_ + position_;
+        position_ += size;
+        return data;
+    }
+
+    template<typename T>
+    T get() {
+        return load<T>(this->take(sizeof(T)), 0);
+    }
+
+    template<typename T>
+    void get_array(T* output, size_t count) {
+        auto data = this->take(this->checked_size(count, sizeof(T)));
+        if (is_little_endian()) {
+            std::memcpy(output, data, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                output[i] = load<T>(data, i);
+            }
+        }
+    }
+
+    /// Get a number of elements of size `element_size` following in the
+    /// data, checking that there is enough data left for all of them
+    size_t get_count(size_t element_size) {
+        auto count = this->get<uint64_t>();
+        this->checked_size(count, element_size);
+        return static_cast<size_t>(count);
+    }
+
+    std::string get_string(uint64_t index) const {
+        if (index >= strings_.size()) {
+            throw format_error("invalid snapshot: out of bounds string index {}", index);
+        }
+        return std::string(strings_[static_cast<size_t>(index)]);
+    }
+
+    property_map get_properties() {
+        auto properties = property_map();
+        auto count = this->get_count(2 * sizeof(uint32_t) + sizeof(uint64_t));
+        for (size_t i = 0; i < count; i++) {
+            auto name = this->get_string(this->get<uint32_t>());
+            auto kind = this->get<uint32_t>();
+            switch (kind) {
+            case Property::BOOL:
+                properties.set(std::move(name), this->get<uint64_t>() != 0);
+                break;
+            case Property::DOUBLE:
+                properties.set(std::move(name), this->get<double>());
+                break;
+            case Property::STRING:
+                properties.set(std::move(name), this->get_string(this->get<uint64_t>()));
+                break;
+            case Property::VECTOR3D: {
+                auto x = this->get<double>();
+                auto y = this->get<double>();
+                auto z = this->get<double>();
+                properties.set(std::move(name), Vector3D(x, y, z));
+                break;
+            }
+            default:
+                throw format_error("invalid snapshot: unknown property kind {}", kind);
+            }
+        }
+        return properties;
+    }
+
+    /// Read the topology part of the snapshot into `target`, which can be a
+    /// `Topology` or a `Frame` with the right number of atoms.
+    template<class Target>
+    void get_topology(Target& target) {
+        auto natoms = this->natoms();
+        auto column_size = this->checked_size(natoms, sizeof(uint32_t));
+        auto names = this->take(column_size);
+        auto types = this->take(column_size);
+        auto masses = this->take(column_size * 2);
+        auto charges = this->take(column_size * 2);
+
+        for (size_t i = 0; i < natoms; i++) {
+            auto& atom = target[i];
+            atom.set_name(this->get_string(load<uint32_t>(names, i)));
+            atom.set_type(this->get_string(load<uint32_t>(types, i)));
+            atom.set_mass(load<double>(masses, i));
+            atom.set_charge(load<double>(charges, i));
+        }
+
+        auto with_properties = this->get_count(2 * sizeof(uint64_t));
+        for (size_t i = 0; i < with_properties; i++) {
+            auto index = this->get_index(natoms);
+            for (auto& it: this->get_properties()) {
+                target[index].set(it.first, it.second);
+            }
+        }
+
+        auto nbonds = this->get_count(2 * sizeof(uint64_t) + sizeof(uint8_t));
+        auto indexes = this->take(nbonds * 2 * sizeof(uint64_t));
+        auto orders = this->take(nbonds);
+        for (size_t i = 0; i < nbonds; i++) {
+            auto atom_i = load<uint64_t>(indexes, 2 * i);
+            auto atom_j = load<uint64_t>(indexes, 2 * i + 1);
+            if (atom_i >= natoms || atom_j >= natoms) {
+                throw format_error("invalid snapshot: out of bounds atomic index in bond");
+            }
+            auto order = static_cast<uint8_t>(orders[i]);
+            if (order > Bond::QUINTUPLET && order < Bond::DOWN) {
+                throw format_error("invalid snapshot: unknown bond order {}", order);
+            }
+            target.add_bond(static_cast<size_t>(atom_i), static_cast<size_t>(atom_j), static_cast<Bond::BondOrder>(order));
+        }
+
+        auto nresidues = this->get_count(2 * sizeof(uint32_t) + 3 * sizeof(uint64_t));
+        for (size_t i = 0; i < nresidues; i++) {
+            auto name = this->get_string(this->get<uint32_t>());
+            auto has_id = this->get<uint32_t>();
+            auto id = this->get<int64_t>();
+            auto residue = has_id ? Residue(std::move(name), id) : Residue(std::move(name));
+
+            auto residue_size = this->get_count(sizeof(uint64_t));
+            for (size_t j = 0; j < residue_size; j++) {
+                residue.add_atom(this->get_index(natoms));
+            }
+
+            for (auto& it: this->get_properties()) {
+                residue.set(it.first, it.second);
+            }
+            target.add_residue(std::move(residue));
+        }
+    }
+
+    /// Get an atomic index, checking it against the number of atoms
+    size_t get_index(size_t natoms) {
+        auto index = this->get<uint64_t>();
+        if (index >= natoms) {
+            throw format_error("invalid snapshot: out of bounds atomic index {}", index);
+        }
+        return static_cast<size_t>(index);
+    }
+
+private:
+    /// Get `count * element_size`, checking that there are enough bytes left
+    /// in the data for this
+    size_t checked_size(uint64_t count, size_t element_size) const {
+        auto remaining = size_ - position_;
+        if (count > remaining / element_size) {
+            throw format_error("invalid snapshot: unexpected end of data");
+        }
+        return static_cast<size_t>(count) * element_size;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t position_ = 0;
+    uint32_t kind_ = TOPOLOGY_SNAPSHOT;
+    uint64_t natoms_ = 0;
+    std::vector<std::string_view> strings_;
+};
+
+}
+
+void chemfiles::write_snapshot(const Frame& frame, std::vector<char>& output) {
+    auto writer = SnapshotWriter(output);
+    writer.put_topology(frame.topology());
+
+    auto natoms = frame.size();
+    writer.put<uint64_t>(frame.step());
+
+    auto matrix = frame.cell().matrix();
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            writer.put<double>(matrix[i][j]);
+        }
+    }
+    writer.put<uint32_t>(static_cast<uint32_t>(frame.cell().shape()));
+
+    auto velocities = frame.velocities();
+    writer.put<uint32_t>(velocities ? 1 : 0);
+    if (natoms != 0) {
+        writer.put_array(&frame.positions()[0][0], 3 * natoms);
+        if (velocities) {
+            writer.put_array(&(*velocities)[0][0], 3 * natoms);
+        }
+    }
+    writer.put_properties(frame.properties());
+
+    writer.finish(FRAME_SNAPSHOT, natoms);
+}
+
+void chemfiles::write_snapshot(const Topology& topology, std::vector<char>& output) {
+    auto writer = SnapshotWriter(output);
+    writer.put_topology(topology);
+    writer.finish(TOPOLOGY_SNAPSHOT, topology.size());
+}
+
+uint64_t chemfiles::snapshot_size(const char* data, size_t size) {
+    if (size < SNAPSHOT_HEADER_SIZE || std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw format_error("invalid snapshot: missing CHFL-SNP header");
+    }
+
+    auto version = SnapshotReader::load<uint32_t>(data + 8, 0);
+    if (version != SNAPSHOT_VERSION) {
+        throw format_error(
+            "unsupported snapshot version {}, expected {}", version, SNAPSHOT_VERSION
+        );
+    }
+
+    auto total = SnapshotReader::load<uint64_t>(data + 16, 0);
+    if (total < SNAPSHOT_HEADER_SIZE) {
+        throw format_error("invalid snapshot: the size in the header is too small");
+    }
+    return total;
+}
+
+Frame chemfiles::read_frame_snapshot(const char* data, size_t size) {
+    auto reader = SnapshotReader(data, size);
+    if (reader.kind() != FRAME_SNAPSHOT) {
+        throw format_error("invalid snapshot: expected a frame, got a topology");
+    }
+
+    auto natoms = reader.natoms();
+    auto frame = Frame();
+    frame.resize(natoms);
+    reader.get_topology(frame);
+
+    frame.set_step(static_cast<size_t>(reader.get<uint64_t>()));
+
+    auto matrix = Matrix3D::zero();
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            matrix[i][j] = reader.get<double>();
+        }
+    }
+    auto shape = reader.get<uint32_t>();
+    if (shape > UnitCell::INFINITE) {
+        throw format_error("invalid snapshot: unknown unit cell shape {}", shape);
+    }
+    auto cell = UnitCell(matrix);
+    if (cell.shape() != static_cast<UnitCell::CellShape>(shape)) {
+        cell.set_shape(static_cast<UnitCell::CellShape>(shape));
+    }
+    frame.set_cell(cell);
+
+    auto has_velocities = reader.get<uint32_t>();
+    if (natoms != 0) {
+        reader.get_array(&frame.positions()[0][0], 3 * natoms);
+    }
+    if (has_velocities) {
+        frame.add_velocities();
+        if (natoms != 0) {
+            reader.get_array(&(*frame.velocities())[0][0], 3 * natoms);
+        }
+    }
+
+    for (auto& it: reader.get_properties()) {
+        frame.set(it.first, it.second);
+    }
+
+    return frame;
+}
+
+Topology chemfiles::read_topology_snapshot(const char* data, size_t size) {
+    auto reader = SnapshotReader(data, size);
+    if (reader.kind() != TOPOLOGY_SNAPSHOT) {
+        throw format_error("invalid snapshot: expected a topology, got a frame");
+    }
+
+    auto topology = Topology();
+    topology.resize(reader.natoms());
+    reader.get_topology(topology);
+    return topology;
+}
@@ -0,0 +1,279 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/step_bisection.hpp"
+#include "chemfiles/files/BinaryFile.hpp"
+
+using namespace chemfiles;
+
+/// Number of 32-bit values to read at once when looking for the magic number
+static constexpr size_t RESYNC_CHUNK = 4096;
+
+/// Frames start on 32-bit boundaries in XDR files
+static uint64_t round_to_int_boundary(uint64_t offset) {
+    return (offset + 3) & ~uint64_t(3);
+}
+
+StepBisection::StepBisection(BinaryFile& file, int32_t magic, frame_reader_t read_frame):
+    file_(file), magic_(magic), read_frame_(std::move(read_frame)) {}
+
+optional<FrameLocation> StepBisection::frame_at(uint64_t offset) {
+    optional<FrameLocation> frame = nullopt;
+    try {
+        frame = read_frame_(offset);
+    } catch (const Error&) {
+        return nullopt;
+    }
+
+    if (!frame || frame->size == 0 || frame->offset + frame->size > file_size_) {
+        return nullopt;
+    }
+
+    auto end = frame->offset + frame->size;
+    if (end == file_size_) {
+        return frame;
+    }
+
+    if (end + sizeof(int32_t) > file_size_) {
+        return nullopt;
+    }
+
+    try {
+        file_.seek(end);
+        if (file_.read_single_i32() != magic_) {
+            return nullopt;
+        }
+    } catch (const Error&) {
+        return nullopt;
+    }
+    return frame;
+}
+
+optional<FrameLocation> StepBisection::next(const FrameLocation& frame) {
+    auto end = frame.offset + frame.size;
+    if (end >= file_size_) {
+        return nullopt;
+    }
+    return frame_at(end);
+}
+
+optional<FrameLocation> StepBisection::resynchronize(uint64_t start, uint64_t stop) {
+    stop = std::min(stop, file_size_);
+    auto values = std::vector<int32_t>(RESYNC_CHUNK);
+    auto position = round_to_int_boundary(start);
+    while (position + sizeof(int32_t) <= stop) {
+        auto count = std::min<uint64_t>(RESYNC_CHUNK, (file_size_ - position) / sizeof(int32_t));
+        file_.seek(position);
+        file_.read_i32(values.data(), static_cast<size_t>(count));
+
+        for (size_t i = 0; i < count; i++) {
+            auto offset = position + i * sizeof(int32_t);
+            if (offset >= stop) {
+                return nullopt;
+            }
+            if (values[i] == magic_) {
+                auto frame = frame_at(offset);
+                if (frame) {
+                    return frame;
+                }
+            }
+        }
+        position += count * sizeof(int32_t);
+    }
+    return nullopt;
+}
+
+optional<FrameLocation> StepBisection::find_last() {
+    // look for a frame close to the end of the file, and follow the frames
+    // from there to the last one
+    auto window = std::max<uint64_t>(4 * first_.size, 65536);
+    while (true) {
+        auto start = file_size_ > window ? file_size_ - window : 0;
+        auto frame = resynchronize(start, file_size_);
+        if (frame) {
+            auto following = next(*frame);
+            while (following) {
+                frame = following;
+                following = next(*frame);
+            }
+            return frame;
+        }
+
+        if (start == 0) {
+            return nullopt;
+        }
+        window *= 2;
+    }
+}
+
+optional<size_t> StepBisection::initialize() {
+    file_size_ = file_.file_size();
+
+    auto first = frame_at(0);
+    if (!first) {
+        return nullopt;
+    }
+    first_ = *first;
+
+    auto last = find_last();
+    if (!last) {
+        return nullopt;
+    }
+    last_ = *last;
+
+    if (last_.offset == first_.offset) {
+        return 1;
+    }
+
+    auto second = next(first_);
+    if (!second || second->step <= first_.step || last_.step < second->step) {
+        return nullopt;
+    }
+    stride_ = second->step - first_.step;
+
+    // check that a few frames across the file are where they should be if
+    // the steps are evenly spaced, comparing their offset to the number of
+    // frames before them
+    auto samples = std::vector<FrameLocation>{*second, last_};
+    for (uint64_t fraction = 1; fraction < 4; fraction++) {
+        auto frame = resynchronize(fraction * file_size_ / 4, last_.offset);
+        if (frame) {
+            samples.push_back(*frame);
+        }
+    }
+
+    auto min_size = first_.size;
+    auto max_size = first_.size;
+    for (const auto& frame: samples) {
+        min_size = std::min(min_size, frame.size);
+        max_size = std::max(max_size, frame.size);
+    }
+
+    // when all the frames have the same size, the offset of each frame is
+    // known exactly, and a missing frame is found by `is_at_index`
+    if (min_size == max_size) {
+        frame_size_ = min_size;
+    }
+
+    for (const auto& frame: samples) {
+        if (frame.step <= first_.step || (frame.step - first_.step) % stride_ != 0) {
+            return nullopt;
+        }
+
+        if (!is_at_index(frame, (frame.step - first_.step) / stride_)) {
+            return nullopt;
+        }
+
+        auto index = static_cast<double>((frame.step - first_.step) / stride_);
+        auto offset = static_cast<double>(frame.offset - first_.offset);
+        if (offset < 0.8 * index * static_cast<double>(min_size) || offset > 1.25 * index * static_cast<double>(max_size)) {
+            return nullopt;
+        }
+    }
+
+    return static_cast<size_t>((last_.step - first_.step) / stride_ + 1);
+}
+
+bool StepBisection::is_at_index(const FrameLocation& frame, uint64_t index) const {
+    if ((frame.step - first_.step) % stride_ != 0) {
+        return false;
+    }
+    if (frame_size_ != 0 && frame.offset - first_.offset != index * frame_size_) {
+        return false;
+    }
+    return true;
+}
+
+optional<uint64_t> StepBisection::locate(size_t index) {
+    auto target = first_.step + index * stride_;
+    if (target == first_.step) {
+        return first_.offset;
+    } else if (target == last_.step) {
+        return last_.offset;
+    } else if (target > last_.step) {
+        return nullopt;
+    }
+
+    // invariant: low.step < target < high.step
+    auto low = first_;
+    auto high = last_;
+    while (true) {
+        // follow the frames one by one when only a few of them remain
+        if ((high.step - low.step) / stride_ <= 4) {
+            auto frame = next(low);
+            auto expected = low.step + stride_;
+            while (frame && frame->step < target && frame->offset < high.offset) {
+                if (frame->step != expected) {
+                    // there is a missing step between `low` and `high`
+                    return nullopt;
+                }
+                expected += stride_;
+                frame = next(*frame);
+            }
+            if (frame && frame->step == target && is_at_index(*frame, index)) {
+                return frame->offset;
+            }
+            return nullopt;
+        }
+
+        auto low_end = low.offset + low.size;
+        auto middle = low_end + (high.offset - low_end) / 2;
+        auto frame = resynchronize(middle, high.offset);
+        if (!frame) {
+            // no frame starts in the second half of the range
+            frame = next(low);
+            if (!frame) {
+                return nullopt;
+            }
+        }
+
+        if (frame->step <= low.step || frame->step >= high.step) {
+            // the steps are not increasing in the file
+            return nullopt;
+        }
+
+        if (!is_at_index(*frame, (frame->step - first_.step) / stride_)) {
+            // the frames are not where they should be with evenly spaced
+            // steps, for example because a frame is missing in the file
+            return nullopt;
+        }
+
+        if (frame->step == target) {
+            return frame->offset;
+        } else if (frame->step < target) {
+            low = *frame;
+        } else {
+            high = *frame;
+        }
+    }
+}
+
+optional<FrameLocation> StepBisection::locate_range(size_t index, size_t count) {
+    auto offset = this->locate(index);
+    if (!offset) {
+        return nullopt;
+    }
+    auto first = this->frame_at(*offset);
+    if (!first) {
+        return nullopt;
+    }
+
+    auto end = first->offset + first->size;
+    if (count > 1) {
+        auto target = first_.step + (index + count) * stride_;
+        if (target > last_.step) {
+            // the range contains all the frames until the end of the file
+            end = last_.offset + last_.size;
+        } else if (auto next = this->locate(index + count)) {
+            end = *next;
+        }
+    }
+
+    return FrameLocation{first->offset, end - first->offset, first->step};
+}
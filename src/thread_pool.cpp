@@ -0,0 +1,318 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdlib>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <exception>
+#include <functional>
+
+#include "chemfiles/misc.hpp"
+#include "chemfiles/parse.hpp"
+#include "chemfiles/Error.hpp"
+#include "chemfiles/warnings.hpp"
+#include "chemfiles/thread_pool.hpp"
+
+using namespace chemfiles;
+
+/// Index (in `ThreadPool::queues_`) of the queue owned by the current thread,
+/// or 0 if the current thread is not a worker thread.
+static thread_local size_t CURRENT_QUEUE = 0;
+
+/// Get the default number of threads, from the `CHEMFILES_NUM_THREADS`
+/// environment variable or the hardware.
+static size_t default_num_threads() {
+    const char* variable = std::getenv("CHEMFILES_NUM_THREADS"); // NOLINT: we only read the environment once
+    if (variable != nullptr) {
+        try {
+            auto count = parse<size_t>(variable);
+            if (count != 0) {
+                return count;
+            }
+        } catch (const Error&) {
+            // fallthrough
+        }
+        warning("thread pool",
+            "invalid value '{}' for CHEMFILES_NUM_THREADS, expected a positive integer",
+            variable
+        );
+    }
+
+    auto count = static_cast<size_t>(std::thread::hardware_concurrency());
+    return count == 0 ? 1 : count;
+}
+
+ThreadPool& ThreadPool::get() {
+    static ThreadPool instance;
+    return instance;
+}
+
+ThreadPool::ThreadPool():
+    num_threads_(default_num_threads()),
+    concurrency_(num_threads_),
+    started_(false),
+    next_queue_(0),
+    pending_(0),
+    stopping_(false)
+{}
+
+ThreadPool::~ThreadPool() {
+    auto guard = std::lock_guard<std::mutex>(config_mutex_);
+    stop();
+}
+
+size_t ThreadPool::concurrency() {
+    // this is not protected by `config_mutex_`, since it can be called from
+    // tasks running while the pool is being stopped
+    return concurrency_;
+}
+
+void ThreadPool::set_num_threads(size_t count) {
+    auto guard = std::lock_guard<std::mutex>(config_mutex_);
+    stop();
+    executor_ = nullptr;
+    num_threads_ = count == 0 ? default_num_threads() : count;
+    concurrency_ = num_threads_;
+}
+
+void ThreadPool::set_executor(executor_t executor, size_t concurrency) {
+    if (!executor) {
+        throw error("the executor for the thread pool can not be empty");
+    }
+
+    auto guard = std::lock_guard<std::mutex>(config_mutex_);
+    stop();
+    executor_ = std::move(executor);
+    concurrency_ = concurrency == 0 ? 1 : concurrency;
+}
+
+void ThreadPool::start() {
+    if (started_) {
+        return;
+    }
+
+    stopping_ = false;
+    queues_.clear();
+    // the first queue is used for tasks submitted from outside the pool
+    queues_.emplace_back(std::make_unique<WorkQueue>());
+
+    if (!executor_) {
+        // the thread calling `TaskGroup::wait` is the last thread
+        auto workers = num_threads_ - 1;
+        for (size_t i = 0; i < workers; i++) {
+            queues_.emplace_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < workers; i++) {
+            threads_.emplace_back([this, i]() {
+                this->worker_loop(i + 1);
+            });
+        }
+    }
+
+    started_ = true;
+}
+
+void ThreadPool::stop() {
+    if (!started_) {
+        return;
+    }
+
+    {
+        auto lock = std::lock_guard<std::mutex>(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_up_.notify_all();
+
+    for (auto& thread: threads_) {
+        thread.join();
+    }
+    threads_.clear();
+
+    // execute any remaining task (from an external executor) here
+    while (run_pending_task()) {}
+
+    started_ = false;
+}
+
+void ThreadPool::submit(task_t task) {
+    if (!started_) {
+        auto guard = std::unique_lock<std::mutex>(config_mutex_);
+        if (!executor_ && num_threads_ <= 1) {
+            // no parallelism, run the task right now. The lock is released
+            // first, since the task can use the pool as well.
+            guard.unlock();
+            task();
+            return;
+        }
+        start();
+    }
+
+    auto index = CURRENT_QUEUE;
+    if (index == 0 && queues_.size() > 1) {
+        // distribute tasks from outside the pool between the workers
+        index = 1 + next_queue_++ % (queues_.size() - 1);
+    }
+
+    {
+        auto& queue = *queues_[index];
+        auto lock = std::lock_guard<std::mutex>(queue.mutex);
+        queue.tasks.emplace_back(std::move(task));
+        pending_++;
+    }
+
+    if (executor_) {
+        executor_([this]() {
+            // the task might already have been executed by a thread waiting
+            // on a TaskGroup, in which case this does nothing
+            this->run_pending_task();
+        });
+    } else {
+        {
+            // take the lock to make sure no worker is between checking
+            // `pending_` and going to sleep
+            auto lock = std::lock_guard<std::mutex>(sleep_mutex_);
+        }
+        wake_up_.notify_one();
+    }
+}
+
+bool ThreadPool::pop_task(size_t index, task_t& task) {
+    if (pending_ == 0 || queues_.empty()) {
+        return false;
+    }
+
+    // start with our own queue, taking the most recent task
+    if (index < queues_.size()) {
+        auto& queue = *queues_[index];
+        auto lock = std::lock_guard<std::mutex>(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            pending_--;
+            return true;
+        }
+    }
+
+    // then steal the oldest task from the other queues
+    for (size_t i = 0; i < queues_.size(); i++) {
+        auto& queue = *queues_[(index + i) % queues_.size()];
+        auto lock = std::lock_guard<std::mutex>(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            pending_--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::run_pending_task() {
+    task_t task;
+    if (!pop_task(CURRENT_QUEUE, task)) {
+        return false;
+    }
+
+    try {
+        task();
+    } catch (const std::exception& e) {
+        send_warning(std::string("thread pool: uncaught exception in task: ") + e.what());
+    } catch (...) {
+        send_warning("thread pool: uncaught exception in task");
+    }
+
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    CURRENT_QUEUE = index;
+    while (true) {
+        if (run_pending_task()) {
+            continue;
+        }
+
+        auto lock = std::unique_lock<std::mutex>(sleep_mutex_);
+        wake_up_.wait(lock, [this]() {
+            return pending_ != 0 || stopping_;
+        });
+
+        if (stopping_ && pending_ == 0) {
+            return;
+        }
+    }
+}
+
+/******************************************************************************/
+
+TaskGroup::TaskGroup(ThreadPool& pool): pool_(pool), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // errors should be handled by calling `wait` explicitly
+    }
+}
+
+void TaskGroup::run(task_t task) {
+    state_->remaining++;
+    auto state = state_;
+    pool_.submit([state, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            auto lock = std::lock_guard<std::mutex>(state->mutex);
+            if (!state->error) {
+                state->error = std::current_exception();
+            }
+        }
+        if (--state->remaining == 0) {
+            // take the lock to make sure the waiting thread is either before
+            // checking `remaining` or already sleeping
+            auto lock = std::lock_guard<std::mutex>(state->mutex);
+            state->done.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    while (state_->remaining != 0) {
+        if (pool_.run_pending_task()) {
+            continue;
+        }
+
+        // the remaining tasks of this group are running in other threads,
+        // wait for them to finish
+        auto lock = std::unique_lock<std::mutex>(state_->mutex);
+        state_->done.wait(lock, [this]() {
+            return state_->remaining == 0;
+        });
+    }
+
+    auto lock = std::lock_guard<std::mutex>(state_->mutex);
+    if (state_->error) {
+        auto error = state_->error;
+        state_->error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+/******************************************************************************/
+
+void chemfiles::set_num_threads(size_t count) {
+    ThreadPool::get().set_num_threads(count);
+}
+
+size_t chemfiles::num_threads() {
+    return ThreadPool::get().concurrency();
+}
+
+void chemfiles::set_executor(executor_t executor, size_t concurrency) {
+    ThreadPool::get().set_executor(std::move(executor), concurrency);
+}
@@ -0,0 +1,212 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <list>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include "chemfiles/misc.hpp"
+#include "chemfiles/Atom.hpp"
+#include "chemfiles/Frame.hpp"
+#include "chemfiles/Residue.hpp"
+#include "chemfiles/Topology.hpp"
+#include "chemfiles/Trajectory.hpp"
+#include "chemfiles/Connectivity.hpp"
+#include "chemfiles/topology_cache.hpp"
+
+using namespace chemfiles;
+
+/// Get the heap memory used by `string`, ignoring small string optimization
+static size_t string_memory(const std::string& string) {
+    if (string.capacity() < sizeof(std::string)) {
+        return 0;
+    }
+    return string.capacity();
+}
+
+size_t chemfiles::properties_memory(const property_map& properties) {
+    size_t memory = 0;
+    for (const auto& it: properties) {
+        // 64 bytes for the map node
+        memory += 64 + sizeof(Property) + string_memory(it.first);
+        if (it.second.kind() == Property::STRING) {
+            memory += string_memory(it.second.as_string());
+        }
+    }
+    return memory;
+}
+
+size_t chemfiles::topology_memory(const Topology& topology) {
+    size_t memory = sizeof(Topology);
+
+    for (const auto& atom: topology) {
+        memory += sizeof(Atom);
+        memory += string_memory(atom.name());
+        memory += string_memory(atom.type());
+        if (atom.properties()) {
+            memory += properties_memory(*atom.properties());
+        }
+    }
+
+    // bonds and bond orders. Angles, dihedrals and impropers are computed
+    // lazily and not accounted for here.
+    memory += topology.bonds().size() * (sizeof(Bond) + sizeof(Bond::BondOrder));
+
+    for (const auto& residue: topology.residues()) {
+        memory += sizeof(Residue);
+        memory += string_memory(residue.name());
+        memory += residue.size() * sizeof(size_t);
+        memory += properties_memory(residue.properties());
+        // atom index => residue index mapping, 32 bytes per node
+        memory += residue.size() * 32;
+    }
+
+    return memory;
+}
+
+bool chemfiles::same_topology(const Topology& lhs, const Topology& rhs) {
+    if (&lhs == &rhs) {
+        return true;
+    }
+
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    if (lhs.bonds() != rhs.bonds() || lhs.bond_orders() != rhs.bond_orders()) {
+        return false;
+    }
+
+    if (lhs.residues() != rhs.residues()) {
+        return false;
+    }
+
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+TopologyCache& TopologyCache::get() {
+    static TopologyCache instance;
+    return instance;
+}
+
+std::shared_ptr<const Topology> TopologyCache::read(const std::string& path, const std::string& format) {
+    auto read_topology = [&]() {
+        auto file = Trajectory(path, 'r', format);
+        auto frame = file.read_step(0);
+        return std::make_shared<const Topology>(frame.topology());
+    };
+
+    std::error_code error;
+    auto canonical = std::filesystem::canonical(path, error);
+    auto size = error ? 0 : std::filesystem::file_size(canonical, error);
+    auto mtime = error ? std::filesystem::file_time_type() : std::filesystem::last_write_time(canonical, error);
+    if (error) {
+        // this is not a regular file, do not try to cache it. If the file
+        // does not exist, the Trajectory constructor will give a better error
+        // message.
+        return read_topology();
+    }
+
+    auto key = Key{
+        canonical.string(),
+        format,
+        static_cast<uint64_t>(size),
+        static_cast<int64_t>(mtime.time_since_epoch().count()),
+    };
+
+    auto matches = [&key](const Entry& entry) {
+        return entry.key.path == key.path && entry.key.format == key.format
+            && entry.key.size == key.size && entry.key.mtime == key.mtime;
+    };
+
+    {
+        auto state = state_.lock();
+        for (auto it = state->entries.begin(); it != state->entries.end(); it++) {
+            if (matches(*it)) {
+                // move the entry to the front of the list
+                state->entries.splice(state->entries.begin(), state->entries, it);
+                return state->entries.front().topology;
+            }
+        }
+    }
+
+    // read the file without holding the lock, to allow other threads to use
+    // the cache in the meantime
+    auto topology = read_topology();
+    auto memory = topology_memory(*topology);
+
+    auto state = state_.lock();
+    if (memory > state->limit) {
+        return topology;
+    }
+
+    for (auto it = state->entries.begin(); it != state->entries.end(); it++) {
+        if (matches(*it)) {
+            // another thread read the same file in the meantime
+            return it->topology;
+        }
+    }
+
+    state->entries.push_front(Entry{std::move(key), topology, memory});
+    state->memory += memory;
+    state->shrink();
+
+    return topology;
+}
+
+void TopologyCache::State::shrink() {
+    while (memory > limit && !entries.empty()) {
+        memory -= entries.back().memory;
+        entries.pop_back();
+    }
+}
+
+void TopologyCache::set_limit(size_t limit) {
+    auto state = state_.lock();
+    state->limit = limit;
+    state->shrink();
+}
+
+void TopologyCache::clear(const std::string& path) {
+    auto state = state_.lock();
+    if (path.empty()) {
+        state->entries.clear();
+        state->memory = 0;
+        return;
+    }
+
+    std::error_code error;
+    auto canonical = std::filesystem::canonical(path, error);
+    // if the file no longer exists, compare with the path as given
+    auto key = error ? path : canonical.string();
+
+    auto it = state->entries.begin();
+    while (it != state->entries.end()) {
+        if (it->key.path == key) {
+            state->memory -= it->memory;
+            it = state->entries.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+size_t TopologyCache::size() {
+    return state_.lock()->entries.size();
+}
+
+size_t TopologyCache::memory() {
+    return state_.lock()->memory;
+}
+
+void chemfiles::set_topology_cache_limit(size_t limit) {
+    TopologyCache::get().set_limit(limit);
+}
+
+void chemfiles::clear_topology_cache(const std::string& path) {
+    TopologyCache::get().clear(path);
+}
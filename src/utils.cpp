@@ -2,21 +2,32 @@
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
 #include <cerrno>
+#include <cstring>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <string_view>
+
+#include <sys/stat.h>
 
 #include "chemfiles/config.h"  // IWYU pragma: keep
 #include "chemfiles/utils.hpp"
+#include "chemfiles/misc.hpp"
+#include "chemfiles/error_fmt.hpp"
+#include "chemfiles/files/Archive.hpp"
 
 #ifdef CHEMFILES_WINDOWS
-#include <windows.h>  // GetUserName & GetComputerNameEx
+#include <windows.h>  // GetUserName, GetComputerNameEx & FindFirstFile
 #include <direct.h>  // _getcwd
 #define getcwd _getcwd
 #else
 #include <unistd.h>
 #include <limits.h>
+#include <dirent.h>
 #endif
 
+using namespace chemfiles;
+
 std::string chemfiles::user_name() {
 #ifdef CHEMFILES_WINDOWS
     char name[1024] = {0};
@@ -79,3 +90,132 @@ std::string chemfiles::current_directory() {
         return std::string(buffer.data());
     }
 }
+
+/// Check if `name` matches the glob `pattern`, where `*` matches any sequence
+/// of characters and `?` matches a single character
+static bool glob_match(std::string_view name, std::string_view pattern) {
+    size_t n = 0;
+    size_t p = 0;
+    // position of the last `*` in the pattern, and of the corresponding
+    // character in the name, used for backtracking
+    auto star = std::string_view::npos;
+    size_t star_name = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            n++;
+            p++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_name = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_name;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+static bool is_directory(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+static bool is_regular_file(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFREG;
+}
+
+/// Get the names of all entries in the directory at `path`
+static std::vector<std::string> directory_entries(const std::string& path) {
+    auto entries = std::vector<std::string>();
+#ifdef CHEMFILES_WINDOWS
+    WIN32_FIND_DATAA data;
+    auto handle = FindFirstFileA((path + "\\*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw file_error("could not open the directory at '{}'", path);
+    }
+    do {
+        entries.emplace_back(data.cFileName);
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+#else
+    auto directory = opendir(path.c_str());
+    if (directory == nullptr) {
+        throw file_error("could not open the directory at '{}': {}", path, std::strerror(errno));
+    }
+    while (auto entry = readdir(directory)) {
+        entries.emplace_back(entry->d_name);
+    }
+    closedir(directory);
+#endif
+    return entries;
+}
+
+std::vector<std::string> chemfiles::list_files(const std::string& pattern) {
+    auto archive_pattern = Archive::split_path(pattern);
+    if (archive_pattern) {
+        const auto& archive_path = archive_pattern->first;
+        const auto& member_pattern = archive_pattern->second;
+        auto archive = Archive::open(archive_path);
+
+        auto files = std::vector<std::string>();
+        for (const auto& member: archive->members()) {
+            if (glob_match(member, member_pattern)) {
+                files.emplace_back(archive_path + ARCHIVE_MEMBER_SEPARATOR + member);
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string directory;
+    std::string name_pattern;
+    if (is_directory(pattern)) {
+        directory = pattern;
+        name_pattern = "*";
+    } else {
+#ifdef CHEMFILES_WINDOWS
+        auto separator = pattern.find_last_of("/\\");
+#else
+        auto separator = pattern.rfind('/');
+#endif
+        if (separator == std::string::npos) {
+            directory = ".";
+            name_pattern = pattern;
+        } else {
+            directory = pattern.substr(0, separator + 1);
+            name_pattern = pattern.substr(separator + 1);
+        }
+    }
+
+    auto prefix = directory;
+    if (directory == "." && name_pattern != "*") {
+        prefix = "";
+    } else if (prefix.back() != '/' && prefix.back() != '\\') {
+        prefix += '/';
+    }
+
+    auto files = std::vector<std::string>();
+    for (auto& entry: directory_entries(directory)) {
+        // as in shell globs, wildcards do not match hidden files
+        if (entry[0] == '.' && name_pattern[0] != '.') {
+            continue;
+        }
+
+        if (glob_match(entry, name_pattern)) {
+            auto path = prefix + entry;
+            if (is_regular_file(path)) {
+                files.emplace_back(std::move(path));
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
@@ -186,6 +186,108 @@ TEST_CASE("chfl_frame") {
         chfl_free(frame);
     }
 
+    SECTION("DLPack") {
+        CHFL_FRAME* frame = chfl_frame();
+        REQUIRE(frame);
+        CHECK_STATUS(chfl_frame_resize(frame, 3));
+
+        chfl_vector3d* positions = nullptr;
+        uint64_t natoms = 0;
+        CHECK_STATUS(chfl_frame_positions(frame, &positions, &natoms));
+        for (size_t i=0; i<natoms; i++) {
+            for (size_t j=0; j<3; j++) {
+                positions[i][j] = static_cast<double>(i * 3 + j);
+            }
+        }
+
+        chfl_dlpack_managed_tensor* tensor = nullptr;
+        CHECK_STATUS(chfl_frame_dlpack(frame, CHFL_ARRAY_POSITIONS, &tensor));
+        REQUIRE(tensor);
+        CHECK(tensor->dl_tensor.data == positions);
+        CHECK(tensor->dl_tensor.device.device_type == 1);
+        CHECK(tensor->dl_tensor.dtype.code == 2);
+        CHECK(tensor->dl_tensor.dtype.bits == 64);
+        CHECK(tensor->dl_tensor.dtype.lanes == 1);
+        CHECK(tensor->dl_tensor.ndim == 2);
+        CHECK(tensor->dl_tensor.shape[0] == 3);
+        CHECK(tensor->dl_tensor.shape[1] == 3);
+        CHECK(tensor->dl_tensor.strides[0] == 3);
+        CHECK(tensor->dl_tensor.strides[1] == 1);
+        CHECK(tensor->dl_tensor.byte_offset == 0);
+
+        // the tensor keeps the frame alive
+        chfl_free(frame);
+        auto data = static_cast<double*>(tensor->dl_tensor.data);
+        CHECK(data[2 * 3 + 1] == 7.0);
+        tensor->deleter(tensor);
+
+        frame = chfl_frame();
+        REQUIRE(frame);
+        CHECK_STATUS(chfl_frame_resize(frame, 2));
+
+        CHECK(chfl_frame_dlpack(frame, CHFL_ARRAY_VELOCITIES, &tensor) == CHFL_MEMORY_ERROR);
+        CHECK_STATUS(chfl_frame_add_velocities(frame));
+        CHECK_STATUS(chfl_frame_dlpack(frame, CHFL_ARRAY_VELOCITIES, &tensor));
+        chfl_vector3d* velocities = nullptr;
+        CHECK_STATUS(chfl_frame_velocities(frame, &velocities, &natoms));
+        CHECK(tensor->dl_tensor.data == velocities);
+        CHECK(tensor->dl_tensor.shape[0] == 2);
+        tensor->deleter(tensor);
+
+        chfl_vector3d lengths = {3, 4, 5};
+        CHFL_CELL* cell = chfl_cell(lengths, nullptr);
+        REQUIRE(cell);
+        CHECK_STATUS(chfl_frame_set_cell(frame, cell));
+        chfl_free(cell);
+
+        CHECK_STATUS(chfl_frame_dlpack(frame, CHFL_ARRAY_CELL, &tensor));
+        CHECK(tensor->dl_tensor.ndim == 2);
+        CHECK(tensor->dl_tensor.shape[0] == 3);
+        CHECK(tensor->dl_tensor.shape[1] == 3);
+        data = static_cast<double*>(tensor->dl_tensor.data);
+        CHECK(data[0] == 3.0);
+        CHECK(fabs(data[1]) < 1e-12);
+        CHECK(data[4] == 4.0);
+        CHECK(data[8] == 5.0);
+        tensor->deleter(tensor);
+
+        CHFL_ATOM* atom = chfl_atom_from_frame(frame, 1);
+        REQUIRE(atom);
+        CHECK_STATUS(chfl_atom_set_mass(atom, 42.0));
+        CHECK_STATUS(chfl_atom_set_charge(atom, -1.5));
+        chfl_free(atom);
+
+        CHECK_STATUS(chfl_frame_dlpack(frame, CHFL_ARRAY_MASSES, &tensor));
+        CHECK(tensor->dl_tensor.ndim == 1);
+        CHECK(tensor->dl_tensor.shape[0] == 2);
+        data = static_cast<double*>(tensor->dl_tensor.data);
+        CHECK(tensor->dl_tensor.strides[0] == 1);
+        CHECK(data[1] == 42.0);
+        // masses are copied, modifications through the tensor are not
+        // visible in the frame
+        auto mass_before = data[0];
+        data[0] = 12.0;
+        tensor->deleter(tensor);
+
+        CHECK_STATUS(chfl_frame_dlpack(frame, CHFL_ARRAY_CHARGES, &tensor));
+        data = static_cast<double*>(tensor->dl_tensor.data);
+        CHECK(data[0] == 0.0);
+        CHECK(data[1] == -1.5);
+        tensor->deleter(tensor);
+
+        atom = chfl_atom_from_frame(frame, 0);
+        REQUIRE(atom);
+        double mass = 0;
+        CHECK_STATUS(chfl_atom_mass(atom, &mass));
+        CHECK(mass == mass_before);
+        chfl_free(atom);
+
+        auto invalid = static_cast<chfl_frame_array>(42);
+        CHECK(chfl_frame_dlpack(frame, invalid, &tensor) == CHFL_OUT_OF_BOUNDS);
+
+        chfl_free(frame);
+    }
+
     SECTION("Add atoms") {
         CHFL_FRAME* frame = chfl_frame();
         REQUIRE(frame);
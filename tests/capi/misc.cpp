@@ -1,6 +1,9 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <atomic>
+#include <thread>
+#include <fstream>
 #include <sstream>
 #include <cstring>
 
@@ -53,6 +56,121 @@ TEST_CASE("Guess format") {
     CHECK(status == CHFL_FORMAT_ERROR);
 }
 
+static void run_in_thread(chfl_task_function function, void* task, void* user_data) {
+    auto count = static_cast<std::atomic<int>*>(user_data);
+    (*count)++;
+    std::thread(function, task).detach();
+}
+
+TEST_CASE("Threads") {
+    uint64_t count = 0;
+    CHECK_STATUS(chfl_set_num_threads(3));
+    CHECK_STATUS(chfl_num_threads(&count));
+    CHECK(count == 3);
+
+    CHECK_STATUS(chfl_set_num_threads(1));
+    CHECK_STATUS(chfl_num_threads(&count));
+    CHECK(count == 1);
+
+    std::atomic<int> executed(0);
+    CHECK_STATUS(chfl_set_executor(run_in_thread, &executed, 2));
+    CHECK_STATUS(chfl_num_threads(&count));
+    CHECK(count == 2);
+
+    // guess bonds uses the thread pool
+    CHFL_FRAME* frame = chfl_frame();
+    REQUIRE(frame);
+    for (size_t i = 0; i < 300; i++) {
+        CHFL_ATOM* atom = chfl_atom("C");
+        chfl_vector3d position = {static_cast<double>(i), 0, 0};
+        CHECK_STATUS(chfl_frame_add_atom(frame, atom, position, nullptr));
+        chfl_free(atom);
+    }
+    CHECK_STATUS(chfl_frame_guess_bonds(frame));
+    CHECK(executed != 0);
+
+    const CHFL_TOPOLOGY* topology = chfl_topology_from_frame(frame);
+    REQUIRE(topology);
+    CHECK_STATUS(chfl_topology_bonds_count(topology, &count));
+    CHECK(count == 299);
+    chfl_free(topology);
+    chfl_free(frame);
+
+    CHECK_STATUS(chfl_set_num_threads(0));
+}
+
+TEST_CASE("Topology cache") {
+    CHECK_STATUS(chfl_set_topology_cache_limit(1024 * 1024));
+    CHECK_STATUS(chfl_clear_topology_cache("not-there.xyz"));
+    CHECK_STATUS(chfl_clear_topology_cache(nullptr));
+    CHECK_STATUS(chfl_set_topology_cache_limit(1024 * 1024 * 1024));
+}
+
+TEST_CASE("Component dictionary") {
+    auto cif = NamedTempPath(".cif");
+    {
+        std::ofstream file(cif);
+        file << "data_EOH\n";
+        file << "loop_\n_chem_comp_atom.comp_id\n_chem_comp_atom.atom_id\n";
+        file << "EOH C1\nEOH C2\nEOH O\n";
+        file << "loop_\n_chem_comp_bond.atom_id_1\n_chem_comp_bond.atom_id_2\n";
+        file << "C1 C2\nC1 O\n";
+    }
+
+    auto binary = NamedTempPath(".chfl-ccd");
+    CHECK_STATUS(chfl_build_component_dictionary(cif.path().c_str(), binary.path().c_str()));
+    CHECK_STATUS(chfl_load_component_dictionary(binary.path().c_str()));
+    CHECK_STATUS(chfl_load_component_dictionary(nullptr));
+
+    CHECK(chfl_load_component_dictionary("not-there") == CHFL_FILE_ERROR);
+    CHECK(chfl_build_component_dictionary(nullptr, binary.path().c_str()) == CHFL_MEMORY_ERROR);
+}
+
+TEST_CASE("Read many files") {
+    auto path = NamedTempPath(".xyz");
+    {
+        std::ofstream file(path);
+        file << "2\n\nO 0 0 0\nH 1 0 0\n";
+    }
+
+    const char* paths[] = {path.path().c_str(), "not-there.xyz", path.path().c_str()};
+    CHFL_FRAME* frames[3] = {nullptr, nullptr, nullptr};
+    CHECK(chfl_read_files(paths, 3, "", frames) == CHFL_FILE_ERROR);
+    CHECK(chfl_last_error() == std::string("could not open the file at 'not-there.xyz'"));
+    REQUIRE(frames[0]);
+    CHECK_FALSE(frames[1]);
+    REQUIRE(frames[2]);
+
+    uint64_t natoms = 0;
+    CHECK_STATUS(chfl_frame_atoms_count(frames[0], &natoms));
+    CHECK(natoms == 2);
+    chfl_free(frames[0]);
+    chfl_free(frames[2]);
+
+    CHECK_STATUS(chfl_read_files(paths, 1, "XYZ", frames));
+    REQUIRE(frames[0]);
+    chfl_free(frames[0]);
+
+    // the kind of error is kept
+    auto invalid = NamedTempPath(".xyz");
+    {
+        std::ofstream file(invalid);
+        file << "not a number\n\n";
+    }
+    const char* invalid_paths[] = {invalid.path().c_str()};
+    CHECK(chfl_read_files(invalid_paths, 1, "", frames) == CHFL_FORMAT_ERROR);
+    CHECK_FALSE(frames[0]);
+
+    // all frames are set to NULL, even after a NULL path
+    const char* null_paths[] = {path.path().c_str(), nullptr, path.path().c_str()};
+    auto garbage = reinterpret_cast<CHFL_FRAME*>(static_cast<uintptr_t>(0x1));
+    CHFL_FRAME* uninitialized[3] = {garbage, garbage, garbage};
+    CHECK(chfl_read_files(null_paths, 3, "", uninitialized) == CHFL_MEMORY_ERROR);
+    CHECK_FALSE(uninitialized[0]);
+    CHECK_FALSE(uninitialized[1]);
+    CHECK_FALSE(uninitialized[2]);
+}
+
 // Global variables for access from callback and main
 static char* buffer = nullptr;
 
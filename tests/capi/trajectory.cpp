@@ -6,6 +6,7 @@
 #include "catch.hpp"
 #include "helpers.hpp"
 #include "chemfiles.h"
+#include <cmath>
 
 static CHFL_FRAME* testing_frame();
 
@@ -130,6 +131,57 @@ TEST_CASE("Read trajectory") {
         chfl_trajectory_close(trajectory);
     }
 
+    SECTION("Frame cache") {
+        CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("data/xyz/water.xyz", 'r');
+        CHFL_FRAME* frame = chfl_frame();
+        REQUIRE(trajectory);
+        REQUIRE(frame);
+
+        CHECK_STATUS(chfl_trajectory_set_frame_cache(trajectory, 64 * 1024 * 1024, 2));
+        CHECK_STATUS(chfl_trajectory_read_step(trajectory, 41, frame));
+        // this step was prefetched
+        CHECK_STATUS(chfl_trajectory_read_step(trajectory, 40, frame));
+
+        uint64_t step = 0;
+        CHECK_STATUS(chfl_frame_step(frame, &step));
+        CHECK(step == 40);
+
+        uint64_t natoms = 0;
+        CHECK_STATUS(chfl_frame_atoms_count(frame, &natoms));
+        CHECK(natoms == 297);
+
+        CHECK_STATUS(chfl_trajectory_set_frame_cache(trajectory, 0, 0));
+
+        chfl_free(frame);
+        chfl_trajectory_close(trajectory);
+    }
+
+    SECTION("Locate steps by bisection") {
+        CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("data/xtc/ubiquitin.xtc", 'r');
+        CHFL_FRAME* frame = chfl_frame();
+        REQUIRE(trajectory);
+        REQUIRE(frame);
+
+        CHECK_STATUS(chfl_trajectory_bisect_steps(trajectory));
+
+        uint64_t nsteps = 0;
+        CHECK_STATUS(chfl_trajectory_nsteps(trajectory, &nsteps));
+        CHECK(nsteps == 251);
+
+        CHECK_STATUS(chfl_trajectory_read_step(trajectory, 120, frame));
+        uint64_t step = 0;
+        CHECK_STATUS(chfl_frame_step(frame, &step));
+        CHECK(step == 12000);
+
+        chfl_free(frame);
+        chfl_trajectory_close(trajectory);
+
+        trajectory = chfl_trajectory_open("data/xyz/water.xyz", 'r');
+        REQUIRE(trajectory);
+        CHECK(chfl_trajectory_bisect_steps(trajectory) == CHFL_FORMAT_ERROR);
+        chfl_trajectory_close(trajectory);
+    }
+
     SECTION("Get topology") {
         CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("data/xyz/water.xyz", 'r');
         CHFL_FRAME* frame = chfl_frame();
@@ -275,6 +327,109 @@ TEST_CASE("Write trajectory") {
     CHECK(content == EXPECTED_CONTENT);
 }
 
+TEST_CASE("Write positions") {
+    chfl_vector3d positions[3] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    chfl_vector3d velocities[3] = {{0, 0, 1}, {0, 1, 0}, {1, 0, 0}};
+
+    SECTION("XYZ") {
+        auto tmpfile = NamedTempPath(".xyz");
+        const char* EXPECTED_CONTENT =
+        "3\n"
+        "Properties=species:S:1:pos:R:3\n"
+        "He 1 2 3\n"
+        "He 4 5 6\n"
+        "He 7 8 9\n"
+        "3\n"
+        "Properties=species:S:1:pos:R:3\n"
+        "X 1 2 3\n"
+        "X 4 5 6\n"
+        "X 7 8 9\n";
+
+        CHFL_TRAJECTORY* trajectory = chfl_trajectory_open(tmpfile.path().c_str(), 'w');
+        REQUIRE(trajectory);
+
+        CHFL_TOPOLOGY* topology = chfl_topology();
+        REQUIRE(topology);
+        CHFL_ATOM* atom = chfl_atom("He");
+        REQUIRE(atom);
+        for (size_t i=0; i<3; i++) {
+            CHECK_STATUS(chfl_topology_add_atom(topology, atom));
+        }
+        chfl_free(atom);
+
+        CHECK_STATUS(chfl_trajectory_write_positions(trajectory, positions, nullptr, 3, topology, nullptr, 0));
+        CHECK_STATUS(chfl_trajectory_write_positions(trajectory, positions, nullptr, 3, nullptr, nullptr, 1));
+
+        // wrong number of atoms in the topology
+        CHECK(chfl_trajectory_write_positions(trajectory, positions, nullptr, 2, topology, nullptr, 2) == CHFL_GENERIC_ERROR);
+
+        chfl_free(topology);
+        chfl_trajectory_close(trajectory);
+
+        auto content = read_text_file(tmpfile);
+        CHECK(content == EXPECTED_CONTENT);
+    }
+
+    SECTION("TRR") {
+        auto tmpfile = NamedTempPath(".trr");
+
+        CHFL_TRAJECTORY* trajectory = chfl_trajectory_open(tmpfile.path().c_str(), 'w');
+        REQUIRE(trajectory);
+
+        chfl_vector3d lengths = {10, 11, 12};
+        CHFL_CELL* cell = chfl_cell(lengths, nullptr);
+        REQUIRE(cell);
+
+        for (uint64_t step=0; step<4; step++) {
+            CHECK_STATUS(chfl_trajectory_write_positions(trajectory, positions, velocities, 3, nullptr, cell, 2 * step));
+        }
+
+        chfl_free(cell);
+        chfl_trajectory_close(trajectory);
+
+        trajectory = chfl_trajectory_open(tmpfile.path().c_str(), 'r');
+        REQUIRE(trajectory);
+        uint64_t nsteps = 0;
+        CHECK_STATUS(chfl_trajectory_nsteps(trajectory, &nsteps));
+        CHECK(nsteps == 4);
+
+        CHFL_FRAME* frame = chfl_frame();
+        REQUIRE(frame);
+        CHECK_STATUS(chfl_trajectory_read_step(trajectory, 3, frame));
+
+        uint64_t step = 0;
+        CHECK_STATUS(chfl_frame_step(frame, &step));
+        CHECK(step == 6);
+
+        chfl_vector3d* data = nullptr;
+        uint64_t natoms = 0;
+        CHECK_STATUS(chfl_frame_positions(frame, &data, &natoms));
+        CHECK(natoms == 3);
+        CHECK(fabs(data[1][1] - 5.0) < 1e-5);
+        CHECK_STATUS(chfl_frame_velocities(frame, &data, &natoms));
+        CHECK(fabs(data[2][0] - 1.0) < 1e-5);
+
+        uint64_t steps[2] = {2, 0};
+        CHFL_FRAME* other = chfl_frame();
+        REQUIRE(other);
+        CHFL_FRAME* frames[2] = {frame, other};
+        CHECK_STATUS(chfl_trajectory_read_steps(trajectory, steps, 2, frames));
+        CHECK_STATUS(chfl_frame_step(frames[0], &step));
+        CHECK(step == 4);
+        CHECK_STATUS(chfl_frame_step(frames[1], &step));
+        CHECK(step == 0);
+
+        steps[1] = 4;
+        CHECK(chfl_trajectory_read_steps(trajectory, steps, 2, frames) == CHFL_FILE_ERROR);
+        frames[1] = nullptr;
+        CHECK(chfl_trajectory_read_steps(trajectory, steps, 2, frames) == CHFL_MEMORY_ERROR);
+
+        chfl_free(frame);
+        chfl_free(other);
+        chfl_trajectory_close(trajectory);
+    }
+}
+
 TEST_CASE("Write trajectory to memory") {
     // Make sure this fails
     CHECK(chfl_trajectory_memory_writer("") == nullptr);
@@ -0,0 +1,245 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <fstream>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+#include "chemfiles/component_dictionary.hpp"
+using namespace chemfiles;
+
+static const char* COMPONENTS = R"(data_EOH
+#
+_chem_comp.id                                    EOH
+_chem_comp.name                                  ETHANOL
+_chem_comp.type                                  NON-POLYMER
+_chem_comp.pdbx_synonyms                         ?
+#
+loop_
+_chem_comp_atom.comp_id
+_chem_comp_atom.atom_id
+_chem_comp_atom.type_symbol
+EOH C1 C
+EOH C2 C
+EOH O  O
+EOH HO H
+#
+loop_
+_chem_comp_bond.comp_id
+_chem_comp_bond.atom_id_1
+_chem_comp_bond.atom_id_2
+_chem_comp_bond.value_order
+_chem_comp_bond.pdbx_aromatic_flag
+EOH C1 C2 SING N
+EOH C1 O  SING N
+EOH O  HO SING N
+#
+data_NA
+#
+_chem_comp.id                                    NA
+_chem_comp.name                                  "SODIUM ION"
+_chem_comp.type                                  NON-POLYMER
+#
+_chem_comp_atom.comp_id                          NA
+_chem_comp_atom.atom_id                          NA
+_chem_comp_atom.type_symbol                      NA
+#
+data_MSE
+#
+_chem_comp.id                                    MSE
+_chem_comp.name                                  SELENOMETHIONINE
+_chem_comp.type                                  "L-peptide linking"
+_chem_comp.pdbx_synonyms
+;a multi-lines
+text field with 'quotes'
+;
+#
+loop_
+_chem_comp_atom.comp_id
+_chem_comp_atom.atom_id
+MSE N
+MSE CA
+MSE C
+MSE O
+#
+loop_
+_chem_comp_bond.comp_id
+_chem_comp_bond.atom_id_1
+_chem_comp_bond.atom_id_2
+_chem_comp_bond.value_order
+MSE N  CA SING
+MSE CA C  SING
+MSE C  O  DOUB
+#
+data_QTE
+_chem_comp.type                                  'NON-POLYMER'
+loop_
+_chem_comp_atom.comp_id
+_chem_comp_atom.atom_id
+QTE "C1'"
+QTE "O5'"
+QTE 'C2"'
+loop_
+_chem_comp_bond.comp_id
+_chem_comp_bond.atom_id_1
+_chem_comp_bond.atom_id_2
+_chem_comp_bond.value_order
+QTE "C1'" "O5'" AROM
+QTE "C1'" 'C2"' TRIP
+)";
+
+static const char* PDB_FILE = R"(ATOM      1  N   ALA A   1       0.000   0.000   0.000  1.00  0.00           N
+ATOM      2  CA  ALA A   1       1.500   0.000   0.000  1.00  0.00           C
+ATOM      3  C   ALA A   1       3.000   0.000   0.000  1.00  0.00           C
+ATOM      4  O   ALA A   1       4.500   0.000   0.000  1.00  0.00           O
+ATOM      5  CB  ALA A   1       6.000   0.000   0.000  1.00  0.00           C
+HETATM    6  N   MSE A   2       7.500   0.000   0.000  1.00  0.00           N
+HETATM    7  CA  MSE A   2       9.000   0.000   0.000  1.00  0.00           C
+HETATM    8  C   MSE A   2      10.500   0.000   0.000  1.00  0.00           C
+HETATM    9  O   MSE A   2      12.000   0.000   0.000  1.00  0.00           O
+HETATM   10  C1  EOH A   3      13.500   0.000   0.000  1.00  0.00           C
+HETATM   11  C2  EOH A   3      15.000   0.000   0.000  1.00  0.00           C
+HETATM   12  O   EOH A   3      16.500   0.000   0.000  1.00  0.00           O
+END
+)";
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+TEST_CASE("Component dictionary") {
+    auto cif = NamedTempPath(".cif");
+    write_file(cif, COMPONENTS);
+
+    auto binary = NamedTempPath(".chfl-ccd");
+    ComponentDictionary::build(cif, binary);
+
+    SECTION("Lookup") {
+        auto dictionary = ComponentDictionary(binary);
+        CHECK(dictionary.size() == 4);
+        CHECK_FALSE(dictionary.find("ALA"));
+        CHECK_FALSE(dictionary.find(""));
+
+        auto component = dictionary.find("EOH").value();
+        CHECK(component.name() == "EOH");
+        CHECK_FALSE(component.polymer());
+        CHECK(component.size() == 4);
+        CHECK(component.atom(0) == "C1");
+        CHECK(component.atom(3) == "HO");
+        CHECK_THROWS_WITH(component.atom(4),
+            "out of bounds atomic index in component 'EOH': we have 4 atoms, but the index is 4"
+        );
+
+        CHECK(component.bonds_count() == 3);
+        auto bond = component.bond(2);
+        CHECK(bond.i == 2);
+        CHECK(bond.j == 3);
+        CHECK(bond.order == Bond::SINGLE);
+
+        component = dictionary.find("NA").value();
+        CHECK(component.size() == 1);
+        CHECK(component.atom(0) == "NA");
+        CHECK(component.bonds_count() == 0);
+
+        component = dictionary.find("MSE").value();
+        CHECK(component.polymer());
+        CHECK(component.size() == 4);
+        CHECK(component.bonds_count() == 3);
+        CHECK(component.bond(2).order == Bond::DOUBLE);
+
+        component = dictionary.find("QTE").value();
+        CHECK(component.size() == 3);
+        CHECK(component.atom(0) == "C1'");
+        CHECK(component.atom(1) == "O5'");
+        CHECK(component.atom(2) == "C2\"");
+        CHECK(component.bond(0).order == Bond::AROMATIC);
+        CHECK(component.bond(1).order == Bond::TRIPLE);
+    }
+
+    SECTION("Many components") {
+        std::string content;
+        for (size_t i = 0; i < 5000; i++) {
+            auto name = "C" + std::to_string(i);
+            content += "data_" + name + "\n";
+            content += "_chem_comp_atom.comp_id " + name + "\n";
+            content += "_chem_comp_atom.atom_id A" + std::to_string(i) + "\n";
+        }
+        write_file(cif, content);
+        ComponentDictionary::build(cif, binary);
+
+        auto dictionary = ComponentDictionary(binary);
+        CHECK(dictionary.size() == 5000);
+        for (size_t i = 0; i < 5000; i++) {
+            auto component = dictionary.find("C" + std::to_string(i));
+            REQUIRE(component);
+            CHECK(component->atom(0) == "A" + std::to_string(i));
+        }
+        CHECK_FALSE(dictionary.find("C5000"));
+    }
+
+    SECTION("Bonds in PDB files") {
+        auto content = std::string(PDB_FILE);
+        auto frame = Trajectory::memory_reader(content.data(), content.size(), "PDB").read();
+        CHECK(frame.topology().bonds().size() == 4);
+
+        load_component_dictionary(binary);
+        frame = Trajectory::memory_reader(content.data(), content.size(), "PDB").read();
+        load_component_dictionary("");
+
+        const auto& topology = frame.topology();
+        CHECK(topology.bonds().size() == 10);
+        // peptide bond with the modified residue
+        CHECK(topology.bond_order(2, 5) == Bond::UNKNOWN);
+        CHECK(topology.bond_order(5, 6) == Bond::SINGLE);
+        CHECK(topology.bond_order(7, 8) == Bond::DOUBLE);
+        CHECK(topology.bond_order(9, 10) == Bond::SINGLE);
+        CHECK(topology.bond_order(9, 11) == Bond::SINGLE);
+    }
+
+    SECTION("Errors") {
+        CHECK_THROWS_WITH(ComponentDictionary("not-there"),
+            "could not open component dictionary at 'not-there': No such file or directory"
+        );
+
+        CHECK_THROWS_WITH(ComponentDictionary(cif),
+            "'" + cif.path() + "' is not a chemfiles component dictionary"
+        );
+
+        auto data = read_binary_file(binary);
+        data.pop_back();
+        std::ofstream file(binary, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.close();
+        CHECK_THROWS_WITH(ComponentDictionary(binary),
+            "invalid component dictionary in '" + binary.path() + "': the file is corrupted"
+        );
+
+        // single component with a bond, and an invalid bond order
+        write_file(cif,
+            "data_BO\nloop_\n_chem_comp_atom.atom_id\nA\nB\n"
+            "loop_\n_chem_comp_bond.atom_id_1\n_chem_comp_bond.atom_id_2\n_chem_comp_bond.value_order\nA B SING\n"
+        );
+        ComponentDictionary::build(cif, binary);
+        data = read_binary_file(binary);
+        auto strings_size = static_cast<size_t>(data[28] | data[29] << 8 | data[30] << 16 | data[31] << 24);
+        // the bond order is the third uint16_t in the last bond, right before
+        // the strings
+        auto order = data.size() - strings_size - 4;
+        CHECK(data[order] == Bond::SINGLE);
+        data[order] = 42;
+        file.open(binary, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.close();
+        auto dictionary = ComponentDictionary(binary);
+        CHECK_THROWS_WITH(dictionary.find("BO")->bond(0),
+            "invalid bond in component 'BO': the file is corrupted"
+        );
+
+        write_file(cif, "data_BAD\nloop_\n_chem_comp_bond.atom_id_1\n_chem_comp_bond.atom_id_2\nA B\n");
+        CHECK_THROWS_WITH(ComponentDictionary::build(cif, binary),
+            "invalid bond between 'A' and 'B' in component 'BAD'"
+        );
+    }
+}
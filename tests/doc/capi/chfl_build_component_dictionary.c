@@ -0,0 +1,14 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    // this only needs to be done once
+    chfl_build_component_dictionary("components.cif.gz", "components.chfl-ccd");
+
+    chfl_load_component_dictionary("components.chfl-ccd");
+    // [example]
+    return 0;
+}
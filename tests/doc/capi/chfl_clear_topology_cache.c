@@ -0,0 +1,16 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <stdlib.h>
+
+int main(void) {
+    // [example]
+    // remove a single file from the topology cache
+    chfl_clear_topology_cache("system.tpr");
+
+    // remove all the topologies from the cache
+    chfl_clear_topology_cache(NULL);
+    // [example]
+    return 0;
+}
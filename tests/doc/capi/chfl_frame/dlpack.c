@@ -0,0 +1,25 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <stdlib.h>
+
+int main(void) {
+    // [example]
+    CHFL_FRAME* frame = chfl_frame();
+    chfl_frame_resize(frame, 10);
+
+    chfl_dlpack_managed_tensor* tensor = NULL;
+    chfl_frame_dlpack(frame, CHFL_ARRAY_POSITIONS, &tensor);
+
+    // the frame stays alive until the tensor is deleted
+    chfl_free(frame);
+
+    // tensor->dl_tensor.data points to the positions, which contain
+    // tensor->dl_tensor.shape[0] x tensor->dl_tensor.shape[1] values
+
+    // give the tensor to another library, or delete it when done
+    tensor->deleter(tensor);
+    // [example]
+    return 0;
+}
@@ -0,0 +1,20 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <stdlib.h>
+
+int main(void) {
+    // [example] [no-run]
+    chfl_load_component_dictionary("components.chfl-ccd");
+
+    // bonds in ligands are created from the dictionary
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("protein.pdb", 'r');
+    // ...
+    chfl_trajectory_close(trajectory);
+
+    // remove the dictionary
+    chfl_load_component_dictionary(NULL);
+    // [example]
+    return 0;
+}
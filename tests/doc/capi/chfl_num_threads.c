@@ -0,0 +1,14 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <assert.h>
+
+int main(void) {
+    // [example]
+    uint64_t count = 0;
+    chfl_num_threads(&count);
+    assert(count >= 1);
+    // [example]
+    return 0;
+}
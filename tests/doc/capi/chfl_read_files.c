@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <stdlib.h>
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    const char* paths[] = {"first.sdf", "second.sdf", "third.sdf"};
+    CHFL_FRAME* frames[3] = {NULL};
+
+    chfl_status status = chfl_read_files(paths, 3, "", frames);
+    if (status != CHFL_SUCCESS) {
+        /* some files could not be read, and the corresponding frame is NULL */
+    }
+
+    for (int i = 0; i < 3; i++) {
+        /* use the frames here */
+        chfl_free(frames[i]);
+    }
+    // [example]
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <assert.h>
+
+// -- silent clang warnings
+void run_now(chfl_task_function function, void* task, void* user_data);
+// -- end of clang warnings
+
+    // [example]
+    // A very simple executor, running all tasks in the calling thread.
+    // A real executor would send the task to a thread pool.
+    void run_now(chfl_task_function function, void* task, void* user_data) {
+        int* tasks_count = (int*)user_data;
+        *tasks_count += 1;
+        function(task);
+    }
+
+    int main(void) {
+        int tasks_count = 0;
+        chfl_set_executor(run_now, &tasks_count, 1);
+
+        // ... use chemfiles as usual
+
+        // go back to the internal thread pool
+        chfl_set_num_threads(0);
+        return 0;
+    }
+    // [example]
@@ -0,0 +1,20 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <assert.h>
+
+int main(void) {
+    // [example]
+    // use 4 threads to run parallel code
+    chfl_set_num_threads(4);
+
+    uint64_t count = 0;
+    chfl_num_threads(&count);
+    assert(count == 4);
+
+    // disable parallelism
+    chfl_set_num_threads(1);
+    // [example]
+    return 0;
+}
@@ -0,0 +1,15 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example]
+    // use at most 4 GiB to cache topologies
+    chfl_set_topology_cache_limit(4ull * 1024 * 1024 * 1024);
+
+    // disable the topology cache
+    chfl_set_topology_cache_limit(0);
+    // [example]
+    return 0;
+}
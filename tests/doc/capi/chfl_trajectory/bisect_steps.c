@@ -0,0 +1,23 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("huge.xtc", 'r');
+    CHFL_FRAME* frame = chfl_frame();
+
+    chfl_trajectory_bisect_steps(trajectory);
+
+    /* this is an estimate, computed without reading all the steps */
+    uint64_t nsteps = 0;
+    chfl_trajectory_nsteps(trajectory, &nsteps);
+
+    chfl_trajectory_read_step(trajectory, nsteps / 2, frame);
+
+    chfl_free(frame);
+    chfl_trajectory_close(trajectory);
+    // [example]
+    return 0;
+}
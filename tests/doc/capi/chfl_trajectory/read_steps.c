@@ -0,0 +1,23 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("water.xtc", 'r');
+
+    uint64_t steps[3] = {42, 7, 1000};
+    CHFL_FRAME* frames[3] = {chfl_frame(), chfl_frame(), chfl_frame()};
+
+    chfl_trajectory_read_steps(trajectory, steps, 3, frames);
+
+    /* frames[0] contains the 42nd step, frames[1] the 7th, ... */
+
+    for (int i=0; i<3; i++) {
+        chfl_free(frames[i]);
+    }
+    chfl_trajectory_close(trajectory);
+    // [example]
+    return 0;
+}
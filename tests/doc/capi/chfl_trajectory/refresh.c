@@ -0,0 +1,31 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("running.xtc", 'r');
+    CHFL_FRAME* frame = chfl_frame();
+
+    uint64_t step = 0;
+    uint64_t nsteps = 0;
+    chfl_trajectory_nsteps(trajectory, &nsteps);
+    while (1) {
+        for (; step<nsteps; step++) {
+            chfl_trajectory_read_step(trajectory, step, frame);
+            /* Do stuff with the frame */
+        }
+
+        /* Wait for the simulation to write more steps */
+        chfl_trajectory_refresh(trajectory, &nsteps);
+        if (nsteps == step) {
+            break;
+        }
+    }
+
+    chfl_free(frame);
+    chfl_trajectory_close(trajectory);
+    // [example]
+    return 0;
+}
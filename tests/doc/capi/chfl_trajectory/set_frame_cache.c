@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+
+int main(void) {
+    // [example] [no-run]
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("water.xtc", 'r');
+    CHFL_FRAME* frame = chfl_frame();
+
+    /* use up to 512 MiB to keep decoded frames, and read the 10 steps before
+       and after each requested step in advance */
+    chfl_trajectory_set_frame_cache(trajectory, 512 * 1024 * 1024, 10);
+
+    chfl_trajectory_read_step(trajectory, 100, frame);
+    /* these steps are already in the cache */
+    chfl_trajectory_read_step(trajectory, 101, frame);
+    chfl_trajectory_read_step(trajectory, 95, frame);
+
+    chfl_free(frame);
+    chfl_trajectory_close(trajectory);
+    // [example]
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <chemfiles.h>
+#include <stdio.h>
+
+int main(void) {
+    // [example]
+    chfl_vector3d positions[3] = {{1, 2, 3}, {2, 3, 4}, {3, 4, 5}};
+    chfl_vector3d lengths = {20, 20, 20};
+    CHFL_CELL* cell = chfl_cell(lengths, NULL);
+
+    CHFL_TRAJECTORY* trajectory = chfl_trajectory_open("positions.xtc", 'w');
+    for (uint64_t step=0; step<10; step++) {
+        /* update the positions here */
+        chfl_status status = chfl_trajectory_write_positions(
+            trajectory, positions, NULL, 3, NULL, cell, step
+        );
+        if (status != CHFL_SUCCESS) {
+            /* handle error */
+        }
+    }
+
+    chfl_trajectory_close(trajectory);
+    chfl_free(cell);
+    // [example]
+
+    remove("positions.xtc");
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    // this only needs to be done once
+    chemfiles::build_component_dictionary("components.cif.gz", "components.chfl-ccd");
+
+    chemfiles::load_component_dictionary("components.chfl-ccd");
+
+    // bonds in ligands are created from the dictionary
+    auto frame = Trajectory("protein.pdb").read();
+
+    // remove the dictionary
+    chemfiles::load_component_dictionary("");
+    // [example]
+}
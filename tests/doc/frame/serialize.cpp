@@ -0,0 +1,26 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    frame.add_atom(Atom("O"), {0, 0, 0});
+    frame.add_atom(Atom("H"), {1, 0, 0});
+    frame.add_bond(0, 1);
+
+    auto snapshot = frame.serialize();
+    auto copy = Frame::deserialize(snapshot.data(), snapshot.size());
+
+    assert(copy.size() == 2);
+    assert(copy[1].name() == "H");
+    assert(copy.positions()[1] == Vector3D(1, 0, 0));
+    assert(copy.topology().bonds().size() == 1);
+    assert(copy.cell().lengths() == Vector3D(10, 10, 10));
+    // [example]
+}
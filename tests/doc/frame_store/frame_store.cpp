@@ -0,0 +1,34 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    // keep positions with an error below 0.0005 Angstroms
+    auto store = FrameStore(1e-3);
+
+    auto frame = Frame();
+    frame.add_atom(Atom("O"), {1.0, 2.0, 3.0});
+    frame.add_atom(Atom("H"), {1.5, 2.5, 3.5});
+    for (size_t step = 0; step < 10; step++) {
+        frame.set_step(step);
+        store.add(frame);
+    }
+    assert(store.size() == 10);
+
+    auto decompressed = store.get(3);
+    assert(decompressed.step() == 3);
+    assert(decompressed[0].name() == "O");
+    assert(std::abs(decompressed.positions()[1][0] - 1.5) < 5e-4);
+
+    // only decompress the positions
+    auto positions = std::vector<Vector3D>(2);
+    store.positions(7, positions);
+    assert(std::abs(positions[0][2] - 3.0) < 5e-4);
+    // [example]
+}
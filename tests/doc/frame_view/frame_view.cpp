@@ -0,0 +1,38 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto frame = Frame();
+    frame.add_atom(Atom("O"), {0, 0, 0});
+    frame.add_atom(Atom("H"), {1, 0, 0});
+
+    auto view = FrameView(frame);
+    assert(view.size() == 2);
+    assert(view.frame() == &frame);
+    assert(view[0].name() == "O");
+
+    auto topology = Topology();
+    topology.add_atom(Atom("C"));
+    topology.add_atom(Atom("N"));
+    view.set_topology(topology);
+    assert(view[0].name() == "C");
+    // the view no longer matches the frame
+    assert(view.frame() == nullptr);
+
+    auto positions = std::vector<double>{1, 2, 3, 4, 5, 6};
+    auto cell = UnitCell({10, 10, 10});
+    view = FrameView(topology, VectorsView(positions.data(), 2), cell);
+    assert(view.positions()[1] == Vector3D(4, 5, 6));
+
+    auto copy = view.to_frame();
+    assert(copy.size() == 2);
+    assert(copy.positions()[0] == Vector3D(1, 2, 3));
+    // [example]
+}
@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    // positions stored as float, with a fourth unused value per atom
+    auto data = std::vector<float>{1, 2, 3, 0, 4, 5, 6, 0};
+    auto positions = VectorsView(data.data(), 2, 4);
+    assert(positions.size() == 2);
+    assert(positions[1] == Vector3D(4, 5, 6));
+    assert(positions.contiguous() == nullptr);
+
+    auto vectors = std::vector<Vector3D>{{1, 2, 3}, {4, 5, 6}};
+    auto view = VectorsView(vectors);
+    assert(view[0] == Vector3D(1, 2, 3));
+    assert(view.contiguous() == &vectors[0][0]);
+    // [example]
+}
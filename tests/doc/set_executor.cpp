@@ -0,0 +1,23 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <thread>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    // run each task in a new detached thread. A real application would send
+    // the tasks to its own thread pool instead.
+    chemfiles::set_executor([](std::function<void()> task) {
+        std::thread(std::move(task)).detach();
+    }, 4);
+    assert(chemfiles::num_threads() == 4);
+
+    // go back to the internal thread pool
+    chemfiles::set_num_threads(0);
+    // [example]
+}
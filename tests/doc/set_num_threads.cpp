@@ -0,0 +1,23 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    // use 4 threads to run parallel code
+    chemfiles::set_num_threads(4);
+    assert(chemfiles::num_threads() == 4);
+
+    // disable parallelism
+    chemfiles::set_num_threads(1);
+    assert(chemfiles::num_threads() == 1);
+
+    // go back to the default number of threads
+    chemfiles::set_num_threads(0);
+    // [example]
+}
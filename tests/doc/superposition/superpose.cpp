@@ -0,0 +1,31 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto reference = Frame();
+    reference.add_atom(Atom("O"), {0, 0, 0});
+    reference.add_atom(Atom("H"), {1, 0, 0});
+    reference.add_atom(Atom("H"), {0, 1, 0});
+
+    auto frames = std::vector<Frame>();
+    for (double shift: {1.0, 2.0, 3.0}) {
+        auto frame = Frame();
+        frame.add_atom(Atom("O"), {shift, 0, 0});
+        frame.add_atom(Atom("H"), {shift + 1, 0, 0});
+        frame.add_atom(Atom("H"), {shift, 1, 0});
+        frames.emplace_back(std::move(frame));
+    }
+
+    auto superpositions = superpose(reference, frames);
+    assert(superpositions.size() == 3);
+    assert(superpositions[2].rmsd() < 1e-6);
+    assert(fabs(superpositions[2].mobile_center()[0] - 3.333333) < 1e-6);
+    // [example]
+}
@@ -0,0 +1,24 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto reference = std::vector<Vector3D>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    // the same positions, rotated by 90° around z and translated
+    auto mobile = std::vector<Vector3D>{{2, 2, 2}, {2, 3, 2}, {1, 2, 2}};
+
+    auto superposition = Superposition(reference, mobile);
+    assert(superposition.rmsd() < 1e-6);
+
+    auto position = superposition.apply(mobile[1]);
+    assert(fabs(position[0] - 1) < 1e-6);
+    assert(fabs(position[1]) < 1e-6);
+    assert(fabs(position[2]) < 1e-6);
+    // [example]
+}
@@ -0,0 +1,29 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto topology = Topology();
+    topology.add_atom(Atom("C"));
+    topology.add_atom(Atom("O"));
+    topology.add_bond(0, 1, Bond::DOUBLE);
+
+    auto residue = Residue("CO", 1);
+    residue.add_atom(0);
+    residue.add_atom(1);
+    topology.add_residue(residue);
+
+    auto snapshot = topology.serialize();
+    auto copy = Topology::deserialize(snapshot.data(), snapshot.size());
+
+    assert(copy.size() == 2);
+    assert(copy.bond_order(0, 1) == Bond::DOUBLE);
+    assert(copy.residues()[0].name() == "CO");
+    // [example]
+}
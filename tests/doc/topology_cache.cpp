@@ -0,0 +1,23 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    // use at most 4 GiB to cache topologies
+    chemfiles::set_topology_cache_limit(4ull * 1024 * 1024 * 1024);
+
+    for (auto path: {"replica-0.xtc", "replica-1.xtc", "replica-2.xtc"}) {
+        auto trajectory = Trajectory(path);
+        // the topology file is only read once
+        trajectory.set_topology("system.tpr");
+        // ...
+    }
+
+    // remove the topology from the cache to release memory
+    chemfiles::clear_topology_cache("system.tpr");
+    // [example]
+}
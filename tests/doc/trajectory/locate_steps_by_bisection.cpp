@@ -0,0 +1,20 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("huge.xtc");
+    trajectory.locate_steps_by_bisection();
+
+    // this is an estimate, computed without reading all the steps
+    auto nsteps = trajectory.nsteps();
+
+    // only a few frames headers are read to find this step
+    auto frame = trajectory.read_step(nsteps / 2);
+    // [example]
+}
@@ -0,0 +1,28 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <iostream>
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto paths = list_files("dataset/*.sdf");
+    auto results = read_files(paths);
+
+    for (const auto& result: results) {
+        if (!result.error.empty()) {
+            std::cout << "failed to read " << result.path << ": " << result.error << std::endl;
+            continue;
+        }
+        const auto& frame = result.frames[0];
+        std::cout << result.path << " contains " << frame.size() << " atoms" << std::endl;
+    }
+
+    // read all the frames in multiple trajectories
+    results = read_files({"first.xyz", "second.xyz"}, "XYZ", true);
+    std::cout << "second.xyz contains " << results[1].frames.size() << " steps" << std::endl;
+    // [example]
+}
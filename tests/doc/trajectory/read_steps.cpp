@@ -0,0 +1,22 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xtc");
+
+    // read 100 random steps for bootstrap resampling
+    auto steps = std::vector<size_t>();
+    for (size_t i = 0; i < 100; i++) {
+        steps.push_back(static_cast<size_t>(std::rand()) % trajectory.nsteps());
+    }
+
+    auto frames = trajectory.read_steps(steps);
+    // frames[i] contains the step steps[i]
+    // [example]
+}
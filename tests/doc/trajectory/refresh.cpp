@@ -0,0 +1,26 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("running.xtc");
+
+    size_t step = 0;
+    while (true) {
+        for (; step < trajectory.nsteps(); step++) {
+            auto frame = trajectory.read_step(step);
+            // Do stuff with the frame
+        }
+
+        // Wait for the simulation to write more steps
+        if (trajectory.refresh() == step) {
+            break;
+        }
+    }
+    // [example]
+}
@@ -0,0 +1,21 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("huge.dcd");
+
+    // read all the steps once, requesting the next 4 steps in advance and
+    // dropping the data from the cache afterward
+    trajectory.set_access_pattern(AccessPattern::STREAMING, 4);
+    while (!trajectory.done()) {
+        auto frame = trajectory.read();
+        // ...
+    }
+    // [example]
+}
@@ -0,0 +1,22 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xtc");
+
+    // use up to 512 MiB to keep decoded frames, and read the 10 steps before
+    // and after each requested step in advance
+    trajectory.set_frame_cache(512 * 1024 * 1024, 10);
+
+    auto frame = trajectory.read_step(100);
+    // these steps are already in the cache
+    frame = trajectory.read_step(101);
+    frame = trajectory.read_step(95);
+    // [example]
+}
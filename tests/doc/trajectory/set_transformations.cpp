@@ -0,0 +1,27 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto trajectory = Trajectory("water.xtc");
+
+    // center the first molecule in the box, and only keep the first 300 atoms
+    auto indexes = std::vector<size_t>();
+    for (size_t i = 0; i < 300; i++) {
+        indexes.push_back(i);
+    }
+    trajectory.set_transformations(
+        Transformations().subset(indexes).center({0, 1, 2}).wrap()
+    );
+
+    while (!trajectory.done()) {
+        auto frame = trajectory.read();
+        // frame only contains the first 300 atoms
+    }
+    // [example]
+}
@@ -0,0 +1,25 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    auto input = Trajectory("input.xtc");
+    auto output = Trajectory("output.pdb", 'w');
+    output.set_topology("topology.pdb");
+
+    // format 100 frames at once with multiple threads
+    auto frames = std::vector<Frame>();
+    while (!input.done()) {
+        frames.emplace_back(input.read());
+        if (frames.size() == 100 || input.done()) {
+            output.write(frames);
+            frames.clear();
+        }
+    }
+    // [example]
+}
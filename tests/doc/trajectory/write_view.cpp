@@ -0,0 +1,29 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+
+TEST_CASE() {
+    // [no-run]
+    // [example]
+    // positions as managed by a simulation code
+    auto positions = std::vector<float>{0, 0, 0, 1, 0, 0, 0, 1, 0};
+
+    auto topology = Topology();
+    topology.add_atom(Atom("O"));
+    topology.add_atom(Atom("H"));
+    topology.add_atom(Atom("H"));
+    auto cell = UnitCell({10, 10, 10});
+
+    auto trajectory = Trajectory("water.xtc", 'w');
+    for (size_t step = 0; step < 100; step++) {
+        // update the positions here
+
+        auto view = FrameView(topology, VectorsView(positions.data(), 3), cell);
+        view.set_step(step);
+        trajectory.write(view);
+    }
+    // [example]
+}
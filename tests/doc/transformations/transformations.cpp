@@ -0,0 +1,30 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include <chemfiles.hpp>
+using namespace chemfiles;
+#undef assert
+#define assert CHECK
+
+TEST_CASE() {
+    // [example]
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    frame.add_atom(Atom("O"), {0.1, 0.1, 0.1});
+    frame.add_atom(Atom("H"), {0.2, 0.1, 0.1});
+    frame.add_atom(Atom("Zn"), {0.9, 0.9, 0.9});
+
+    // keep the two first atoms, convert from nanometers to Angstroms, center
+    // the system on the oxygen and wrap everything in the unit cell
+    auto transformations = Transformations()
+        .subset({0, 1})
+        .scale(10)
+        .center({0})
+        .wrap();
+
+    transformations.apply(frame);
+    assert(frame.size() == 2);
+    assert(frame.positions()[0] == Vector3D(0, 0, 0));
+    assert(frame.cell().lengths() == Vector3D(100, 100, 100));
+    // [example]
+}
@@ -0,0 +1,368 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+
+#include <zlib.h>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+#include "chemfiles/files/Archive.hpp"
+#include "chemfiles/files/MemoryBuffer.hpp"
+using namespace chemfiles;
+
+static const std::string WATER_XYZ = "3\nwater\nO 0 0 0\nH 1 0 0\nH 0 1 0\n";
+static const std::string HELIUM_XYZ = "1\nhelium\nHe 0 0 0\n";
+static const std::string METHANE_PDB =
+    "HETATM    1  C   LIG A   1       0.000   0.000   0.000  1.00  0.00           C\n"
+    "HETATM    2  H1  LIG A   1       1.000   0.000   0.000  1.00  0.00           H\n"
+    "END\n";
+
+static std::string tar_member(const std::string& name, const std::string& content, char type = '0', const std::string& prefix = "") {
+    auto header = std::string(512, '\0');
+    header.replace(0, name.size(), name);
+    header.replace(100, 8, "0000644", 8);
+    header.replace(108, 8, "0000000", 8);
+    header.replace(116, 8, "0000000", 8);
+
+    char buffer[16] = {0};
+    std::snprintf(buffer, sizeof(buffer), "%011lo", static_cast<unsigned long>(content.size()));
+    header.replace(124, 12, buffer, 12);
+    header.replace(136, 12, "00000000000", 12);
+    header.replace(148, 8, "        ");
+    header[156] = type;
+    header.replace(257, 6, "ustar", 6);
+    header.replace(263, 2, "00");
+    header.replace(345, prefix.size(), prefix);
+
+    unsigned checksum = 0;
+    for (auto c: header) {
+        checksum += static_cast<unsigned char>(c);
+    }
+    std::snprintf(buffer, sizeof(buffer), "%06o", checksum);
+    header.replace(148, 7, buffer, 7);
+
+    auto padding = (512 - content.size() % 512) % 512;
+    return header + content + std::string(padding, '\0');
+}
+
+static std::string compress(const std::string& data, int window_bits) {
+    z_stream stream = {};
+    REQUIRE(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+    auto output = std::string(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return output;
+}
+
+static void push_u16(std::string& data, uint16_t value) {
+    data += static_cast<char>(value & 0xFF);
+    data += static_cast<char>(value >> 8);
+}
+
+static void push_u32(std::string& data, uint32_t value) {
+    push_u16(data, static_cast<uint16_t>(value & 0xFFFF));
+    push_u16(data, static_cast<uint16_t>(value >> 16));
+}
+
+struct ZipMember {
+    std::string name;
+    std::string content;
+    uint16_t method;
+};
+
+static std::string zip_archive(const std::vector<ZipMember>& members) {
+    auto data = std::string();
+    auto directory = std::string();
+    for (const auto& member: members) {
+        auto stored = member.method == 8 ? compress(member.content, -15) : member.content;
+        auto crc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(member.content.data()), static_cast<uInt>(member.content.size())));
+        auto offset = static_cast<uint32_t>(data.size());
+
+        push_u32(data, 0x04034b50);
+        push_u16(data, 20);
+        push_u16(data, 0);
+        push_u16(data, member.method);
+        push_u32(data, 0);
+        push_u32(data, crc);
+        push_u32(data, static_cast<uint32_t>(stored.size()));
+        push_u32(data, static_cast<uint32_t>(member.content.size()));
+        push_u16(data, static_cast<uint16_t>(member.name.size()));
+        push_u16(data, 0);
+        data += member.name;
+        data += stored;
+
+        push_u32(directory, 0x02014b50);
+        push_u16(directory, 20);
+        push_u16(directory, 20);
+        push_u16(directory, 0);
+        push_u16(directory, member.method);
+        push_u32(directory, 0);
+        push_u32(directory, crc);
+        push_u32(directory, static_cast<uint32_t>(stored.size()));
+        push_u32(directory, static_cast<uint32_t>(member.content.size()));
+        push_u16(directory, static_cast<uint16_t>(member.name.size()));
+        push_u16(directory, 0);
+        push_u16(directory, 0);
+        push_u16(directory, 0);
+        push_u16(directory, 0);
+        push_u32(directory, 0);
+        push_u32(directory, offset);
+        directory += member.name;
+    }
+
+    auto directory_offset = static_cast<uint32_t>(data.size());
+    data += directory;
+
+    push_u32(data, 0x06054b50);
+    push_u16(data, 0);
+    push_u16(data, 0);
+    push_u16(data, static_cast<uint16_t>(members.size()));
+    push_u16(data, static_cast<uint16_t>(members.size()));
+    push_u32(data, static_cast<uint32_t>(directory.size()));
+    push_u32(data, directory_offset);
+    push_u16(data, 7);
+    data += "comment";
+
+    return data;
+}
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+static std::string read_member(const Archive& archive, const std::string& name) {
+    auto buffer = archive.read(name);
+    return std::string(buffer->data(), buffer->size());
+}
+
+TEST_CASE("Tar archives") {
+    auto tar = tar_member("./water.xyz", WATER_XYZ);
+    tar += tar_member("molecules/", "", '5');
+    tar += tar_member("helium.xyz", HELIUM_XYZ, '0', "molecules");
+    tar += tar_member("././@LongLink", std::string(150, 'a') + ".pdb", 'L');
+    tar += tar_member("truncated-name.pdb", METHANE_PDB);
+    tar += tar_member("PaxHeaders/methane", "24 path=pax/methane.pdb\n", 'x');
+    tar += tar_member("methane", METHANE_PDB);
+    tar += tar_member("no-extension", METHANE_PDB);
+    tar += std::string(1024, '\0');
+
+    auto path = NamedTempPath(".tar");
+    write_file(path, tar);
+
+    SECTION("Index") {
+        auto archive = Archive(path);
+        auto expected = std::vector<std::string>{
+            "water.xyz",
+            "molecules/helium.xyz",
+            std::string(150, 'a') + ".pdb",
+            "pax/methane.pdb",
+            "no-extension",
+        };
+        CHECK(archive.members() == expected);
+        CHECK(archive.contains("water.xyz"));
+        CHECK_FALSE(archive.contains("molecules/"));
+
+        CHECK(read_member(archive, "water.xyz") == WATER_XYZ);
+        CHECK(read_member(archive, "molecules/helium.xyz") == HELIUM_XYZ);
+        CHECK(read_member(archive, "pax/methane.pdb") == METHANE_PDB);
+
+        CHECK_THROWS_WITH(
+            archive.read("not-there.xyz"),
+            "could not find 'not-there.xyz' in the archive at '" + path.path() + "'"
+        );
+    }
+
+    SECTION("Trajectory") {
+        auto frame = Trajectory(path.path() + "::water.xyz").read();
+        CHECK(frame.size() == 3);
+        CHECK(frame[0].name() == "O");
+
+        auto trajectory = Trajectory(path.path() + "::molecules/helium.xyz");
+        CHECK(trajectory.path() == path.path() + "::molecules/helium.xyz");
+        CHECK(trajectory.read()[0].name() == "He");
+
+        // format guessed from the content
+        frame = Trajectory(path.path() + "::no-extension").read();
+        CHECK(frame.size() == 2);
+
+        // explicit format
+        frame = Trajectory(path.path() + "::no-extension", 'r', "PDB").read();
+        CHECK(frame.size() == 2);
+
+        CHECK_THROWS_WITH(
+            Trajectory(path.path() + "::water.xyz", 'w'),
+            "can not open '" + path.path() + "::water.xyz' with mode 'w': files inside archives can only be read"
+        );
+    }
+
+    SECTION("List and read many files") {
+        auto files = list_files(path.path() + "::*.xyz");
+        auto expected = std::vector<std::string>{
+            path.path() + "::molecules/helium.xyz",
+            path.path() + "::water.xyz",
+        };
+        CHECK(files == expected);
+
+        auto results = read_files(files);
+        REQUIRE(results.size() == 2);
+        CHECK(results[0].error.empty());
+        CHECK(results[0].frames[0].size() == 1);
+        CHECK(results[1].frames[0].size() == 3);
+    }
+
+    SECTION("Compressed archives") {
+        auto gz = NamedTempPath(".tar.gz");
+        write_file(gz, compress(tar, 15 + 16));
+
+        auto archive = Archive(gz);
+        CHECK(archive.members().size() == 5);
+        CHECK(read_member(archive, "water.xyz") == WATER_XYZ);
+        CHECK(Trajectory(gz.path() + "::pax/methane.pdb").read().size() == 2);
+    }
+
+    SECTION("Errors") {
+        auto invalid = NamedTempPath(".tar");
+        auto content = tar;
+        content[0] = 'W';
+        write_file(invalid, content);
+        CHECK_THROWS_WITH(
+            Archive(invalid),
+            "invalid tar archive at '" + invalid.path() + "': wrong header checksum at offset 0"
+        );
+
+        // truncated data
+        write_file(invalid, tar.substr(0, 520));
+        CHECK_THROWS_WITH(
+            Archive(invalid),
+            "invalid tar archive at '" + invalid.path() + "': invalid member size at offset 0"
+        );
+
+        // truncated header
+        write_file(invalid, tar.substr(0, 1100));
+        CHECK_THROWS_WITH(
+            Archive(invalid),
+            "invalid tar archive at '" + invalid.path() + "': truncated header at offset 1024"
+        );
+
+        CHECK_THROWS(Trajectory("not-there.tar::water.xyz"));
+    }
+}
+
+TEST_CASE("Zip archives") {
+    auto content = zip_archive({
+        {"water.xyz", WATER_XYZ, 0},
+        {"data/", "", 0},
+        {"data/methane.pdb", METHANE_PDB, 8},
+        {"methane", METHANE_PDB + METHANE_PDB, 8},
+        {"bzip2.xyz", WATER_XYZ, 12},
+    });
+
+    auto path = NamedTempPath(".zip");
+    write_file(path, content);
+
+    SECTION("Index") {
+        auto archive = Archive(path);
+        auto expected = std::vector<std::string>{
+            "water.xyz", "data/methane.pdb", "methane", "bzip2.xyz"
+        };
+        CHECK(archive.members() == expected);
+
+        CHECK(read_member(archive, "water.xyz") == WATER_XYZ);
+        CHECK(read_member(archive, "data/methane.pdb") == METHANE_PDB);
+        CHECK(read_member(archive, "methane") == METHANE_PDB + METHANE_PDB);
+
+        CHECK_THROWS_WITH(
+            archive.read("bzip2.xyz"),
+            "can not read 'bzip2.xyz' in '" + path.path() + "': unsupported zip compression method 12"
+        );
+    }
+
+    SECTION("Trajectory") {
+        CHECK(Trajectory(path.path() + "::water.xyz").read().size() == 3);
+        CHECK(Trajectory(path.path() + "::data/methane.pdb").read().size() == 2);
+        CHECK(Trajectory(path.path() + "::methane").nsteps() == 2);
+
+        auto files = list_files(path.path() + "::data/*");
+        REQUIRE(files.size() == 1);
+        CHECK(files[0] == path.path() + "::data/methane.pdb");
+    }
+
+    SECTION("Cache") {
+        auto first = Archive::open(path);
+        auto second = Archive::open(path);
+        CHECK(first.get() == second.get());
+
+        write_file(path, zip_archive({{"helium.xyz", HELIUM_XYZ, 8}}));
+        auto third = Archive::open(path);
+        // the file changed, it should be indexed again (the modification time
+        // might not change, but the size does)
+        CHECK(third.get() != first.get());
+        CHECK(third->members() == std::vector<std::string>{"helium.xyz"});
+    }
+
+    SECTION("Errors") {
+        auto invalid = NamedTempPath(".zip");
+        write_file(invalid, "not a zip file, but long enough to contain the end record");
+        CHECK_THROWS_WITH(
+            Archive(invalid),
+            "invalid zip archive at '" + invalid.path() + "': could not find the central directory"
+        );
+
+        // truncated zip64 archive, shorter than the zip64 end of central
+        // directory record it points to
+        auto le = [](uint64_t value, size_t size) {
+            auto bytes = std::string();
+            for (size_t i = 0; i < size; i++) {
+                bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+            }
+            return bytes;
+        };
+        auto truncated = le(0x06064b50, 4);
+        // zip64 end of central directory locator, pointing to offset 0
+        truncated += le(0x07064b50, 4) + le(0, 4) + le(0, 8) + le(1, 4);
+        // end of central directory, with zip64 markers
+        truncated += le(0x06054b50, 4) + le(0, 4) + le(0xFFFF, 2) + le(0xFFFF, 2);
+        truncated += le(0xFFFFFFFF, 4) + le(0xFFFFFFFF, 4) + le(0, 2);
+        REQUIRE(truncated.size() == 46);
+        write_file(invalid, truncated);
+        CHECK_THROWS_WITH(
+            Archive(invalid),
+            "invalid zip archive at '" + invalid.path() + "': invalid zip64 end of central directory"
+        );
+    }
+}
+
+TEST_CASE("Archive paths") {
+    auto split = Archive::split_path("dir/file.tar.gz::member/1abc.pdb");
+    REQUIRE(split);
+    CHECK(split->first == "dir/file.tar.gz");
+    CHECK(split->second == "member/1abc.pdb");
+
+    split = Archive::split_path("file.zip::data::1abc.pdb");
+    REQUIRE(split);
+    CHECK(split->first == "file.zip");
+    CHECK(split->second == "data::1abc.pdb");
+
+    CHECK_FALSE(Archive::split_path("file.xyz::member.xyz"));
+    CHECK_FALSE(Archive::split_path("file.tar::"));
+    CHECK_FALSE(Archive::split_path("file.tar"));
+
+    CHECK(Archive::is_archive("file.tgz"));
+    CHECK(Archive::is_archive("file.tar.xz"));
+    CHECK(Archive::is_archive("file.tar.bz2"));
+    CHECK_FALSE(Archive::is_archive("file.gz"));
+}
@@ -363,3 +363,23 @@ TEST_CASE("Write binary files") {
         }
     }
 }
+
+TEST_CASE("Prefetch data in binary files") {
+    auto filename = NamedTempPath(".data");
+    auto content = std::vector<char>(100000);
+    for (size_t i = 0; i < content.size(); i++) {
+        content[i] = static_cast<char>(i % 251);
+    }
+    {
+        auto file = LittleEndianFile(filename, File::Mode::WRITE);
+        file.write_char(content);
+    }
+
+    auto file = LittleEndianFile(filename, File::Mode::READ);
+    auto ranges = std::vector<BinaryFile::Range>{{10, 100}, {50000, 20}, {0, 0}, {99990, 10}};
+    auto seen = std::vector<size_t>();
+    file.prefetch(ranges, [&](size_t i) {
+        seen.push_back(i);
+    });
+    CHECK(seen == std::vector<size_t>{0, 1, 2, 3});
+}
@@ -47,11 +47,6 @@ TEST_CASE("Read a text file") {
             Bz2File("not existing", File::READ),
             "could not open the file at 'not existing'"
         );
-
-        CHECK_THROWS_WITH(
-            Bz2File("data/xyz/water.9.xyz.bz2", File::APPEND),
-            "appending (open mode 'a') is not supported with bzip2 files"
-        );
     }
 
     SECTION("Lines offsets") {
@@ -98,6 +93,43 @@ TEST_CASE("Write a bzip2 file") {
     CHECK(file.readline() == "5467");
 }
 
+TEST_CASE("Append to a bzip2 file") {
+    auto filename = NamedTempPath(".bz2");
+
+    {
+        TextFile file(filename, File::WRITE, File::BZIP2);
+        file.print("Test\n");
+    }
+
+    {
+        // appending writes a new stream, and flushing starts another one
+        TextFile file(filename, File::APPEND, File::BZIP2);
+        file.print("Append 1\n");
+        file.flush();
+        file.print("{}\n", 7645);
+    }
+
+    {
+        TextFile file(filename, File::APPEND, File::BZIP2);
+        file.print("Append 2\n");
+    }
+
+    TextFile file(filename, File::READ, File::BZIP2);
+    CHECK(file.readline() == "Test");
+    CHECK(file.readline() == "Append 1");
+    CHECK(file.readline() == "7645");
+    CHECK(file.readline() == "Append 2");
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+
+    file.seekpos(14);
+    CHECK(file.readline() == "7645");
+
+    auto content = read_binary_file(filename);
+    auto decompressed = decompress_bz2(reinterpret_cast<const char*>(content.data()), content.size());
+    CHECK(std::string(decompressed.data(), decompressed.size()) == "Test\nAppend 1\n7645\nAppend 2\n");
+}
+
 TEST_CASE("In-memory decompression") {
     auto content = std::vector<uint8_t> {
         'B', 'Z', 'h', 0x36, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0xde, 0x45, 0xac,
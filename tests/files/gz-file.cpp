@@ -137,6 +137,18 @@ TEST_CASE("Append to a gz file") {
     CHECK(file.readline() == "6754");
     CHECK(file.readline() == "");
     CHECK(file.eof());
+
+    // flushing starts a new gzip member
+    {
+        TextFile append(filename, File::APPEND, File::GZIP);
+        append.print("Append 3\n");
+        append.flush();
+        append.print("Append 4\n");
+    }
+
+    content = read_binary_file(filename);
+    auto decompressed = decompress_gz(reinterpret_cast<const char*>(content.data()), content.size());
+    CHECK(std::string(decompressed.data(), decompressed.size()) == "Append 1\n7645\nAppend 2\n6754\nAppend 3\nAppend 4\n");
 }
 
 TEST_CASE("In-memory decompression") {
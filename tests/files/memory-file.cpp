@@ -19,6 +19,7 @@ TEST_CASE("Reading from files in memory") {
     SECTION("Basic reading functionalities") {
         auto buffer = std::make_shared<MemoryBuffer>(TEST_DATA.data(), TEST_DATA.size());
         auto file = TextFile(buffer, File::READ, File::DEFAULT);
+        CHECK(file.size() == TEST_DATA.size());
 
         CHECK(file.readline() == "This is");
         CHECK(file.readline() == "a test");
@@ -78,6 +79,37 @@ TEST_CASE("Reading from files in memory") {
         // This way, we can be sure the file works with buffers greater than
         // 8192 in size
     }
+
+    SECTION("Peek at the content") {
+        auto buffer = std::make_shared<MemoryBuffer>(TEST_DATA.data(), TEST_DATA.size());
+        auto file = TextFile(buffer, File::READ, File::DEFAULT);
+
+        CHECK(file.peek(4) == "This");
+        CHECK(file.tellpos() == 0);
+        CHECK(file.peek(1000) == TEST_DATA);
+        CHECK(file.readline() == "This is");
+        CHECK(file.peek(6) == "a test");
+        CHECK(file.tellpos() == 8);
+        CHECK(file.readall() == "a test\nfor the memory file\nclass!\n");
+
+        // peek further than the initial buffer size
+        auto content = std::string();
+        for (size_t i = 0; i < 3000; i++) {
+            content += "line " + std::to_string(i) + "\n";
+        }
+        buffer = std::make_shared<MemoryBuffer>(content.data(), content.size());
+        file = TextFile(buffer, File::READ, File::DEFAULT);
+
+        CHECK(file.peek(20000) == content.substr(0, 20000));
+        CHECK(file.tellpos() == 0);
+        for (size_t i = 0; i < 2000; i++) {
+            CHECK(file.readline() == "line " + std::to_string(i));
+        }
+        auto position = content.find("line 2000");
+        CHECK(file.tellpos() == position);
+        CHECK(file.peek(100000) == content.substr(position));
+        CHECK(file.readline() == "line 2000");
+    }
 }
 
 TEST_CASE("Write to files in memory") {
@@ -40,11 +40,6 @@ TEST_CASE("Read a text file") {
             XzFile("not existing", File::READ),
             "could not open the file at 'not existing'"
         );
-
-        CHECK_THROWS_WITH(
-            XzFile("data/xyz/water.xyz.xz", File::APPEND),
-            "appending (open mode 'a') is not supported with xz files"
-        );
     }
 
     SECTION("Lines offsets") {
@@ -87,6 +82,43 @@ TEST_CASE("Write an xz file") {
     CHECK(content == expected);
 }
 
+TEST_CASE("Append to an xz file") {
+    auto filename = NamedTempPath(".xz");
+
+    {
+        TextFile file(filename, File::WRITE, File::LZMA);
+        file.print("Test\n");
+    }
+
+    {
+        // appending writes a new stream, and flushing starts another one
+        TextFile file(filename, File::APPEND, File::LZMA);
+        file.print("Append 1\n");
+        file.flush();
+        file.print("{}\n", 7645);
+    }
+
+    {
+        TextFile file(filename, File::APPEND, File::LZMA);
+        file.print("Append 2\n");
+    }
+
+    TextFile file(filename, File::READ, File::LZMA);
+    CHECK(file.readline() == "Test");
+    CHECK(file.readline() == "Append 1");
+    CHECK(file.readline() == "7645");
+    CHECK(file.readline() == "Append 2");
+    CHECK(file.readline() == "");
+    CHECK(file.eof());
+
+    file.seekpos(14);
+    CHECK(file.readline() == "7645");
+
+    auto content = read_binary_file(filename);
+    auto decompressed = decompress_xz(reinterpret_cast<const char*>(content.data()), content.size());
+    CHECK(std::string(decompressed.data(), decompressed.size()) == "Test\nAppend 1\n7645\nAppend 2\n");
+}
+
 TEST_CASE("In-memory decompression") {
     auto content = std::vector<uint8_t> {
         0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46,
@@ -0,0 +1,515 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+
+#include <msgpack.hpp>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+using packer_t = msgpack::packer<msgpack::sbuffer>;
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+static void pack_bytes(packer_t& packer, const std::string& bytes) {
+    packer.pack_bin(static_cast<uint32_t>(bytes.size()));
+    packer.pack_bin_body(bytes.data(), static_cast<uint32_t>(bytes.size()));
+}
+
+static std::string little_endian(const std::vector<int32_t>& values, size_t width) {
+    auto bytes = std::string();
+    for (auto value: values) {
+        auto bits = static_cast<uint32_t>(value);
+        for (size_t i = 0; i < width; i++) {
+            bytes.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+        }
+    }
+    return bytes;
+}
+
+static void pack_byte_array(packer_t& packer, int type) {
+    packer.pack_map(2);
+    packer.pack(std::string("kind"));
+    packer.pack(std::string("ByteArray"));
+    packer.pack(std::string("type"));
+    packer.pack(type);
+}
+
+/// Pack `values` as a ByteArray of Int32
+static void pack_integers(packer_t& packer, const std::vector<int32_t>& values) {
+    packer.pack_map(2);
+    packer.pack(std::string("data"));
+    pack_bytes(packer, little_endian(values, 4));
+    packer.pack(std::string("encoding"));
+    packer.pack_array(1);
+    pack_byte_array(packer, 3);
+}
+
+/// A column and the function packing its data
+struct Column {
+    std::string name;
+    std::function<void(packer_t&)> data;
+    std::vector<int32_t> mask;
+};
+
+/// Integer column, encoded with RunLength
+static Column integer_column(std::string name, std::vector<int32_t> values, std::vector<int32_t> mask = {}) {
+    return {std::move(name), [values](packer_t& packer) {
+        auto runs = std::vector<int32_t>();
+        for (auto value: values) {
+            if (!runs.empty() && runs[runs.size() - 2] == value) {
+                runs.back() += 1;
+            } else {
+                runs.push_back(value);
+                runs.push_back(1);
+            }
+        }
+
+        packer.pack_map(2);
+        packer.pack(std::string("data"));
+        pack_bytes(packer, little_endian(runs, 4));
+        packer.pack(std::string("encoding"));
+        packer.pack_array(2);
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("RunLength"));
+        packer.pack(std::string("srcType"));
+        packer.pack(3);
+        packer.pack(std::string("srcSize"));
+        packer.pack(values.size());
+        pack_byte_array(packer, 3);
+    }, std::move(mask)};
+}
+
+/// Floating point column, encoded with FixedPoint, Delta and IntegerPacking
+/// in Int8, as done by the RCSB PDB for coordinates
+static Column float_column(std::string name, std::vector<double> values) {
+    return {std::move(name), [values](packer_t& packer) {
+        auto integers = std::vector<int32_t>();
+        for (auto value: values) {
+            integers.push_back(static_cast<int32_t>(std::lround(value * 1000)));
+        }
+        auto origin = integers[0];
+        auto previous = origin;
+        auto packed = std::vector<int32_t>();
+        for (auto value: integers) {
+            auto delta = value - previous;
+            previous = value;
+            while (delta >= 0x7F) {
+                packed.push_back(0x7F);
+                delta -= 0x7F;
+            }
+            while (delta <= -0x80) {
+                packed.push_back(-0x80);
+                delta += 0x80;
+            }
+            packed.push_back(delta);
+        }
+
+        packer.pack_map(2);
+        packer.pack(std::string("data"));
+        pack_bytes(packer, little_endian(packed, 1));
+        packer.pack(std::string("encoding"));
+        packer.pack_array(4);
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("FixedPoint"));
+        packer.pack(std::string("factor"));
+        packer.pack(1000);
+        packer.pack(std::string("srcType"));
+        packer.pack(33);
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("Delta"));
+        packer.pack(std::string("origin"));
+        packer.pack(origin);
+        packer.pack(std::string("srcType"));
+        packer.pack(3);
+        packer.pack_map(4);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("IntegerPacking"));
+        packer.pack(std::string("byteCount"));
+        packer.pack(1);
+        packer.pack(std::string("isUnsigned"));
+        packer.pack(false);
+        packer.pack(std::string("srcSize"));
+        packer.pack(integers.size());
+        pack_byte_array(packer, 1);
+    }, {}};
+}
+
+/// Single value column, encoded with IntervalQuantization
+static Column quantized_column(std::string name, int32_t step) {
+    return {std::move(name), [step](packer_t& packer) {
+        packer.pack_map(2);
+        packer.pack(std::string("data"));
+        pack_bytes(packer, little_endian({step}, 4));
+        packer.pack(std::string("encoding"));
+        packer.pack_array(2);
+        packer.pack_map(5);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("IntervalQuantization"));
+        packer.pack(std::string("min"));
+        packer.pack(0.0);
+        packer.pack(std::string("max"));
+        packer.pack(180.0);
+        packer.pack(std::string("numSteps"));
+        packer.pack(361);
+        packer.pack(std::string("srcType"));
+        packer.pack(32);
+        pack_byte_array(packer, 3);
+    }, {}};
+}
+
+/// String column, encoded with StringArray. Empty strings are masked as `.`
+static Column string_column(std::string name, std::vector<std::string> values) {
+    auto mask = std::vector<int32_t>();
+    for (const auto& value: values) {
+        mask.push_back(value.empty() ? 1 : 0);
+    }
+    if (std::all_of(mask.begin(), mask.end(), [](int32_t m) { return m == 0; })) {
+        mask.clear();
+    }
+
+    return {std::move(name), [values](packer_t& packer) {
+        auto strings = std::vector<std::string>();
+        auto indexes = std::vector<int32_t>();
+        for (const auto& value: values) {
+            if (value.empty()) {
+                indexes.push_back(-1);
+                continue;
+            }
+            auto it = std::find(strings.begin(), strings.end(), value);
+            indexes.push_back(static_cast<int32_t>(it - strings.begin()));
+            if (it == strings.end()) {
+                strings.push_back(value);
+            }
+        }
+        auto string_data = std::string();
+        auto offsets = std::vector<int32_t>{0};
+        for (const auto& string: strings) {
+            string_data += string;
+            offsets.push_back(static_cast<int32_t>(string_data.size()));
+        }
+
+        packer.pack_map(2);
+        packer.pack(std::string("data"));
+        pack_bytes(packer, little_endian(indexes, 4));
+        packer.pack(std::string("encoding"));
+        packer.pack_array(1);
+        packer.pack_map(5);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("StringArray"));
+        packer.pack(std::string("dataEncoding"));
+        packer.pack_array(1);
+        pack_byte_array(packer, 3);
+        packer.pack(std::string("stringData"));
+        packer.pack(string_data);
+        packer.pack(std::string("offsetEncoding"));
+        packer.pack_array(1);
+        pack_byte_array(packer, 3);
+        packer.pack(std::string("offsets"));
+        pack_bytes(packer, little_endian(offsets, 4));
+    }, std::move(mask)};
+}
+
+struct Category {
+    std::string name;
+    size_t rows;
+    std::vector<Column> columns;
+};
+
+static std::string binary_cif(const std::vector<Category>& categories) {
+    auto buffer = msgpack::sbuffer();
+    auto packer = packer_t(buffer);
+    packer.pack_map(3);
+    packer.pack(std::string("version"));
+    packer.pack(std::string("0.3.0"));
+    packer.pack(std::string("encoder"));
+    packer.pack(std::string("chemfiles tests"));
+    packer.pack(std::string("dataBlocks"));
+    packer.pack_array(1);
+    packer.pack_map(2);
+    packer.pack(std::string("header"));
+    packer.pack(std::string("TEST"));
+    packer.pack(std::string("categories"));
+    packer.pack_array(static_cast<uint32_t>(categories.size()));
+    for (const auto& category: categories) {
+        packer.pack_map(3);
+        packer.pack(std::string("name"));
+        packer.pack(category.name);
+        packer.pack(std::string("rowCount"));
+        packer.pack(category.rows);
+        packer.pack(std::string("columns"));
+        packer.pack_array(static_cast<uint32_t>(category.columns.size()));
+        for (const auto& column: category.columns) {
+            packer.pack_map(3);
+            packer.pack(std::string("name"));
+            packer.pack(column.name);
+            packer.pack(std::string("data"));
+            column.data(packer);
+            packer.pack(std::string("mask"));
+            if (column.mask.empty()) {
+                packer.pack_nil();
+            } else {
+                pack_integers(packer, column.mask);
+            }
+        }
+    }
+    return std::string(buffer.data(), buffer.size());
+}
+
+/// Two models of two glycine residues and a zinc ion bound to the second
+/// residue, as found in the RCSB PDB files
+static std::string test_structure() {
+    auto names = std::vector<std::string>{"N", "CA", "C", "O", "N", "CA", "C", "O", "ZN"};
+    auto types = std::vector<std::string>{"N", "C", "C", "O", "N", "C", "C", "O", "ZN"};
+    auto x = std::vector<double>{0.0, 1.458, 2.009, 1.246, 3.332, 3.97, 5.45, 6.11, 7.5};
+
+    auto repeat = [](std::vector<std::string> values) {
+        auto copy = values;
+        values.insert(values.end(), copy.begin(), copy.end());
+        return values;
+    };
+
+    auto all_x = x;
+    for (auto value: x) {
+        all_x.push_back(value + 1.0);
+    }
+    auto y = std::vector<double>(18, -2.5);
+    auto z = std::vector<double>(18, 0.125);
+
+    auto atom_site = Category{"_atom_site", 18, {
+        string_column("group_PDB", repeat({"ATOM", "ATOM", "ATOM", "ATOM", "ATOM", "ATOM", "ATOM", "ATOM", "HETATM"})),
+        integer_column("id", {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18}),
+        string_column("type_symbol", repeat(types)),
+        string_column("label_atom_id", repeat(names)),
+        string_column("label_alt_id", repeat({"", "A", "", "", "", "", "", "", ""})),
+        string_column("label_comp_id", repeat({"GLY", "GLY", "GLY", "GLY", "GLY", "GLY", "GLY", "GLY", "ZN"})),
+        string_column("label_asym_id", repeat({"A", "A", "A", "A", "A", "A", "A", "A", "B"})),
+        string_column("label_entity_id", repeat({"1", "1", "1", "1", "1", "1", "1", "1", "2"})),
+        integer_column("label_seq_id",
+            {1, 1, 1, 1, 2, 2, 2, 2, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0},
+            {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1}
+        ),
+        float_column("Cartn_x", all_x),
+        float_column("Cartn_y", y),
+        float_column("Cartn_z", z),
+        integer_column("pdbx_formal_charge",
+            {0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 2},
+            {2, 2, 2, 2, 2, 2, 2, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 0}
+        ),
+        integer_column("auth_seq_id", {1, 1, 1, 1, 2, 2, 2, 2, 101, 1, 1, 1, 1, 2, 2, 2, 2, 101}),
+        string_column("auth_asym_id", repeat({"P", "P", "P", "P", "P", "P", "P", "P", "P"})),
+        integer_column("pdbx_PDB_model_num", {1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2}),
+    }};
+
+    auto struct_conn = Category{"_struct_conn", 2, {
+        string_column("conn_type_id", {"metalc", "hydrog"}),
+        string_column("ptnr1_label_asym_id", {"A", "A"}),
+        string_column("ptnr1_label_atom_id", {"O", "N"}),
+        integer_column("ptnr1_auth_seq_id", {2, 1}),
+        string_column("ptnr1_symmetry", {"1_555", "1_555"}),
+        string_column("ptnr2_label_asym_id", {"B", "A"}),
+        string_column("ptnr2_label_atom_id", {"ZN", "O"}),
+        integer_column("ptnr2_auth_seq_id", {101, 2}),
+        string_column("ptnr2_symmetry", {"1_555", "1_555"}),
+        string_column("pdbx_value_order", {"sing", ""}),
+    }};
+
+    return binary_cif({
+        {"_entry", 1, {string_column("id", {"1ABC"})}},
+        {"_struct", 1, {string_column("title", {"GLYCINE DIPEPTIDE WITH ZINC"})}},
+        {"_cell", 1, {
+            float_column("length_a", {40.5}),
+            float_column("length_b", {50.25}),
+            float_column("length_c", {60.0}),
+            quantized_column("angle_beta", 200),
+        }},
+        atom_site,
+        struct_conn,
+    });
+}
+
+static void check_first_model(const Frame& frame) {
+    CHECK(frame.size() == 9);
+    CHECK(frame.get("name")->as_string() == "GLYCINE DIPEPTIDE WITH ZINC");
+    CHECK(frame.get("pdb_idcode")->as_string() == "1ABC");
+
+    CHECK(approx_eq(frame.cell().lengths(), {40.5, 50.25, 60.0}, 1e-12));
+    CHECK(approx_eq(frame.cell().angles(), {90.0, 100.0, 90.0}, 1e-12));
+
+    auto positions = frame.positions();
+    CHECK(approx_eq(positions[0], Vector3D(0.0, -2.5, 0.125), 1e-12));
+    CHECK(approx_eq(positions[3], Vector3D(1.246, -2.5, 0.125), 1e-12));
+    CHECK(approx_eq(positions[8], Vector3D(7.5, -2.5, 0.125), 1e-12));
+
+    CHECK(frame[1].name() == "CA");
+    CHECK(frame[1].type() == "C");
+    CHECK(frame[1].get("altloc")->as_string() == "A");
+    CHECK_FALSE(frame[0].get("altloc"));
+    CHECK(frame[8].name() == "ZN");
+    CHECK(frame[8].charge() == 2);
+    CHECK(frame[0].charge() == 0);
+
+    const auto& topology = frame.topology();
+    REQUIRE(topology.residues().size() == 3);
+    auto residue = topology.residue_for_atom(5);
+    REQUIRE(residue);
+    CHECK(residue->name() == "GLY");
+    CHECK(residue->id().value() == 2);
+    CHECK(residue->size() == 4);
+    CHECK(residue->get("chainid")->as_string() == "A");
+    CHECK(residue->get("chainname")->as_string() == "P");
+    CHECK(residue->get("is_standard_pdb")->as_bool());
+
+    // non-polymer residues use the entity id
+    residue = topology.residue_for_atom(8);
+    REQUIRE(residue);
+    CHECK(residue->name() == "ZN");
+    CHECK(residue->id().value() == 2);
+    CHECK(residue->get("chainid")->as_string() == "B");
+    CHECK_FALSE(residue->get("is_standard_pdb")->as_bool());
+
+    // bonds in standard residues, and the peptide bond
+    const auto& bonds = topology.bonds();
+    CHECK(std::find(bonds.begin(), bonds.end(), Bond(0, 1)) != bonds.end());
+    CHECK(topology.are_linked(topology.residue(0), topology.residue(1)));
+    // bonds from _struct_conn, without hydrogen bonds
+    CHECK(topology.bond_order(7, 8) == Bond::SINGLE);
+    CHECK(std::find(bonds.begin(), bonds.end(), Bond(0, 7)) == bonds.end());
+}
+
+TEST_CASE("Read files in BinaryCIF format") {
+    auto content = test_structure();
+
+    SECTION("Read file") {
+        auto path = NamedTempPath(".bcif");
+        write_file(path, content);
+
+        auto file = Trajectory(path);
+        CHECK(file.nsteps() == 2);
+
+        auto frame = file.read();
+        check_first_model(frame);
+
+        frame = file.read();
+        CHECK(frame.size() == 9);
+        CHECK(approx_eq(frame.positions()[8], Vector3D(8.5, -2.5, 0.125), 1e-12));
+        CHECK(frame.topology().bond_order(7, 8) == Bond::SINGLE);
+
+        frame = file.read_step(0);
+        check_first_model(frame);
+    }
+
+    SECTION("Read memory") {
+        auto file = Trajectory::memory_reader(content.data(), content.size(), "BinaryCIF");
+        CHECK(file.nsteps() == 2);
+        check_first_model(file.read());
+    }
+}
+
+TEST_CASE("Errors in BinaryCIF format") {
+    auto path = NamedTempPath(".bcif");
+    CHECK_THROWS_WITH(
+        Trajectory(path, 'w'),
+        "only read mode ('r') is supported for the BinaryCIF format"
+    );
+
+    auto content = binary_cif({{"_entry", 1, {string_column("id", {"1ABC"})}}});
+    CHECK_THROWS_WITH(
+        Trajectory::memory_reader(content.data(), content.size(), "BinaryCIF"),
+        "could not find _atom_site category in BinaryCIF from memory"
+    );
+
+    content = binary_cif({{"_atom_site", 2, {
+        string_column("type_symbol", {"C", "C"}),
+        float_column("Cartn_x", {0.0, 1.0, 2.0}),
+        float_column("Cartn_y", {0.0, 1.0}),
+        float_column("Cartn_z", {0.0, 1.0}),
+    }}});
+    CHECK_THROWS_WITH(
+        Trajectory::memory_reader(content.data(), content.size(), "BinaryCIF"),
+        "invalid BinaryCIF column 'Cartn_x': expected 2 values, got 3"
+    );
+
+    // column with Int32 `data`, decoded with a single `encoding` before the
+    // ByteArray
+    auto encoded_column = [](std::vector<int32_t> values, std::function<void(packer_t&)> encoding) {
+        return Column{"Cartn_x", [values, encoding](packer_t& packer) {
+            packer.pack_map(2);
+            packer.pack(std::string("data"));
+            pack_bytes(packer, little_endian(values, 4));
+            packer.pack(std::string("encoding"));
+            packer.pack_array(2);
+            encoding(packer);
+            pack_byte_array(packer, 3);
+        }, {}};
+    };
+    auto check_invalid = [&](const Column& column) {
+        auto invalid = binary_cif({{"_atom_site", 2, {
+            string_column("type_symbol", {"C", "C"}),
+            column,
+            float_column("Cartn_y", {0.0, 1.0}),
+            float_column("Cartn_z", {0.0, 1.0}),
+        }}});
+        CHECK_THROWS_AS(
+            Trajectory::memory_reader(invalid.data(), invalid.size(), "BinaryCIF"),
+            FormatError
+        );
+    };
+
+    auto huge = static_cast<uint64_t>(1) << 62;
+    check_invalid(encoded_column({1, 2}, [&](packer_t& packer) {
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("RunLength"));
+        packer.pack(std::string("srcType"));
+        packer.pack(3);
+        packer.pack(std::string("srcSize"));
+        packer.pack(huge);
+    }));
+
+    check_invalid(encoded_column({1, 2}, [&](packer_t& packer) {
+        packer.pack_map(4);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("IntegerPacking"));
+        packer.pack(std::string("byteCount"));
+        packer.pack(1);
+        packer.pack(std::string("isUnsigned"));
+        packer.pack(false);
+        packer.pack(std::string("srcSize"));
+        packer.pack(huge);
+    }));
+
+    check_invalid(encoded_column({1, 2}, [&](packer_t& packer) {
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("FixedPoint"));
+        packer.pack(std::string("factor"));
+        packer.pack(0);
+        packer.pack(std::string("srcType"));
+        packer.pack(33);
+    }));
+
+    check_invalid(encoded_column({1, 2}, [&](packer_t& packer) {
+        packer.pack_map(3);
+        packer.pack(std::string("kind"));
+        packer.pack(std::string("Delta"));
+        packer.pack(std::string("origin"));
+        packer.pack(INT64_MAX);
+        packer.pack(std::string("srcType"));
+        packer.pack(3);
+    }));
+}
@@ -0,0 +1,93 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <fstream>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+static Frame water_frame(size_t step) {
+    auto frame = Frame(UnitCell({20, 20, 20}));
+    frame.set_step(step);
+    auto shift = static_cast<double>(step);
+    frame.add_atom(Atom("O"), {shift, 0, 0});
+    frame.add_atom(Atom("H"), {shift + 1, 0, 0});
+    frame.add_atom(Atom("H"), {shift, 1, 0});
+    frame.add_bond(0, 1);
+    frame.add_bond(0, 2);
+
+    auto residue = Residue("HOH", 1);
+    residue.add_atom(0);
+    residue.add_atom(1);
+    residue.add_atom(2);
+    frame.add_residue(residue);
+    return frame;
+}
+
+TEST_CASE("Read and write files in Chemfiles Snapshot format") {
+    auto path = NamedTempPath(".chfl");
+
+    {
+        auto file = Trajectory(path, 'w');
+        for (size_t step = 0; step < 3; step++) {
+            file.write(water_frame(step));
+        }
+    }
+
+    {
+        auto file = Trajectory(path, 'a');
+        CHECK(file.nsteps() == 3);
+        auto frame = water_frame(3);
+        frame.add_velocities();
+        (*frame.velocities())[0] = Vector3D(1, 2, 3);
+        file.write(frame);
+    }
+
+    auto file = Trajectory(path);
+    REQUIRE(file.nsteps() == 4);
+
+    auto frame = file.read();
+    CHECK(frame.step() == 0);
+    CHECK(frame.size() == 3);
+    CHECK(frame.topology().bonds().size() == 2);
+    CHECK(frame.topology().residues()[0].name() == "HOH");
+    CHECK(frame.cell().lengths() == Vector3D(20, 20, 20));
+    CHECK_FALSE(frame.velocities());
+
+    frame = file.read_step(3);
+    CHECK(frame.step() == 3);
+    CHECK(frame.positions()[0] == Vector3D(3, 0, 0));
+    REQUIRE(frame.velocities());
+    CHECK((*frame.velocities())[0] == Vector3D(1, 2, 3));
+
+    frame = file.read_step(1);
+    CHECK(frame.positions()[1] == Vector3D(2, 0, 0));
+    frame = file.read();
+    CHECK(frame.step() == 2);
+
+    CHECK_THROWS_WITH(
+        Trajectory(path, 'r', "Chemfiles Snapshot / GZ"),
+        "compression is not supported for Chemfiles Snapshot files"
+    );
+}
+
+TEST_CASE("Errors in Chemfiles Snapshot format") {
+    auto path = NamedTempPath(".chfl");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "this is not a snapshot file, but long enough for the header";
+    }
+    CHECK_THROWS_WITH(Trajectory(path), "invalid snapshot: missing CHFL-SNP header");
+
+    auto snapshot = water_frame(0).serialize();
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size() - 10));
+    }
+    CHECK_THROWS_WITH(
+        Trajectory(path),
+        "invalid Chemfiles Snapshot file: truncated snapshot at offset 0"
+    );
+}
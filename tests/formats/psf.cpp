@@ -0,0 +1,189 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+TEST_CASE("Read PSF format") {
+    SECTION("Standard PSF") {
+        auto file = Trajectory("data/psf/776wat_1Ca.psf");
+        CHECK(file.nsteps() == 1);
+        auto frame = file.read();
+
+        CHECK(frame.size() == 3105);
+
+        auto& topology = frame.topology();
+        CHECK(topology[0].name() == "OH2");
+        CHECK(topology[0].type() == "OT");
+        CHECK(approx_eq(topology[0].charge(), 0.0, 1e-12));
+        CHECK(approx_eq(topology[0].mass(), 15.9994, 1e-12));
+
+        CHECK(topology[1].name() == "H1");
+        CHECK(topology[1].type() == "HT");
+        CHECK(approx_eq(topology[1].charge(), 0.556400, 1e-12));
+        CHECK(approx_eq(topology[1].mass(), 1.0080, 1e-12));
+
+        CHECK(topology[3104].name() == "CAL");
+        CHECK(topology[3104].type() == "CAL");
+        CHECK(approx_eq(topology[3104].charge(), 2.0, 1e-12));
+        CHECK(approx_eq(topology[3104].mass(), 40.0800, 1e-12));
+
+        CHECK(topology.residues().size() == 777);
+        auto residue = topology.residue_for_atom(0).value();
+        CHECK(residue.id().value() == 1);
+        CHECK(residue.name() == "TIP4");
+        CHECK(residue.get("segname")->as_string() == "WT1");
+        CHECK(residue.get("chainname")->as_string() == "W");
+        CHECK(residue.get("chainid")->as_string() == "W");
+
+        // a different residue with the same resid
+        residue = topology.residue_for_atom(2098).value();
+        CHECK(residue.id().value() == 1);
+        CHECK(residue.name() == "TIP4");
+        CHECK(residue.get("segname")->as_string() == "WT5");
+        CHECK(residue.get("chainname")->as_string() == "W");
+        CHECK(residue.get("chainid")->as_string() == "W");
+
+        CHECK(residue.size() == 4);
+        CHECK(residue.contains(2096));
+        CHECK(residue.contains(2097));
+        CHECK(residue.contains(2098));
+        CHECK(residue.contains(2099));
+
+        auto& bonds = topology.bonds();
+        CHECK(bonds.size() == 3104);
+
+        CHECK(bonds[0][0] == 0);
+        CHECK(bonds[0][1] == 1);
+    }
+
+    SECTION("Extended PSF") {
+        auto file = Trajectory("data/psf/ligandrm.psf");
+        CHECK(file.nsteps() == 1);
+        auto frame = file.read();
+
+        CHECK(frame.size() == 4);
+
+        auto& topology = frame.topology();
+        CHECK(topology[0].name() == "C1");
+        CHECK(topology[0].type() == "CG2O6");
+        CHECK(approx_eq(topology[0].charge(), 1.42000, 1e-12));
+        CHECK(approx_eq(topology[0].mass(), 12.0110, 1e-12));
+
+        CHECK(topology[1].name() == "O1");
+        CHECK(topology[1].type() == "OG2D2");
+        CHECK(approx_eq(topology[3].charge(), -1.14000, 1e-12));
+        CHECK(approx_eq(topology[3].mass(), 15.9994, 1e-12));
+
+        CHECK(topology[2].name() == "O2");
+        CHECK(topology[2].type() == "OG2D2");
+        CHECK(approx_eq(topology[3].charge(), -1.14000, 1e-12));
+        CHECK(approx_eq(topology[3].mass(), 15.9994, 1e-12));
+
+        CHECK(topology[3].name() == "O3");
+        CHECK(topology[3].type() == "OG2D2");
+        CHECK(approx_eq(topology[3].charge(), -1.14000, 1e-12));
+        CHECK(approx_eq(topology[3].mass(), 15.9994, 1e-12));
+
+        auto& bonds = topology.bonds();
+        CHECK(bonds.size() == 3);
+
+        CHECK(bonds[0][0] == 0);
+        CHECK(bonds[0][1] == 1);
+
+        CHECK(bonds[1][0] == 0);
+        CHECK(bonds[1][1] == 2);
+
+        CHECK(bonds[2][0] == 0);
+        CHECK(bonds[2][1] == 3);
+    }
+}
+
+TEST_CASE("Read PSF files in memory") {
+    SECTION("Reading from memory") {
+        auto content = read_text_file("data/psf/ligandrm.psf");
+
+        auto file = Trajectory::memory_reader(content.data(), content.size(), "PSF");
+        CHECK(file.nsteps() == 1);
+
+        auto frame = file.read();
+        CHECK(frame.size() == 4);
+        CHECK(frame.topology().bonds().size() == 3);
+    }
+
+    SECTION("Residues, fixed columns and unsorted bonds") {
+        std::string content(R"(PSF
+
+       1 !NTITLE
+ REMARKS small test system
+
+       5 !NATOM
+       1 PROA 12A  ALA  N    NH1   -0.470000       14.0070           0
+       2 PROA 12A  ALA  CA   CT1    0.070000       12.0110           0
+       3 PROA 13   GLY  N    NH1   -0.470000       14.0070           0
+       4 WT1  1    TIP3 OH2  OT    -0.834000       15.9994           0
+       5      1    TIP3 H1   HT     0.417000        1.0080
+
+       4 !NBOND: bonds
+       4       5       2       3       1       2       3       1
+
+       0 !NTHETA: angles
+)");
+
+        auto file = Trajectory::memory_reader(content.data(), content.size(), "PSF");
+        auto frame = file.read();
+        CHECK(frame.size() == 5);
+
+        CHECK(frame[0].name() == "N");
+        CHECK(frame[0].type() == "NH1");
+        CHECK(approx_eq(frame[0].charge(), -0.47, 1e-12));
+        CHECK(approx_eq(frame[0].mass(), 14.007, 1e-12));
+
+        // this line has no segment name, and is read with fixed columns
+        CHECK(frame[4].name() == "H1");
+        CHECK(frame[4].type() == "HT");
+        CHECK(approx_eq(frame[4].charge(), 0.417, 1e-12));
+        CHECK(approx_eq(frame[4].mass(), 1.008, 1e-12));
+
+        const auto& topology = frame.topology();
+        CHECK(topology.residues().size() == 4);
+
+        auto residue = topology.residue_for_atom(1).value();
+        CHECK(residue.name() == "ALA");
+        CHECK(residue.id().value() == 12);
+        CHECK(residue.get("insertion_code")->as_string() == "A");
+        CHECK(residue.get("segname")->as_string() == "PROA");
+        CHECK(residue.get("chainid")->as_string() == "P");
+        CHECK(residue.size() == 2);
+
+        residue = topology.residue_for_atom(4).value();
+        CHECK(residue.name() == "TIP3");
+        CHECK(residue.id().value() == 1);
+        CHECK(!residue.get("segname"));
+        CHECK(residue.size() == 1);
+
+        auto& bonds = topology.bonds();
+        CHECK(bonds.size() == 4);
+        CHECK(bonds[0] == Bond(0, 1));
+        CHECK(bonds[1] == Bond(0, 2));
+        CHECK(bonds[2] == Bond(1, 2));
+        CHECK(bonds[3] == Bond(3, 4));
+        CHECK(topology.angles().size() == 3);
+    }
+
+    SECTION("Errors") {
+        std::string content = "NOT A PSF\n";
+        auto file = Trajectory::memory_reader(content.data(), content.size(), "PSF");
+        CHECK_THROWS_WITH(file.read(),
+            "invalid PSF file '<in memory>': expected the file to start with 'PSF', got 'NOT A PSF'"
+        );
+
+        content = "PSF\n\n 0 !NTITLE\n\n 1 !NATOM\n 1 A 1 RES C1 C 0.0 12.0 0\n\n 1 !NBOND\n 1 1\n";
+        file = Trajectory::memory_reader(content.data(), content.size(), "PSF");
+        CHECK_THROWS_WITH(file.read(),
+            "invalid bond between atoms 1 and 1 in PSF file with 1 atoms"
+        );
+    }
+}
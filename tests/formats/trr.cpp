@@ -400,3 +400,105 @@ TEST_CASE("Check Errors") {
         file.write(frame),
         "TRR format does not support varying numbers of atoms: expected 1, but got 2");
 }
+
+static Frame bisection_frame(size_t natoms, size_t step) {
+    auto frame = Frame(UnitCell({20, 20, 20}));
+    for (size_t i = 0; i < natoms; i++) {
+        // vary the size of compressed frames
+        auto x = static_cast<double>((i * step) % 97) / static_cast<double>(1 + step % 7);
+        frame.add_atom(Atom("A"), {x, static_cast<double>(i), static_cast<double>(step) / 100});
+    }
+    frame.set_step(step);
+    return frame;
+}
+
+TEST_CASE("Locate steps by bisection") {
+    auto tmpfile = NamedTempPath(".trr");
+    for (size_t natoms: {3, 50}) {
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t i = 0; i < 300; i++) {
+                file.write(bisection_frame(natoms, 10 + 5 * i));
+            }
+        }
+
+        auto file = Trajectory(tmpfile);
+        file.locate_steps_by_bisection();
+        CHECK(file.nsteps() == 300);
+
+        for (size_t i: {0, 1, 2, 17, 150, 151, 298, 299, 42}) {
+            auto frame = file.read_step(i);
+            CHECK(frame.step() == 10 + 5 * i);
+            auto expected = bisection_frame(natoms, 10 + 5 * i);
+            CHECK(approx_eq(frame.positions()[natoms - 1], expected.positions()[natoms - 1], 1e-5));
+        }
+
+        // sequential reading continues after the last step read
+        CHECK(file.read().step() == 10 + 5 * 43);
+
+        // the frames are also located by bisection for hints and prefetching
+        file.set_access_pattern(AccessPattern::SEQUENTIAL, 4);
+        CHECK(file.read().step() == 10 + 5 * 44);
+        CHECK(file.read().step() == 10 + 5 * 45);
+        auto frames = file.read_steps({250, 7, 120});
+        CHECK(frames[0].step() == 10 + 5 * 250);
+        CHECK(frames[1].step() == 10 + 5 * 7);
+        CHECK(frames[2].step() == 10 + 5 * 120);
+        file.set_access_pattern(AccessPattern::NORMAL);
+
+        CHECK_THROWS_WITH(file.read_step(300), "can not read file '" + tmpfile.path() + "' at step 300: maximal step is 299");
+
+        // refresh finds all the steps in the file
+        CHECK(file.refresh() == 300);
+        CHECK(file.read_step(200).step() == 10 + 5 * 200);
+    }
+
+    SECTION("Unevenly spaced steps") {
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t i = 0; i < 100; i++) {
+                file.write(bisection_frame(50, i < 50 ? i : 2 * i));
+            }
+        }
+
+        auto file = Trajectory(tmpfile);
+        file.locate_steps_by_bisection();
+        CHECK(file.nsteps() == 100);
+        CHECK(file.read_step(75).step() == 150);
+    }
+
+    SECTION("Missing step") {
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t i = 0; i < 100; i++) {
+                if (i != 37) {
+                    file.write(bisection_frame(50, i));
+                }
+            }
+        }
+
+        auto file = Trajectory(tmpfile);
+        file.locate_steps_by_bisection();
+        // the step is not found by bisection, and all the steps in the file
+        // are found instead
+        CHECK(file.read_step(37).step() == 38);
+        CHECK(file.nsteps() == 99);
+    }
+
+    SECTION("Missing step before the step read") {
+        {
+            auto file = Trajectory(tmpfile, 'w');
+            for (size_t i = 0; i < 100; i++) {
+                if (i != 37) {
+                    file.write(bisection_frame(50, i));
+                }
+            }
+        }
+
+        // the offsets of frames with the same size do not match the steps
+        auto file = Trajectory(tmpfile);
+        file.locate_steps_by_bisection();
+        CHECK(file.read_step(60).step() == 61);
+        CHECK(file.nsteps() == 99);
+    }
+}
@@ -0,0 +1,111 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include "chemfiles.hpp"
+#include "chemfiles/frame_cache.hpp"
+using namespace chemfiles;
+
+static Frame make_frame(size_t step, size_t natoms) {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    for (size_t i = 0; i < natoms; i++) {
+        frame.add_atom(Atom("O"), {static_cast<double>(step), 0, 0});
+    }
+    frame.set_step(step);
+    return frame;
+}
+
+TEST_CASE("Frame cache") {
+    SECTION("Get cached frames") {
+        auto cache = FrameCache(1024 * 1024);
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory() == 0);
+
+        auto frame = make_frame(3, 10);
+        frame.add_velocities();
+        (*frame.velocities())[2] = {1, 2, 3};
+        frame.set("name", "cached");
+        frame.add_bond(0, 1);
+        cache.insert(3, frame);
+        CHECK(cache.size() == 1);
+        CHECK(cache.contains(3));
+        CHECK_FALSE(cache.contains(2));
+
+        auto cached = Frame();
+        CHECK_FALSE(cache.get(2, cached));
+        CHECK(cached.size() == 0);
+
+        CHECK(cache.get(3, cached));
+        CHECK(cached.size() == 10);
+        CHECK(cached.step() == 3);
+        CHECK(cached.positions()[4] == Vector3D(3, 0, 0));
+        CHECK(cached.velocities());
+        CHECK((*cached.velocities())[2] == Vector3D(1, 2, 3));
+        CHECK(cached.get("name")->as_string() == "cached");
+        CHECK(cached.topology()[0].name() == "O");
+        CHECK(cached.topology().bonds().size() == 1);
+        CHECK(cached.cell().lengths() == Vector3D(10, 10, 10));
+
+        cache.clear();
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory() == 0);
+    }
+
+    SECTION("Share topologies") {
+        auto cache = FrameCache(1024 * 1024 * 1024);
+        cache.insert(0, make_frame(0, 1000));
+        auto first = cache.memory();
+
+        cache.insert(1, make_frame(1, 1000));
+        auto second = cache.memory() - first;
+        // the second frame only stores the positions
+        CHECK(second < first / 2);
+
+        auto different = make_frame(2, 1000);
+        different.add_bond(3, 4);
+        cache.insert(2, different);
+        CHECK(cache.memory() - first - second > second);
+
+        auto cached = Frame();
+        CHECK(cache.get(1, cached));
+        CHECK(cached.topology().bonds().empty());
+        CHECK(cache.get(2, cached));
+        CHECK(cached.topology().bonds().size() == 1);
+    }
+
+    SECTION("Least recently used eviction") {
+        auto single = FrameCache(1024 * 1024 * 1024);
+        single.insert(0, make_frame(0, 100));
+        auto memory = single.memory();
+
+        // space for a bit more than 3 frames sharing the same topology
+        auto cache = FrameCache(memory + 2 * 100 * sizeof(Vector3D) + 3 * 1024);
+        for (size_t step = 0; step < 3; step++) {
+            cache.insert(step, make_frame(step, 100));
+        }
+        CHECK(cache.size() == 3);
+
+        cache.touch(0);
+        cache.insert(3, make_frame(3, 100));
+        CHECK(cache.size() == 3);
+        CHECK(cache.contains(0));
+        CHECK_FALSE(cache.contains(1));
+        CHECK(cache.contains(2));
+        CHECK(cache.contains(3));
+
+        auto frame = Frame();
+        CHECK(cache.get(2, frame));
+        cache.insert(4, make_frame(4, 100));
+        CHECK_FALSE(cache.contains(0));
+        CHECK(cache.contains(2));
+
+        // re-inserting a frame does not use more memory
+        memory = cache.memory();
+        cache.insert(4, make_frame(4, 100));
+        CHECK(cache.memory() == memory);
+
+        cache.set_limit(0);
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory() == 0);
+    }
+}
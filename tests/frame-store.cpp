@@ -0,0 +1,153 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+#include <limits>
+
+#include <catch.hpp>
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+static Frame water_box(size_t nmolecules, uint64_t seed) {
+    auto frame = Frame(UnitCell({30, 30, 30}));
+    auto random = [&seed]() {
+        // simple linear congruential generator, giving values in [0, 1)
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+        return static_cast<double>(seed >> 11) / 9007199254740992.0;
+    };
+
+    for (size_t i = 0; i < nmolecules; i++) {
+        auto oxygen = Vector3D(30 * random(), 30 * random(), 30 * random());
+        frame.add_atom(Atom("O"), oxygen);
+        frame.add_atom(Atom("H"), oxygen + Vector3D(0.96, 0, 0));
+        frame.add_atom(Atom("H"), oxygen + Vector3D(-0.24, 0.93, 0));
+        frame.add_bond(3 * i, 3 * i + 1);
+        frame.add_bond(3 * i, 3 * i + 2);
+    }
+
+    return frame;
+}
+
+TEST_CASE("Frame store") {
+    SECTION("Errors") {
+        CHECK_THROWS_WITH(FrameStore(-1),
+            "invalid precision for FrameStore: expected a positive value, got -1"
+        );
+
+        auto store = FrameStore();
+        CHECK_THROWS_WITH(store.get(0),
+            "out of bounds index in FrameStore: we have 0 frames, but the index is 0"
+        );
+
+        auto frame = Frame();
+        frame.add_atom(Atom("X"), {1e300, 0, 0});
+        CHECK_THROWS_WITH(store.add(frame),
+            "can not store the value 1e+300 in a FrameStore with a precision of 0.001"
+        );
+        CHECK(store.empty());
+
+        frame.positions()[0] = {1, 2, 3};
+        store.add(frame);
+        auto positions = std::vector<Vector3D>(3);
+        CHECK_THROWS_WITH(store.positions(0, positions),
+            "the frame at index 0 in FrameStore contains 1 atoms, but the positions array has space for 3 atoms"
+        );
+    }
+
+    SECTION("Round trip") {
+        auto store = FrameStore(1e-3);
+        CHECK(store.precision() == 1e-3);
+
+        auto frame = water_box(300, 12);
+        frame.add_velocities();
+        for (size_t i = 0; i < frame.size(); i++) {
+            (*frame.velocities())[i] = Vector3D(0.01 * static_cast<double>(i), -3, 0.5);
+        }
+        frame.set("name", "water");
+        frame.set_step(42);
+        frame.positions()[7] = {-12.3456, -0.0004, 1234.5678};
+        store.add(frame);
+
+        frame.remove(0);
+        store.add(frame);
+        CHECK(store.size() == 2);
+
+        for (size_t index = 0; index < 2; index++) {
+            auto expected = index == 0 ? water_box(300, 12) : Frame();
+            auto decompressed = store.get(index);
+            CHECK(decompressed.step() == 42);
+            CHECK(decompressed.get("name")->as_string() == "water");
+            CHECK(decompressed.cell().lengths() == Vector3D(30, 30, 30));
+            CHECK(decompressed.size() == (index == 0 ? 900 : 899));
+            CHECK(decompressed.topology().bonds().size() == (index == 0 ? 600 : 598));
+
+            REQUIRE(decompressed.velocities());
+            auto velocities = *decompressed.velocities();
+            CHECK(std::abs(velocities[100][0] - (index == 0 ? 1.0 : 1.01)) <= 5e-4);
+            CHECK(std::abs(velocities[100][1] + 3) <= 5e-4);
+        }
+
+        auto decompressed = store.get(0);
+        auto original = water_box(300, 12);
+        original.positions()[7] = {-12.3456, -0.0004, 1234.5678};
+        for (size_t i = 0; i < original.size(); i++) {
+            for (size_t j = 0; j < 3; j++) {
+                CHECK(std::abs(decompressed.positions()[i][j] - original.positions()[i][j]) <= 5e-4 + 1e-12);
+            }
+        }
+
+        auto positions = std::vector<Vector3D>(899);
+        store.positions(1, positions);
+        CHECK(std::abs(positions[6][2] - 1234.5678) <= 5e-4 + 1e-12);
+
+        store.clear();
+        CHECK(store.empty());
+        CHECK(store.memory() == 0);
+    }
+
+    SECTION("Lossless storage") {
+        auto store = FrameStore(0);
+
+        auto frame = water_box(100, 5);
+        frame.positions()[0] = {-0.0, std::numeric_limits<double>::denorm_min(), -1e300};
+        frame.positions()[1] = {std::numeric_limits<double>::infinity(), 1e-300, -3.14159};
+        store.add(frame);
+
+        auto decompressed = store.get(0);
+        for (size_t i = 0; i < frame.size(); i++) {
+            CHECK(decompressed.positions()[i] == frame.positions()[i]);
+        }
+        CHECK(std::signbit(decompressed.positions()[0][0]));
+    }
+
+    SECTION("Compression and shared topology") {
+        auto store = FrameStore(1e-3);
+        auto frame = water_box(10000, 3);
+        store.add(frame);
+        auto first = store.memory();
+
+        for (size_t step = 1; step < 10; step++) {
+            for (auto& position: frame.positions()) {
+                position += Vector3D(0.1, -0.1, 0.05);
+            }
+            store.add(frame);
+        }
+        CHECK(&store.topology(0) == &store.topology(9));
+
+        // positions only use a fraction of the uncompressed size
+        auto per_frame = (store.memory() - first) / 9;
+        CHECK(per_frame < frame.size() * sizeof(Vector3D) / 3);
+
+        for (auto& position: frame.positions()) {
+            position += Vector3D(0.1, -0.1, 0.05);
+        }
+        auto decompressed = store.get(9);
+        CHECK(std::abs(decompressed.positions()[2000][1] - (frame.positions()[2000][1] + 0.1)) <= 5e-4 + 1e-9);
+
+        frame.add_bond(0, 4);
+        store.add(frame);
+        CHECK(&store.topology(9) != &store.topology(10));
+        CHECK(store.topology(10).bonds().size() == 20001);
+    }
+}
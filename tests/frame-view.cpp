@@ -0,0 +1,205 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include "catch.hpp"
+#include "chemfiles.hpp"
+#include "helpers.hpp"
+using namespace chemfiles;
+
+TEST_CASE("VectorsView") {
+    SECTION("From Vector3D") {
+        auto vectors = std::vector<Vector3D>{{1, 2, 3}, {4, 5, 6}};
+        auto view = VectorsView(vectors);
+        CHECK(view.size() == 2);
+        CHECK(view[0] == Vector3D(1, 2, 3));
+        CHECK(view[1] == Vector3D(4, 5, 6));
+        CHECK(view.contiguous() == &vectors[0][0]);
+
+        view = VectorsView();
+        CHECK(view.size() == 0);
+    }
+
+    SECTION("From double") {
+        auto data = std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8};
+        auto view = VectorsView(data.data(), 2);
+        CHECK(view[1] == Vector3D(4, 5, 6));
+        CHECK(view.contiguous() == data.data());
+
+        view = VectorsView(data.data(), 2, 4);
+        CHECK(view[1] == Vector3D(5, 6, 7));
+        CHECK(view.contiguous() == nullptr);
+
+        CHECK_THROWS_WITH(
+            VectorsView(data.data(), 2, 2),
+            "the stride of a VectorsView must be at least 3, got 2"
+        );
+    }
+
+    SECTION("From float") {
+        auto data = std::vector<float>{1, 2, 3, 4, 5, 6, 7, 8};
+        auto view = VectorsView(data.data(), 2);
+        CHECK(view[1] == Vector3D(4, 5, 6));
+        CHECK(view.contiguous() == nullptr);
+
+        view = VectorsView(data.data(), 2, 5);
+        CHECK(view[1] == Vector3D(6, 7, 8));
+
+        CHECK_THROWS_WITH(
+            VectorsView(data.data(), 2, 1),
+            "the stride of a VectorsView must be at least 3, got 1"
+        );
+    }
+}
+
+TEST_CASE("FrameView") {
+    SECTION("From frame") {
+        auto frame = Frame(UnitCell({10, 11, 12}));
+        frame.add_atom(Atom("O"), {1, 2, 3});
+        frame.add_atom(Atom("H"), {4, 5, 6});
+        frame.set_step(42);
+        frame.set("name", "water");
+
+        auto view = FrameView(frame);
+        CHECK(view.frame() == &frame);
+        CHECK(view.size() == 2);
+        CHECK(view.step() == 42);
+        CHECK(view[1].name() == "H");
+        CHECK(view.positions()[1] == Vector3D(4, 5, 6));
+        CHECK_FALSE(view.velocities());
+        CHECK(view.cell().lengths() == Vector3D(10, 11, 12));
+        CHECK(view.get<Property::STRING>("name").value() == "water");
+        CHECK_FALSE(view.get("foo"));
+
+        frame.add_velocities();
+        view = FrameView(frame);
+        REQUIRE(view.velocities());
+        CHECK(view.velocities()->size() == 2);
+
+        auto cell = UnitCell();
+        view.set_cell(cell);
+        CHECK(view.frame() == nullptr);
+        CHECK(view.cell().shape() == UnitCell::INFINITE);
+    }
+
+    SECTION("From arrays") {
+        auto topology = Topology();
+        topology.add_atom(Atom("C"));
+        topology.add_atom(Atom("N"));
+        auto cell = UnitCell({10, 10, 10});
+        auto positions = std::vector<float>{1, 2, 3, 4, 5, 6};
+        auto velocities = std::vector<double>{-1, -2, -3, -4, -5, -6};
+
+        auto view = FrameView(topology, VectorsView(positions.data(), 2), cell);
+        CHECK(view.frame() == nullptr);
+        CHECK(view.size() == 2);
+        CHECK(view.properties().size() == 0);
+        view.set_velocities(VectorsView(velocities.data(), 2));
+        view.set_step(3);
+
+        auto properties = property_map();
+        properties.set("time", 4.5);
+        view.set_properties(properties);
+
+        auto frame = view.to_frame();
+        CHECK(frame.size() == 2);
+        CHECK(frame.step() == 3);
+        CHECK(frame[0].name() == "C");
+        CHECK(frame.positions()[1] == Vector3D(4, 5, 6));
+        CHECK((*frame.velocities())[0] == Vector3D(-1, -2, -3));
+        CHECK(frame.cell().lengths() == Vector3D(10, 10, 10));
+        CHECK(frame.get("time")->as_double() == 4.5);
+    }
+
+    SECTION("Errors") {
+        auto topology = Topology();
+        topology.resize(3);
+        auto positions = std::vector<double>(6, 0.0);
+        auto cell = UnitCell();
+
+        CHECK_THROWS_WITH(
+            FrameView(topology, VectorsView(positions.data(), 2), cell),
+            "the topology contains 3 atoms, but the positions contain 2 atoms"
+        );
+
+        auto frame = Frame();
+        frame.resize(2);
+        auto view = FrameView(frame);
+        CHECK_THROWS_WITH(
+            view.set_topology(topology),
+            "the topology contains 3 atoms, but the frame view contains 2 atoms"
+        );
+        CHECK_THROWS_WITH(
+            view.set_velocities(VectorsView(positions.data(), 1)),
+            "the velocities contain 1 atoms, but the frame view contains 2 atoms"
+        );
+    }
+}
+
+TEST_CASE("Write frame views") {
+    auto topology = Topology();
+    topology.add_atom(Atom("O"));
+    topology.add_atom(Atom("H"));
+    topology.add_atom(Atom("H"));
+    auto cell = UnitCell({10, 10, 10});
+    auto positions = std::vector<float>{1, 2, 3, 0, 4, 5, 6, 0, 7, 8, 9, 0};
+
+    SECTION("Binary format") {
+        auto tmpfile = NamedTempPath(".trr");
+        {
+            auto trajectory = Trajectory(tmpfile, 'w');
+            for (size_t step = 0; step < 3; step++) {
+                auto view = FrameView(topology, VectorsView(positions.data(), 3, 4), cell);
+                view.set_step(step * 10);
+                trajectory.write(view);
+            }
+        }
+
+        auto trajectory = Trajectory(tmpfile);
+        CHECK(trajectory.nsteps() == 3);
+        auto frame = trajectory.read_step(2);
+        CHECK(frame.step() == 20);
+        CHECK(frame.size() == 3);
+        CHECK(approx_eq(frame.positions()[1], Vector3D(4, 5, 6), 1e-5));
+        CHECK(approx_eq(frame.cell().lengths(), Vector3D(10, 10, 10), 1e-5));
+    }
+
+    SECTION("Text format") {
+        auto tmpfile = NamedTempPath(".xyz");
+        {
+            auto trajectory = Trajectory(tmpfile, 'w');
+            auto view = FrameView(topology, VectorsView(positions.data(), 3, 4), cell);
+            trajectory.write(view);
+        }
+
+        auto trajectory = Trajectory(tmpfile);
+        auto frame = trajectory.read();
+        CHECK(frame.size() == 3);
+        CHECK(frame[1].name() == "H");
+        CHECK(frame.positions()[2] == Vector3D(7, 8, 9));
+    }
+
+    SECTION("Custom topology and cell") {
+        auto tmpfile = NamedTempPath(".xyz");
+        {
+            auto trajectory = Trajectory(tmpfile, 'w');
+            auto custom = Topology();
+            custom.add_atom(Atom("Zn"));
+            custom.add_atom(Atom("Zn"));
+            custom.add_atom(Atom("Zn"));
+            trajectory.set_topology(custom);
+
+            auto frame = Frame();
+            frame.add_atom(Atom("O"), {1, 2, 3});
+            frame.add_atom(Atom("H"), {1, 2, 3});
+            frame.add_atom(Atom("H"), {1, 2, 3});
+            trajectory.write(frame);
+            // the frame is not modified
+            CHECK(frame[0].name() == "O");
+        }
+
+        auto trajectory = Trajectory(tmpfile);
+        auto frame = trajectory.read();
+        CHECK(frame[0].name() == "Zn");
+        CHECK(frame[2].name() == "Zn");
+    }
+}
@@ -0,0 +1,197 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <string>
+#include <fstream>
+
+#include "catch.hpp"
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+#include "chemfiles/sniff_format.hpp"
+using namespace chemfiles;
+
+static const char* PDB_CONTENT = R"(CRYST1   10.000   10.000   10.000  90.00  90.00  90.00 P 1           1
+HETATM    1  N1  LIG A   1       0.000   0.000   0.000  1.00  0.00           N
+HETATM    2  C1  LIG A   1       1.500   0.000   0.000  1.00  0.00           C
+END
+)";
+
+static const char* CIF_CONTENT = R"(data_test
+_cell_length_a 10
+_cell_length_b 10
+_cell_length_c 10
+_cell_angle_alpha 90
+_cell_angle_beta 90
+_cell_angle_gamma 90
+loop_
+_atom_site_label
+_atom_site_type_symbol
+_atom_site_fract_x
+_atom_site_fract_y
+_atom_site_fract_z
+C1 C 0.1 0.2 0.3
+O1 O 0.4 0.5 0.6
+N1 N 0.7 0.8 0.9
+)";
+
+static const char* MMCIF_CONTENT = R"(data_test
+loop_
+_atom_site.group_PDB
+_atom_site.id
+_atom_site.type_symbol
+_atom_site.label_atom_id
+_atom_site.label_comp_id
+_atom_site.label_asym_id
+_atom_site.label_seq_id
+_atom_site.Cartn_x
+_atom_site.Cartn_y
+_atom_site.Cartn_z
+ATOM 1 N N ALA A 1 0.0 0.0 0.0
+ATOM 2 C CA ALA A 1 1.5 0.0 0.0
+)";
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+TEST_CASE("Guess format") {
+    SECTION("From the extension") {
+        auto format = chemfiles::guess_format("filename.nc");
+        CHECK(format == "Amber NetCDF");
+
+        format = chemfiles::guess_format("filename.xyz.gz");
+        CHECK(format == "XYZ / GZ");
+
+        // the file is not read when the extension is enough
+        auto sniffed = sniff_format("filename.pdb", File::READ);
+        CHECK(sniffed.format == "PDB");
+        CHECK(sniffed.compression == File::DEFAULT);
+        CHECK_FALSE(sniffed.file);
+    }
+
+    SECTION("From the content") {
+        auto path = NamedTempPath("");
+        write_file(path, PDB_CONTENT);
+        CHECK(chemfiles::guess_format(path) == "PDB");
+
+        auto sniffed = sniff_format(path, File::READ);
+        CHECK(sniffed.format == "PDB");
+        REQUIRE(sniffed.file);
+        CHECK(sniffed.file->tellpos() == 0);
+
+        auto frame = Trajectory(path).read();
+        CHECK(frame.size() == 2);
+        CHECK(frame[1].name() == "C1");
+
+        // unknown extensions also use the file content
+        auto unknown = NamedTempPath(".dat");
+        write_file(unknown, "3\ncomment\nO 0 0 0\nH 1 0 0\nH 0 1 0\n");
+        CHECK(chemfiles::guess_format(unknown) == "XYZ");
+        CHECK(Trajectory(unknown).read().size() == 3);
+
+        // files opened in write mode are never read
+        CHECK_THROWS(chemfiles::guess_format(path, 'w'));
+    }
+
+    SECTION("Compressed files") {
+        auto path = NamedTempPath("");
+        {
+            auto file = TextFile(path, File::WRITE, File::GZIP);
+            file.print("{}", PDB_CONTENT);
+        }
+        CHECK(chemfiles::guess_format(path) == "PDB / GZ");
+        CHECK(Trajectory(path).read().size() == 2);
+
+        auto gz = NamedTempPath(".gz");
+        {
+            auto file = TextFile(gz, File::WRITE, File::GZIP);
+            file.print("{}", PDB_CONTENT);
+        }
+        CHECK(chemfiles::guess_format(gz) == "PDB / GZ");
+    }
+
+    SECTION("CIF and mmCIF") {
+        auto cif = NamedTempPath(".cif");
+        write_file(cif, CIF_CONTENT);
+        CHECK(chemfiles::guess_format(cif) == "CIF");
+        CHECK(Trajectory(cif).read().size() == 3);
+
+        auto mmcif = NamedTempPath(".cif");
+        write_file(mmcif, MMCIF_CONTENT);
+        CHECK(chemfiles::guess_format(mmcif) == "mmCIF");
+        CHECK(Trajectory(mmcif).read().size() == 2);
+
+        auto no_extension = NamedTempPath("");
+        write_file(no_extension, CIF_CONTENT);
+        CHECK(chemfiles::guess_format(no_extension) == "CIF");
+
+        // only a bounded prefix of the file is read
+        auto content = std::string("data_test\n");
+        while (content.size() < SNIFF_WINDOW_SIZE) {
+            content += "# a comment line\n";
+        }
+        content += "_cell.length_a 10\n";
+        write_file(mmcif, content);
+        CHECK(chemfiles::guess_format(mmcif) == "CIF");
+    }
+
+    SECTION("Binary files") {
+        auto path = NamedTempPath("");
+        write_file(path, std::string("\x00\x00\x07\xcb\x00\x00\x00\x03", 8));
+        CHECK(chemfiles::guess_format(path) == "XTC");
+
+        write_file(path, std::string("\x00\x00\x07\xc9\x00\x00\x00\x0d", 8));
+        CHECK(chemfiles::guess_format(path) == "TRR");
+
+        write_file(path, std::string("CDF\x01\x00\x00\x00\x00", 8));
+        CHECK(chemfiles::guess_format(path) == "Amber NetCDF");
+
+        write_file(path, std::string("\x54\x00\x00\x00" "CORD\x00\x00\x00\x00", 12));
+        CHECK(chemfiles::guess_format(path) == "DCD");
+
+        write_file(path, std::string("\x83\xa7version\xa5" "0.3.0\xaa" "dataBlocks\x91\xc4\x01\x00", 30));
+        CHECK(chemfiles::guess_format(path) == "BinaryCIF");
+    }
+
+    SECTION("Errors") {
+        CHECK_THROWS_WITH(
+            chemfiles::guess_format("filename.not-there"),
+            "can not find a format associated with the '.not-there' extension"
+        );
+
+        CHECK_THROWS_WITH(
+            chemfiles::guess_format("not-there"),
+            "file at 'not-there' does not have an extension, provide a format name to read it"
+        );
+
+        auto path = NamedTempPath("");
+        write_file(path, "this is not\na chemistry file\n");
+        CHECK_THROWS(chemfiles::guess_format(path));
+
+        auto unknown = NamedTempPath(".not-there");
+        write_file(unknown, "this is not\na chemistry file\n");
+        CHECK_THROWS_WITH(
+            chemfiles::guess_format(unknown),
+            "can not find a format associated with the '.not-there' extension"
+        );
+    }
+}
+
+TEST_CASE("Sniff text formats") {
+    CHECK(sniff_text_format("PSF EXT\n\n       1 !NTITLE\n").value() == "PSF");
+    CHECK(sniff_text_format("ITEM: TIMESTEP\n0\n").value() == "LAMMPS");
+    CHECK(sniff_text_format("# comment\n@<TRIPOS>MOLECULE\n").value() == "MOL2");
+    CHECK(sniff_text_format("<?xml version=\"1.0\"?>\n<cml>\n").value() == "CML");
+    CHECK(sniff_text_format("name\n  program\n\n  2  1  0  0  0  0  0  0  0  0999 V2000\n").value() == "SDF");
+    CHECK(sniff_text_format("HEADER    PROTEIN\n").value() == "PDB");
+    CHECK(sniff_text_format("LAMMPS data\n\n3 atoms\n1 atom types\n").value() == "LAMMPS Data");
+    CHECK(sniff_text_format("2 water\n 1 O 0.0 0.0 0.0 1 2\n 2 H 1.0 0.0 0.0 5 1\n").value() == "Tinker");
+    CHECK(sniff_text_format("1\n\nHe 0.0 0.0 0.0\n").value() == "XYZ");
+    CHECK(sniff_text_format(
+        "title\n    1\n    1ALA      N    1   0.000   0.000   0.000\n   1.0 1.0 1.0\n"
+    ).value() == "GRO");
+
+    CHECK_FALSE(sniff_text_format(""));
+    CHECK_FALSE(sniff_text_format("hello\nworld\n"));
+}
@@ -48,6 +48,10 @@ WHITELIST = [
     "chemfiles/types.hpp",
     "chemfiles/Atom.hpp",
     "chemfiles/Frame.hpp",
+    "chemfiles/FrameView.hpp",
+    "chemfiles/FrameStore.hpp",
+    "chemfiles/Transformations.hpp",
+    "chemfiles/Superposition.hpp",
     "chemfiles/Error.hpp",
     "chemfiles/Residue.hpp",
     "chemfiles/Property.hpp",
@@ -0,0 +1,152 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+
+#include <catch.hpp>
+#include "chemfiles/offset_index.hpp"
+using namespace chemfiles;
+
+static void check_index(const std::vector<uint64_t>& values) {
+    auto index = OffsetIndex();
+    for (auto value: values) {
+        index.push_back(value);
+    }
+
+    REQUIRE(index.size() == values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        CHECK(index[i] == values[i]);
+    }
+    CHECK(index.back() == values.back());
+
+    // remove values through multiple blocks
+    auto remaining = values.size() / 3;
+    while (index.size() > remaining) {
+        index.pop_back();
+    }
+    CHECK(index.back() == values[remaining - 1]);
+    for (size_t i = remaining; i < values.size(); i++) {
+        index.push_back(values[i]);
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        CHECK(index[i] == values[i]);
+    }
+}
+
+TEST_CASE("Offset index") {
+    SECTION("Basic usage") {
+        auto index = OffsetIndex();
+        CHECK(index.empty());
+        CHECK(index.size() == 0);
+
+        index.push_back(10);
+        index.push_back(25);
+        CHECK_FALSE(index.empty());
+        CHECK(index.size() == 2);
+        CHECK(index[0] == 10);
+        CHECK(index.back() == 25);
+
+        index.pop_back();
+        CHECK(index.size() == 1);
+        CHECK(index.back() == 10);
+
+        index.clear();
+        CHECK(index.empty());
+    }
+
+    SECTION("Constant step size") {
+        auto values = std::vector<uint64_t>();
+        for (uint64_t i = 0; i < 10000; i++) {
+            values.push_back(123 + 4567 * i);
+        }
+        check_index(values);
+
+        auto index = OffsetIndex();
+        for (auto value: values) {
+            index.push_back(value);
+        }
+        // less than one byte per value
+        CHECK(index.memory() < values.size());
+    }
+
+    SECTION("Extend with constant step size") {
+        auto values = std::vector<uint64_t>();
+        for (uint64_t i = 0; i < 1000; i++) {
+            values.push_back(42 + 321 * i);
+        }
+
+        // start from a partially filled block
+        auto index = OffsetIndex();
+        for (size_t i = 0; i < 10; i++) {
+            index.push_back(values[i]);
+        }
+        index.extend(values[10], 321, values.size() - 10);
+
+        REQUIRE(index.size() == values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            CHECK(index[i] == values[i]);
+        }
+        CHECK(index.memory() < values.size());
+
+        index.pop_back();
+        index.push_back(3);
+        CHECK(index.back() == 3);
+        CHECK(index[998] == values[998]);
+
+        index.clear();
+        index.extend(7, 3, 2);
+        CHECK(index.size() == 2);
+        CHECK(index.back() == 10);
+    }
+
+    SECTION("Varying step size") {
+        auto values = std::vector<uint64_t>();
+        uint64_t position = 0;
+        uint64_t state = 42;
+        for (size_t i = 0; i < 10000; i++) {
+            values.push_back(position);
+            // simple linear congruential generator
+            state = state * 6364136223846793005 + 1442695040888963407;
+            position += 10000 + (state >> 54);
+        }
+        check_index(values);
+
+        auto index = OffsetIndex();
+        for (auto value: values) {
+            index.push_back(value);
+        }
+        // at most half the memory of a std::vector<uint64_t>
+        CHECK(index.memory() < 4 * values.size());
+    }
+
+    SECTION("Extreme values") {
+        auto max = std::numeric_limits<uint64_t>::max();
+        auto values = std::vector<uint64_t>();
+        for (size_t i = 0; i < 200; i++) {
+            switch (i % 4) {
+            case 0:
+                values.push_back(0);
+                break;
+            case 1:
+                values.push_back(max);
+                break;
+            case 2:
+                values.push_back(max / 2 + i);
+                break;
+            default:
+                values.push_back(i);
+                break;
+            }
+        }
+        check_index(values);
+
+        // decreasing values
+        values.clear();
+        for (size_t i = 0; i < 200; i++) {
+            values.push_back(max - 1000 * i);
+        }
+        check_index(values);
+    }
+}
@@ -0,0 +1,178 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include <catch.hpp>
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+#include "chemfiles/snapshot.hpp"
+using namespace chemfiles;
+
+static Frame test_frame() {
+    auto frame = Frame(UnitCell({10, 11, 12}, {90, 80, 120}));
+    frame.set_step(42);
+    frame.add_velocities();
+
+    auto atom = Atom("OW", "O");
+    atom.set_charge(-0.8);
+    atom.set("vector", Vector3D(1, 2, 3));
+    frame.add_atom(atom, {1, 2, 3}, {-1, -2, -3});
+    frame.add_atom(Atom("HW1", "H"), {4, 5, 6}, {0.5, 0.5, 0.5});
+    frame.add_atom(Atom("HW2", "H"), {7, 8, 9});
+    frame.add_atom(Atom("a-very-long-atom-name-which-is-not-in-sso", "Zn"), {10, 11, 12});
+    frame[3].set_mass(65.5);
+
+    frame.add_bond(0, 1, Bond::SINGLE);
+    frame.add_bond(0, 2, Bond::AROMATIC);
+
+    auto water = Residue("WAT", 3);
+    water.add_atom(0);
+    water.add_atom(1);
+    water.add_atom(2);
+    water.set("is water", true);
+    frame.add_residue(water);
+    frame.add_residue(Residue("ZN"));
+
+    frame.set("name", "test frame");
+    frame.set("temperature", 300.0);
+    return frame;
+}
+
+static void check_topology(const Topology& topology) {
+    REQUIRE(topology.size() == 4);
+    CHECK(topology[0].name() == "OW");
+    CHECK(topology[0].type() == "O");
+    CHECK(topology[0].charge() == -0.8);
+    CHECK(topology[0].mass() == Atom("O").mass());
+    CHECK(topology[0].get<Property::VECTOR3D>("vector").value() == Vector3D(1, 2, 3));
+    CHECK(topology[2].name() == "HW2");
+    CHECK_FALSE(topology[2].properties());
+    CHECK(topology[3].name() == "a-very-long-atom-name-which-is-not-in-sso");
+    CHECK(topology[3].mass() == 65.5);
+
+    auto bonds = std::vector<Bond>{{0, 1}, {0, 2}};
+    CHECK(topology.bonds() == bonds);
+    CHECK(topology.bond_order(0, 1) == Bond::SINGLE);
+    CHECK(topology.bond_order(0, 2) == Bond::AROMATIC);
+
+    REQUIRE(topology.residues().size() == 2);
+    const auto& water = topology.residues()[0];
+    CHECK(water.name() == "WAT");
+    CHECK(water.id().value() == 3);
+    CHECK(water.size() == 3);
+    CHECK(water.get<Property::BOOL>("is water").value());
+    CHECK(topology.residue_for_atom(2)->name() == "WAT");
+    CHECK(topology.residues()[1].name() == "ZN");
+    CHECK_FALSE(topology.residues()[1].id());
+}
+
+TEST_CASE("Frame snapshots") {
+    auto frame = test_frame();
+    auto snapshot = frame.serialize();
+    CHECK(std::memcmp(snapshot.data(), "CHFL-SNP", 8) == 0);
+    CHECK(snapshot_size(snapshot.data(), snapshot.size()) == snapshot.size());
+
+    auto copy = Frame::deserialize(snapshot.data(), snapshot.size());
+    check_topology(copy.topology());
+
+    CHECK(copy.step() == 42);
+    CHECK(copy.cell().shape() == UnitCell::TRICLINIC);
+    CHECK(copy.cell().matrix() == frame.cell().matrix());
+    CHECK(copy.positions() == frame.positions());
+    REQUIRE(copy.velocities());
+    CHECK(*copy.velocities() == *frame.velocities());
+    CHECK(copy.get<Property::STRING>("name").value() == "test frame");
+    CHECK(copy.get<Property::DOUBLE>("temperature").value() == 300.0);
+
+    // serializing again gives the same data
+    CHECK(copy.serialize() == snapshot);
+
+    CHECK_THROWS_WITH(
+        Topology::deserialize(snapshot.data(), snapshot.size()),
+        "invalid snapshot: expected a topology, got a frame"
+    );
+
+    // empty frames
+    auto empty = Frame();
+    snapshot = empty.serialize();
+    copy = Frame::deserialize(snapshot.data(), snapshot.size());
+    CHECK(copy.size() == 0);
+    CHECK(copy.cell().shape() == UnitCell::INFINITE);
+    CHECK_FALSE(copy.velocities());
+}
+
+TEST_CASE("Topology snapshots") {
+    auto frame = test_frame();
+    auto snapshot = frame.topology().serialize();
+    auto topology = Topology::deserialize(snapshot.data(), snapshot.size());
+    check_topology(topology);
+
+    CHECK_THROWS_WITH(
+        Frame::deserialize(snapshot.data(), snapshot.size()),
+        "invalid snapshot: expected a frame, got a topology"
+    );
+}
+
+TEST_CASE("Invalid snapshots") {
+    auto snapshot = test_frame().serialize();
+
+    CHECK_THROWS_WITH(
+        Frame::deserialize(snapshot.data(), 16),
+        "invalid snapshot: missing CHFL-SNP header"
+    );
+
+    CHECK_THROWS_WITH(
+        Frame::deserialize(snapshot.data(), snapshot.size() - 1),
+        "invalid snapshot: expected " + std::to_string(snapshot.size()) +
+        " bytes of data, got " + std::to_string(snapshot.size() - 1)
+    );
+
+    auto copy = snapshot;
+    copy[8] = 42;
+    CHECK_THROWS_WITH(
+        Frame::deserialize(copy.data(), copy.size()),
+        "unsupported snapshot version 42, expected 1"
+    );
+
+    auto bonded = Frame();
+    bonded.add_atom(Atom("A"), {0, 0, 0});
+    bonded.add_atom(Atom("B"), {0, 0, 0});
+    bonded.add_bond(0, 1, Bond::DATIVE_R);
+    copy = bonded.serialize();
+    auto order = std::find(copy.begin(), copy.end(), static_cast<char>(Bond::DATIVE_R));
+    REQUIRE(order != copy.end());
+    CHECK(std::find(order + 1, copy.end(), static_cast<char>(Bond::DATIVE_R)) == copy.end());
+    *order = 42;
+    CHECK_THROWS_WITH(
+        Frame::deserialize(copy.data(), copy.size()),
+        "invalid snapshot: unknown bond order 42"
+    );
+
+    // the number of atoms is checked before allocating the atoms
+    copy = snapshot;
+    uint64_t natoms = UINT64_C(1) << 60;
+    std::memcpy(copy.data() + 24, &natoms, sizeof(natoms));
+    CHECK_THROWS_WITH(
+        Frame::deserialize(copy.data(), copy.size()),
+        "invalid snapshot: unexpected end of data"
+    );
+    auto topology_snapshot = test_frame().topology().serialize();
+    std::memcpy(topology_snapshot.data() + 24, &natoms, sizeof(natoms));
+    CHECK_THROWS_WITH(
+        Topology::deserialize(topology_snapshot.data(), topology_snapshot.size()),
+        "invalid snapshot: unexpected end of data"
+    );
+
+    // every truncated snapshot is invalid, and should give an error instead
+    // of reading out of bounds
+    for (size_t size = 32; size < snapshot.size(); size++) {
+        copy = std::vector<char>(snapshot.begin(), snapshot.begin() + static_cast<std::ptrdiff_t>(size));
+        // update the size in the header
+        uint64_t size_64 = size;
+        std::memcpy(copy.data() + 16, &size_64, sizeof(size_64));
+        CHECK_THROWS(Frame::deserialize(copy.data(), copy.size()));
+    }
+}
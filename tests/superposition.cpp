@@ -0,0 +1,194 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <cmath>
+
+#include <catch.hpp>
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+static Frame reference_frame() {
+    auto frame = Frame();
+    frame.add_atom(Atom("C"), {0.0, 0.0, 0.0});
+    frame.add_atom(Atom("C"), {1.5, 0.0, 0.0});
+    frame.add_atom(Atom("C"), {1.5, 1.2, 0.3});
+    frame.add_atom(Atom("O"), {0.2, 1.9, -0.7});
+    frame.add_atom(Atom("N"), {-1.1, 0.4, 1.3});
+    frame.add_atom(Atom("H"), {2.3, -0.8, 0.5});
+    return frame;
+}
+
+static Matrix3D rotation(double angle) {
+    // rotation around the (1, 1, 1) axis
+    auto c = std::cos(angle);
+    auto s = std::sin(angle);
+    auto t = 1 - c;
+    auto x = 1 / std::sqrt(3.0);
+    return Matrix3D(
+        t * x * x + c, t * x * x - s * x, t * x * x + s * x,
+        t * x * x + s * x, t * x * x + c, t * x * x - s * x,
+        t * x * x - s * x, t * x * x + s * x, t * x * x + c
+    );
+}
+
+/// Create a copy of `reference`, rotated by `matrix` and translated by
+/// `translation`
+static Frame moved_frame(const Frame& reference, const Matrix3D& matrix, Vector3D translation) {
+    auto frame = Frame();
+    frame.add_velocities();
+    for (auto& position: reference.positions()) {
+        frame.add_atom(Atom("X"), matrix * position + translation, matrix * Vector3D(1, 0, 0));
+    }
+    return frame;
+}
+
+TEST_CASE("Superposition") {
+    SECTION("Errors") {
+        auto reference = reference_frame();
+        auto frame = Frame();
+        frame.resize(3);
+        CHECK_THROWS_WITH(Superposition(reference, frame),
+            "can not superpose positions with different sizes: the reference contains 6 atoms, but the mobile positions contain 3 atoms"
+        );
+
+        CHECK_THROWS_WITH(Superposition(reference, reference, {0, 8}),
+            "out of bounds atomic index in superposition: we have 6 atoms, but the index is 8"
+        );
+
+        CHECK_THROWS_WITH(Superposition(Frame(), Frame()),
+            "can not superpose an empty set of atoms"
+        );
+    }
+
+    SECTION("Identity") {
+        auto superposition = Superposition();
+        CHECK(superposition.rmsd() == 0);
+        CHECK(superposition.rotation() == Matrix3D::unit());
+        CHECK(superposition.apply(Vector3D(1, 2, 3)) == Vector3D(1, 2, 3));
+
+        auto reference = reference_frame();
+        superposition = Superposition(reference, reference);
+        CHECK(superposition.rmsd() < 1e-6);
+        CHECK(approx_eq(superposition.rotation(), Matrix3D::unit(), 1e-6));
+    }
+
+    SECTION("Rotation and translation") {
+        auto reference = reference_frame();
+        auto matrix = rotation(0.7);
+        auto frame = moved_frame(reference, matrix, {3, -2, 10});
+
+        auto superposition = Superposition(reference, frame);
+        CHECK(superposition.rmsd() < 1e-6);
+        // the superposition undoes the rotation
+        CHECK(approx_eq(superposition.rotation(), matrix.transpose(), 1e-6));
+
+        superposition.apply(frame);
+        for (size_t i = 0; i < frame.size(); i++) {
+            CHECK(approx_eq(frame.positions()[i], reference.positions()[i], 1e-6));
+            CHECK(approx_eq((*frame.velocities())[i], Vector3D(1, 0, 0), 1e-6));
+        }
+
+        // large rotations
+        for (auto angle: {2.0, 3.1, 3.14159265358979, -2.5}) {
+            matrix = rotation(angle);
+            frame = moved_frame(reference, matrix, {0, 0, 0});
+            superposition = Superposition(reference, frame);
+            CHECK(superposition.rmsd() < 1e-6);
+            CHECK(approx_eq(superposition.rotation(), matrix.transpose(), 1e-6));
+        }
+    }
+
+    SECTION("RMSD") {
+        auto reference = reference_frame();
+        auto frame = moved_frame(reference, rotation(1.2), {1, 2, 3});
+        // displace one atom after the rotation
+        frame.positions()[2] += Vector3D(0.5, 0, 0);
+
+        auto superposition = Superposition(reference, frame);
+        CHECK(superposition.rmsd() > 0.1);
+
+        // the RMSD is the one of the superposed positions
+        superposition.apply(frame);
+        double sum = 0;
+        for (size_t i = 0; i < frame.size(); i++) {
+            auto delta = frame.positions()[i] - reference.positions()[i];
+            sum += dot(delta, delta);
+        }
+        CHECK(superposition.rmsd() == Approx(std::sqrt(sum / 6.0)).margin(1e-6));
+
+        // the superposition is optimal: a second superposition does nothing
+        auto second = Superposition(reference, frame);
+        CHECK(second.rmsd() == Approx(superposition.rmsd()).margin(1e-6));
+        CHECK(approx_eq(second.rotation(), Matrix3D::unit(), 1e-6));
+    }
+
+    SECTION("Subset of atoms") {
+        auto reference = reference_frame();
+        auto matrix = rotation(0.4);
+        auto frame = moved_frame(reference, matrix, {1, 1, 1});
+        // move atoms not used in the superposition
+        frame.positions()[4] += Vector3D(4, 0, 0);
+        frame.positions()[5] += Vector3D(0, -3, 0);
+
+        auto superposition = Superposition(reference, frame, {0, 1, 2, 3});
+        CHECK(superposition.rmsd() < 1e-6);
+        CHECK(approx_eq(superposition.rotation(), matrix.transpose(), 1e-6));
+
+        auto full = Superposition(reference, frame);
+        CHECK(full.rmsd() > 1);
+    }
+
+    SECTION("Spans") {
+        auto reference = std::vector<Vector3D>{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+        auto mobile = std::vector<Vector3D>{{2, 2, 2}, {2, 3, 2}, {1, 2, 2}};
+
+        auto superposition = Superposition(reference, mobile);
+        CHECK(superposition.rmsd() < 1e-6);
+        CHECK(approx_eq(superposition.mobile_center(), Vector3D(5.0 / 3.0, 7.0 / 3.0, 2), 1e-12));
+        CHECK(approx_eq(superposition.reference_center(), Vector3D(1.0 / 3.0, 1.0 / 3.0, 0), 1e-12));
+        for (size_t i = 0; i < 3; i++) {
+            CHECK(approx_eq(superposition.apply(mobile[i]), reference[i], 1e-6));
+        }
+    }
+}
+
+TEST_CASE("Batched superposition") {
+    auto reference = reference_frame();
+    auto frames = std::vector<Frame>();
+    for (size_t i = 0; i < 20; i++) {
+        auto translation = Vector3D(static_cast<double>(i), 1, -2);
+        frames.emplace_back(moved_frame(reference, rotation(0.3 * static_cast<double>(i)), translation));
+    }
+
+    SECTION("Superpose") {
+        auto superpositions = superpose(reference, frames);
+        REQUIRE(superpositions.size() == 20);
+        for (size_t i = 0; i < 20; i++) {
+            CHECK(superpositions[i].rmsd() < 1e-6);
+            auto matrix = rotation(0.3 * static_cast<double>(i));
+            CHECK(approx_eq(superpositions[i].rotation(), matrix.transpose(), 1e-6));
+        }
+    }
+
+    SECTION("Align") {
+        auto rmsds = align(reference, frames, {0, 1, 2, 3, 4, 5});
+        REQUIRE(rmsds.size() == 20);
+        for (size_t i = 0; i < 20; i++) {
+            CHECK(rmsds[i] < 1e-6);
+            for (size_t j = 0; j < reference.size(); j++) {
+                CHECK(approx_eq(frames[i].positions()[j], reference.positions()[j], 1e-6));
+            }
+        }
+    }
+
+    SECTION("Errors") {
+        frames[12].resize(2);
+        CHECK_THROWS_WITH(superpose(reference, frames),
+            "can not superpose positions with different sizes: the reference contains 6 atoms, but the mobile positions contain 2 atoms"
+        );
+        CHECK_THROWS_WITH(align(reference, frames),
+            "can not superpose positions with different sizes: the reference contains 6 atoms, but the mobile positions contain 2 atoms"
+        );
+    }
+}
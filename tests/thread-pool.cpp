@@ -0,0 +1,138 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+
+#include <catch.hpp>
+#include "chemfiles/misc.hpp"
+#include "chemfiles/thread_pool.hpp"
+using namespace chemfiles;
+
+TEST_CASE("Thread pool") {
+    SECTION("Number of threads") {
+        set_num_threads(3);
+        CHECK(num_threads() == 3);
+        CHECK(ThreadPool::get().concurrency() == 3);
+
+        set_num_threads(1);
+        CHECK(num_threads() == 1);
+
+        set_num_threads(0);
+        CHECK(num_threads() >= 1);
+    }
+
+    SECTION("Parallel for") {
+        for (size_t threads: {1, 2, 4}) {
+            set_num_threads(threads);
+
+            auto values = std::vector<size_t>(10000, 0);
+            parallel_for(0, values.size(), 100, [&](size_t start, size_t stop) {
+                for (size_t i = start; i < stop; i++) {
+                    values[i] += i;
+                }
+            });
+
+            for (size_t i = 0; i < values.size(); i++) {
+                CHECK(values[i] == i);
+            }
+        }
+
+        // empty range
+        parallel_for(10, 10, 1, [](size_t, size_t) {
+            FAIL("function should not be called");
+        });
+    }
+
+    SECTION("Nested parallelism") {
+        set_num_threads(4);
+
+        std::atomic<size_t> count(0);
+        parallel_for(0, 16, 1, [&](size_t start, size_t stop) {
+            for (size_t i = start; i < stop; i++) {
+                parallel_for(0, 100, 10, [&](size_t inner_start, size_t inner_stop) {
+                    count += inner_stop - inner_start;
+                });
+            }
+        });
+        CHECK(count == 1600);
+    }
+
+    SECTION("Nested tasks without parallelism") {
+        set_num_threads(1);
+
+        std::atomic<size_t> count(0);
+        TaskGroup group;
+        group.run([&]() {
+            TaskGroup inner;
+            inner.run([&]() { count++; });
+            inner.wait();
+            count++;
+        });
+        group.wait();
+        CHECK(count == 2);
+
+        set_num_threads(0);
+    }
+
+    SECTION("Waiting for running tasks") {
+        set_num_threads(4);
+
+        std::atomic<size_t> count(0);
+        TaskGroup group;
+        for (size_t i = 0; i < 3; i++) {
+            group.run([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                count++;
+            });
+        }
+        group.wait();
+        CHECK(count == 3);
+    }
+
+    SECTION("Errors") {
+        set_num_threads(4);
+
+        TaskGroup group;
+        for (size_t i = 0; i < 10; i++) {
+            group.run([i]() {
+                if (i == 5) {
+                    throw std::runtime_error("error in task");
+                }
+            });
+        }
+        CHECK_THROWS_WITH(group.wait(), "error in task");
+
+        // the group can be used again after an error
+        std::atomic<size_t> count(0);
+        group.run([&]() { count++; });
+        group.wait();
+        CHECK(count == 1);
+    }
+
+    SECTION("External executor") {
+        std::atomic<size_t> executed(0);
+        set_executor([&](std::function<void()> task) {
+            executed++;
+            std::thread(std::move(task)).detach();
+        }, 2);
+        CHECK(num_threads() == 2);
+
+        auto values = std::vector<size_t>(1000, 0);
+        parallel_for(0, values.size(), 10, [&](size_t start, size_t stop) {
+            for (size_t i = start; i < stop; i++) {
+                values[i] = 2 * i;
+            }
+        });
+        CHECK(executed != 0);
+        for (size_t i = 0; i < values.size(); i++) {
+            CHECK(values[i] == 2 * i);
+        }
+
+        set_num_threads(0);
+    }
+}
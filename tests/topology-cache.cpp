@@ -0,0 +1,106 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <string>
+#include <fstream>
+
+#include <catch.hpp>
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+#include "chemfiles/topology_cache.hpp"
+using namespace chemfiles;
+
+static void write_xyz(const std::string& path, const std::string& element, size_t natoms) {
+    auto frame = Frame();
+    for (size_t i = 0; i < natoms; i++) {
+        frame.add_atom(Atom(element), {0, 0, 0});
+    }
+    auto file = Trajectory(path, 'w');
+    file.write(frame);
+}
+
+TEST_CASE("Topology cache") {
+    auto& cache = TopologyCache::get();
+    cache.clear();
+    cache.set_limit(TopologyCache::DEFAULT_LIMIT);
+
+    auto topology_path = NamedTempPath(".xyz");
+    write_xyz(topology_path, "Zn", 3);
+
+    auto trajectory_path = NamedTempPath(".xyz");
+    write_xyz(trajectory_path, "H", 3);
+
+    SECTION("Re-use topologies") {
+        auto first = cache.read(topology_path, "");
+        CHECK(cache.size() == 1);
+        CHECK(cache.memory() > 0);
+        CHECK((*first)[0].name() == "Zn");
+
+        auto second = cache.read(topology_path, "");
+        CHECK(cache.size() == 1);
+        CHECK(first == second);
+
+        // different format string use a different entry
+        auto third = cache.read(topology_path, "XYZ");
+        CHECK(cache.size() == 2);
+        CHECK(first != third);
+
+        // through Trajectory
+        auto trajectory = Trajectory(trajectory_path);
+        trajectory.set_topology(topology_path);
+        CHECK(cache.size() == 2);
+        auto frame = trajectory.read();
+        CHECK(frame[0].name() == "Zn");
+    }
+
+    SECTION("Modified files") {
+        auto first = cache.read(topology_path, "");
+        CHECK(cache.size() == 1);
+
+        write_xyz(topology_path, "Cu", 4);
+        auto second = cache.read(topology_path, "");
+        CHECK(first != second);
+        CHECK(second->size() == 4);
+        CHECK((*second)[0].name() == "Cu");
+    }
+
+    SECTION("Invalidation") {
+        cache.read(topology_path, "");
+        cache.read(trajectory_path, "");
+        CHECK(cache.size() == 2);
+
+        clear_topology_cache(topology_path);
+        CHECK(cache.size() == 1);
+
+        clear_topology_cache();
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory() == 0);
+    }
+
+    SECTION("Memory limit") {
+        auto first = cache.read(topology_path, "");
+        auto memory = cache.memory();
+
+        // only room for one topology
+        set_topology_cache_limit(memory + 1);
+        cache.read(trajectory_path, "");
+        CHECK(cache.size() == 1);
+
+        // the least recently used entry was removed
+        auto second = cache.read(topology_path, "");
+        CHECK(first != second);
+
+        // disable the cache
+        set_topology_cache_limit(0);
+        CHECK(cache.size() == 0);
+        cache.read(topology_path, "");
+        CHECK(cache.size() == 0);
+
+        set_topology_cache_limit(TopologyCache::DEFAULT_LIMIT);
+    }
+
+    SECTION("Errors") {
+        CHECK_THROWS_AS(cache.read("not-there.xyz", ""), FileError);
+        CHECK(cache.size() == 0);
+    }
+}
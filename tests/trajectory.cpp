@@ -1,8 +1,10 @@
 // Chemfiles, a modern library for chemistry file reading and writing
 // Copyright (C) Guillaume Fraux and contributors -- BSD license
 
+#include <cstdio>
 #include <fstream>
 #include <thread>
+#include <algorithm>
 
 #include <catch.hpp>
 
@@ -268,6 +270,64 @@ TEST_CASE("reading a files from multiple threads") {
 
 #endif
 
+TEST_CASE("Read many files") {
+    auto base = NamedTempPath("");
+    auto paths = std::vector<std::string>();
+    for (size_t i = 0; i < 20; i++) {
+        auto path = base.path() + "-" + std::to_string(i) + ".xyz";
+        std::ofstream file(path);
+        for (size_t step = 0; step < 2; step++) {
+            file << i + 1 << "\n\n";
+            for (size_t atom = 0; atom < i + 1; atom++) {
+                file << "C " << atom << " " << step << " 0\n";
+            }
+        }
+        paths.push_back(path);
+    }
+
+    auto results = read_files(paths);
+    REQUIRE(results.size() == 20);
+    for (size_t i = 0; i < 20; i++) {
+        CHECK(results[i].path == paths[i]);
+        CHECK(results[i].error.empty());
+        REQUIRE(results[i].frames.size() == 1);
+        CHECK(results[i].frames[0].size() == i + 1);
+    }
+
+    results = read_files(paths, "XYZ", true);
+    for (size_t i = 0; i < 20; i++) {
+        REQUIRE(results[i].frames.size() == 2);
+        CHECK(results[i].frames[1].step() == 1);
+        CHECK(results[i].frames[1].positions()[0] == Vector3D(0, 1, 0));
+    }
+
+    auto with_errors = paths;
+    with_errors.insert(with_errors.begin() + 3, "not-there.xyz");
+    results = read_files(with_errors);
+    REQUIRE(results.size() == 21);
+    CHECK(results[2].frames[0].size() == 3);
+    CHECK(results[3].frames.empty());
+    CHECK(results[3].error == "could not open the file at 'not-there.xyz'");
+    CHECK(results[4].frames[0].size() == 4);
+
+    CHECK(read_files({}).empty());
+
+    auto listed = list_files(base.path() + "-*.xyz");
+    std::sort(paths.begin(), paths.end());
+    CHECK(listed == paths);
+    CHECK(list_files(base.path() + "-?.xyz").size() == 10);
+    CHECK(list_files(base.path() + "-1?.xyz").size() == 10);
+    CHECK(list_files(base.path() + "-*.pdb").empty());
+
+    CHECK_THROWS_WITH(list_files("not-there/*.xyz"),
+        "could not open the directory at 'not-there/': No such file or directory"
+    );
+
+    for (auto& path: paths) {
+        std::remove(path.c_str());
+    }
+}
+
 TEST_CASE("Errors") {
     SECTION("Unknow opening mode") {
         CHECK_THROWS_AS(Trajectory("trajectory.xyz", 'z'), FileError);
@@ -313,3 +373,465 @@ TEST_CASE("Errors") {
         CHECK_THROWS_AS(file.set_topology("topology"), FileError);
     }
 }
+
+TEST_CASE("Follow a growing trajectory") {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    frame.add_atom(Atom("C"), {1, 2, 3});
+    frame.add_atom(Atom("O"), {4, 5, 6});
+    frame.add_atom(Atom("H"), {7, 8, 9});
+
+    for (auto extension: {".xyz", ".xtc", ".trr", ".dcd"}) {
+        auto full = NamedTempPath(extension);
+        auto single = NamedTempPath(extension);
+        {
+            auto trajectory = Trajectory(full, 'w');
+            for (size_t i = 0; i < 3; i++) {
+                frame.set_step(i);
+                trajectory.write(frame);
+            }
+            trajectory = Trajectory(single, 'w');
+            trajectory.write(frame);
+        }
+
+        // use the header from the file containing a single frame, since
+        // some formats store the number of frames in the header
+        auto content = read_binary_file(single);
+        auto first = content.size();
+        auto rest = read_binary_file(full);
+        content.insert(content.end(), rest.begin() + static_cast<std::ptrdiff_t>(first), rest.end());
+        auto frame_size = (content.size() - first) / 2;
+
+        auto growing = NamedTempPath(extension);
+        auto output = std::ofstream(growing.path(), std::ios::binary);
+        auto append = [&](size_t start, size_t end) {
+            output.write(reinterpret_cast<const char*>(content.data() + start), static_cast<std::streamsize>(end - start));
+            output.flush();
+        };
+
+        append(0, first);
+        auto trajectory = Trajectory(growing);
+        CHECK(trajectory.nsteps() == 1);
+        CHECK(trajectory.refresh() == 1);
+
+        // a partially written frame is not counted
+        append(first, first + frame_size / 2);
+        CHECK(trajectory.refresh() == 1);
+        CHECK(trajectory.nsteps() == 1);
+
+        append(first + frame_size / 2, first + frame_size);
+        CHECK(trajectory.refresh() == 2);
+        CHECK(approx_eq(trajectory.read_step(1).positions()[2], Vector3D(7, 8, 9), 1e-6));
+
+        append(first + frame_size, content.size());
+        CHECK(trajectory.refresh() == 3);
+        CHECK(trajectory.nsteps() == 3);
+        auto last = trajectory.read_step(2);
+        CHECK(last.size() == 3);
+        CHECK(approx_eq(last.positions()[0], Vector3D(1, 2, 3), 1e-6));
+    }
+
+    auto file = NamedTempPath(".xyz");
+    auto trajectory = Trajectory(file, 'w');
+    CHECK_THROWS_WITH(trajectory.refresh(),
+        "can not refresh the trajectory at '" + file.path() + "', it was not opened in read mode"
+    );
+}
+
+TEST_CASE("Read multiple steps") {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    for (size_t i = 0; i < 20; i++) {
+        frame.add_atom(Atom("C"), {0, 0, 0});
+    }
+
+    for (auto extension: {".xyz", ".xtc", ".trr", ".dcd"}) {
+        auto file = NamedTempPath(extension);
+        {
+            auto trajectory = Trajectory(file, 'w');
+            for (size_t step = 0; step < 10; step++) {
+                auto positions = frame.positions();
+                for (size_t i = 0; i < frame.size(); i++) {
+                    positions[i] = Vector3D(static_cast<double>(step), static_cast<double>(i), 1);
+                }
+                frame.set_step(step);
+                trajectory.write(frame);
+            }
+        }
+
+        auto trajectory = Trajectory(file);
+        auto steps = std::vector<size_t>{7, 0, 3, 3, 9};
+        auto frames = trajectory.read_steps(steps);
+        REQUIRE(frames.size() == steps.size());
+        for (size_t i = 0; i < steps.size(); i++) {
+            auto expected = trajectory.read_step(steps[i]);
+            REQUIRE(frames[i].size() == 20);
+            CHECK(frames[i].step() == expected.step());
+            CHECK(frames[i].positions()[5] == expected.positions()[5]);
+            CHECK(approx_eq(frames[i].positions()[5][0], static_cast<double>(steps[i]), 1e-6));
+        }
+
+        CHECK(trajectory.read_steps({}).empty());
+        CHECK_THROWS_WITH(trajectory.read_steps({2, 10}),
+            "can not read file '" + file.path() + "' at step 10: maximal step is 9"
+        );
+    }
+}
+
+TEST_CASE("Access pattern hints") {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    for (size_t i = 0; i < 1000; i++) {
+        frame.add_atom(Atom("C"), {0, 0, 0});
+    }
+
+    for (auto extension: {".xyz", ".xtc", ".trr", ".dcd"}) {
+        auto file = NamedTempPath(extension);
+        {
+            auto trajectory = Trajectory(file, 'w');
+            CHECK_THROWS_WITH(trajectory.set_access_pattern(AccessPattern::SEQUENTIAL),
+                "the file at '" + file.path() + "' was not opened in read mode"
+            );
+            for (size_t step = 0; step < 10; step++) {
+                frame.positions()[42] = Vector3D(static_cast<double>(step), 0, 0);
+                trajectory.write(frame);
+            }
+        }
+
+        auto trajectory = Trajectory(file);
+        for (auto pattern: {AccessPattern::SEQUENTIAL, AccessPattern::STREAMING}) {
+            trajectory.set_access_pattern(pattern, 3);
+            for (size_t step = 0; step < 10; step++) {
+                auto read = trajectory.read_step(step);
+                CHECK(approx_eq(read.positions()[42][0], static_cast<double>(step), 1e-6));
+            }
+        }
+
+        trajectory.set_access_pattern(AccessPattern::RANDOM);
+        CHECK(approx_eq(trajectory.read_step(7).positions()[42][0], 7.0, 1e-6));
+        trajectory.set_access_pattern(AccessPattern::NORMAL);
+        CHECK(approx_eq(trajectory.read_step(2).positions()[42][0], 2.0, 1e-6));
+    }
+}
+
+TEST_CASE("Frame cache") {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    for (size_t i = 0; i < 100; i++) {
+        frame.add_atom(Atom("C"), {0, 0, 0});
+    }
+
+    for (auto extension: {".xyz", ".xtc"}) {
+        auto file = NamedTempPath(extension);
+        {
+            auto trajectory = Trajectory(file, 'w');
+            CHECK_THROWS_WITH(trajectory.set_frame_cache(1024 * 1024),
+                "the file at '" + file.path() + "' was not opened in read mode"
+            );
+            for (size_t step = 0; step < 20; step++) {
+                frame.set_step(step);
+                frame.positions()[42] = Vector3D(static_cast<double>(step), 0, 0);
+                trajectory.write(frame);
+            }
+        }
+
+        auto trajectory = Trajectory(file);
+        trajectory.set_frame_cache(64 * 1024 * 1024, 3);
+
+        // going back and forth around the current step
+        for (auto step: {10, 11, 9, 13, 7, 10, 14, 0, 19, 2}) {
+            auto read = trajectory.read_step(static_cast<size_t>(step));
+            CHECK(read.step() == static_cast<size_t>(step));
+            CHECK(read.size() == 100);
+            CHECK(approx_eq(read.positions()[42][0], static_cast<double>(step), 1e-5));
+        }
+
+        // sequential reading with the cache
+        auto sequential = Trajectory(file);
+        sequential.set_frame_cache(64 * 1024 * 1024, 2);
+        for (size_t step = 0; step < 20; step++) {
+            auto read = sequential.read();
+            CHECK(read.step() == step);
+            CHECK(approx_eq(read.positions()[42][0], static_cast<double>(step), 1e-5));
+        }
+        CHECK(sequential.done());
+
+        // mixing cached and missing steps
+        trajectory.set_frame_cache(64 * 1024 * 1024);
+        auto frames = trajectory.read_steps({15, 3, 8});
+        REQUIRE(frames.size() == 3);
+        CHECK(frames[0].step() == 15);
+        CHECK(approx_eq(frames[1].positions()[42][0], 3.0, 1e-5));
+        CHECK(approx_eq(frames[2].positions()[42][0], 8.0, 1e-5));
+
+        // the custom topology is used for cached frames
+        auto topology = Topology();
+        topology.resize(100);
+        topology.add_bond(0, 1);
+        trajectory.set_topology(topology);
+        CHECK(trajectory.read_step(10).topology().bonds().size() == 1);
+
+        // disabling the cache
+        trajectory.set_frame_cache(0);
+        CHECK(approx_eq(trajectory.read_step(5).positions()[42][0], 5.0, 1e-5));
+    }
+}
+
+TEST_CASE("Transformations when reading") {
+    auto file = NamedTempPath(".xyz");
+    {
+        auto trajectory = Trajectory(file, 'w');
+        CHECK_THROWS_WITH(trajectory.set_transformations(Transformations().wrap()),
+            "the file at '" + file.path() + "' was not opened in read mode"
+        );
+
+        auto frame = Frame(UnitCell({10, 10, 10}));
+        frame.add_atom(Atom("O"), {0, 0, 0});
+        frame.add_atom(Atom("H"), {1, 0, 0});
+        frame.add_atom(Atom("H"), {0, 1, 0});
+        for (size_t step = 0; step < 5; step++) {
+            frame.positions()[0] = Vector3D(static_cast<double>(step), 0, 0);
+            trajectory.write(frame);
+        }
+    }
+
+    auto trajectory = Trajectory(file);
+    trajectory.set_transformations(Transformations().subset({2, 0}).scale(0.1));
+
+    auto frame = trajectory.read();
+    CHECK(frame.size() == 2);
+    CHECK(frame[0].name() == "H");
+    CHECK(approx_eq(frame.positions()[1], Vector3D(0, 0, 0), 1e-12));
+    CHECK(approx_eq(frame.cell().lengths(), Vector3D(1, 1, 1), 1e-12));
+
+    frame = trajectory.read_step(3);
+    CHECK(approx_eq(frame.positions()[1], Vector3D(0.3, 0, 0), 1e-12));
+
+    // transformations also apply to cached frames
+    trajectory.set_frame_cache(1024 * 1024, 2);
+    auto frames = trajectory.read_steps({4, 1});
+    CHECK(frames[0].size() == 2);
+    CHECK(approx_eq(frames[0].positions()[1], Vector3D(0.4, 0, 0), 1e-12));
+    frame = trajectory.read_step(2);
+    CHECK(approx_eq(frame.positions()[1], Vector3D(0.2, 0, 0), 1e-12));
+
+    trajectory.set_transformations(Transformations());
+    frame = trajectory.read_step(2);
+    CHECK(frame.size() == 3);
+}
+
+static std::string written_text(const Trajectory& trajectory) {
+    auto buffer = trajectory.memory_buffer().value();
+    return std::string(buffer.data(), buffer.size());
+}
+
+static std::vector<Frame> frames_to_write(size_t start, size_t stop) {
+    auto frames = std::vector<Frame>();
+    for (size_t step = start; step < stop; step++) {
+        auto frame = Frame(UnitCell({10, 10, 10}));
+        frame.add_atom(Atom("O"), {static_cast<double>(step), 0, 0});
+        frame.add_atom(Atom("H"), {1, 0, 0});
+        frame.add_atom(Atom("H"), {0, 1, 0});
+        frame.set_step(step);
+        frames.emplace_back(std::move(frame));
+    }
+    return frames;
+}
+
+TEST_CASE("Write multiple frames") {
+    auto frames = frames_to_write(0, 25);
+
+    set_num_threads(4);
+    for (auto format: {"XYZ", "PDB", "GRO", "SDF"}) {
+        auto expected = Trajectory::memory_writer(format);
+        for (const auto& frame: frames) {
+            expected.write(frame);
+        }
+
+        // SDF does not support formatting frames in parallel, and writes them
+        // one by one
+        auto trajectory = Trajectory::memory_writer(format);
+        trajectory.write(frames[0]);
+        trajectory.write(frames_to_write(1, 25));
+        CHECK(written_text(trajectory) == written_text(expected));
+    }
+
+    SECTION("Custom topology and cell") {
+        auto topology = Topology();
+        topology.add_atom(Atom("Zn"));
+        topology.add_atom(Atom("Zn"));
+        topology.add_atom(Atom("Zn"));
+
+        auto trajectory = Trajectory::memory_writer("XYZ");
+        trajectory.set_topology(topology);
+        trajectory.set_cell(UnitCell({3, 3, 3}));
+        trajectory.write(frames_to_write(0, 2));
+
+        auto text = written_text(trajectory);
+        CHECK(text.find("Zn 1 0 0") != std::string::npos);
+        CHECK(text.find("Lattice=\"3 0 0 0 3 0 0 0 3\"") != std::string::npos);
+        CHECK(text.find("O ") == std::string::npos);
+    }
+
+    SECTION("Large frames") {
+        auto frame = Frame();
+        for (size_t i = 0; i < 10000; i++) {
+            frame.add_atom(Atom("C"), {static_cast<double>(i), 0.5, -1.25});
+        }
+
+        set_num_threads(1);
+        auto expected = Trajectory::memory_writer("XYZ");
+        expected.write(frame);
+
+        set_num_threads(4);
+        auto trajectory = Trajectory::memory_writer("XYZ");
+        trajectory.write(frame);
+        CHECK(written_text(trajectory) == written_text(expected));
+    }
+
+    SECTION("Errors") {
+        // the frames before the one that can not be formatted are written
+        auto invalid = frames_to_write(0, 25);
+        invalid[10].positions()[0] = Vector3D(1e10, 0, 0);
+
+        auto expected = Trajectory::memory_writer("GRO");
+        for (size_t i = 0; i < 10; i++) {
+            expected.write(invalid[i]);
+        }
+
+        auto trajectory = Trajectory::memory_writer("GRO");
+        CHECK_THROWS(trajectory.write(invalid));
+        CHECK(written_text(trajectory) == written_text(expected));
+    }
+
+    set_num_threads(0);
+
+    auto file = NamedTempPath(".xyz");
+    Trajectory(file, 'w').write(frames);
+    auto trajectory = Trajectory(file);
+    CHECK(trajectory.nsteps() == 25);
+    CHECK(trajectory.read_step(12).positions()[0] == Vector3D(12, 0, 0));
+}
+
+TEST_CASE("Read large frames") {
+    // frames larger than PARALLEL_PARSE_GRAIN atoms are parsed in parallel
+    auto frame = Frame(UnitCell({100, 100, 100}));
+    for (size_t i = 0; i < 10000; i++) {
+        auto x = static_cast<double>(i % 100) * 0.5;
+        frame.add_atom(Atom(i % 3 == 0 ? "O" : "H"), {x, 1.25, -2.5});
+    }
+    for (size_t i = 0; i < 10000; i += 3) {
+        auto residue = Residue("WAT", static_cast<int64_t>(i / 3 + 1));
+        residue.set("chainid", "A");
+        for (size_t j = i; j < std::min<size_t>(i + 3, 10000); j++) {
+            residue.add_atom(j);
+        }
+        frame.add_residue(std::move(residue));
+    }
+
+    for (auto format: {"XYZ", "GRO", "LAMMPS Data", "mmCIF"}) {
+        auto writer = Trajectory::memory_writer(format);
+        writer.write(frame);
+        auto text = written_text(writer);
+
+        set_num_threads(1);
+        auto expected = Trajectory::memory_reader(text.data(), text.size(), format).read();
+
+        set_num_threads(4);
+        auto parsed = Trajectory::memory_reader(text.data(), text.size(), format).read();
+
+        REQUIRE(parsed.size() == 10000);
+        REQUIRE(expected.size() == 10000);
+        CHECK(parsed.positions()[4242] == Vector3D(21, 1.25, -2.5));
+        for (size_t i = 0; i < 10000; i++) {
+            CHECK(parsed[i].name() == expected[i].name());
+            CHECK(parsed.positions()[i] == expected.positions()[i]);
+        }
+
+        const auto& residues = parsed.topology().residues();
+        REQUIRE(residues.size() == expected.topology().residues().size());
+        for (size_t i = 0; i < residues.size(); i++) {
+            CHECK(residues[i].id() == expected.topology().residues()[i].id());
+            CHECK(residues[i].size() == expected.topology().residues()[i].size());
+        }
+    }
+
+    set_num_threads(0);
+}
+
+TEST_CASE("Read steps with a fixed size") {
+    auto write_frames = [](const std::string& format, const std::vector<double>& values) {
+        auto writer = Trajectory::memory_writer(format);
+        for (auto x: values) {
+            auto frame = Frame(UnitCell({10, 10, 10}));
+            frame.add_atom(Atom("O"), {x, 0, 0});
+            frame.add_atom(Atom("H"), {1, 0, 0});
+            frame.add_atom(Atom("H"), {0, 1, 0});
+            writer.write(frame);
+        }
+        return written_text(writer);
+    };
+
+    auto values = std::vector<double>();
+    for (size_t i = 0; i < 300; i++) {
+        values.push_back(100 + static_cast<double>(i));
+    }
+
+    for (auto format: {"XYZ", "GRO"}) {
+        auto text = write_frames(format, values);
+        auto trajectory = Trajectory::memory_reader(text.data(), text.size(), format);
+        CHECK(trajectory.nsteps() == 300);
+        CHECK(trajectory.read_step(257).positions()[0][0] == 357);
+        CHECK(trajectory.read_step(299).positions()[0][0] == 399);
+        CHECK(trajectory.read_step(2).positions()[0][0] == 102);
+        CHECK_THROWS(trajectory.read_step(300));
+    }
+
+    // one step is longer and a later one is shorter, keeping the total size a
+    // multiple of the size of the first steps
+    values[30] = 1000;
+    values[250] = 10;
+    auto text = write_frames("XYZ", values);
+    auto trajectory = Trajectory::memory_reader(text.data(), text.size(), "XYZ");
+    CHECK(trajectory.nsteps() == 300);
+    CHECK(trajectory.read_step(30).positions()[0][0] == 1000);
+    CHECK(trajectory.read_step(100).positions()[0][0] == 200);
+    CHECK(trajectory.read_step(250).positions()[0][0] == 10);
+    CHECK(trajectory.read_step(299).positions()[0][0] == 399);
+}
+
+TEST_CASE("Append to compressed files") {
+    auto frame = Frame();
+    frame.add_atom(Atom("C"), {1, 2, 3});
+
+    for (auto extension: {".xyz", ".xyz.gz", ".xyz.xz", ".xyz.bz2"}) {
+        auto file = NamedTempPath(extension);
+        {
+            auto trajectory = Trajectory(file, 'w');
+            for (size_t i = 0; i < 3; i++) {
+                frame.positions()[0][0] = static_cast<double>(i);
+                trajectory.write(frame);
+            }
+        }
+
+        {
+            // the existing steps are only counted when needed
+            auto trajectory = Trajectory(file, 'a');
+            frame.positions()[0][0] = 3;
+            trajectory.write(frame);
+            CHECK(trajectory.nsteps() == 4);
+
+            frame.positions()[0][0] = 4;
+            trajectory.write(frame);
+            CHECK(trajectory.nsteps() == 5);
+        }
+
+        {
+            auto trajectory = Trajectory(file, 'a');
+            frame.positions()[0][0] = 5;
+            trajectory.write(frame);
+        }
+
+        auto trajectory = Trajectory(file);
+        REQUIRE(trajectory.nsteps() == 6);
+        for (size_t i = 0; i < 6; i++) {
+            CHECK(trajectory.read_step(i).positions()[0][0] == static_cast<double>(i));
+        }
+    }
+}
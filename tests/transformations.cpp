@@ -0,0 +1,190 @@
+// Chemfiles, a modern library for chemistry file reading and writing
+// Copyright (C) Guillaume Fraux and contributors -- BSD license
+
+#include <catch.hpp>
+#include "helpers.hpp"
+#include "chemfiles.hpp"
+using namespace chemfiles;
+
+static Frame test_frame() {
+    auto frame = Frame(UnitCell({10, 10, 10}));
+    frame.add_velocities();
+    frame.add_atom(Atom("O"), {1, 1, 1}, {1, 0, 0});
+    frame.add_atom(Atom("H"), {2, 1, 1}, {0, 1, 0});
+    frame.add_atom(Atom("H"), {1, 2, 1}, {0, 0, 1});
+    frame.add_atom(Atom("Zn"), {9, 9, 9}, {1, 1, 1});
+    frame.add_bond(0, 1);
+    frame.add_bond(0, 2, Bond::SINGLE);
+
+    auto water = Residue("WAT", 3);
+    water.add_atom(0);
+    water.add_atom(1);
+    water.add_atom(2);
+    water.set("chainid", "A");
+    frame.add_residue(water);
+
+    auto zinc = Residue("ZN", 4);
+    zinc.add_atom(3);
+    frame.add_residue(zinc);
+
+    frame.set("name", "test");
+    frame.set_step(33);
+    return frame;
+}
+
+TEST_CASE("Transformations") {
+    SECTION("Errors") {
+        auto transformations = Transformations();
+        CHECK_THROWS_WITH(transformations.subset({0, 3, 0}),
+            "atom 0 appears multiple times in the subset"
+        );
+        CHECK_THROWS_WITH(transformations.center({}),
+            "can not center on an empty list of atoms"
+        );
+
+        transformations.center({12});
+        auto frame = test_frame();
+        CHECK_THROWS_WITH(transformations.apply(frame),
+            "out of bounds atomic index in transformations: the frame has 4 atoms, but the index is 12"
+        );
+    }
+
+    SECTION("Empty") {
+        auto transformations = Transformations();
+        CHECK(transformations.empty());
+
+        auto frame = test_frame();
+        transformations.apply(frame);
+        CHECK(frame.size() == 4);
+        CHECK(frame.positions()[3] == Vector3D(9, 9, 9));
+    }
+
+    SECTION("Scale") {
+        auto transformations = Transformations().scale(10);
+        CHECK_FALSE(transformations.empty());
+
+        auto frame = test_frame();
+        transformations.apply(frame);
+        CHECK(frame.positions()[1] == Vector3D(20, 10, 10));
+        CHECK((*frame.velocities())[3] == Vector3D(10, 10, 10));
+        CHECK(frame.cell().lengths() == Vector3D(100, 100, 100));
+        CHECK(frame.cell().shape() == UnitCell::ORTHORHOMBIC);
+    }
+
+    SECTION("Center and wrap") {
+        auto transformations = Transformations().center({0, 1, 2}).wrap();
+
+        auto frame = test_frame();
+        transformations.apply(frame);
+        auto positions = frame.positions();
+        CHECK(approx_eq(positions[0], Vector3D(-1.0 / 3.0, -1.0 / 3.0, 0), 1e-12));
+        CHECK(approx_eq(positions[1], Vector3D(2.0 / 3.0, -1.0 / 3.0, 0), 1e-12));
+        // wrapped in the cell: 9 - 4/3 - 10
+        CHECK(approx_eq(positions[3], Vector3D(-7.0 / 3.0, -7.0 / 3.0, -2), 1e-12));
+
+        // the order of transformations matters
+        transformations = Transformations().scale(2).center({3});
+        frame = test_frame();
+        transformations.apply(frame);
+        CHECK(approx_eq(frame.positions()[3], Vector3D(0, 0, 0), 1e-12));
+        CHECK(approx_eq(frame.positions()[0], Vector3D(-16, -16, -16), 1e-12));
+
+        // infinite cells are not wrapped
+        transformations = Transformations().wrap();
+        frame = test_frame();
+        frame.set_cell(UnitCell());
+        transformations.apply(frame);
+        CHECK(frame.positions()[3] == Vector3D(9, 9, 9));
+    }
+
+    SECTION("Subset") {
+        auto transformations = Transformations().subset({3, 0, 1}).scale(0.5);
+
+        for (size_t repeat = 0; repeat < 2; repeat++) {
+            // the second time uses the cached topology
+            auto frame = test_frame();
+            transformations.apply(frame);
+
+            CHECK(frame.size() == 3);
+            CHECK(frame.step() == 33);
+            CHECK(frame.get("name")->as_string() == "test");
+            CHECK(frame[0].name() == "Zn");
+            CHECK(frame[1].name() == "O");
+            CHECK(frame[2].name() == "H");
+
+            CHECK(frame.positions()[0] == Vector3D(4.5, 4.5, 4.5));
+            CHECK(frame.positions()[2] == Vector3D(1, 0.5, 0.5));
+            CHECK((*frame.velocities())[1] == Vector3D(0.5, 0, 0));
+            CHECK(frame.cell().lengths() == Vector3D(5, 5, 5));
+
+            const auto& topology = frame.topology();
+            REQUIRE(topology.bonds().size() == 1);
+            CHECK(topology.bonds()[0] == Bond(1, 2));
+
+            REQUIRE(topology.residues().size() == 2);
+            auto residue = topology.residue_for_atom(1);
+            REQUIRE(residue);
+            CHECK(residue->name() == "WAT");
+            CHECK(residue->size() == 2);
+            CHECK(residue->get("chainid")->as_string() == "A");
+            CHECK(topology.residue_for_atom(0)->name() == "ZN");
+        }
+
+        // a different topology is handled correctly
+        auto frame = test_frame();
+        frame[3].set_name("Cu");
+        transformations.apply(frame);
+        CHECK(frame[0].name() == "Cu");
+    }
+
+    SECTION("Needed atoms") {
+        CHECK_FALSE(Transformations().needed_atoms());
+        CHECK_FALSE(Transformations().center({5}).needed_atoms());
+        CHECK(Transformations().subset({3, 0, 1}).needed_atoms().value() == 4);
+        CHECK(Transformations().subset({1, 2}).center({6}).needed_atoms().value() == 7);
+    }
+
+    SECTION("Align") {
+        auto reference = test_frame();
+
+        // rotate the frame by 90° around z and translate it
+        auto frame = test_frame();
+        for (auto& position: frame.positions()) {
+            position = Vector3D(-position[1], position[0], position[2]) + Vector3D(3, 0, -1);
+        }
+        auto velocities = *frame.velocities();
+        for (auto& velocity: velocities) {
+            velocity = Vector3D(-velocity[1], velocity[0], velocity[2]);
+        }
+
+        auto transformations = Transformations().align(reference, {0, 1, 2});
+        transformations.apply(frame);
+        for (size_t i = 0; i < 4; i++) {
+            CHECK(approx_eq(frame.positions()[i], reference.positions()[i], 1e-9));
+            CHECK(approx_eq((*frame.velocities())[i], (*reference.velocities())[i], 1e-9));
+        }
+        CHECK(frame.cell().lengths() == Vector3D(10, 10, 10));
+
+        // previous transformations are used to compute the alignment
+        frame = test_frame();
+        transformations = Transformations().subset({3, 0, 1, 2}).scale(0.5).align(reference);
+        transformations.apply(frame);
+        CHECK(frame.size() == 4);
+        CHECK(frame[0].name() == "Zn");
+        // the Zn atom is mis-placed relative to the scaled water molecule
+        CHECK_FALSE(approx_eq(frame.positions()[0], reference.positions()[3], 1e-3));
+
+        frame = test_frame();
+        transformations = Transformations().center({0}).align(reference, {0, 1, 2}).scale(2);
+        transformations.apply(frame);
+        CHECK(approx_eq(frame.positions()[0], 2 * reference.positions()[0], 1e-9));
+        CHECK(approx_eq(frame.positions()[3], 2 * reference.positions()[3], 1e-9));
+
+        CHECK_THROWS_WITH(Transformations().align(Frame()),
+            "can not align on an empty list of atoms"
+        );
+        CHECK_THROWS_WITH(Transformations().align(reference, {0, 6}),
+            "out of bounds atomic index in alignment: the reference has 4 atoms, but the index is 6"
+        );
+    }
+}